@@ -0,0 +1,162 @@
+// CPU 合成器与 SDL 软件渲染器的对比，宠物数量 1 / 100 / 1000
+// 两条路径画同一组宠物（x3 像素画，一半水平翻转）到同一个软件渲染目标：
+// - SDL：预缩放 x3 纹理 + SDL_BLENDMODE_BLEND，逐个 SDL_RenderTexture（与游戏里 GPU 不可用时相同）
+// - CPU：预乘 x1 像素，CpuCanvas 缩放/翻转/混合，再一次上传 + 拷贝
+// 先比较两条路径的输出（每个通道的最大差值），再计时
+#include "core/compositor.h"
+#include "tools/random.h"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kScreenW = 1920;
+constexpr int kScreenH = 1080;
+constexpr int kFrameSize = 48;
+constexpr int kFrameCount = 4;
+constexpr int kScale = 3;
+constexpr int kRounds = 100;
+constexpr int kTolerance = 3; // SDL 的直通 alpha 混合与预乘混合舍入不同
+
+struct Pet {
+    SDL_Rect dst;
+    int frame;
+    bool flip;
+};
+
+// 程序生成的精灵表：不透明的身体、半透明的边缘、透明背景（不依赖资源文件）
+SDL_Surface* makeSheet(){
+    SDL_Surface* sheet = SDL_CreateSurface(kFrameSize * kFrameCount, kFrameSize, SDL_PIXELFORMAT_ARGB8888);
+    if(!sheet) return nullptr;
+    for(int y = 0; y < sheet->h; y++){
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(sheet->pixels) + y * sheet->pitch);
+        for(int x = 0; x < sheet->w; x++){
+            const int f = x / kFrameSize;
+            const int cx = x % kFrameSize - kFrameSize / 2 - f, cy = y - kFrameSize / 2 - 4;
+            const int d2 = cx * cx + cy * cy;
+            Uint32 a = 0;
+            if(d2 < 17 * 17) a = 255;
+            else if(d2 < 20 * 20) a = static_cast<Uint32>(255 - (d2 - 17 * 17) * 255 / (20 * 20 - 17 * 17));
+            const Uint32 r = 0xD2, g = static_cast<Uint32>(0x2F + (x * 7) % 128), b = static_cast<Uint32>(0x1E + (y * 5) % 200);
+            row[x] = a ? (a << 24) | (r << 16) | (g << 8) | b : 0;
+        }
+    }
+    return sheet;
+}
+
+std::vector<Pet> placePets(int count){
+    tools::Random::setSeed(42);
+    std::vector<Pet> pets(count);
+    const int size = kFrameSize * kScale;
+    for(Pet& p : pets){
+        p.dst = SDL_Rect{tools::Random::randint(-size / 2, kScreenW - size / 2), tools::Random::randint(-size / 2, kScreenH - size / 2), size, size};
+        p.frame = tools::Random::randint(0, kFrameCount - 1);
+        p.flip = tools::Random::randint(0, 1) == 1;
+    }
+    return pets;
+}
+
+void drawSDL(SDL_Renderer* renderer, SDL_Texture* scaled, const std::vector<Pet>& pets){
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    for(const Pet& p : pets){
+        const SDL_FRect src{static_cast<float>(p.frame * kFrameSize * kScale), 0.0f, static_cast<float>(kFrameSize * kScale), static_cast<float>(kFrameSize * kScale)};
+        const SDL_FRect dst{static_cast<float>(p.dst.x), static_cast<float>(p.dst.y), static_cast<float>(p.dst.w), static_cast<float>(p.dst.h)};
+        SDL_RenderTextureRotated(renderer, scaled, &src, &dst, 0.0, nullptr, p.flip ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+    }
+    SDL_FlushRenderer(renderer);
+}
+
+void drawCPU(SDL_Renderer* renderer, const CpuSprite& sprite, const std::vector<Pet>& pets){
+    Compositor& compositor = Compositor::getInstance();
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    compositor.begin();
+    for(const Pet& p : pets){
+        compositor.draw(sprite, SDL_Rect{p.frame * kFrameSize, 0, kFrameSize, kFrameSize}, p.dst, p.flip);
+    }
+    compositor.present();
+    SDL_FlushRenderer(renderer);
+}
+
+std::vector<Uint32> readPixels(SDL_Surface* target){
+    std::vector<Uint32> out(static_cast<size_t>(target->w) * target->h);
+    for(int y = 0; y < target->h; y++){
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(target->pixels) + y * target->pitch);
+        std::copy(row, row + target->w, out.begin() + static_cast<size_t>(y) * target->w);
+    }
+    return out;
+}
+
+int maxChannelDiff(const std::vector<Uint32>& a, const std::vector<Uint32>& b){
+    int diff = 0;
+    for(size_t i = 0; i < a.size(); i++){
+        for(int shift = 0; shift < 32; shift += 8){
+            const int d = std::abs(static_cast<int>((a[i] >> shift) & 0xFF) - static_cast<int>((b[i] >> shift) & 0xFF));
+            diff = std::max(diff, d);
+        }
+    }
+    return diff;
+}
+
+double msPerFrame(Clock::time_point start, Clock::time_point end){
+    return std::chrono::duration<double, std::milli>(end - start).count() / kRounds;
+}
+
+bool run(SDL_Surface* target, SDL_Renderer* renderer, SDL_Texture* scaled, const CpuSprite& sprite, int count){
+    const std::vector<Pet> pets = placePets(count);
+
+    drawSDL(renderer, scaled, pets);
+    const std::vector<Uint32> expected = readPixels(target);
+    drawCPU(renderer, sprite, pets);
+    const int diff = maxChannelDiff(expected, readPixels(target));
+
+    auto t0 = Clock::now();
+    for(int i = 0; i < kRounds; i++) drawSDL(renderer, scaled, pets);
+    auto t1 = Clock::now();
+    for(int i = 0; i < kRounds; i++) drawCPU(renderer, sprite, pets);
+    auto t2 = Clock::now();
+
+    const double sdlMs = msPerFrame(t0, t1), cpuMs = msPerFrame(t1, t2);
+    std::printf("%5d pets | sdl %8.3f ms | cpu %8.3f ms | %5.2fx | max diff %d %s\n",
+                count, sdlMs, cpuMs, cpuMs > 0.0 ? sdlMs / cpuMs : 0.0, diff, diff <= kTolerance ? "ok" : "MISMATCH");
+    return diff <= kTolerance;
+}
+
+}
+
+int main(int argc, char* argv[]){
+    SDL_Surface* target = SDL_CreateSurface(kScreenW, kScreenH, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    SDL_Surface* sheet = makeSheet();
+    SDL_Surface* sheetX3 = sheet ? SDL_ScaleSurface(sheet, sheet->w * kScale, sheet->h * kScale, SDL_SCALEMODE_NEAREST) : nullptr;
+    SDL_Texture* scaled = (renderer && sheetX3) ? SDL_CreateTextureFromSurface(renderer, sheetX3) : nullptr;
+    if(!scaled || !Compositor::getInstance().init(renderer, kScreenW, kScreenH)){
+        std::fprintf(stderr, "setup failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_SetTextureBlendMode(scaled, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(scaled, SDL_SCALEMODE_NEAREST);
+    const CpuSprite sprite = CpuSprite::premultiply(sheet);
+    std::printf("kernel: %s\n", Compositor::getInstance().getKernelName());
+
+    bool ok = true;
+    for(int count : {1, 100, 1000}){
+        ok = run(target, renderer, scaled, sprite, count) && ok;
+    }
+
+    Compositor::getInstance().shutdown();
+    SDL_DestroyTexture(scaled);
+    SDL_DestroySurface(sheetX3);
+    SDL_DestroySurface(sheet);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(target);
+    return ok ? 0 : 1;
+}
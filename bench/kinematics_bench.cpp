@@ -0,0 +1,90 @@
+// 宠物移动：逐只 KinematicBody::step 与 KinematicsBatch::integrate（SoA + SIMD）的对比，数量 1 .. 10k
+// 每轮所有物体前进一帧，到达的物体换一个新目标（两条路径用同一串目标）；约一半的物体在走动
+// 同时核对两条路径的位置差与到达次数
+#include "tools/kinematics.h"
+#include "tools/random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using tools::math::KinematicBody;
+using tools::math::KinematicsBatch;
+
+constexpr float kScreenW = 1920.0f;
+constexpr float kScreenH = 1080.0f;
+constexpr float kDt = 1.0f / 60.0f;
+constexpr int kRounds = 600;
+
+double elapsedNs(Clock::time_point start, Clock::time_point end){
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+glm::vec2 randomPoint(tools::RandomStream& rng){
+    return glm::vec2(rng.randfloat(0.0f, kScreenW), rng.randfloat(0.0f, kScreenH));
+}
+
+void run(int count){
+    tools::RandomStream rng(42);
+    std::vector<KinematicBody> bodies(count);
+    KinematicsBatch batch;
+    for(int i = 0; i < count; i++){
+        KinematicBody& b = bodies[i];
+        b.position = randomPoint(rng);
+        if(i % 2 == 0){
+            b.moveTo(randomPoint(rng)); // 另一半待机
+        }
+        batch.add(b);
+    }
+    // 两条路径到达后取同一个新目标
+    std::vector<glm::vec2> retarget(static_cast<size_t>(count) * 8);
+    for(glm::vec2& t : retarget) t = randomPoint(rng);
+    std::vector<size_t> nextScalar(count, 0), nextBatch(count, 0);
+
+    double scalarNs = 0, batchNs = 0;
+    long long scalarArrivals = 0, batchArrivals = 0;
+    for(int round = 0; round < kRounds; round++){
+        auto t0 = Clock::now();
+        for(int i = 0; i < count; i++){
+            if(bodies[i].step(kDt)){
+                scalarArrivals++;
+                bodies[i].moveTo(retarget[static_cast<size_t>(i) * 8 + nextScalar[i]++ % 8]);
+            }
+        }
+        auto t1 = Clock::now();
+        batch.integrate(kDt);
+        for(int i = 0; i < count; i++){
+            if(batch.arrived(i)){
+                batchArrivals++;
+                batch.setTarget(i, retarget[static_cast<size_t>(i) * 8 + nextBatch[i]++ % 8]);
+            }
+        }
+        auto t2 = Clock::now();
+        scalarNs += elapsedNs(t0, t1);
+        batchNs += elapsedNs(t1, t2);
+    }
+
+    float maxDiff = 0.0f;
+    for(int i = 0; i < count; i++){
+        const glm::vec2 d = bodies[i].position - batch.getPosition(i);
+        maxDiff = std::max(maxDiff, std::sqrt(d.x * d.x + d.y * d.y));
+    }
+    const double steps = static_cast<double>(kRounds) * count;
+    std::printf("%6d pets | scalar %7.2f ns/pet | batch(%s) %7.2f ns/pet | x%.2f | arrivals %lld/%lld | max diff %.4f px\n",
+                count, scalarNs / steps, KinematicsBatch::kernelName(), batchNs / steps,
+                batchNs > 0.0 ? scalarNs / batchNs : 0.0, scalarArrivals, batchArrivals, maxDiff);
+}
+
+}
+
+int main(int argc, char* argv[]){
+    for(int count : {1, 10, 100, 1000, 10000}){
+        run(count);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// SpatialGrid 与线性扫描的对比，宠物数量 1 .. 10k
+// 每轮：所有宠物移动一小步并增量更新，然后做点 / 矩形 / 半径查询
+#include "tools/spatial_grid.h"
+#include "tools/random.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kScreenW = 1920;
+constexpr int kScreenH = 1080;
+constexpr int kPetSize = 144;
+constexpr int kRounds = 200;
+constexpr int kQueriesPerRound = 64;
+
+double elapsedNs(Clock::time_point start, Clock::time_point end){
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+int linearPoint(const std::vector<SDL_Rect>& rects, SDL_Point p){
+    int best = -1;
+    for(int i = 0; i < static_cast<int>(rects.size()); i++){
+        const SDL_Rect& r = rects[i];
+        if(p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h) best = i;
+    }
+    return best;
+}
+
+void run(int count){
+    tools::Random::setSeed(42);
+    std::vector<SDL_Rect> rects(count);
+    tools::SpatialGrid grid(128);
+    for(int i = 0; i < count; i++){
+        rects[i] = SDL_Rect{tools::Random::randint(0, kScreenW - kPetSize), tools::Random::randint(0, kScreenH - kPetSize), kPetSize, kPetSize};
+        grid.insert(i, rects[i], i);
+    }
+
+    std::vector<SDL_Point> points(kQueriesPerRound);
+    for(auto& p : points){
+        p = SDL_Point{tools::Random::randint(0, kScreenW), tools::Random::randint(0, kScreenH)};
+    }
+
+    std::vector<int> out;
+    out.reserve(count);
+    double updateNs = 0, gridPointNs = 0, linearPointNs = 0, rectNs = 0, radiusNs = 0;
+    long long checksum = 0;
+
+    for(int round = 0; round < kRounds; round++){
+        auto t0 = Clock::now();
+        for(int i = 0; i < count; i++){
+            rects[i].x += (round & 1) ? 3 : -3;
+            grid.update(i, rects[i]);
+        }
+        auto t1 = Clock::now();
+        for(const SDL_Point& p : points) checksum += grid.queryPoint(p);
+        auto t2 = Clock::now();
+        for(const SDL_Point& p : points) checksum -= linearPoint(rects, p);
+        auto t3 = Clock::now();
+        for(const SDL_Point& p : points){
+            grid.queryRect(SDL_Rect{p.x - 100, p.y - 100, 200, 200}, out);
+            checksum += static_cast<long long>(out.size());
+        }
+        auto t4 = Clock::now();
+        for(const SDL_Point& p : points){
+            grid.queryRadius(SDL_FPoint{static_cast<float>(p.x), static_cast<float>(p.y)}, 150.0f, out);
+            checksum += static_cast<long long>(out.size());
+        }
+        auto t5 = Clock::now();
+        updateNs += elapsedNs(t0, t1);
+        gridPointNs += elapsedNs(t1, t2);
+        linearPointNs += elapsedNs(t2, t3);
+        rectNs += elapsedNs(t3, t4);
+        radiusNs += elapsedNs(t4, t5);
+    }
+
+    const double queries = static_cast<double>(kRounds) * kQueriesPerRound;
+    std::printf("%6d pets | update %8.1f ns/pet | point grid %8.1f ns linear %9.1f ns | rect %8.1f ns | radius %8.1f ns | (%lld)\n",
+                count,
+                updateNs / (static_cast<double>(kRounds) * count),
+                gridPointNs / queries, linearPointNs / queries,
+                rectNs / queries, radiusNs / queries,
+                checksum);
+}
+
+}
+
+int main(int argc, char* argv[]){
+    for(int count : {1, 10, 100, 1000, 10000}){
+        run(count);
+    }
+    return 0;
+}
@@ -1,6 +1,38 @@
 #include "animation.h"
 #include "../tools/manifest_loader.h"
+#include "compositor.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+SpriteGeometry Animation::geometry_ = SpriteGeometry::Trim;
+OverdrawStats Animation::overdraw_;
+
+namespace {
+
+constexpr int kMaxHullVertices = 8; // 与 trimFrames 一致
+
+// 帧内的一部分（精灵表坐标）放到目标矩形里的位置，翻转时左右镜像
+SDL_Rect placePart(const SDL_Rect& frame, const SDL_Rect& part, int x, int y, int width, int height, bool flip){
+    const double sx = static_cast<double>(width) / frame.w, sy = static_cast<double>(height) / frame.h;
+    const int left = flip ? (frame.x + frame.w) - (part.x + part.w) : part.x - frame.x;
+    const int top = part.y - frame.y;
+    const int x0 = x + static_cast<int>(std::lround(left * sx)), x1 = x + static_cast<int>(std::lround((left + part.w) * sx));
+    const int y0 = y + static_cast<int>(std::lround(top * sy)), y1 = y + static_cast<int>(std::lround((top + part.h) * sy));
+    return SDL_Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+} // namespace
+
+const char* getSpriteGeometryName(SpriteGeometry geometry)
+{
+    switch(geometry){
+        case SpriteGeometry::Quad: return "quad";
+        case SpriteGeometry::Trim: return "trim";
+        case SpriteGeometry::Hull: return "hull";
+    }
+    return "unknown";
+}
 
 Animation::Animation()
 {
@@ -24,56 +56,200 @@ void Animation::init(SDL_Texture* texture,
     frames_ = frames;
     isLooping_ = is_loop;
     currentFrame_ = 0;
-    frameTimer_ = 0;
+    frameTimerNs_ = 0;
     isFinished_ = false;
+    cueFrame_ = -1;
+
+}
+
+void Animation::init(std::shared_ptr<SpriteCache> sprites,
+                     const std::vector<AnimationFrame>& frames,
+                     bool is_loop)
+{
+    if(!sprites || sprites->getTexture() == nullptr)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Sprite cache is empty");
+        return;
+    }
 
+    sprites_ = std::move(sprites);
+    texture_ = sprites_->getTexture();
+    frames_ = frames;
+    isLooping_ = is_loop;
+    currentFrame_ = 0;
+    frameTimerNs_ = 0;
+    isFinished_ = false;
+    cueFrame_ = -1;
 }
 
-void Animation::update(float deltaTime)
+void Animation::advance(Uint64 ns)
 {
     if(isFinished_ || frames_.empty()){
         return;
     }
+    if(cueFrame_ < 0){
+        enterFrame(currentFrame_); // 开始播放（或重置后）的第一帧
+    }
 
-    // frameTimer_ 统计时间，超出动画的duration，则切换到下一帧，duration int 毫秒
-    frameTimer_ += static_cast<int>(deltaTime * 1000); // 转换为毫秒
-    if(frameTimer_ >= frames_[currentFrame_].duration){
-        currentFrame_++;
-        frameTimer_ = 0;
+    // 帧时长按毫秒存放，至少 1 ms，避免时长为 0 的帧原地打转
+    auto frameNs = [this](int frame) -> Uint64 {
+        return static_cast<Uint64>(std::max(frames_[frame].duration, 1)) * 1'000'000ULL;
+    };
 
+    // 超出当前帧时长的部分留给下一帧（不清零，帧周期不是帧时长的整数倍时动画不会变慢）
+    frameTimerNs_ += ns;
+    if(frameTimerNs_ < frameNs(currentFrame_)){
+        return;
+    }
+    if(isLooping_){
+        // 整圈跳过：从当前帧开始走一圈回到同一帧的同一时刻
+        Uint64 cycleNs = 0;
+        for(int i = 0; i < static_cast<int>(frames_.size()); i++){
+            cycleNs += frameNs(i);
+        }
+        frameTimerNs_ %= cycleNs;
+    }
+    int entered = -1;
+    while(frameTimerNs_ >= frameNs(currentFrame_)){
+        frameTimerNs_ -= frameNs(currentFrame_);
+        currentFrame_++;
         if(currentFrame_ >= static_cast<int>(frames_.size())){
             if(isLooping_){
                 currentFrame_ = 0;
             }else{
                 isFinished_ = true;
                 currentFrame_ = static_cast<int>(frames_.size()) - 1; // 保持在最后一帧
+                frameTimerNs_ = 0;
+                break;
             }
         }
+        entered = currentFrame_;
+    }
+    // 一次跨过多帧（补帧）时只触发最后一帧的音效，中间的已经过时
+    if(entered >= 0 && !isFinished_){
+        enterFrame(entered);
     }
+}
+
+void Animation::setCues(std::vector<AnimationCue> cues)
+{
+    std::stable_sort(cues.begin(), cues.end(), [](const AnimationCue& a, const AnimationCue& b){
+        return a.frame < b.frame;
+    });
+    cues_ = std::move(cues);
+}
 
+void Animation::enterFrame(int frame)
+{
+    cueFrame_ = frame;
+    // 只做查表和投递，不解码不分配
+    for(const AnimationCue& cue : cues_){
+        if(cue.frame > frame) break;
+        if(cue.frame == frame){
+            AudioSystem::getInstance().play(cue.sound, cue.priority, cue.volume);
+        }
+    }
 }
 
 void Animation::render(SDL_Renderer* renderer,
                         int x, int y, int width, int heifht,
                         bool flipHorizontal)
+{
+    renderFrame(renderer, currentFrame_, x, y, width, heifht, flipHorizontal);
+}
+
+void Animation::renderFrame(SDL_Renderer* renderer, int frame,
+                            int x, int y, int width, int heifht,
+                            bool flipHorizontal) const
 {
     if(renderer == nullptr || texture_ == nullptr || frames_.empty()){
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Renderer or texture is null, or frames are empty");
         return;
     }
 
-    // 获取当前帧的源矩形
-    SDL_Rect srcRect = frames_[currentFrame_].souceRect;
+    // 获取该帧的源矩形
+    const AnimationFrame& f = frames_[std::clamp(frame, 0, static_cast<int>(frames_.size()) - 1)];
+    SDL_Rect srcRect = f.souceRect;
+    if(srcRect.w <= 0 || srcRect.h <= 0){
+        return;
+    }
+
+    // 统计：整帧四边形与不透明像素的面积（按目标尺寸）
+    const double areaScale = static_cast<double>(width) * heifht / (static_cast<double>(srcRect.w) * srcRect.h);
+    overdraw_.draws++;
+    overdraw_.quadPixels += static_cast<double>(width) * heifht;
+    if(f.trimmed){
+        overdraw_.opaquePixels += f.opaquePixels * areaScale;
+    }
+
+    // 透明像素在软件渲染下与不透明像素一样要混合，只画包住不透明像素的部分，位置按整帧计算
+    SDL_Rect dstRect{x, y, width, heifht};
+    const SDL_Rect frameRect = srcRect;
+    if(geometry_ != SpriteGeometry::Quad && f.trimmed){
+        if(f.trimRect.w <= 0 || f.trimRect.h <= 0){
+            return; // 整帧透明
+        }
+        dstRect = placePart(frameRect, f.trimRect, x, y, width, heifht, flipHorizontal);
+        srcRect = f.trimRect;
+    }
+
+    // CPU 合成：直接从预乘像素缩放、翻转、混合到帧缓冲
+    Compositor& compositor = Compositor::getInstance();
+    if(compositor.isEnabled() && sprites_){
+        if(const CpuSprite* cpu = sprites_->getCpuSprite()){
+            compositor.draw(*cpu, srcRect, dstRect, flipHorizontal);
+            overdraw_.drawnPixels += static_cast<double>(dstRect.w) * dstRect.h;
+            return;
+        }
+    }
+
+    // 有预缩放缓存时，选用与目标尺寸最接近的变体，避免每帧逐像素缩放
+    SDL_Texture* texture = texture_;
+    const SpriteVariant* variant = nullptr;
+    if(sprites_){
+        const float scale = static_cast<float>(width) / static_cast<float>(frameRect.w);
+        variant = sprites_->pick(scale);
+        if(variant){
+            texture = variant->texture;
+        }
+    }
+
+    // 凸多边形网格：顶点按整帧映射到目标位置，纹理坐标按所选变体换算
+    if(geometry_ == SpriteGeometry::Hull && !f.hull.empty() && static_cast<int>(f.hull.size()) <= kMaxHullVertices){
+        float texW = 0.0f, texH = 0.0f;
+        if(SDL_GetTextureSize(texture, &texW, &texH) && texW > 0.0f && texH > 0.0f){
+            const float sx = static_cast<float>(width) / frameRect.w, sy = static_cast<float>(heifht) / frameRect.h;
+            const float vs = variant ? variant->scale() : 1.0f;
+            SDL_Vertex vertices[kMaxHullVertices];
+            int indices[(kMaxHullVertices - 2) * 3];
+            const int n = static_cast<int>(f.hull.size());
+            for(int i = 0; i < n; i++){
+                const SDL_FPoint& p = f.hull[i];
+                const float local = flipHorizontal ? (frameRect.x + frameRect.w - p.x) : (p.x - frameRect.x);
+                vertices[i].position = SDL_FPoint{x + local * sx, y + (p.y - frameRect.y) * sy};
+                vertices[i].color = SDL_FColor{1.0f, 1.0f, 1.0f, 1.0f};
+                vertices[i].tex_coord = SDL_FPoint{p.x * vs / texW, p.y * vs / texH};
+            }
+            for(int i = 0; i + 2 < n; i++){
+                indices[i * 3] = 0;
+                indices[i * 3 + 1] = i + 1;
+                indices[i * 3 + 2] = i + 2;
+            }
+            SDL_RenderGeometry(renderer, texture, vertices, n, indices, (n - 2) * 3);
+            overdraw_.drawnPixels += f.hullArea * areaScale;
+            return;
+        }
+    }
 
     // 设置要渲染的位置和大小
     SDL_FRect destRect = { 
-        static_cast<float>(x), 
-        static_cast<float>(y),
-        static_cast<float>(width),
-        static_cast<float>(heifht) };
+        static_cast<float>(dstRect.x), 
+        static_cast<float>(dstRect.y),
+        static_cast<float>(dstRect.w),
+        static_cast<float>(dstRect.h) };
 
     // 当前帧转化为 float 版本的矩形
-    SDL_FRect  srcFRect = { 
+    SDL_FRect srcFRect = variant ? SpriteCache::mapRect(*variant, srcRect) : SDL_FRect{
         static_cast<float>(srcRect.x),
         static_cast<float>(srcRect.y),
         static_cast<float>(srcRect.w),
@@ -82,21 +258,35 @@ void Animation::render(SDL_Renderer* renderer,
 
     // 渲染当前帧
     if(flipHorizontal){
-        SDL_FRect flipDestRect = destRect;
-        flipDestRect.x += destRect.w;
-        flipDestRect.w = -destRect.w; // 水平翻转宽度为负
-        SDL_RenderTexture(renderer, texture_, &srcFRect, &flipDestRect);
+        SDL_RenderTextureRotated(renderer, texture, &srcFRect, &destRect, 0.0, nullptr, SDL_FLIP_HORIZONTAL);
     } else{
-        SDL_RenderTexture(renderer, texture_, &srcFRect, &destRect);
+        SDL_RenderTexture(renderer, texture, &srcFRect, &destRect);
     }
+    overdraw_.drawnPixels += static_cast<double>(dstRect.w) * dstRect.h;
 
 }
 
+SDL_Rect Animation::getOpaqueRect(int frame, const SDL_Rect& dst, bool flipHorizontal) const
+{
+    if(frames_.empty()){
+        return dst;
+    }
+    const AnimationFrame& f = frames_[std::clamp(frame, 0, static_cast<int>(frames_.size()) - 1)];
+    if(!f.trimmed || f.souceRect.w <= 0 || f.souceRect.h <= 0){
+        return dst;
+    }
+    if(f.trimRect.w <= 0 || f.trimRect.h <= 0){
+        return SDL_Rect{dst.x, dst.y, 0, 0};
+    }
+    return placePart(f.souceRect, f.trimRect, dst.x, dst.y, dst.w, dst.h, flipHorizontal);
+}
+
 void Animation::resetAnimation()
 {
     currentFrame_ = 0;
-    frameTimer_ = 0;
+    frameTimerNs_ = 0;
     isFinished_ = false;
+    cueFrame_ = -1;
 }
 
 void Animation::setLooping(bool is_loop){
@@ -109,11 +299,17 @@ int Animation::getFrameCount() const
 }
 
 void Animation::clean(){
+    if(sprites_){
+        // 纹理由缓存持有
+        sprites_.reset();
+        texture_ = nullptr;
+    }
     if(texture_ != nullptr){
         SDL_DestroyTexture(texture_);
         texture_ = nullptr;
     }
     frames_.clear();
+    cues_.clear();
 }
 
 // --------------------------------------------------------------
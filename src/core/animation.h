@@ -6,11 +6,47 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <memory>
+#include "spritecache.h"
+#include "spritelibrary.h"
+#include "audio.h"
+#include "../tools/string_id.h"
 
 // 动画帧结构体
 struct AnimationFrame {
     SDL_Rect souceRect; // 帧的源矩形（一般是整个sprite）
     int duration;   // 当前帧的持续时间，毫秒
+
+    // 加载时按 alpha 裁剪（trimFrames），位置仍按 souceRect 计算，画面不变
+    bool trimmed = false;
+    SDL_Rect trimRect{0, 0, 0, 0};  // 不透明像素的包围盒（精灵表坐标），w/h 为 0 表示整帧透明
+    int opaquePixels = 0;           // 不透明像素数（统计用）
+    std::vector<SDL_FPoint> hull;   // 可选：包住不透明像素的凸多边形（精灵表坐标），空则画 trimRect
+    float hullArea = 0.0f;
+};
+
+// 帧的绘制几何（--sprite-geometry）
+enum class SpriteGeometry : uint8_t {
+    Quad,   // 整帧四边形
+    Trim,   // 裁剪到不透明像素的包围盒（默认）
+    Hull,   // 凸多边形网格（SDL_RenderGeometry），CPU 合成时按 Trim 处理
+};
+const char* getSpriteGeometryName(SpriteGeometry geometry);
+
+// 绘制宠物精灵时填充的像素（渲染线程累计，按目标尺寸计）
+struct OverdrawStats {
+    uint64_t draws = 0;
+    double quadPixels = 0.0;    // 整帧四边形的面积：不裁剪时要混合的像素
+    double drawnPixels = 0.0;   // 实际交给渲染器/合成器的面积
+    double opaquePixels = 0.0;  // 其中不透明的像素
+};
+
+// 帧音效：进入第 frame 帧时播放（音效已在加载时解码）
+struct AnimationCue {
+    int frame = 0;
+    SoundId sound = kInvalidSound;
+    int priority = 0;
+    float volume = 1.0f;
 };
 
 // 可选：用于从 JSON 指定的矩形构建帧
@@ -28,12 +64,29 @@ public:
     void init(SDL_Texture* texture,
               const std::vector<AnimationFrame>& frames,
               bool is_loop = true);
+    // 使用预缩放缓存，渲染时按目标尺寸选择变体
+    void init(std::shared_ptr<SpriteCache> sprites,
+              const std::vector<AnimationFrame>& frames,
+              bool is_loop = true);
 
-    void update(float deltaTime);
+    void advance(Uint64 ns); // 前进 ns 纳秒，可一次跨过多帧（与分多次前进的结果相同）
+    void setCues(std::vector<AnimationCue> cues); // 设置帧音效
 
     void render(SDL_Renderer* renderer, 
                 int x, int y, int width, int height, 
                 bool flipHorizontal = false);
+    // 绘制指定的帧，不读播放状态（渲染线程按快照里的帧号调用）
+    void renderFrame(SDL_Renderer* renderer, int frame,
+                     int x, int y, int width, int height,
+                     bool flipHorizontal = false) const;
+
+    // 帧在 dst 中不透明部分的矩形（没有裁剪信息时为 dst，整帧透明时 w/h 为 0），例如窗口的输入区域
+    SDL_Rect getOpaqueRect(int frame, const SDL_Rect& dst, bool flipHorizontal = false) const;
+
+    // 所有动画共用的绘制方式与统计（只在渲染线程使用）
+    static void setGeometry(SpriteGeometry geometry) {geometry_ = geometry;}
+    static SpriteGeometry getGeometry() {return geometry_;}
+    static const OverdrawStats& getOverdrawStats() {return overdraw_;}
 
     void clean();
     
@@ -43,21 +96,45 @@ public:
 
     // Getters
     int getFrameCount() const;
+    int getCurrentFrame() const { return currentFrame_; }
     bool isFinished() const { return isFinished_; }
     bool isLooping() const { return isLooping_; }
 
 private:
-    SDL_Texture* texture_; // 动画纹理
+    SDL_Texture* texture_ = nullptr; // 动画纹理（使用缓存时为 x1 变体，由缓存持有）
+    std::shared_ptr<SpriteCache> sprites_; // 预缩放缓存，可为空
     std::vector<AnimationFrame> frames_; // 动画帧容器
-    int currentFrame_; // 当前帧索引
-    int frameTimer_; // 帧计时器
-    bool isLooping_; // 是否循环播放
-    bool isFinished_; // 是否播放完毕
+    int currentFrame_ = 0; // 当前帧索引
+    Uint64 frameTimerNs_ = 0; // 当前帧已播放的时间（纳秒，整数累加不丢精度）
+    bool isLooping_ = true; // 是否循环播放
+    bool isFinished_ = false; // 是否播放完毕
+    std::vector<AnimationCue> cues_; // 帧音效，按帧排序
+    int cueFrame_ = -1; // 最近一次触发音效的帧，-1 表示刚开始播放
+
+    void enterFrame(int frame); // 进入新的一帧时触发音效
+
+    static SpriteGeometry geometry_;
+    static OverdrawStats overdraw_;
+
+};
+
+// 清单中的帧音效 "cues": [{"frame": 2, "sound": "meow", "priority": 1, "volume": 1.0}]
+struct AnimCueDescription {
+    int frame{0};
+    std::string sound; // 引用 "sounds" 中的名字
+    int priority{0};
+    float volume{1.0f};
+};
 
+// 清单中的音效 "sounds": {"meow": "meow.ogg"} 或 {"meow": {"path": "meow.ogg", "volume": 0.8}}
+struct SoundDescription {
+    std::string path; // 相对 basePath
+    float volume{1.0f};
 };
 
 struct AnimationDescription {
     std::string name; // 动画名称
+    tools::StringId id; // 名字登记后的 id，即宠物的状态 id
     std::string path; // 资源路径(相对路径)
     int frames{-1};    // 帧数量（可选，<=0 表示自动计算）
     int frameWidth{-1};  // 帧宽度
@@ -68,6 +145,7 @@ struct AnimationDescription {
     std::string layout; // 布局方式 "row" 或 "column"
     std::vector<AnimFrameRect> rects; // 可选，手动指定每帧的源矩形
     bool is_movement{false}; // 是否为移动动画
+    std::vector<AnimCueDescription> cues; // 可选，帧音效
 };
 
 struct Defaults {
@@ -83,6 +161,8 @@ struct Manifest {
     std::string basePath; // 基础路径
     Defaults defaults; // 默认值
     std::unordered_map<std::string, AnimationDescription> animations;
+    std::unordered_map<std::string, SoundDescription> sounds; // 音效
+    std::unordered_map<std::string, PaletteSwap> palettes; // 颜色变体，按名字换色
 };
 
 
@@ -0,0 +1,174 @@
+#include "audio.h"
+#include "../tools/memory_stats.h"
+#include "../tools/embedded_assets.h"
+#include <algorithm>
+
+bool AudioSystem::init(int voices, int masterVolume)
+{
+    voiceCount_ = std::clamp(voices, 1, kMaxVoices);
+    if(Mix_AllocateChannels(voiceCount_) != voiceCount_){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AudioSystem: failed to allocate %d channels: %s", voiceCount_, SDL_GetError());
+        return false;
+    }
+    masterVolume_ = masterVolume;
+    Mix_Volume(-1, masterVolume_);
+    for(auto& v : voices_){
+        v.active.store(false, std::memory_order_relaxed);
+        v.sound = kInvalidSound;
+    }
+    Mix_ChannelFinished(&AudioSystem::onChannelFinished);
+    ready_ = true;
+    return true;
+}
+
+void AudioSystem::shutdown()
+{
+    if(ready_){
+        Mix_HaltChannel(-1);
+        Mix_ChannelFinished(nullptr);
+    }
+    for(auto& s : sounds_){
+        if(s.chunk){
+            tools::MemoryStats::getInstance().sub(tools::MemTag::Audio, s.chunk->alen);
+            Mix_FreeChunk(s.chunk);
+        }
+    }
+    sounds_.clear();
+    byName_.clear();
+    byPath_.clear();
+    for(auto& v : voices_){
+        v.active.store(false, std::memory_order_relaxed);
+        v.sound = kInvalidSound;
+    }
+    ready_ = false;
+}
+
+SoundId AudioSystem::loadSound(const std::string& name, const std::string& path, float volume)
+{
+    if(auto it = byPath_.find(path); it != byPath_.end()){
+        byName_[name] = it->second;
+        return it->second;
+    }
+    if(!ready_){
+        return kInvalidSound;
+    }
+
+    tools::MemoryScope scope(tools::MemTag::Audio);
+    // Mix_LoadWAV 对 ogg/mp3 也会在这里完整解码成 PCM，播放时不再解码
+    SDL_IOStream* embedded = tools::assets::openFile(path);
+    Mix_Chunk* chunk = embedded ? Mix_LoadWAV_IO(embedded, true) : Mix_LoadWAV(path.c_str());
+    if(!chunk){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AudioSystem: failed to load %s: %s", path.c_str(), SDL_GetError());
+        return kInvalidSound;
+    }
+    tools::MemoryStats::getInstance().add(tools::MemTag::Audio, chunk->alen); // PCM 由 SDL_malloc 分配，单独记账
+    const SoundId id = static_cast<SoundId>(sounds_.size());
+    sounds_.push_back(Sound{chunk, std::clamp(volume, 0.0f, 1.0f)});
+    byPath_[path] = id;
+    byName_[name] = id;
+    SDL_Log("Sound loaded: %s as '%s' (%u bytes PCM)", path.c_str(), name.c_str(), chunk->alen);
+    return id;
+}
+
+SoundId AudioSystem::findSound(const std::string& name) const
+{
+    auto it = byName_.find(name);
+    return it == byName_.end() ? kInvalidSound : it->second;
+}
+
+void AudioSystem::onChannelFinished(int channel)
+{
+    if(channel >= 0 && channel < kMaxVoices){
+        getInstance().voices_[channel].active.store(false, std::memory_order_release);
+    }
+}
+
+int AudioSystem::pickVoice(SoundId sound, int priority)
+{
+    int freeVoice = -1;
+    int victim = -1;        // 全局可抢占的声道
+    int sameVictim = -1;    // 同一音效中最早开始的声道
+    int sameCount = 0;
+
+    for(int ch = 0; ch < voiceCount_; ch++){
+        const Voice& v = voices_[ch];
+        if(!v.active.load(std::memory_order_acquire)){
+            if(freeVoice < 0) freeVoice = ch;
+            continue;
+        }
+        if(v.sound == sound){
+            sameCount++;
+            if(sameVictim < 0 || v.startSeq < voices_[sameVictim].startSeq){
+                sameVictim = ch;
+            }
+        }
+        if(victim < 0 || v.priority < voices_[victim].priority ||
+           (v.priority == voices_[victim].priority && v.startSeq < voices_[victim].startSeq)){
+            victim = ch;
+        }
+    }
+
+    // 同一个音效太多了：用新的替换最早的那个，而不是再占一个声道
+    if(sameCount >= kMaxInstancesPerSound){
+        return voices_[sameVictim].priority <= priority ? sameVictim : -1;
+    }
+    if(freeVoice >= 0){
+        return freeVoice;
+    }
+    if(victim >= 0 && voices_[victim].priority <= priority){
+        return victim;
+    }
+    return -1;
+}
+
+void AudioSystem::startVoice(int channel, SoundId sound, int priority, float volume)
+{
+    Voice& v = voices_[channel];
+    if(v.active.load(std::memory_order_acquire)){
+        Mix_HaltChannel(channel); // 结束回调会同步清除 active
+        steals_++;
+    }
+    const float gain = std::clamp(volume * sounds_[sound].volume, 0.0f, 1.0f);
+    Mix_Volume(channel, static_cast<int>(static_cast<float>(masterVolume_) * gain));
+
+    v.sound = sound;
+    v.priority = priority;
+    v.startSeq = ++seq_;
+    v.active.store(true, std::memory_order_release);
+    if(Mix_PlayChannel(channel, sounds_[sound].chunk, 0) < 0){
+        v.active.store(false, std::memory_order_release);
+        drops_++;
+        return;
+    }
+    plays_++;
+}
+
+bool AudioSystem::play(SoundId sound, int priority, float volume)
+{
+    if(!ready_ || !enabled_ || sound < 0 || sound >= static_cast<SoundId>(sounds_.size())){
+        return false;
+    }
+    const int channel = pickVoice(sound, priority);
+    if(channel < 0){
+        drops_++;
+        return false;
+    }
+    startVoice(channel, sound, priority, volume);
+    return true;
+}
+
+void AudioSystem::stopAll()
+{
+    if(ready_){
+        Mix_HaltChannel(-1);
+    }
+}
+
+int AudioSystem::getActiveVoices() const
+{
+    int n = 0;
+    for(int ch = 0; ch < voiceCount_; ch++){
+        if(voices_[ch].active.load(std::memory_order_relaxed)) n++;
+    }
+    return n;
+}
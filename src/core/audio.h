@@ -0,0 +1,92 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_mixer/SDL_mixer.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 音效 id：音效表下标，-1 表示无效
+using SoundId = int;
+constexpr SoundId kInvalidSound = -1;
+
+// 音效系统（单例）
+// - 音效在加载时一次性解码为 PCM（Mix_Chunk），按路径缓存，所有宠物共用
+// - 固定数量的声道（voice），满了以后按优先级抢占：先抢优先级最低的，同优先级抢最早开始的，
+//   新音效优先级更低时直接丢弃
+// - 同一个音效同时最多播放 kMaxInstancesPerSound 个，几百只宠物同时叫也不会占满所有声道
+// - play() 不解码、不分配内存，可以在帧更新里直接调用
+class AudioSystem{
+public:
+    static AudioSystem& getInstance(){
+        static AudioSystem instance;
+        return instance;
+    }
+
+    static constexpr int kMaxVoices = 64;
+    static constexpr int kMaxInstancesPerSound = 4;
+
+    // 需要在 Mix_OpenAudio 成功之后调用
+    bool init(int voices = 16, int masterVolume = MIX_MAX_VOLUME);
+    void shutdown(); // 停止播放并释放所有音效
+
+    // 加载并解码音效，相同路径只解码一次；name 用于清单中的引用
+    SoundId loadSound(const std::string& name, const std::string& path, float volume = 1.0f);
+    SoundId findSound(const std::string& name) const;
+
+    // 播放，返回是否分到了声道
+    bool play(SoundId sound, int priority = 0, float volume = 1.0f);
+    void stopAll();
+
+    void setMasterVolume(int volume) {masterVolume_ = volume;}
+    void setEnabled(bool enabled) {enabled_ = enabled;}
+    bool isReady() const {return ready_;}
+
+    // 统计
+    uint64_t getPlayCount() const {return plays_;}
+    uint64_t getStealCount() const {return steals_;}
+    uint64_t getDropCount() const {return drops_;}
+    int getActiveVoices() const;
+
+private:
+    AudioSystem() = default;
+    AudioSystem(const AudioSystem&) = delete;
+    AudioSystem& operator=(const AudioSystem&) = delete;
+
+    struct Sound{
+        Mix_Chunk* chunk = nullptr;
+        float volume = 1.0f;
+    };
+
+    struct Voice{
+        std::atomic<bool> active{false}; // 由音频线程的结束回调清除
+        SoundId sound = kInvalidSound;
+        int priority = 0;
+        uint64_t startSeq = 0;
+    };
+
+    static void onChannelFinished(int channel); // 音频线程回调
+
+    int pickVoice(SoundId sound, int priority);  // 返回声道号，-1 表示应丢弃
+    void startVoice(int channel, SoundId sound, int priority, float volume);
+
+    std::vector<Sound> sounds_;
+    std::unordered_map<std::string, SoundId> byName_;
+    std::unordered_map<std::string, SoundId> byPath_;
+    std::array<Voice, kMaxVoices> voices_;
+    int voiceCount_ = 0;
+    int masterVolume_ = MIX_MAX_VOLUME;
+    uint64_t seq_ = 0;
+    bool ready_ = false;
+    bool enabled_ = true;
+
+    uint64_t plays_ = 0;
+    uint64_t steals_ = 0;
+    uint64_t drops_ = 0;
+};
+
+#endif // AUDIO_H
@@ -0,0 +1,239 @@
+#include "behavior.h"
+#include <SDL3/SDL.h>
+#include <exception>
+#include <new>
+#include <utility>
+
+// --------------------------------------------------------------
+// frame pool
+
+namespace {
+
+constexpr size_t kClassSizes[] = {128, 256, 512, 1024, 2048};
+constexpr size_t kClassCount = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+constexpr size_t kBlocksPerChunk = 32;
+
+struct FreeBlock{
+    FreeBlock* next;
+};
+
+struct FramePoolState{
+    FreeBlock* freeLists[kClassCount] = {};
+    std::vector<void*> chunks;
+
+    ~FramePoolState(){
+        for(void* c : chunks){
+            ::operator delete(c);
+        }
+    }
+};
+
+FramePoolState& poolState(){
+    static FramePoolState state;
+    return state;
+}
+
+int sizeClass(size_t size){
+    for(size_t i = 0; i < kClassCount; i++){
+        if(size <= kClassSizes[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+}
+
+void* BehaviorFramePool::allocate(size_t size)
+{
+    const int c = sizeClass(size);
+    if(c < 0){
+        return ::operator new(size); // 超大的帧直接走全局分配
+    }
+    FramePoolState& pool = poolState();
+    if(!pool.freeLists[c]){
+        // 一次切一整块
+        const size_t blockSize = kClassSizes[c];
+        char* chunk = static_cast<char*>(::operator new(blockSize * kBlocksPerChunk));
+        pool.chunks.push_back(chunk);
+        for(size_t i = 0; i < kBlocksPerChunk; i++){
+            FreeBlock* b = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+            b->next = pool.freeLists[c];
+            pool.freeLists[c] = b;
+        }
+    }
+    FreeBlock* b = pool.freeLists[c];
+    pool.freeLists[c] = b->next;
+    return b;
+}
+
+void BehaviorFramePool::deallocate(void* ptr, size_t size)
+{
+    if(!ptr) return;
+    const int c = sizeClass(size);
+    if(c < 0){
+        ::operator delete(ptr);
+        return;
+    }
+    FramePoolState& pool = poolState();
+    FreeBlock* b = static_cast<FreeBlock*>(ptr);
+    b->next = pool.freeLists[c];
+    pool.freeLists[c] = b;
+}
+
+// --------------------------------------------------------------
+// Behavior
+
+Behavior::promise_type::~promise_type()
+{
+    // 行为被提前销毁：撤掉仍在路上的唤醒
+    if(pendingTimer){
+        tools::TimerService::getInstance().cancel(pendingTimer);
+    }
+    if(waitingSignal){
+        waitingSignal->detach();
+    }
+    BehaviorScheduler::getInstance().unschedule(Handle::from_promise(*this));
+}
+
+void Behavior::promise_type::unhandled_exception()
+{
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Behavior: unhandled exception in behavior coroutine");
+    std::terminate();
+}
+
+std::coroutine_handle<> Behavior::FinalAwaiter::await_suspend(Handle h) noexcept
+{
+    if(auto parent = h.promise().continuation){
+        return parent;
+    }
+    return std::noop_coroutine();
+}
+
+Behavior::~Behavior()
+{
+    if(handle_){
+        handle_.destroy();
+    }
+}
+
+Behavior::Behavior(Behavior&& other) noexcept
+    : handle_(std::exchange(other.handle_, nullptr))
+{
+}
+
+Behavior& Behavior::operator=(Behavior&& other) noexcept
+{
+    if(this != &other){
+        if(handle_){
+            handle_.destroy();
+        }
+        handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+}
+
+void Behavior::start()
+{
+    if(handle_ && !handle_.done()){
+        BehaviorScheduler::getInstance().schedule(handle_);
+    }
+}
+
+std::coroutine_handle<> Behavior::await_suspend(std::coroutine_handle<> parent) noexcept
+{
+    handle_.promise().continuation = parent;
+    return handle_;
+}
+
+// --------------------------------------------------------------
+// scheduler
+
+BehaviorScheduler::BehaviorScheduler()
+{
+    ready_.reserve(256);
+    running_.reserve(256);
+}
+
+void BehaviorScheduler::schedule(Behavior::Handle h)
+{
+    if(!h){
+        return;
+    }
+    Behavior::promise_type& p = h.promise();
+    if(p.queueSlot >= 0){
+        return; // 已在队列中（同一个行为一次只等一件事，正常不会发生）
+    }
+    p.queueSlot = static_cast<int>(ready_.size());
+    p.queueBatch = batch_;
+    ready_.push_back(h);
+}
+
+void BehaviorScheduler::unschedule(Behavior::Handle h)
+{
+    Behavior::promise_type& p = h.promise();
+    if(p.queueSlot < 0){
+        return;
+    }
+    // 就绪队列或正在 run() 中的批次：置空，run() 会跳过
+    std::vector<Behavior::Handle>& queue = p.queueBatch == batch_ ? ready_ : running_;
+    queue[static_cast<size_t>(p.queueSlot)] = nullptr;
+    p.queueSlot = -1;
+}
+
+void BehaviorScheduler::run()
+{
+    // 本帧恢复过程中新唤醒的行为留到下一帧
+    running_.swap(ready_);
+    batch_++;
+    for(size_t i = 0; i < running_.size(); i++){
+        Behavior::Handle h = running_[i];
+        if(!h){
+            continue;
+        }
+        h.promise().queueSlot = -1;
+        if(!h.done()){
+            resumeCount_++;
+            h.resume();
+        }
+    }
+    running_.clear();
+}
+
+// --------------------------------------------------------------
+// awaiters
+
+void BehaviorSignal::Awaiter::await_suspend(Behavior::Handle h) noexcept
+{
+    signal.waiter_ = h;
+    h.promise().waitingSignal = &signal;
+}
+
+void BehaviorSignal::notify(bool result)
+{
+    if(signaled_){
+        return; // 只有第一次通知有效，直到下一次 reset()
+    }
+    signaled_ = true;
+    result_ = result;
+    if(waiter_){
+        Behavior::Handle h = std::exchange(waiter_, nullptr);
+        h.promise().waitingSignal = nullptr;
+        BehaviorScheduler::getInstance().schedule(h);
+    }
+}
+
+void BehaviorSignal::detach()
+{
+    if(waiter_){
+        waiter_.promise().waitingSignal = nullptr;
+        waiter_ = nullptr;
+    }
+}
+
+void WaitAwaiter::await_suspend(Behavior::Handle h)
+{
+    // 句柄只有 8 字节，放得进 std::function 的内联存储，不会为每次等待分配堆内存
+    h.promise().pendingTimer = tools::TimerService::getInstance().schedule(ns, 0, [h](){
+        h.promise().pendingTimer = 0;
+        BehaviorScheduler::getInstance().schedule(h);
+    });
+}
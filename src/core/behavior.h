@@ -0,0 +1,134 @@
+#ifndef BEHAVIOR_H
+#define BEHAVIOR_H
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../tools/timer_service.h"
+
+// 协程帧内存池：按大小分级的空闲链表，帧只在创建行为时分配一次，co_await 不分配
+class BehaviorFramePool{
+public:
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr, size_t size);
+};
+
+class BehaviorSignal;
+
+// 宠物行为协程
+// 写法：Behavior wander(){ co_await waitFor(2.0f); co_await walkTo(...); }
+// 挂起中的行为不会被轮询：等待由时间轮或宠物事件唤醒，唤醒后交给 BehaviorScheduler 在帧内恢复
+class Behavior{
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter{
+        bool await_ready() noexcept {return false;}
+        std::coroutine_handle<> await_suspend(Handle h) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    struct promise_type{
+        std::coroutine_handle<> continuation;       // 等待这个子行为的父行为
+        tools::TimerId pendingTimer = 0;            // 挂起在 waitFor() 上
+        BehaviorSignal* waitingSignal = nullptr;    // 挂起在宠物事件上
+        int queueSlot = -1;                         // 在调度器队列中的下标，不在队列中为 -1
+        uint64_t queueBatch = 0;                    // 入队时的批次号：区分就绪队列与正在恢复的批次
+
+        ~promise_type();
+
+        Behavior get_return_object() {return Behavior(Handle::from_promise(*this));}
+        std::suspend_always initial_suspend() noexcept {return {};}
+        FinalAwaiter final_suspend() noexcept {return {};}
+        void return_void() {}
+        void unhandled_exception();
+
+        static void* operator new(size_t size) {return BehaviorFramePool::allocate(size);}
+        static void operator delete(void* ptr, size_t size) {BehaviorFramePool::deallocate(ptr, size);}
+    };
+
+    Behavior() = default;
+    ~Behavior();
+    Behavior(const Behavior&) = delete;
+    Behavior& operator=(const Behavior&) = delete;
+    Behavior(Behavior&& other) noexcept;
+    Behavior& operator=(Behavior&& other) noexcept;
+
+    void start();   // 交给调度器，下一次 run() 时开始执行
+    bool isValid() const {return static_cast<bool>(handle_);}
+    bool isDone() const {return !handle_ || handle_.done();}
+
+    // 作为子行为被 co_await：立即开始，结束后恢复父行为
+    bool await_ready() const noexcept {return isDone();}
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) noexcept;
+    void await_resume() noexcept {}
+
+private:
+    explicit Behavior(Handle h) : handle_(h) {}
+    Handle handle_;
+};
+
+// 帧调度器：被唤醒的行为放进就绪队列，每帧 run() 一次统一恢复
+// 行为在 promise 里记下自己在队列中的位置，销毁时 O(1) 移出（置空，run() 跳过）
+class BehaviorScheduler{
+public:
+    static BehaviorScheduler& getInstance(){
+        static BehaviorScheduler instance;
+        return instance;
+    }
+
+    void schedule(Behavior::Handle h);
+    void unschedule(Behavior::Handle h); // 行为被销毁时移出队列
+    void run();
+
+    size_t getReadyCount() const {return ready_.size();} // 含已移出的空位
+    uint64_t getResumeCount() const {return resumeCount_;}
+
+private:
+    BehaviorScheduler();
+    std::vector<Behavior::Handle> ready_;
+    std::vector<Behavior::Handle> running_;
+    uint64_t batch_ = 1;        // ready_ 的批次号，run() 交换队列后加一
+    uint64_t resumeCount_ = 0;
+};
+
+// 单个等待者的事件，宠物用它通知“走到了”“动画播完了”
+class BehaviorSignal{
+public:
+    struct Awaiter{
+        BehaviorSignal& signal;
+        bool await_ready() const noexcept {return signal.signaled_;}
+        void await_suspend(Behavior::Handle h) noexcept;
+        bool await_resume() const noexcept {return signal.result_;}
+    };
+
+    ~BehaviorSignal() {detach();}
+
+    void reset() {signaled_ = false; result_ = false;}  // 开始一个新动作前调用
+    void notify(bool result);   // result：正常完成为 true，被打断为 false
+    void detach();              // 等待者被销毁
+    Awaiter wait() {return Awaiter{*this};}
+    bool isWaiting() const {return static_cast<bool>(waiter_);}
+
+private:
+    Behavior::Handle waiter_;
+    bool signaled_ = false;
+    bool result_ = false;
+};
+
+// 等待若干秒（由 TimerService 唤醒）
+// 不叫 wait：与 POSIX <sys/wait.h> 的 ::wait(int*) 同名
+struct WaitAwaiter{
+    uint64_t ns;
+    bool await_ready() const noexcept {return ns == 0;}
+    void await_suspend(Behavior::Handle h);
+    void await_resume() const noexcept {}
+};
+
+inline WaitAwaiter waitFor(float seconds){
+    return WaitAwaiter{seconds > 0.0f ? static_cast<uint64_t>(static_cast<double>(seconds) * 1.0e9) : 0};
+}
+
+#endif // BEHAVIOR_H
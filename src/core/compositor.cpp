@@ -0,0 +1,203 @@
+#include "compositor.h"
+#include "../tools/memory_stats.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// x / 255 四舍五入（x <= 255 * 255），SIMD 内核用同样的算法
+inline Uint32 div255(Uint32 x){
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+inline SDL_Rect unite(const SDL_Rect& a, const SDL_Rect& b){
+    if(a.w <= 0 || a.h <= 0) return b;
+    if(b.w <= 0 || b.h <= 0) return a;
+    const int x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.w, b.x + b.w), y1 = std::max(a.y + a.h, b.y + b.h);
+    return SDL_Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+} // namespace
+
+CpuSprite CpuSprite::premultiply(SDL_Surface* surface)
+{
+    CpuSprite out;
+    if(!surface || surface->format != SDL_PIXELFORMAT_ARGB8888){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CpuSprite::premultiply: expected an ARGB8888 surface");
+        return out;
+    }
+    out.width = surface->w;
+    out.height = surface->h;
+    out.pixels.resize(static_cast<size_t>(surface->w) * surface->h);
+    for(int y = 0; y < surface->h; y++){
+        const Uint32* s = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch);
+        Uint32* d = out.pixels.data() + static_cast<size_t>(y) * surface->w;
+        for(int x = 0; x < surface->w; x++){
+            const Uint32 p = s[x];
+            const Uint32 a = p >> 24;
+            if(a == 255){
+                d[x] = p;
+            } else if(a == 0){
+                d[x] = 0;
+            } else{
+                d[x] = (a << 24) | (div255(((p >> 16) & 0xFF) * a) << 16) | (div255(((p >> 8) & 0xFF) * a) << 8) | div255((p & 0xFF) * a);
+            }
+        }
+    }
+    return out;
+}
+
+// -------------------------------------------------------
+// 内核
+
+namespace compose {
+
+void blendRowScalar(Uint32* dst, const Uint32* src, int count)
+{
+    for(int i = 0; i < count; i++){
+        const Uint32 s = src[i];
+        const Uint32 a = s >> 24;
+        if(a == 0) continue;
+        if(a == 255){
+            dst[i] = s;
+            continue;
+        }
+        const Uint32 d = dst[i];
+        const Uint32 ia = 255 - a;
+        Uint32 out = 0;
+        for(int shift = 0; shift < 32; shift += 8){
+            const Uint32 c = ((s >> shift) & 0xFF) + div255(((d >> shift) & 0xFF) * ia);
+            out |= std::min<Uint32>(c, 255) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+BlendRowFn selectBlendRow(const char** name)
+{
+    BlendRowFn fn = nullptr;
+    const char* chosen = "scalar";
+    if(SDL_HasAVX2() && (fn = getBlendRowAVX2()) != nullptr){
+        chosen = "avx2";
+    } else if(SDL_HasSSE2() && (fn = getBlendRowSSE2()) != nullptr){
+        chosen = "sse2";
+    } else{
+        fn = blendRowScalar;
+    }
+    if(name) *name = chosen;
+    return fn;
+}
+
+} // namespace compose
+
+// -------------------------------------------------------
+// CpuCanvas
+
+bool CpuCanvas::resize(int width, int height)
+{
+    if(width <= 0 || height <= 0) return false;
+    width_ = width;
+    height_ = height;
+    pixels_.assign(static_cast<size_t>(width) * height, 0);
+    row_.resize(static_cast<size_t>(width));
+    columns_.resize(static_cast<size_t>(width));
+    dirty_ = SDL_Rect{0, 0, 0, 0};
+    return true;
+}
+
+void CpuCanvas::begin()
+{
+    if(dirty_.w > 0 && dirty_.h > 0){
+        for(int y = dirty_.y; y < dirty_.y + dirty_.h; y++){
+            std::memset(pixels_.data() + static_cast<size_t>(y) * width_ + dirty_.x, 0, static_cast<size_t>(dirty_.w) * sizeof(Uint32));
+        }
+    }
+    dirty_ = SDL_Rect{0, 0, 0, 0};
+}
+
+void CpuCanvas::blit(const CpuSprite& sprite, const SDL_Rect& src, const SDL_Rect& dst, bool flipX)
+{
+    if(sprite.empty() || src.w <= 0 || src.h <= 0 || dst.w <= 0 || dst.h <= 0) return;
+
+    // 裁剪到画布
+    const int x0 = std::max(dst.x, 0), y0 = std::max(dst.y, 0);
+    const int x1 = std::min(dst.x + dst.w, width_), y1 = std::min(dst.y + dst.h, height_);
+    if(x0 >= x1 || y0 >= y1) return;
+    const int n = x1 - x0;
+
+    // 最近邻：目标像素取 floor(u * src.w / dst.w)，与 SDL 最近邻缩放一致；翻转时从右往左取
+    for(int x = x0; x < x1; x++){
+        int u = static_cast<int>(static_cast<int64_t>(x - dst.x) * src.w / dst.w);
+        if(flipX) u = src.w - 1 - u;
+        columns_[x - x0] = std::clamp(src.x + u, 0, sprite.width - 1);
+    }
+
+    for(int y = y0; y < y1; y++){
+        const int v = static_cast<int>(static_cast<int64_t>(y - dst.y) * src.h / dst.h);
+        const Uint32* s = sprite.pixels.data() + static_cast<size_t>(std::clamp(src.y + v, 0, sprite.height - 1)) * sprite.width;
+        for(int i = 0; i < n; i++){
+            row_[i] = s[columns_[i]];
+        }
+        kernel_(pixels_.data() + static_cast<size_t>(y) * width_ + x0, row_.data(), n);
+    }
+    dirty_ = unite(dirty_, SDL_Rect{x0, y0, n, y1 - y0});
+}
+
+// -------------------------------------------------------
+// Compositor
+
+bool Compositor::init(SDL_Renderer* renderer, int width, int height)
+{
+    shutdown();
+    if(!renderer){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Compositor::init: renderer is null");
+        return false;
+    }
+    tools::MemoryScope scope(tools::MemTag::UI);
+    if(!canvas_.resize(width, height)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Compositor::init: bad size %dx%d", width, height);
+        return false;
+    }
+    texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if(!texture_){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Compositor::init: %s", SDL_GetError());
+        return false;
+    }
+    // 渲染目标每帧清为全透明，画布本身已是预乘结果，直接拷贝即可
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_NONE);
+    SDL_SetTextureScaleMode(texture_, SDL_SCALEMODE_NEAREST);
+    tools::MemoryStats::getInstance().trackTexture(texture_, "compositor");
+
+    renderer_ = renderer;
+    canvas_.setKernel(compose::selectBlendRow(&kernelName_));
+    SDL_Log("Compositor: CPU compositing %dx%d, kernel %s", width, height, kernelName_);
+    return true;
+}
+
+void Compositor::shutdown()
+{
+    if(texture_){
+        tools::MemoryStats::getInstance().untrackTexture(texture_);
+        SDL_DestroyTexture(texture_);
+        texture_ = nullptr;
+    }
+    renderer_ = nullptr;
+}
+
+void Compositor::present()
+{
+    if(!texture_) return;
+    const SDL_Rect& r = canvas_.getDirtyRect();
+    if(r.w <= 0 || r.h <= 0) return;
+
+    // 一次上传：只传本帧画过的区域（上一帧的区域在渲染目标上已被清除）
+    const Uint32* first = canvas_.getPixels() + static_cast<size_t>(r.y) * canvas_.getWidth() + r.x;
+    if(!SDL_UpdateTexture(texture_, &r, first, canvas_.getWidth() * static_cast<int>(sizeof(Uint32)))){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Compositor::present: %s", SDL_GetError());
+        return;
+    }
+    const SDL_FRect area{static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.w), static_cast<float>(r.h)};
+    SDL_RenderTexture(renderer_, texture_, &area, &area);
+}
@@ -0,0 +1,86 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+
+// CPU 合成用的精灵表：预乘 alpha 的 ARGB8888（x1），加载时转换一次
+struct CpuSprite {
+    int width = 0;
+    int height = 0;
+    std::vector<Uint32> pixels;
+
+    bool empty() const {return pixels.empty();}
+    static CpuSprite premultiply(SDL_Surface* surface); // surface 必须是 ARGB8888
+};
+
+// 行混合内核：dst = src + dst * (255 - srcA) / 255（预乘 alpha 的 over），逐字节与标量版本结果一致
+namespace compose {
+    using BlendRowFn = void(*)(Uint32* dst, const Uint32* src, int count);
+
+    void blendRowScalar(Uint32* dst, const Uint32* src, int count);
+    BlendRowFn getBlendRowSSE2(); // 没有编译对应内核时返回空
+    BlendRowFn getBlendRowAVX2();
+
+    // 按 CPU 特性选择内核：AVX2 优先，其次 SSE2，都没有时用标量（SDL_HasAVX2/SDL_HasSSE2）
+    BlendRowFn selectBlendRow(const char** name = nullptr);
+}
+
+// CPU 帧缓冲（预乘 alpha），不依赖渲染器，基准测试直接使用
+// - blit 支持最近邻缩放与水平翻转，先把一行源像素按目标坐标取好，再交给 SIMD 内核混合
+// - 只清除上一帧画过的区域，本帧画过的区域记在 getDirtyRect() 里
+class CpuCanvas {
+public:
+    bool resize(int width, int height);
+    void setKernel(compose::BlendRowFn kernel) {kernel_ = kernel;}
+
+    void begin(); // 清掉上一帧画过的区域
+    void blit(const CpuSprite& sprite, const SDL_Rect& src, const SDL_Rect& dst, bool flipX = false);
+
+    int getWidth() const {return width_;}
+    int getHeight() const {return height_;}
+    const Uint32* getPixels() const {return pixels_.data();}
+    const SDL_Rect& getDirtyRect() const {return dirty_;}
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<Uint32> pixels_;
+    std::vector<Uint32> row_; // 取好的一行源像素
+    std::vector<int> columns_; // 目标列 -> 源列
+    SDL_Rect dirty_{0, 0, 0, 0};
+    compose::BlendRowFn kernel_ = compose::blendRowScalar;
+};
+
+// CPU 合成器（单例）
+// 软件渲染时 SDL 的通用混合器逐像素缩放、按直通 alpha 混合；这里改为：
+// 所有桌宠先合成到 CpuCanvas，每帧只用一次 SDL_UpdateTexture 上传画过的区域，再一次性拷贝到屏幕
+class Compositor {
+public:
+    static Compositor& getInstance(){
+        static Compositor instance;
+        return instance;
+    }
+
+    bool init(SDL_Renderer* renderer, int width, int height);
+    void shutdown();
+    bool isEnabled() const {return texture_ != nullptr;}
+    const char* getKernelName() const {return kernelName_;}
+
+    void begin() {canvas_.begin();}
+    void draw(const CpuSprite& sprite, const SDL_Rect& src, const SDL_Rect& dst, bool flipX) {canvas_.blit(sprite, src, dst, flipX);}
+    void present(); // 上传并绘制本帧画过的区域（渲染目标已清为全透明）
+
+private:
+    Compositor() = default;
+    Compositor(const Compositor&) = delete;
+    Compositor& operator=(const Compositor&) = delete;
+
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_Texture* texture_ = nullptr; // 流式纹理
+    CpuCanvas canvas_;
+    const char* kernelName_ = "scalar";
+};
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,48 @@
+// AVX2 混合内核，这个文件单独带 -mavx2 / /arch:AVX2 编译（见 CMakeLists.txt），只在 CPU 支持时调用
+#include "compositor.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+// 与 SSE2 版相同，一次 8 个像素；unpack/pack 都在 128 位半区内进行，像素顺序保持不变
+inline __m256i scale16(__m256i d16, __m256i ia16){
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(d16, ia16), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+void blendRowAVX2(Uint32* dst, const Uint32* src, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i opaque = _mm256_set1_epi32(255);
+    int i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i a = _mm256_srli_epi32(s, 24);
+        if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, zero)) == -1) continue;
+        if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, opaque)) == -1){
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            continue;
+        }
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i ia = _mm256_sub_epi32(opaque, a);
+        ia = _mm256_or_si256(ia, _mm256_slli_epi32(ia, 16));
+        const __m256i lo = scale16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi32(ia, ia));
+        const __m256i hi = scale16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi32(ia, ia));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epu8(s, _mm256_packus_epi16(lo, hi)));
+    }
+    if(i < count){
+        compose::blendRowScalar(dst + i, src + i, count - i);
+    }
+}
+
+} // namespace
+
+compose::BlendRowFn compose::getBlendRowAVX2() {return blendRowAVX2;}
+
+#else
+
+compose::BlendRowFn compose::getBlendRowAVX2() {return nullptr;}
+
+#endif
@@ -0,0 +1,49 @@
+// SSE2 混合内核，x86-64 上总是可用
+#include "compositor.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+namespace {
+
+// 2 个像素（8 个 16 位通道）乘以各自的 255 - alpha，再除以 255（与标量版相同的舍入）
+inline __m128i scale16(__m128i d16, __m128i ia16){
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d16, ia16), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void blendRowSSE2(Uint32* dst, const Uint32* src, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi32(255);
+    int i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i a = _mm_srli_epi32(s, 24);
+        // 全透明跳过，全不透明直接写（像素画里绝大多数是这两种）
+        if(_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xFFFF) continue;
+        if(_mm_movemask_epi8(_mm_cmpeq_epi32(a, opaque)) == 0xFFFF){
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i ia = _mm_sub_epi32(opaque, a);
+        ia = _mm_or_si128(ia, _mm_slli_epi32(ia, 16));   // 每个像素的 16 位两份
+        const __m128i lo = scale16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(ia, ia));
+        const __m128i hi = scale16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(ia, ia));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(s, _mm_packus_epi16(lo, hi)));
+    }
+    if(i < count){
+        compose::blendRowScalar(dst + i, src + i, count - i);
+    }
+}
+
+} // namespace
+
+compose::BlendRowFn compose::getBlendRowSSE2() {return blendRowSSE2;}
+
+#else
+
+compose::BlendRowFn compose::getBlendRowSSE2() {return nullptr;}
+
+#endif
@@ -1,14 +1,16 @@
 #include "desktoppet.h"
+#include "eventbus.h"
 
 DesktopPet::DesktopPet()
+    : rng_(tools::Random::split())
 {
     renderer_ = nullptr;
     spriteSheet_ = nullptr;
     currentState_ = PetState::IDLE;
     petWidth_ = 0;
     petHeight_ = 0;
-    posX_ = 0;
-    posY_ = 0;
+    posX_ = 0.0f;
+    posY_ = 0.0f;
     viewScale_ = 1;
 }
 
@@ -18,55 +20,141 @@ DesktopPet::~DesktopPet()
 
 void DesktopPet::getPosition(int& x, int& y) const
 {
-    x = posX_;
-    y = posY_;
+    x = static_cast<int>(posX_);
+    y = static_cast<int>(posY_);
 }
 
-void DesktopPet::setPosition(int x, int y)
+void DesktopPet::setPosition(float x, float y)
 {
     posX_ = x;
     posY_ = y;
 }
 
-void DesktopPet::setWidthAndHeight(SDL_Texture* texture, int totalFrames)
+void DesktopPet::say(const std::string& text, float seconds)
 {
-    // 如果获取失败就使用默认值
-    float textureWidth = 48.0f * totalFrames, textureHeight = 48.0f;
-    if(!SDL_GetTextureSize(texture, &textureWidth, &textureHeight)){
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get texture size");
-        return;
-    }
+    speech_ = text;
+    const uint64_t now = tools::TimerService::getInstance().getNowNs();
+    speechUntilNs_ = now + static_cast<uint64_t>(static_cast<double>(seconds > 0.0f ? seconds : 0.0f) * 1.0e9);
+}
+
+void DesktopPet::markInput(const SDL_Event& event)
+{
+    // 同一帧多次输入只记最早的一次
+    if(inputStamp_.inputNs != 0) return;
+    inputStamp_.inputNs = event.common.timestamp;
+    inputStamp_.handledNs = SDL_GetTicksNS();
+}
 
-    petWidth_ = static_cast<int>(textureWidth / totalFrames);
-    petHeight_ = static_cast<int>(textureHeight);
+bool DesktopPet::takeInputStamp(tools::InputStamp& out)
+{
+    if(inputStamp_.inputNs == 0) return false;
+    out = inputStamp_;
+    inputStamp_ = tools::InputStamp();
+    return true;
+}
+
+bool DesktopPet::canDeferUpdate() const
+{
+    // 移动会改变位置与可见性，非循环动画结束时要按时切换状态，这两种都逐帧更新
+    if(currentSlot_ < 0 || states_[currentSlot_].movement) return false;
+    return states_[currentSlot_].animation->isLooping();
+}
 
-    SDL_Log("DesktopPet::setWidthAndHeight -> frame size=%dx%d (from texture %.0fx%.0f, totalFrames=%d)",
-            petWidth_, petHeight_, textureWidth, textureHeight, totalFrames);
+void DesktopPet::catchUp()
+{
+    if(deferredNs_ == 0) return;
+    const Uint64 ns = deferredNs_;
+    deferredNs_ = 0;
+    if(Animation* anim = getSlotAnimation(currentSlot_)){
+        anim->advance(ns);
+    }
+}
 
-    return;
+bool DesktopPet::isSpeaking() const
+{
+    return !speech_.empty() && tools::TimerService::getInstance().getNowNs() < speechUntilNs_;
 }
 
-void DesktopPet::setState(PetState state)
+void DesktopPet::setState(StateId state)
 {
+    catchUp(); // 攒下的时间属于旧状态
+    if(state != currentState_){
+        animSignal_.notify(false); // 正在等待的动画被打断
+        GameEvent e;
+        e.type = GameEvent::Type::StateChanged;
+        e.pet = this;
+        e.from = currentState_.value();
+        e.to = state.value();
+        EventBus::getInstance().post(e);
+    }
     currentState_ = state;
+    currentSlot_ = findSlot(state);
+}
+
+int DesktopPet::findSlot(StateId state) const
+{
+    for(size_t i = 0; i < states_.size(); i++){
+        if(states_[i].id == state) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void DesktopPet::addState(StateId state, std::unique_ptr<Animation> animation, bool movement)
+{
+    int slot = findSlot(state);
+    if(slot < 0){
+        slot = static_cast<int>(states_.size());
+        states_.push_back(StateSlot{state, nullptr, false});
+    }
+    states_[slot].animation = std::move(animation);
+    states_[slot].movement = movement;
+    if(state == PetState::IDLE) idleSlot_ = slot;
+    if(state == currentState_) currentSlot_ = slot;
+}
+
+void DesktopPet::clearStates()
+{
+    for(auto& slot : states_){
+        if(slot.animation) slot.animation->clean();
+    }
+    states_.clear();
+    currentSlot_ = -1;
+    idleSlot_ = -1;
 }
 
-void DesktopPet::playAnimation(PetState state)
-{
-    // 暂时借用AI的，明天再改，先要把animation.cpp和.h改好
-    auto it = animations_.find(state);
-    if (it != animations_.end() && it->second) {
-        // 假设 Animation::render 需要传入渲染器和位置等参数
-        it->second->render(renderer_, posX_, posY_, petWidth_, petHeight_);
-    } else {
-        // 没有对应动画，播放待机动画
-        auto idleIt = animations_.find(PetState::IDLE);
-        if (idleIt != animations_.end() && idleIt->second) {
-            idleIt->second->render(renderer_, posX_, posY_, petWidth_, petHeight_);
-        } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No animation found for state and no idle animation available");
-        }
+BehaviorSignal::Awaiter DesktopPet::play(StateId state)
+{
+    setState(state);
+    animSignal_.reset();
+    // 循环动画不会结束，不需要等待
+    if(isAnimationLooping(state)){
+        animSignal_.notify(true);
     }
+    return animSignal_.wait();
+}
+
+bool DesktopPet::isAnimationLooping(StateId state) const
+{
+    const Animation* anim = getSlotAnimation(findSlot(state));
+    return !anim || anim->isLooping();
+}
+
+void DesktopPet::submit(RenderSnapshot& out) const
+{
+    // 没有对应动画，画待机动画
+    const Animation* anim = getSlotAnimation(currentSlot_);
+    if(!anim){
+        anim = getSlotAnimation(idleSlot_);
+    }
+    if(!anim) return;
+
+    // 像素画按整像素绘制，位置本身保留小数
+    SpriteDraw d;
+    d.clip = anim;
+    d.frame = anim->getCurrentFrame();
+    d.dst = SDL_Rect{static_cast<int>(SDL_floorf(posX_ + 0.5f)), static_cast<int>(SDL_floorf(posY_ + 0.5f)), petWidth_, petHeight_};
+    d.flip = flipX_;
+    out.sprites.push_back(d);
 }
 
 std::vector<AnimationFrame> DesktopPet::getFrames(std::string &spritePath, int frameHeight, int frameWidth, int frameCount)
@@ -110,7 +198,5 @@ std::vector<AnimationFrame> DesktopPet::getFrames(std::string &spritePath, int f
 }
 
 bool DesktopPet::getMovementState() const{
-    auto it = movementStates_.find(currentState_);
-    return ((it != movementStates_.end() ? it->second : false));
+    return currentSlot_ >= 0 && states_[currentSlot_].movement;
 }
-
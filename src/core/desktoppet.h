@@ -7,17 +7,24 @@
 #include <memory>
 #include <unordered_map>
 #include "animation.h"
+#include "behavior.h"
+#include "render_snapshot.h"
+#include "../tools/random.h"
+#include "../tools/latency_stats.h"
 #include <glm/glm.hpp>
 
 class Game; // 前置声明
+namespace tools::math{ class KinematicsBatch; }
 
 
-// 状态
-enum class PetState{
-    IDLE,
-    WALK,
-    CLICK
-};
+// 状态：就是清单里的动画名（登记后的 StringId），宠物可以有任意多个状态
+// 代码里用到的几个名字在编译期算好哈希；新增状态（sleep、groom……）只需改清单
+using StateId = tools::StringId;
+namespace PetState{
+    inline constexpr StateId IDLE{"idle"};
+    inline constexpr StateId WALK{"walk"};
+    inline constexpr StateId CLICK{"click"};
+}
 
 class DesktopPet{
 public:
@@ -25,14 +32,14 @@ public:
     virtual ~DesktopPet();
 
     virtual void init() = 0;
-    virtual void update(float deltaTime) = 0;
-    virtual void render() = 0;
-    virtual void handleEvent(SDL_Event& event) = 0;
+    virtual void update(Uint64 deltaNs) = 0; // 虚拟时间前进 deltaNs（GameClock 本帧的帧长，整数纳秒）
+    virtual void submit(RenderSnapshot& out) const; // 把本帧要画的内容写进快照（模拟线程调用，不调用 SDL）
+    virtual void handleEvent(SDL_Event& event) = 0; // 只收到落在自己身上的鼠标按键事件（由 Game 路由）
+    virtual void onAnimationFinished([[maybe_unused]] StateId state) {} // 本帧 post 的 AnimationFinished，所有宠物更新之后由 Game 经事件总线送回
     virtual void clean() = 0;
 
     // Animation related
     virtual bool loadAnimations() = 0; // 加载动画
-    virtual void playAnimation(PetState state); // 播放动画
 
     // Actual actions
     // virtual void updatePosition(float deltaTime){
@@ -48,35 +55,86 @@ public:
     int getHeight(int Scale = 1) const {return petHeight_ * Scale;}
     int getViewScale() const {return viewScale_;}
     virtual void getPosition(int& x, int& y) const;
-    SDL_Rect getRect() const {return SDL_Rect{posX_, posY_, petWidth_, petHeight_};}
+    SDL_Rect getRect() const {return SDL_Rect{static_cast<int>(posX_), static_cast<int>(posY_), petWidth_, petHeight_};}
     bool getMovementState() const;
+    bool isSpeaking() const; // 气泡是否还在显示
+    const std::string& getSpeech() const {return speech_;}
+    StateId getState() const {return currentState_;}
+    bool hasState(StateId state) const {return findSlot(state) >= 0;}
+    size_t getStateCount() const {return states_.size();}
+
+    // 更新降频：看不见、只在播放循环动画的宠物可以把 update 攒起来
+    // 攒下的时间只推进当前动画，与逐帧 update 的结果完全相同；状态切换前、重新可见时先补上
+    virtual bool canDeferUpdate() const;
+    void deferUpdate(Uint64 deltaNs) {deferredNs_ += deltaNs;}
+    void catchUp();
+    bool hasDeferredUpdate() const {return deferredNs_ > 0;}
+
+    // 说一句话：头顶显示对话气泡 seconds 秒（由 Game 统一绘制）
+    void say(const std::string& text, float seconds = 2.0f);
+
+    // 延迟统计：取走本帧因输入产生的状态变化（Game 生成快照时调用），没有返回 false
+    bool takeInputStamp(tools::InputStamp& out);
 
     // Setters
-    virtual void setPosition(int x, int y);
-    virtual void setWidthAndHeight(SDL_Texture* texture, int totalFrames);
+    virtual void setPosition(float x, float y);
     virtual void setRenderer(SDL_Renderer* renderer) {renderer_ = renderer;}
+    // 活动区域（Game 的窗口大小，无头时是固定的默认值），init 之前设置；不直接查询显示器，保证回放与种子在不同机器上一致
+    void setScreenSize(int width, int height) {screenW_ = width; screenH_ = height;}
+    // 精灵缓存的生成方式（Game 按渲染器与启动参数决定），init 之前设置
+    // prescale：纹理预先放大到视图缩放（软件渲染或像素画放大时）；否则只建 x1，由 GPU 最近邻放大
+    void setSpriteOptions(const SpriteCacheOptions& options, bool prescale) {spriteOptions_ = options; prescaleSprites_ = prescale;}
+    // 移动交给共享的批量积分器（Game 在每帧更新宠物之前统一 integrate），init 之后调用；不移动的宠物忽略
+    virtual void attachMotion([[maybe_unused]] tools::math::KinematicsBatch* batch) {}
 
 
 protected:
 
-    virtual void setState(PetState state); // 设置状态
+    virtual void setState(StateId state); // 设置状态
     virtual void handleEventClick(SDL_Event& event) = 0; // 处理点击事件
+    void markInput(const SDL_Event& event); // 输入引起了可见的变化，记下事件时间戳，随下一份快照送到屏幕
+
+    // behavior helpers, used as `co_await play(state)` inside a Behavior
+    // resumes with true when a non-looping animation finished, false when the state was changed before that
+    BehaviorSignal::Awaiter play(StateId state);
+    bool isAnimationLooping(StateId state) const;
+    BehaviorSignal animSignal_; // 动画播放完毕/被打断
 
     // animation
     SDL_Renderer* renderer_; // 渲染器
     SDL_Texture* spriteSheet_; // 精灵表
     std::vector<std::string> animationPaths_; // 动画路径
     virtual void changePetScale() {petWidth_ *= viewScale_; petHeight_ *= viewScale_;} // 改变宠物缩放
-
-    // mappers
-    std::unordered_map<PetState, std::unique_ptr<Animation>> animations_; // 状态对应的动画
-    std::unordered_map<PetState, bool> movementStates_; // 状态对应的是否为移动动画
-
-    PetState currentState_; // 当前状态
+    void setFrameSize(int width, int height) {petWidth_ = width; petHeight_ = height;} // 一帧的原始大小（缩放前）
+    SpriteCacheOptions spriteOptions_; // 见 setSpriteOptions
+    bool prescaleSprites_ = true;
+
+    // 状态表：按加载顺序紧凑存放，下标即槽位；帧循环里只按槽位访问
+    struct StateSlot{
+        StateId id;
+        std::unique_ptr<Animation> animation;
+        bool movement = false; // 是否为移动动画
+    };
+    std::vector<StateSlot> states_;
+    int findSlot(StateId state) const; // 线性查找（状态只有几个），没有返回 -1
+    void addState(StateId state, std::unique_ptr<Animation> animation, bool movement); // 同名则替换
+    void clearStates();
+    Animation* getSlotAnimation(int slot) const {return slot >= 0 ? states_[slot].animation.get() : nullptr;}
+
+    StateId currentState_; // 当前状态
+    int currentSlot_ = -1; // 当前状态的槽位，没有对应动画时为 -1
+    int idleSlot_ = -1;    // 待机动画的槽位（后备）
+    bool flipX_ = false;   // 是否水平翻转
     int petWidth_, petHeight_; // 宠物宽高
-    int posX_, posY_; // 宠物位置
+    float posX_, posY_; // 宠物位置（浮点，亚像素移动）
+    int screenW_ = 800, screenH_ = 600; // 活动区域大小（见 setScreenSize）
     int viewScale_ = 3; // 视图缩放
     glm::vec2 moveSpeed_ = {20, 0}; // 移动速度（像素/帧）
+    tools::RandomStream rng_; // 每只宠物独立的随机数流（由全局流切分）
+    std::string speech_; // 当前气泡文字
+    uint64_t speechUntilNs_ = 0; // 气泡消失的时间（TimerService 时间）
+    tools::InputStamp inputStamp_; // 待送达的输入（inputNs 为 0 表示没有）
+    Uint64 deferredNs_ = 0; // 攒下还没推进的时间
     
     // As for Timers, I recommend set them in child classes since it will give more flexibility
 };
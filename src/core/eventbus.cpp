@@ -0,0 +1,229 @@
+#include "eventbus.h"
+#include <algorithm>
+
+uint32_t EventBus::maskOf(Uint32 type)
+{
+    switch(type){
+    case SDL_EVENT_QUIT:                return EventMask::Quit;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:              return EventMask::Key;
+    case SDL_EVENT_TEXT_INPUT:          return EventMask::Text;
+    case SDL_EVENT_MOUSE_MOTION:        return EventMask::MouseMotion;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:     return EventMask::MouseButton;
+    case SDL_EVENT_MOUSE_WHEEL:         return EventMask::MouseWheel;
+    default:
+        if(type >= SDL_EVENT_WINDOW_FIRST && type <= SDL_EVENT_WINDOW_LAST){
+            return EventMask::Window;
+        }
+        return EventMask::Other;
+    }
+}
+
+uint32_t EventBus::maskOf(GameEvent::Type type)
+{
+    switch(type){
+    case GameEvent::Type::StateChanged:      return EventMask::StateChanged;
+    case GameEvent::Type::AnimationFinished: return EventMask::AnimationFinished;
+    }
+    return 0;
+}
+
+// -------------------------------------------------------
+// subscriptions
+
+EventBus::SubscriptionId EventBus::addSubscription(const Subscription& s)
+{
+    subscriptions_.push_back(s);
+    subscriptions_.back().id = nextId_++;
+    updateMask();
+    return subscriptions_.back().id;
+}
+
+EventBus::SubscriptionId EventBus::subscribe(uint32_t mask, EventCallback callback, void* userdata)
+{
+    if(!callback) return 0;
+    Subscription s;
+    s.mask = mask & EventMask::AllSDL;
+    s.onEvent = callback;
+    s.userdata = userdata;
+    return addSubscription(s);
+}
+
+EventBus::SubscriptionId EventBus::subscribe(uint32_t mask, GameEventCallback callback, void* userdata)
+{
+    if(!callback) return 0;
+    Subscription s;
+    s.mask = mask & EventMask::AllGame;
+    s.onGameEvent = callback;
+    s.userdata = userdata;
+    return addSubscription(s);
+}
+
+void EventBus::unsubscribe(SubscriptionId id)
+{
+    for(auto& s : subscriptions_){
+        if(s.id == id){
+            s.mask = 0;
+            s.onEvent = nullptr;
+            s.onGameEvent = nullptr;
+        }
+    }
+    // 分发过程中取消订阅只清空回调，分发结束后再移除，避免下标错位
+    if(dispatchDepth_ == 0){
+        compact();
+    }
+    updateMask();
+}
+
+void EventBus::compact()
+{
+    subscriptions_.erase(std::remove_if(subscriptions_.begin(), subscriptions_.end(),
+        [](const Subscription& s){ return !s.onEvent && !s.onGameEvent; }), subscriptions_.end());
+}
+
+void EventBus::clear()
+{
+    subscriptions_.clear();
+    updateMask();
+    hasPendingMotion_ = false;
+    head_ = tail_ = 0;
+}
+
+void EventBus::updateMask()
+{
+    uint32_t mask = 0, gameMask = 0;
+    for(const auto& s : subscriptions_){
+        if(s.onEvent) mask |= s.mask;
+        if(s.onGameEvent) gameMask |= s.mask;
+    }
+    sdlMask_.store(mask, std::memory_order_release);
+    gameMask_ = gameMask;
+}
+
+// -------------------------------------------------------
+// SDL events
+
+bool SDLCALL EventBus::eventFilter(void* userdata, SDL_Event* event)
+{
+    EventBus* bus = static_cast<EventBus*>(userdata);
+    if(event->type == SDL_EVENT_QUIT || event->type >= SDL_EVENT_USER){
+        return true; // 用户事件是程序自己投递的（例如唤醒主线程），总是保留
+    }
+    if(bus->sdlMask_.load(std::memory_order_acquire) & maskOf(event->type)){
+        return true;
+    }
+    bus->filtered_.fetch_add(1, std::memory_order_relaxed);
+    return false; // 没有订阅者，不进入事件队列
+}
+
+void EventBus::installFilter()
+{
+    SDL_SetEventFilter(&EventBus::eventFilter, this);
+    filterInstalled_ = true;
+}
+
+void EventBus::removeFilter()
+{
+    if(filterInstalled_){
+        SDL_SetEventFilter(nullptr, nullptr);
+        filterInstalled_ = false;
+    }
+}
+
+void EventBus::deliver(SDL_Event& event, uint32_t mask)
+{
+    // 按下标遍历：回调里订阅会让 vector 扩容
+    dispatchDepth_++;
+    for(size_t i = 0; i < subscriptions_.size(); i++){
+        const Subscription s = subscriptions_[i];
+        if(s.onEvent && (s.mask & mask)){
+            s.onEvent(s.userdata, event);
+            delivered_++;
+        }
+    }
+    if(--dispatchDepth_ == 0){
+        compact();
+    }
+}
+
+void EventBus::publish(SDL_Event& event)
+{
+    received_++;
+    const uint32_t mask = maskOf(event.type);
+    if(!(sdlMask_.load(std::memory_order_relaxed) & mask)){
+        return; // 没有订阅者（未安装过滤器或回放时会走到这里）
+    }
+
+    if(event.type == SDL_EVENT_MOUSE_MOTION){
+        if(hasPendingMotion_ &&
+           pendingMotion_.motion.windowID == event.motion.windowID &&
+           pendingMotion_.motion.which == event.motion.which){
+            // 合并：位置与按键状态取最新，相对位移累加
+            const float xrel = pendingMotion_.motion.xrel + event.motion.xrel;
+            const float yrel = pendingMotion_.motion.yrel + event.motion.yrel;
+            pendingMotion_ = event;
+            pendingMotion_.motion.xrel = xrel;
+            pendingMotion_.motion.yrel = yrel;
+            coalesced_++;
+            return;
+        }
+        flush();
+        pendingMotion_ = event;
+        hasPendingMotion_ = true;
+        return;
+    }
+
+    flush();
+    deliver(event, mask);
+}
+
+void EventBus::flush()
+{
+    if(hasPendingMotion_){
+        hasPendingMotion_ = false;
+        deliver(pendingMotion_, EventMask::MouseMotion);
+    }
+}
+
+// -------------------------------------------------------
+// game events
+
+bool EventBus::post(const GameEvent& event)
+{
+    // 没人订阅的事件（例如大量宠物的状态切换）不占队列，也就不会挤掉有人等待的事件
+    if(!hasSubscribers(event.type)){
+        return true;
+    }
+    if(tail_ - head_ >= kQueueCapacity){
+        if(dropped_++ == 0){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "EventBus: game event queue full, dropping events");
+        }
+        return false;
+    }
+    queue_[tail_ & (kQueueCapacity - 1)] = event;
+    tail_++;
+    return true;
+}
+
+void EventBus::dispatchGameEvents()
+{
+    // 只分发本次调用开始时已在队列中的事件，回调中 post 的留到下一次
+    const size_t end = tail_;
+    while(head_ != end){
+        const GameEvent event = queue_[head_ & (kQueueCapacity - 1)];
+        head_++;
+        const uint32_t mask = maskOf(event.type);
+        dispatchDepth_++;
+        for(size_t i = 0; i < subscriptions_.size(); i++){
+            const Subscription s = subscriptions_[i];
+            if(s.onGameEvent && (s.mask & mask)){
+                s.onGameEvent(s.userdata, event);
+                delivered_++;
+            }
+        }
+        if(--dispatchDepth_ == 0){
+            compact();
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class DesktopPet;
+
+// 事件类别位掩码，订阅时按位或组合
+namespace EventMask{
+    // SDL 事件
+    constexpr uint32_t Quit          = 1u << 0;
+    constexpr uint32_t Window        = 1u << 1;
+    constexpr uint32_t Key           = 1u << 2;
+    constexpr uint32_t Text          = 1u << 3;
+    constexpr uint32_t MouseMotion   = 1u << 4;
+    constexpr uint32_t MouseButton   = 1u << 5;
+    constexpr uint32_t MouseWheel    = 1u << 6;
+    constexpr uint32_t Other         = 1u << 7;
+    constexpr uint32_t AllSDL        = 0xFFu;
+    // 游戏内部事件
+    constexpr uint32_t StateChanged      = 1u << 16;
+    constexpr uint32_t AnimationFinished = 1u << 17;
+    constexpr uint32_t AllGame           = 0x3u << 16;
+}
+
+// 游戏内部事件，定长，放在预分配的环形队列里
+// 宠物在 update 里 post，Game 在所有宠物更新之后统一分发（同一帧内），分发时宠物都还活着
+struct GameEvent{
+    enum class Type : uint8_t {StateChanged, AnimationFinished};
+    Type type = Type::StateChanged;
+    DesktopPet* pet = nullptr;      // 相关的宠物
+    uint32_t from = 0;              // StateChanged：旧状态（StateId 的值）
+    uint32_t to = 0;                // StateChanged：新状态；AnimationFinished：播放完的状态
+};
+
+// 事件总线（单例）
+// - 订阅者按位掩码声明关心的事件，只收到匹配的事件
+// - 同一帧内连续的鼠标移动事件合并为一个（位置取最后一次，相对位移累加）
+// - installFilter() 通过 SDL_SetEventFilter 在入队前丢弃没人订阅的事件
+// - 内部事件 post() 进定长环形队列，dispatchGameEvents() 统一分发，不分配内存；没有订阅者的类型直接丢弃，不占队列
+class EventBus{
+public:
+    using SubscriptionId = int;
+    using EventCallback = void(*)(void* userdata, SDL_Event& event);
+    using GameEventCallback = void(*)(void* userdata, const GameEvent& event);
+
+    static EventBus& getInstance(){
+        static EventBus instance;
+        return instance;
+    }
+
+    static constexpr size_t kQueueCapacity = 1024; // 2 的幂
+
+    SubscriptionId subscribe(uint32_t mask, EventCallback callback, void* userdata);
+    SubscriptionId subscribe(uint32_t mask, GameEventCallback callback, void* userdata);
+    void unsubscribe(SubscriptionId id);
+    void clear(); // 清空订阅与队列
+
+    // 早期过滤：没有订阅者的事件类型在入队前丢弃（退出事件与用户事件总是保留）
+    void installFilter();
+    void removeFilter();
+
+    // SDL 事件：鼠标移动先合并，其余事件立即分发（分发前先送出合并中的移动事件，保持顺序）
+    void publish(SDL_Event& event);
+    void flush(); // 帧末调用，送出合并中的移动事件
+
+    // 内部事件
+    bool post(const GameEvent& event); // 队列满时丢弃并返回 false；没有订阅者时不入队，返回 true
+    bool hasSubscribers(GameEvent::Type type) const {return (gameMask_ & maskOf(type)) != 0;}
+    void dispatchGameEvents();
+    size_t getQueuedGameEvents() const {return tail_ - head_;}
+
+    static uint32_t maskOf(Uint32 sdlEventType);
+    static uint32_t maskOf(GameEvent::Type type);
+
+    // 统计
+    uint64_t getReceivedCount() const {return received_;}
+    uint64_t getDeliveredCount() const {return delivered_;}
+    uint64_t getCoalescedCount() const {return coalesced_;}
+    uint64_t getFilteredCount() const {return filtered_.load(std::memory_order_relaxed);}
+    uint64_t getDroppedGameEvents() const {return dropped_;}
+
+private:
+    EventBus() = default;
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    struct Subscription{
+        SubscriptionId id = 0;
+        uint32_t mask = 0;
+        EventCallback onEvent = nullptr;
+        GameEventCallback onGameEvent = nullptr;
+        void* userdata = nullptr;
+    };
+
+    static bool SDLCALL eventFilter(void* userdata, SDL_Event* event); // 可能在其他线程调用
+
+    SubscriptionId addSubscription(const Subscription& s);
+    void deliver(SDL_Event& event, uint32_t mask);
+    void updateMask();
+    void compact(); // 移除已取消的订阅
+
+    std::vector<Subscription> subscriptions_;
+    SubscriptionId nextId_ = 1;
+    int dispatchDepth_ = 0;
+    std::atomic<uint32_t> sdlMask_{0};  // 所有订阅者关心的 SDL 事件类别的并集
+    uint32_t gameMask_ = 0;             // 所有订阅者关心的内部事件类别的并集
+    bool filterInstalled_ = false;
+
+    SDL_Event pendingMotion_{};
+    bool hasPendingMotion_ = false;
+
+    std::array<GameEvent, kQueueCapacity> queue_{};
+    size_t head_ = 0, tail_ = 0; // tail_ - head_ 为队列长度
+
+    uint64_t received_ = 0;
+    uint64_t delivered_ = 0;
+    uint64_t coalesced_ = 0;
+    std::atomic<uint64_t> filtered_{0};
+    uint64_t dropped_ = 0;
+};
+
+#endif // EVENTBUS_H
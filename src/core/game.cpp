@@ -2,16 +2,59 @@
 #include "pet/catpet.h"
 #include "../tools/tools.h"
 #include "../tools/hittest.h"
+#include "../tools/timer_service.h"
+#include "../tools/game_clock.h"
+#include "behavior.h"
+#include "audio.h"
+#include "text.h"
+#include "spritelibrary.h"
+#include "../tools/random.h"
+#include "../tools/memory_stats.h"
+#include "compositor.h"
+#include <algorithm>
+#include <cmath>
 
 
 
-void Game::init()
+void Game::init(const GameOptions& options)
 {
+    options_ = options;
+    registerMetrics();
+
+    if(options_.textureBudgetMB > 0){
+        tools::MemoryStats::getInstance().setBudget(tools::MemTag::Textures, options_.textureBudgetMB * 1024 * 1024);
+    }
+
+    // 回放需要先读出种子
+    if(!options_.replayPath.empty() && !player_.open(options_.replayPath)){
+        return;
+    }
+
+    // 压力场景总是无头运行
+    if(!options_.stressPets.empty()){
+        options_.headless = true;
+    }
+
+    // 无头模式：不创建真实窗口，也不占用声卡
+    if(options_.headless){
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    }
+
     // SDL 初始化
     if(!SDL_Init(SDL_INIT_AUDIO | SDL_INIT_VIDEO)){
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init Error: %s", SDL_GetError());
         return;
     }
+    // 事件总线：只订阅需要的事件，其余（例如大量的鼠标移动）在入队前就被过滤
+    EventBus& bus = EventBus::getInstance();
+    bus.subscribe(EventMask::Quit, &Game::onQuitEvent, this);
+    bus.subscribe(EventMask::MouseButton, &Game::onPointerEvent, this);
+    bus.subscribe(EventMask::Key, &Game::onClockKeyEvent, this);
+    bus.subscribe(EventMask::StateChanged | EventMask::AnimationFinished, &Game::onPetEvent, this);
+    bus.installFilter();
+
     // 不需要对SDL_image初始化，会自动初始化
     // SDL3_Mixer初始化
     if(Mix_Init(MIX_INIT_MP3 | MIX_INIT_OGG) != (MIX_INIT_MP3 | MIX_INIT_OGG)){
@@ -22,9 +65,9 @@ void Game::init()
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Mix_OpenAudio Error: %s", SDL_GetError());
         return;
     }
-    Mix_AllocateChannels(16); // 分配16个音频通道
     Mix_VolumeMusic(MIX_MAX_VOLUME / 4); // 设置背景音乐音量为最大音量的1/4
-    Mix_Volume(-1, MIX_MAX_VOLUME / 4); // 设置所有音效音量为最大音量的1/4
+    // 分配16个音频通道（声道池），所有音效音量为最大音量的1/4
+    AudioSystem::getInstance().init(16, MIX_MAX_VOLUME / 4);
 
     // SDL3_ttf初始化
     if(!TTF_Init()){
@@ -32,11 +75,13 @@ void Game::init()
         return;
     }
 
-    // 获取屏幕大小（整型像素）
-    int screenW = 0, screenH = 0;
-    tools::UI::getWindowSize(screenW, screenH);
-    window_size_.x = screenW;
-    window_size_.y = screenH;
+    // 获取屏幕大小（整型像素），无头模式使用默认大小，保证不同机器上结果一致
+    if(!options_.headless){
+        int screenW = 0, screenH = 0;
+        tools::UI::getWindowSize(screenW, screenH);
+        window_size_.x = screenW;
+        window_size_.y = screenH;
+    }
     SDL_Log("Window size: %d x %d", window_size_.x, window_size_.y);
 
     // 创建 透明 置顶 无边框 窗口
@@ -59,6 +104,10 @@ void Game::init()
     SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0); // 清屏为全透明
     SDL_Log("Renderer blend mode set to BLEND, clear color RGBA(0,0,0,0)");
 
+    // 文字（对话气泡），字体加载失败时只是不显示气泡
+    TextSystem::getInstance().init(renderer_);
+
+#ifdef _WIN32
     // 获取 HWND 设置窗口扩展样式
     SDL_Window *window = SDL_GetWindowFromID(SDL_GetWindowID(window_)); // 获取SDL_Window指针
     if(window){
@@ -75,119 +124,897 @@ void Game::init()
             // is_transparent_ = false;
         }
     }
+#else
+    // X11：按宠物区域设置窗口的输入区域，区域外的点击直接穿透到桌面
+    inputShape_ = tools::UI::SupportsInputShape(window_);
+    SDL_Log("Click-through: %s", inputShape_ ? "X11 input shape" : "unsupported on this video driver (whole window receives input)");
+#endif
     
     // 强制窗口获得焦点，确保鼠标事件分发
     SDL_RaiseWindow(window_);
 
-    // to do: 初始化桌宠
-    pet_ = new CatPet();
-    pet_->setRenderer(renderer_);
-    pet_->init(); // CatPet::init 内部已负责加载动画与设置初始状态
+    // 随机数种子：回放用日志里的，否则用 --seed 或当前（随机）种子，并记录下来
+    // 每只宠物的随机数流都从全局流切分，创建顺序固定，所以一个种子就能复现
+    uint64_t seed = tools::Random::getSeed();
+    if(player_.isOpen()){
+        seed = player_.getSeed();
+    } else if(options_.hasSeed){
+        seed = options_.seed;
+    }
+    tools::Random::setSeed(seed);
+    if(!options_.recordPath.empty()){
+        recorder_.open(options_.recordPath, seed);
+    }
+
+    startInputStats();
+    startCompositor(); // 决定精灵加载时是否生成预乘像素，必须在创建桌宠之前
+
+    // 精灵只生成绘制用的一份：软件渲染逐像素缩放很慢，预先放大到视图缩放；GPU 只建 x1，绘制时最近邻放大
+    const char* rendererName = SDL_GetRendererName(renderer_);
+    const bool softwareRenderer = !options_.headless && rendererName && SDL_strcmp(rendererName, "software") == 0;
+    spriteOptions_.cpuPixels = Compositor::getInstance().isEnabled();
+    spriteOptions_.pixelArtUpscale = options_.pixelArtUpscale;
+    prescaleSprites_ = softwareRenderer || options_.pixelArtUpscale;
+
+    // 精灵几何：默认只画每帧不透明像素的包围盒
+    if(options_.spriteGeometry == "quad"){
+        Animation::setGeometry(SpriteGeometry::Quad);
+    } else if(options_.spriteGeometry == "hull"){
+        Animation::setGeometry(SpriteGeometry::Hull);
+    } else{
+        if(options_.spriteGeometry != "trim"){
+            SDL_Log("Unknown --sprite-geometry '%s', using trim", options_.spriteGeometry.c_str());
+        }
+        Animation::setGeometry(SpriteGeometry::Trim);
+    }
+
+    // 初始化桌宠；压力场景在运行时按人口生成
+    if(options_.stressPets.empty()){
+        for(int i = 0; i < std::max(options_.pets, 1); i++){
+            addPet(new CatPet(options_.palette));
+        }
+        rebuildPetGrid();
+    } else if(!stress_.configure(options_.stressPets, options_.stressManifests, options_.stressSeconds, seed)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid --stress list: %s", options_.stressPets.c_str());
+        return;
+    }
 
     // 不再使用 SDL 窗口 HitTest 进行点击穿透（该回调用于边框拖拽/调整大小）
-    // 改为基于 Win32 WS_EX_TRANSPARENT 动态切换鼠标穿透
+    // 改为基于 Win32 WS_EX_TRANSPARENT 动态切换鼠标穿透（X11 下用窗口输入区域，见 updateInputShape）
+#ifdef _WIN32
     SDL_Log("HitTest disabled; using WS_EX_TRANSPARENT toggling based on mouse position");
+#endif
 
     // 设置窗口逻辑分辨率
     SDL_SetRenderLogicalPresentation(renderer_, window_size_.x, window_size_.y, SDL_LOGICAL_PRESENTATION_LETTERBOX);
 
-    // frame delay ns（按目标 FPS 计算）
-    frame_delay_ = static_cast<Uint64>(1'000'000'000ULL / (FPS_ > 0 ? FPS_ : 60));
+    // 帧率控制：垂直同步时按显示器刷新率，否则按目标 FPS 睡眠 + 忙等
+    if(options_.fps > 0){
+        FPS_ = options_.fps;
+    }
+    pacer_.setTargetFps(static_cast<double>(FPS_));
+    if(options_.vsync && !options_.fastForward){
+        const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window_));
+        if(SDL_SetRenderVSync(renderer_, 1)){
+            pacer_.setMode(tools::FramePacer::Mode::VSync);
+            if(mode && mode->refresh_rate > 0.0f){
+                pacer_.setTargetFps(mode->refresh_rate);
+            }
+        } else{
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_SetRenderVSync Error: %s, falling back to timed pacing", SDL_GetError());
+        }
+    }
+    if(pacer_.getMode() != tools::FramePacer::Mode::VSync && !options_.fastForward){
+        pacer_.calibrate();
+    }
+    SDL_Log("Frame pacing: %s, %.2f fps", tools::FramePacer::getModeName(pacer_.getMode()), pacer_.getTargetFps());
+
+    // 虚拟时钟：每帧前进 帧周期 x 倍率；回放按录制的帧长，不受倍率影响
+    tools::GameClock::getInstance().setTimeScale(options_.timeScale);
+    if(options_.timeScale != 1.0){
+        SDL_Log("Time scale: %.3fx", tools::GameClock::getInstance().getTimeScale());
+    }
+    if(options_.paused){
+        tools::GameClock::getInstance().pause();
+        SDL_Log("Game clock paused (F9 resume, F10 step one frame)");
+    }
+
+    // 模拟放到单独的线程：回放/无头/快进需要逐帧串行，保持原来的单线程循环
+    // 无头的延迟探测照常绘制，按实际的线程结构测量
+    threaded_ = !options_.singleThread && !options_.fastForward && !player_.isOpen() && !stress_.isEnabled()
+        && (!options_.headless || options_.latencyProbe > 0);
+    if(threaded_){
+        wakeEvent_ = SDL_RegisterEvents(1);
+        if(wakeEvent_ == 0){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_RegisterEvents failed, running single-threaded");
+            threaded_ = false;
+        }
+    }
+    SDL_Log("Main loop: %s", threaded_ ? "simulation thread + render thread" : "single thread");
+    SDL_Log("Pet motion: batched, %s kernel", tools::math::KinematicsBatch::kernelName());
 
     // 初始化FPS统计
     fps_last_report_ns_ = SDL_GetTicksNS();
     fps_frame_count_ = 0;
     fps_last_value_ = 0.0f;
+    fps_last_presented_ = 0;
+
+    // 实时指标服务：启动失败只是无法抓取，不影响运行
+    if(!options_.metricsSocket.empty()){
+        tools::Metrics::getInstance().startServer(options_.metricsSocket);
+    }
 
     // now we are running
     is_running_ = true;
 }
 
-void Game::update(float deltaTime)
+void Game::update(Uint64 deltaNs)
 {
-    if(pet_){
-        pet_->update(deltaTime);
-    }
-    // 每帧末尾根据鼠标位置切换点击穿透
-    if(hwnd_ && pet_){
-        SDL_Point mouse = tools::UI::getClientMousePosition(hwnd_);
-        SDL_Rect rect = pet_->getRect();
-        int scale = pet_->getViewScale();
-        rect.w *= scale;
-        rect.h *= scale;
-        tools::UI::ChangeTransparentState(hwnd_, mouse, rect, is_transparent_);
+    // 推进时间轮，到期的定时器在这里触发（与 GameClock 同一帧长，整数纳秒）
+    tools::TimerService::getInstance().advance(deltaNs);
+    // 恢复被唤醒的行为协程（挂起中的行为不参与）
+    BehaviorScheduler::getInstance().run();
+    // 行为刚设置的目标也在这一步里：所有走动中的宠物一起积分，宠物 update 时只取结果
+    motion_.integrate(static_cast<float>(static_cast<double>(deltaNs) / 1.0e9));
+
+    const int lod = options_.lodInterval;
+    deferredCount_ = 0;
+    for(size_t i = 0; i < pets_.size(); i++){
+        DesktopPet* pet = pets_[i];
+        // 看不见、也没在走动或演一次性动画的宠物只攒时间，每 lod 帧补一次（按下标错开）
+        // 位置不变，空间索引也不用更新
+        if(lod > 1 && i < petVisible_.size() && !petVisible_[i] && pet->canDeferUpdate()){
+            pet->deferUpdate(deltaNs);
+            deferredCount_++;
+            if((simTick_ + i) % static_cast<uint64_t>(lod) == 0){
+                pet->catchUp();
+            }
+            continue;
+        }
+        pet->catchUp();
+        pet->update(deltaNs);
+        petGrid_.update(static_cast<int>(i), getPetRect(pet)); // 增量更新
     }
+    // 分发本帧产生的内部事件（状态切换、动画结束、定时器）
+    EventBus::getInstance().dispatchGameEvents();
 }
 
 void Game::handleEvent()
 {
+    EventBus& bus = EventBus::getInstance();
     SDL_Event e;
-    while(SDL_PollEvent(&e)){
-        if(e.type == SDL_EVENT_QUIT){
+    uint64_t events = 0;
+    if(player_.isOpen()){
+        // 回放：真实输入只响应退出，其余事件来自日志
+        while(SDL_PollEvent(&e)){
+            if(e.type == SDL_EVENT_QUIT){
+                is_running_ = false;
+            }
+        }
+        if(!player_.beginFrame()){
             is_running_ = false;
+            return;
+        }
+        while(player_.pollEvent(e)){
+            bus.publish(e);
+            events++;
+        }
+        bus.flush();
+        eventsMetric_->add(events);
+        return;
+    }
+
+    if(threaded_){
+        // 模拟线程：事件已由主线程取出放进 inbox_
+        while(inbox_.pop(e)){
+            recorder_.recordEvent(e);
+            bus.publish(e);
+            events++;
         }
-        if(pet_){
-            pet_->handleEvent(e);
+    } else{
+        while(SDL_PollEvent(&e)){
+            recorder_.recordEvent(e);
+            bus.publish(e);
+            events++;
         }
     }
+    bus.flush(); // 送出本帧合并后的鼠标移动
+    eventsMetric_->add(events); // 每帧一次原子加
+}
+
+void Game::forwardEvent(const SDL_Event& event)
+{
+    if(event.type == wakeEvent_){
+        wakePending_.store(false, std::memory_order_release);
+        return;
+    }
+    if(event.type == SDL_EVENT_QUIT){
+        is_running_ = false; // 模拟线程也会收到，这里保证主线程不再等待
+    }
+    if(!inbox_.push(event)){
+        droppedInput_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Game::startInputStats()
+{
+    // 默认不统计：不装全局钩子、不写文件，需要 --input-stats 显式开启（测试时 --synthetic-input 也算）
+    if(!options_.inputStats && options_.syntheticKeysPerMinute <= 0.0f){
+        return;
+    }
+    // 录制/回放、压力场景与无头运行时不统计：宠物会参考打字速度，真实输入速率无法复现
+    if(!options_.recordPath.empty() || player_.isOpen() || !options_.stressPets.empty() || options_.headless){
+        return;
+    }
+    tools::InputStats& stats = tools::InputStats::getInstance();
+    if(options_.syntheticKeysPerMinute > 0.0f){
+        stats.addSource(std::make_unique<tools::SyntheticInputSource>(
+            options_.syntheticKeysPerMinute, options_.syntheticKeysPerMinute / 10.0f));
+    } else{
+#ifdef _WIN32
+        // 窗口大部分时间是鼠标穿透的，键盘焦点也在别的程序上，只能用全局钩子计数
+        stats.addSource(std::make_unique<tools::GlobalHookInputSource>());
+#else
+        // 其他平台只能统计发给本窗口的输入；不订阅鼠标移动，保留入队前的过滤
+        auto source = std::make_unique<tools::SDLInputSource>();
+        EventBus::getInstance().subscribe(EventMask::Key | EventMask::MouseButton | EventMask::MouseWheel,
+            &tools::SDLInputSource::onEvent, source.get());
+        stats.addSource(std::move(source));
+#endif
+    }
+    stats.start(options_.inputStatsPath);
+}
 
+void Game::startCompositor()
+{
+    if(options_.headless || options_.compositor == "sdl"){
+        return;
+    }
+    const char* name = SDL_GetRendererName(renderer_);
+    const bool software = name && SDL_strcmp(name, "software") == 0;
+    if(options_.compositor != "cpu" && !software){
+        return; // GPU 渲染器自己混合更快
+    }
+    if(!Compositor::getInstance().init(renderer_, window_size_.x, window_size_.y)){
+        SDL_Log("Compositor unavailable, pets are drawn by SDL");
+    }
+}
 
+void Game::onQuitEvent(void* userdata, [[maybe_unused]] SDL_Event& event)
+{
+    static_cast<Game*>(userdata)->is_running_ = false;
 }
 
-void Game::render()
+void Game::onPointerEvent(void* userdata, SDL_Event& event)
 {
+    // 通过空间索引找到鼠标下最上层的桌宠，宠物再多也只有一次查询
+    Game* game = static_cast<Game*>(userdata);
+    SDL_Point point = {static_cast<int>(event.button.x), static_cast<int>(event.button.y)};
+    if(DesktopPet* pet = game->getPetAt(point)){
+        pet->handleEvent(event);
+    }
+}
+
+void Game::onClockKeyEvent(void* userdata, SDL_Event& event)
+{
+    // 在模拟线程上处理，和 sampleFrame 同一线程，不需要加锁
+    if(event.type != SDL_EVENT_KEY_DOWN){
+        return;
+    }
+    Game* game = static_cast<Game*>(userdata);
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    if(event.key.key == SDLK_F9 && !event.key.repeat){
+        if(clock.isPaused()){
+            clock.resume();
+        } else{
+            clock.pause();
+        }
+        SDL_Log("Game clock %s at %.3f s", clock.isPaused() ? "paused" : "resumed", clock.getNowSeconds());
+    } else if(event.key.key == SDLK_F10){
+        // 单步：先暂停，下一帧只前进一个名义帧长；按住不放时逐帧前进
+        clock.pause();
+        clock.step(game->pacer_.getPeriodNs());
+    }
+}
+
+void Game::onPetEvent(void* userdata, const GameEvent& event)
+{
+    // update 末尾分发，宠物都还在 pets_ 里
+    Game* game = static_cast<Game*>(userdata);
+    switch(event.type){
+    case GameEvent::Type::AnimationFinished:
+        event.pet->onAnimationFinished(StateId::fromValue(event.to));
+        break;
+    case GameEvent::Type::StateChanged:
+        game->stateChangesMetric_->add();
+        break;
+    }
+}
+
+void Game::render(const RenderSnapshot& snapshot)
+{
+    const Uint64 submitNs = SDL_GetTicksNS();
+
+    // 根据鼠标是否在桌宠上切换点击穿透（窗口样式只在主线程修改）
+#ifdef _WIN32
+    if(hwnd_ && !snapshot.sprites.empty()){
+        tools::UI::ChangeWindowTransparent(hwnd_, snapshot.mouseOverPet, is_transparent_);
+    }
+#else
+    if(inputShape_){
+        updateInputShape(snapshot);
+    }
+#endif
+
     SDL_RenderClear(renderer_);
-    if(pet_){
-        pet_->render();
+    // CPU 合成时宠物先画进帧缓冲，再整块上传
+    Compositor& compositor = Compositor::getInstance();
+    if(compositor.isEnabled()){
+        compositor.begin();
+    }
+    for(const SpriteDraw& d : snapshot.sprites){
+        d.clip->renderFrame(renderer_, d.frame, d.dst.x, d.dst.y, d.dst.w, d.dst.h, d.flip);
+    }
+    if(compositor.isEnabled()){
+        compositor.present();
+    }
+    // 对话气泡画在所有宠物之上，整批一次提交
+    TextSystem& text = TextSystem::getInstance();
+    if(text.isReady() && snapshot.bubbleCount > 0){
+        for(size_t i = 0; i < snapshot.bubbleCount; i++){
+            const BubbleDraw& b = snapshot.bubbles[i];
+            text.drawBubble(b.text, b.x, b.y);
+        }
+        text.flush();
     }
     SDL_RenderPresent(renderer_);
+    presented_.fetch_add(1, std::memory_order_relaxed);
+    const Uint64 presentNs = SDL_GetTicksNS();
+    renderMetric_->record(presentNs - submitNs);
+    collectLatency(snapshot.tick, submitNs, presentNs);
+}
+
+void Game::collectLatency(uint64_t tick, Uint64 submitNs, Uint64 presentNs)
+{
+    tools::InputStamp stamp;
+    while(stamps_.pop(stamp)){
+        waitingStamps_.push_back(stamp);
+    }
+    if(waitingStamps_.empty()){
+        return;
+    }
+    // 画到了交互所在的那一帧（或更新的帧）才算送达
+    tools::LatencyStats& latency = tools::LatencyStats::getInstance();
+    size_t keep = 0;
+    for(const tools::InputStamp& s : waitingStamps_){
+        if(s.tick <= tick){
+            latency.recordStamp(s, submitNs, presentNs);
+        } else{
+            waitingStamps_[keep++] = s;
+        }
+    }
+    waitingStamps_.resize(keep);
+
+    if(options_.latencyProbe > 0 && latency.getCount() >= static_cast<uint64_t>(options_.latencyProbe)){
+        is_running_ = false;
+    }
+}
+
+void Game::runLatencyProbe(const RenderSnapshot& snapshot)
+{
+    if(options_.latencyProbe <= 0 || snapshot.sprites.empty()){
+        return;
+    }
+    const Uint64 now = SDL_GetTicksNS();
+    if(now < probeNextNs_){
+        return;
+    }
+    // 上一次点击还没送达时等待，超过 2 秒算丢失，重新点击
+    const uint64_t measured = tools::LatencyStats::getInstance().getCount();
+    if(measured + probeLost_ < static_cast<uint64_t>(probeSent_)){
+        if(now < probeNextNs_ + 2'000'000'000ULL){
+            return;
+        }
+        probeLost_++;
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Latency probe: click %d was not presented within 2 s", probeSent_);
+    }
+
+    // 点在最上层（最后绘制）的桌宠中心，和真实点击走同一条路径：SDL 队列 -> 事件总线 -> 宠物
+    const SDL_Rect& r = snapshot.sprites.back().dst;
+    SDL_Event e{};
+    e.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+    e.button.timestamp = now;
+    e.button.windowID = SDL_GetWindowID(window_);
+    e.button.button = SDL_BUTTON_LEFT;
+    e.button.down = true;
+    e.button.clicks = 1;
+    e.button.x = r.x + r.w * 0.5f;
+    e.button.y = r.y + r.h * 0.5f;
+    SDL_PushEvent(&e);
+    e.type = SDL_EVENT_MOUSE_BUTTON_UP;
+    e.button.down = false;
+    SDL_PushEvent(&e);
+    probeSent_++;
+    // 间隔随机，避免总是落在帧周期的同一相位
+    probeNextNs_ = now + static_cast<Uint64>(probeRng_.randint(150, 400)) * 1'000'000ULL;
+}
+
+void Game::buildSnapshot(RenderSnapshot& out)
+{
+    out.clear();
+    out.tick = ++simTick_;
+    tools::InputStamp stamp;
+    // 只提交与窗口相交的宠物（留 1 像素余量，绘制位置是四舍五入后的整像素）
+    const SDL_Rect view{-1, -1, window_size_.x + 2, window_size_.y + 2};
+    petVisible_.resize(pets_.size());
+    visibleCount_ = 0;
+    for(size_t i = 0; i < pets_.size(); i++){
+        DesktopPet* pet = pets_[i];
+        const SDL_Rect r = pet->getRect();
+        const bool visible = SDL_HasRectIntersection(&r, &view);
+        petVisible_[i] = visible ? 1 : 0;
+        if(visible){
+            pet->catchUp(); // 刚进入画面的宠物先补上攒下的时间
+            pet->submit(out);
+            visibleCount_++;
+        }
+        // 回放的事件时间戳来自录制时，不参与统计
+        if(pet->takeInputStamp(stamp) && !player_.isOpen()){
+            stamp.tick = out.tick;
+            tickStamps_.push_back(stamp);
+        }
+    }
+    for(const DesktopPet* pet : pets_){
+        if(pet->isSpeaking()){
+            const SDL_Rect r = getPetRect(pet);
+            BubbleDraw& b = out.addBubble();
+            b.text = pet->getSpeech();
+            b.x = r.x + r.w * 0.5f;
+            b.y = static_cast<float>(r.y);
+        }
+    }
+#ifdef _WIN32
+    if(hwnd_ && !pets_.empty()){
+        SDL_Point mouse = tools::UI::getClientMousePosition(hwnd_);
+        out.mouseOverPet = petGrid_.queryPoint(mouse) >= 0;
+    }
+#endif
+}
+
+void Game::updateInputShape(const RenderSnapshot& snapshot)
+{
+    // 只取每帧不透明的部分（透明的边上点击也穿透），逻辑分辨率下的坐标换算成窗口坐标（向外取整，不丢边上的像素）
+    shapeRects_.clear();
+    for(const SpriteDraw& d : snapshot.sprites){
+        const SDL_Rect r = d.clip->getOpaqueRect(d.frame, d.dst, d.flip);
+        if(r.w <= 0 || r.h <= 0) continue;
+        float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+        SDL_RenderCoordinatesToWindow(renderer_, r.x, r.y, &x0, &y0);
+        SDL_RenderCoordinatesToWindow(renderer_, r.x + r.w, r.y + r.h, &x1, &y1);
+        const int left = static_cast<int>(std::floor(x0)), top = static_cast<int>(std::floor(y0));
+        shapeRects_.push_back(SDL_Rect{left, top, static_cast<int>(std::ceil(x1)) - left, static_cast<int>(std::ceil(y1)) - top});
+    }
+
+    // 宠物没动时区域不变，不打扰 X 服务器
+    const bool same = shapeRects_.size() == appliedShape_.size() &&
+        std::equal(shapeRects_.begin(), shapeRects_.end(), appliedShape_.begin(),
+                   [](const SDL_Rect& a, const SDL_Rect& b){ return SDL_RectsEqual(&a, &b); });
+    if(same){
+        return;
+    }
+    if(!tools::UI::SetWindowInputShape(window_, shapeRects_)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to set the window input shape, click-through disabled");
+        inputShape_ = false;
+        return;
+    }
+    appliedShape_.swap(shapeRects_);
+    shapeUpdates_++;
+    if(options_.checkInputShape && !tools::UI::CheckInputShape(window_, appliedShape_)){
+        shapeMismatches_++;
+    }
+}
+
+void Game::step()
+{
+    const Uint64 t0 = SDL_GetTicksNS();
+    handleEvent();
+    if(!is_running_){
+        return;
+    }
+    const Uint64 t1 = SDL_GetTicksNS();
+    // 每帧采样一次虚拟时钟：回放时使用录制时的帧长，保证同样的输入得到同样的结果
+    // 否则用固定的帧周期 x 倍率（暂停时为 0）：画面是否平滑不取决于每帧实际耗时的波动
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    const Uint64 frameNs = player_.isOpen() ? clock.advanceExact(player_.getFrameNs()) : clock.sampleFrame(pacer_.getPeriodNs());
+    update(frameNs);
+    recorder_.endFrame(frameNs);
+    simulated_s_ = clock.getNowSeconds();
+    if(options_.runFor > 0.0 && simulated_s_ >= options_.runFor){
+        is_running_ = false;
+    }
+    const Uint64 t2 = SDL_GetTicksNS();
+
+    buildSnapshot(snapshots_.write());
+    // 交互先于快照交给主线程，主线程画到这一帧时一定已经能取到
+    if(!tickStamps_.empty()){
+        const Uint64 now = SDL_GetTicksNS();
+        for(tools::InputStamp& s : tickStamps_){
+            s.publishedNs = now;
+            stamps_.push(s);
+        }
+        tickStamps_.clear();
+    }
+    snapshots_.publish();
+
+    phaseNs_[0] = t1 - t0;
+    phaseNs_[1] = t2 - t1;
+    phaseNs_[2] = SDL_GetTicksNS() - t2;
+    for(int i = 0; i < 3; i++){
+        phaseMetrics_[i]->record(phaseNs_[i]);
+    }
+    petsMetric_->set(static_cast<double>(pets_.size()));
+    visibleMetric_->set(visibleCount_);
+    deferredMetric_->set(deferredCount_);
+    const uint64_t wakeups = tools::TimerService::getInstance().getFiredTotal() + BehaviorScheduler::getInstance().getResumeCount();
+    wakeupsMetric_->add(wakeups - std::min(wakeups, wakeupsSeen_));
+    wakeupsSeen_ = wakeups;
 }
 
 void Game::run()
 {
-    while(is_running_){
+    const Uint64 run_start_ns = SDL_GetTicksNS();
+    simulated_s_ = tools::GameClock::getInstance().getNowSeconds();
+
+    if(stress_.isEnabled()){
+        runStress();
+    } else if(threaded_){
+        runThreaded();
+    } else{
+        runSingleThread();
+    }
+
+    if(player_.isOpen() || options_.runFor > 0.0){
+        const double wall_s = static_cast<double>(SDL_GetTicksNS() - run_start_ns) / 1.0e9;
+        SDL_Log("%s finished: %llu frames, %.3f s simulated in %.3f s (%.1fx)", player_.isOpen() ? "Replay" : "Run",
+            static_cast<unsigned long long>(tools::GameClock::getInstance().getFrameIndex()), simulated_s_, wall_s,
+            wall_s > 0.0 ? simulated_s_ / wall_s : 0.0);
+    }
+}
+
+void Game::runStress()
+{
+    // 模拟时长按虚拟时钟计：step() 里每帧前进 帧周期 x 倍率，帧数由这个步长得出
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    const uint64_t stepNs = (clock.getMode() == tools::GameClock::Mode::Scaled && !clock.isPaused())
+        ? static_cast<uint64_t>(static_cast<double>(pacer_.getPeriodNs()) * clock.getTimeScale()) : 0;
+    if(stepNs == 0){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Stress: the game clock does not advance (time scale 0 or paused)");
+        is_running_ = false;
+        return;
+    }
+    const float frameDt = static_cast<float>(static_cast<double>(stepNs) / 1.0e9);
+    const uint64_t frames = static_cast<uint64_t>(static_cast<double>(stress_.getSeconds()) * 1.0e9 / static_cast<double>(stepNs) + 0.5);
+    const SDL_WindowID windowId = SDL_GetWindowID(window_);
+    tools::TimerService& timers = tools::TimerService::getInstance();
+    BehaviorScheduler& scheduler = BehaviorScheduler::getInstance();
+    tools::MemoryStats& memory = tools::MemoryStats::getInstance();
+    const SDL_LogPriority logPriority = SDL_GetLogPriority(SDL_LOG_CATEGORY_APPLICATION);
+
+    for(int population : stress_.getPopulations()){
+        if(!is_running_){
+            break;
+        }
+        SDL_Log("Stress: %d pets, %llu frames", population, static_cast<unsigned long long>(frames));
+        // 上万只宠物的初始化/走动日志会淹没计时，运行期间只保留警告和错误
+        SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN);
+
+        StressPoint& point = stress_.beginPoint(population);
+        tools::Random::setSeed(stress_.getSeed()); // 宠物的随机数流从全局流切分，每个人口相同
+        const Uint64 spawnStart = SDL_GetTicksNS();
+        {
+            tools::MemoryScope petScope(tools::MemTag::Pets);
+            for(int i = 0; i < population; i++){
+                DesktopPet* pet = new CatPet(options_.palette, stress_.getManifest(i));
+                addPet(pet);
+                float x = 0.0f, y = 0.0f;
+                const SDL_Rect r = pet->getRect();
+                stress_.placePet(window_size_.x, window_size_.y, r.w, r.h, x, y);
+                pet->setPosition(x, y);
+            }
+            rebuildPetGrid();
+        }
+        point.spawnMs = static_cast<double>(SDL_GetTicksNS() - spawnStart) / 1.0e6;
+
+        const OverdrawStats fillStart = Animation::getOverdrawStats();
+        const uint64_t wakeStart = timers.getFiredTotal() + scheduler.getResumeCount();
+        const Uint64 runStart = SDL_GetTicksNS();
+        for(uint64_t f = 0; f < frames && is_running_; f++){
+            const Uint64 frameStart = SDL_GetTicksNS();
+            step();
+            if(!is_running_ || !snapshots_.consume()){
+                break;
+            }
+            const RenderSnapshot& snapshot = snapshots_.read();
+            const Uint64 renderStart = SDL_GetTicksNS();
+            render(snapshot);
+            const Uint64 frameEnd = SDL_GetTicksNS();
+            // 下一帧的输入，和真实输入一样经过 SDL 队列
+            point.clicks += stress_.injectInput(snapshot, windowId, window_size_.x, window_size_.y, frameDt);
+
+            point.phases[static_cast<size_t>(StressPhase::Events)].record(phaseNs_[0]);
+            point.phases[static_cast<size_t>(StressPhase::Update)].record(phaseNs_[1]);
+            point.phases[static_cast<size_t>(StressPhase::Snapshot)].record(phaseNs_[2]);
+            point.phases[static_cast<size_t>(StressPhase::Render)].record(frameEnd - renderStart);
+            point.phases[static_cast<size_t>(StressPhase::Frame)].record(frameEnd - frameStart);
+            point.drawCalls += snapshot.sprites.size() + snapshot.bubbleCount;
+            point.visible += static_cast<uint64_t>(visibleCount_);
+            point.deferred += static_cast<uint64_t>(deferredCount_);
+            point.frames++;
+        }
+        point.wallS = static_cast<double>(SDL_GetTicksNS() - runStart) / 1.0e9;
+        point.wakeups = timers.getFiredTotal() + scheduler.getResumeCount() - wakeStart;
+        point.heapBytes = memory.getTotalLive();
+        point.textureBytes = memory.getLive(tools::MemTag::Textures);
+        point.quadPixels = Animation::getOverdrawStats().quadPixels - fillStart.quadPixels;
+        point.drawnPixels = Animation::getOverdrawStats().drawnPixels - fillStart.drawnPixels;
+
+        removeAllPets();
+        SDL_FlushEvents(SDL_EVENT_FIRST, SDL_EVENT_LAST); // 丢掉投给已释放宠物的输入
+        SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, logPriority);
+        SDL_Log("Stress: %d pets done, %.3f ms/frame mean, spawn %.1f ms", population,
+            point.phases[static_cast<size_t>(StressPhase::Frame)].getMeanUs() / 1000.0, point.spawnMs);
+    }
+
+    stress_.logReport();
+    if(!options_.stressReport.empty()){
+        char extra[256];
+        SDL_snprintf(extra, sizeof(extra), "\"fps\": %.2f, \"lod\": %d, \"compositor\": \"%s\", \"geometry\": \"%s\", \"window\": [%d, %d]",
+            pacer_.getTargetFps(), options_.lodInterval, Compositor::getInstance().isEnabled() ? "cpu" : "sdl",
+            getSpriteGeometryName(Animation::getGeometry()), window_size_.x, window_size_.y);
+        if(stress_.dumpJson(options_.stressReport, extra)){
+            SDL_Log("Stress report written to %s", options_.stressReport.c_str());
+        }
+    }
+    is_running_ = false;
+}
+
+void Game::addPet(DesktopPet* pet)
+{
+    tools::MemoryScope petScope(tools::MemTag::Pets); // 资源加载内部会切到 Assets/Parser
+    pet->setRenderer(renderer_);
+    pet->setScreenSize(window_size_.x, window_size_.y); // 无头时是固定的默认大小
+    pet->setSpriteOptions(spriteOptions_, prescaleSprites_);
+    pet->init(); // CatPet::init 内部已负责加载动画与设置初始状态
+    pet->attachMotion(&motion_);
+    pets_.push_back(pet);
+}
+
+void Game::rebuildPetGrid()
+{
+    petGrid_.clear();
+    for(size_t i = 0; i < pets_.size(); i++){
+        petGrid_.insert(static_cast<int>(i), getPetRect(pets_[i]), static_cast<int>(i));
+    }
+    petVisible_.clear(); // 下一份快照重新判断
+}
+
+void Game::removeAllPets()
+{
+    for(DesktopPet* pet : pets_){
+        pet->clean();
+        delete pet;
+    }
+    pets_.clear();
+    petGrid_.clear();
+    petVisible_.clear();
+    motion_.clear();
+}
 
+void Game::runSingleThread()
+{
+    pacer_.start();
+    while(is_running_){
         // 获取每帧开始时间
-        auto start_time = SDL_GetTicksNS();
+        const Uint64 start_time = SDL_GetTicksNS();
 
-        handleEvent();
-        update(1 / 60.0f);
-        render();
+        step();
+        if(!is_running_){
+            break;
+        }
+        if((!options_.headless || options_.latencyProbe > 0) && snapshots_.consume()){
+            render(snapshots_.read());
+            runLatencyProbe(snapshots_.read());
+        }
 
-        // 获取每帧结束时间
-        auto end_time = SDL_GetTicksNS();
-        auto frame_time = end_time - start_time;    // 计算每帧耗时
+        // 等到本帧的绝对目标时刻（快进时不等）
+        if(!options_.fastForward){
+            pacer_.waitForNextFrame();
+        }
+        endFrame(start_time);
+    }
+}
+
+void Game::runThreaded()
+{
+    simThread_ = std::thread(&Game::simulationMain, this);
 
-        // 正确的帧率限制：如果本帧耗时小于目标间隔，则延迟剩余时间
-        if(frame_time < frame_delay_){
-            SDL_DelayNS(frame_delay_ - frame_time);  // ns
-            dt = static_cast<float>(frame_delay_) / 1.0e9f; // 秒（对齐到目标帧间隔）
-        }else{
-            dt = static_cast<float>(frame_time) / 1.0e9f; // 秒（真实帧间隔）
+    // 主线程：SDL 事件与绘制都在这里（拥有窗口与渲染器的线程）
+    SDL_Event e;
+    while(is_running_){
+        // 等到有输入或新快照（模拟线程发布后会投递 wakeEvent_）
+        if(SDL_WaitEventTimeout(&e, 100)){
+            forwardEvent(e);
+            while(SDL_PollEvent(&e)){
+                forwardEvent(e);
+            }
         }
+        if(snapshots_.consume()){
+            render(snapshots_.read());
+            runLatencyProbe(snapshots_.read());
+        }
+    }
+
+    simThread_.join();
+    if(droppedInput_.load() > 0){
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Input queue overflowed, %llu events dropped",
+            static_cast<unsigned long long>(droppedInput_.load()));
+    }
+}
 
-        // 累计用于FPS统计
-        fps_frame_count_++;
-        Uint64 now_ns = end_time;
-        Uint64 elapsed_ns = now_ns - fps_last_report_ns_;
-        if(elapsed_ns >= 3'000'000'000ULL){ // 每约1秒输出一次
-            fps_last_value_ = static_cast<float>(fps_frame_count_) * (1.0e9f / static_cast<float>(elapsed_ns));
-            float avg_frame_ms = 1000.0f / (fps_last_value_ > 0.0f ? fps_last_value_ : 1.0f);
-            SDL_Log("FPS: %.2f | avg frame: %.3f ms", fps_last_value_, avg_frame_ms);
-            fps_last_report_ns_ = now_ns;
-            fps_frame_count_ = 0;
+void Game::simulationMain()
+{
+    pacer_.start();
+    SDL_Event wake{};
+    wake.type = wakeEvent_;
+    while(is_running_){
+        const Uint64 start_time = SDL_GetTicksNS();
+        step();
+        // 通知主线程有新快照；上一个唤醒还没被取走就不再投递
+        if(!wakePending_.exchange(true, std::memory_order_acq_rel)){
+            SDL_PushEvent(&wake);
         }
+        if(!is_running_){
+            break;
+        }
+        pacer_.waitForNextFrame();
+        endFrame(start_time);
+    }
+    SDL_PushEvent(&wake); // 主线程可能正在等待事件
+}
+
+void Game::registerMetrics()
+{
+    tools::Metrics& m = tools::Metrics::getInstance();
+    framesMetric_ = &m.counter("patpat_frames_total", "Simulation frames completed.");
+    eventsMetric_ = &m.counter("patpat_events_total", "SDL events published to the event bus.");
+    wakeupsMetric_ = &m.counter("patpat_wakeups_total", "Timer firings plus behavior coroutine resumes.");
+    stateChangesMetric_ = &m.counter("patpat_state_changes_total", "Pet state transitions delivered through the event bus.");
+    fpsMetric_ = &m.gauge("patpat_fps", "Simulation frames per second over the last report interval (about 3 s).");
+    wakeRateMetric_ = &m.gauge("patpat_wakeups_per_second", "Wakeups per second over the last report interval.");
+    petsMetric_ = &m.gauge("patpat_pets", "Pets alive.");
+    visibleMetric_ = &m.gauge("patpat_pets_visible", "Pets drawn in the latest snapshot.");
+    deferredMetric_ = &m.gauge("patpat_pets_deferred", "Invisible idle pets whose update was deferred this frame.");
+    frameMetric_ = &m.histogram("patpat_frame_time_seconds", "Wall time between frame starts, including pacing waits.");
+    phaseMetrics_[0] = &m.histogram("patpat_phase_events_seconds", "Per-frame event handling time.");
+    phaseMetrics_[1] = &m.histogram("patpat_phase_update_seconds", "Per-frame simulation update time.");
+    phaseMetrics_[2] = &m.histogram("patpat_phase_snapshot_seconds", "Per-frame render snapshot build time.");
+    renderMetric_ = &m.histogram("patpat_render_seconds", "Main thread draw and present time per presented frame.");
+
+    // 以下在抓取时由服务线程读取，帧线程不做任何事
+    m.sampled("patpat_presented_frames", "Frames presented by the render thread.", [this]{
+        return static_cast<double>(presented_.load(std::memory_order_relaxed));
+    });
+    m.sampled("patpat_texture_bytes", "Estimated resident texture bytes.", []{
+        return static_cast<double>(tools::MemoryStats::getInstance().getLive(tools::MemTag::Textures));
+    });
+    m.sampled("patpat_heap_bytes", "Tracked heap bytes (0 unless built with PATPAT_MEMORY_TRACKING).", []{
+        return static_cast<double>(tools::MemoryStats::getInstance().getTotalLive());
+    });
+    m.sampled("patpat_input_dropped", "Input events dropped because the simulation inbox was full.", [this]{
+        return static_cast<double>(droppedInput_.load(std::memory_order_relaxed));
+    });
+}
+
+void Game::endFrame(Uint64 start_ns)
+{
+    const Uint64 end_time = SDL_GetTicksNS();
+
+    framesMetric_->add();
+    frameMetric_->record(end_time - start_ns);
+
+    // 累计用于FPS统计
+    fps_frame_count_++;
+    Uint64 now_ns = end_time;
+    Uint64 elapsed_ns = now_ns - fps_last_report_ns_;
+    if(elapsed_ns >= 3'000'000'000ULL){ // 每约3秒输出一次
+        fps_last_value_ = static_cast<float>(fps_frame_count_) * (1.0e9f / static_cast<float>(elapsed_ns));
+        float avg_frame_ms = 1000.0f / (fps_last_value_ > 0.0f ? fps_last_value_ : 1.0f);
+        const uint64_t presented = presented_.load(std::memory_order_relaxed);
+        const double presents_per_s = static_cast<double>(presented - fps_last_presented_) * 1.0e9 / static_cast<double>(elapsed_ns);
+        fps_last_presented_ = presented;
+        const uint64_t wakeups = wakeupsMetric_->get();
+        fpsMetric_->set(fps_last_value_);
+        wakeRateMetric_->set(static_cast<double>(wakeups - wakeupsLastReport_) * 1.0e9 / static_cast<double>(elapsed_ns));
+        wakeupsLastReport_ = wakeups;
+        if(options_.fastForward){
+            SDL_Log("FPS: %.2f | avg frame: %.3f ms | pets visible %d/%zu, deferred %d", fps_last_value_, avg_frame_ms,
+                visibleCount_, pets_.size(), deferredCount_);
+        } else{
+            SDL_Log("FPS: %.2f | avg frame: %.3f ms | presents %.2f/s | pets visible %d/%zu, deferred %d | jitter: mean %.3f ms, sd %.3f ms, max %.3f ms | missed %llu",
+                fps_last_value_, avg_frame_ms, presents_per_s, visibleCount_, pets_.size(), deferredCount_,
+                pacer_.getJitterMeanNs() / 1.0e6, pacer_.getJitterStdDevNs() / 1.0e6,
+                static_cast<double>(pacer_.getJitterMaxNs()) / 1.0e6,
+                static_cast<unsigned long long>(pacer_.getMissedCount()));
+            pacer_.resetStats();
+        }
+        fps_last_report_ns_ = now_ns;
+        fps_frame_count_ = 0;
     }
 }
 
 void Game::clean()
 {
-    if(pet_){
-        pet_->clean();
-        delete pet_;
-        pet_ = nullptr;
+    tools::Metrics::getInstance().stopServer();
+
+    // 在释放资源之前统计，报告里是运行中的占用
+    tools::MemoryStats& memory = tools::MemoryStats::getInstance();
+    if(!options_.memoryReport.empty() && memory.dumpJson(options_.memoryReport)){
+        SDL_Log("Memory report written to %s", options_.memoryReport.c_str());
+    }
+    SDL_Log("Memory: textures %.1f KB (peak %.1f KB), audio %.1f KB%s",
+        memory.getLive(tools::MemTag::Textures) / 1024.0, memory.getPeak(tools::MemTag::Textures) / 1024.0,
+        memory.getLive(tools::MemTag::Audio) / 1024.0,
+        tools::MemoryStats::isAllocationTrackingEnabled() ? "" : " (build with PATPAT_MEMORY_TRACKING for heap tags)");
+
+    // 填充率：整帧四边形 -> 实际绘制 -> 不透明，裁剪省下的就是透明像素的混合
+    const OverdrawStats& fill = Animation::getOverdrawStats();
+    if(fill.draws > 0){
+        const double draws = static_cast<double>(fill.draws);
+        SDL_Log("Sprite fill (%s): %llu draws, per draw %.0f px drawn of %.0f px quad (%.1f%% saved), %.0f px opaque, overdraw x%.2f",
+            getSpriteGeometryName(Animation::getGeometry()), static_cast<unsigned long long>(fill.draws),
+            fill.drawnPixels / draws, fill.quadPixels / draws,
+            fill.quadPixels > 0.0 ? 100.0 * (1.0 - fill.drawnPixels / fill.quadPixels) : 0.0,
+            fill.opaquePixels / draws, fill.opaquePixels > 0.0 ? fill.drawnPixels / fill.opaquePixels : 0.0);
+    }
+
+    tools::LatencyStats& latency = tools::LatencyStats::getInstance();
+    latency.logReport();
+    if(options_.latencyProbe > 0){
+        SDL_Log("Latency probe: %d clicks sent, %llu measured, %d lost (%s)", probeSent_,
+            static_cast<unsigned long long>(latency.getCount()), probeLost_, threaded_ ? "threaded" : "single thread");
+    }
+    if(!options_.latencyReport.empty() && latency.dumpJson(options_.latencyReport)){
+        SDL_Log("Latency report written to %s", options_.latencyReport.c_str());
+    }
+
+    if(inputShape_){
+        SDL_Log("Input shape: %llu updates%s", static_cast<unsigned long long>(shapeUpdates_),
+            options_.checkInputShape ? (shapeMismatches_ ? ", MISMATCHES found" : ", all verified") : "");
+        if(shapeMismatches_){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Input shape: %llu mismatches", static_cast<unsigned long long>(shapeMismatches_));
+        }
+    }
+    // --check-input-shape 是一次检查（ctest 的 input_shape_xvfb）：一次都没核对到也算失败
+    if(options_.checkInputShape && (!inputShape_ || shapeUpdates_ == 0 || shapeMismatches_ > 0)){
+        if(!inputShape_ || shapeUpdates_ == 0){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Input shape: nothing verified (X11 input shape unavailable or never set)");
+        }
+        exitCode_ = 1;
     }
 
+    removeAllPets();
+
+    recorder_.close();
+    player_.close();
+
+    EventBus::getInstance().removeFilter();
+    EventBus::getInstance().clear();
+    tools::InputStats::getInstance().stop(); // 总线不再引用 SDL 来源后再停，写入最后不满一分钟的记录
+
+    TextSystem::getInstance().shutdown(); // 图集纹理属于渲染器
+    Compositor::getInstance().shutdown();
+    SpriteLibrary::getInstance().clear();   // 纹理已随宠物释放，这里只剩索引数据
+
     if(renderer_){
         SDL_DestroyRenderer(renderer_);
         renderer_ = nullptr;
@@ -199,6 +1026,7 @@ void Game::clean()
     }
 
     TTF_Quit();
+    AudioSystem::getInstance().shutdown(); // 释放音效缓存
     Mix_CloseAudio();
     Mix_Quit();
     SDL_Quit();
@@ -208,4 +1036,19 @@ void Game::clean()
 
 std::string Game::getTitle(){
     return title_;
+}
+
+SDL_Rect Game::getPetRect(const DesktopPet* pet) const
+{
+    SDL_Rect rect = pet->getRect();
+    int scale = pet->getViewScale();
+    rect.w *= scale;
+    rect.h *= scale;
+    return rect;
+}
+
+DesktopPet* Game::getPetAt(SDL_Point point) const
+{
+    int id = petGrid_.queryPoint(point);
+    return id >= 0 ? pets_[id] : nullptr;
 }
\ No newline at end of file
@@ -13,7 +13,24 @@
 #include <Windows.h>
 #endif
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
+#include "../tools/spatial_grid.h"
+#include "../tools/replay.h"
+#include "../tools/input_stats.h"
+#include "../tools/frame_pacer.h"
+#include "../tools/triple_buffer.h"
+#include "../tools/spsc_queue.h"
+#include "../tools/latency_stats.h"
+#include "../tools/metrics.h"
+#include "../tools/kinematics.h"
+#include "../tools/random.h"
+#include "eventbus.h"
+#include "render_snapshot.h"
+#include "spritecache.h"
+#include "stress.h"
 
 
 // 定义HitTest穿透
@@ -24,6 +41,41 @@
 class DesktopPet; // 前向声明
 class CatPet; // 前向声明
 
+// 启动参数（见 main.cpp）
+struct GameOptions{
+    std::string recordPath;         // --record <file>：录制事件、dt 与随机数种子
+    std::string replayPath;         // --replay <file>：回放录制的日志，结束后退出
+    bool headless = false;          // --headless：dummy 视频/音频驱动，不渲染
+    bool fastForward = false;       // --fast：不做帧率限制，尽快跑完
+    bool hasSeed = false;           // --seed <n>：固定随机数种子
+    uint64_t seed = 0;
+    Uint64 fps = 0;                 // --fps <n>：目标帧率，0 为默认 60
+    bool vsync = false;             // --vsync：由垂直同步控制帧率（失败时退回睡眠 + 忙等）
+    std::string palette;            // --palette <name>：桌宠颜色变体（见 manifest.json 的 "palettes"）
+    int pets = 1;                   // --pets <n>：启动时的桌宠数量
+    std::string memoryReport;       // --memory-report <file>：退出时把内存统计写成 JSON
+    Uint64 textureBudgetMB = 0;     // --texture-budget <MB>：纹理显存预算，超出后新的颜色变体退回原色
+    bool inputStats = false;        // --input-stats [file]：统计键鼠输入（Windows 上安装全局钩子），给出 file 时累计写入该文件
+    std::string inputStatsPath;
+    float syntheticKeysPerMinute = 0.0f; // --synthetic-input <kpm>：用合成输入代替真实键鼠统计（测试用）
+    double timeScale = 1.0;         // --time-scale <x>：虚拟时间倍率（0 为暂停），配合 --fast 可以几秒跑完一天
+    double runFor = 0.0;            // --run-for <s>：虚拟时间到达 s 秒后退出，0 不限
+    bool paused = false;            // --paused：虚拟时钟从暂停开始（F9 暂停/继续，F10 单步一帧）
+    int lodInterval = 8;            // --lod <n>：看不见的待机宠物每 n 帧更新一次（<= 1 关闭）
+    std::string stressPets;         // --stress 1,10,100,1000：依次用这些数量的宠物无头跑压力场景（隐含 --headless）
+    float stressSeconds = 10.0f;    // --stress-seconds <s>：每个数量模拟的秒数
+    std::string stressManifests;    // --stress-manifest a.json,b.json：宠物轮流使用的清单，默认是猫
+    std::string stressReport;       // --stress-report <file>：扩展曲线写成 JSON
+    bool singleThread = false;      // --single-thread：事件、模拟、绘制在一个线程里串行（回放/无头/快进时总是如此）
+    int latencyProbe = 0;           // --latency-probe <n>：自动点击桌宠 n 次，测量输入到画面的延迟后退出（可配合 --headless）
+    std::string latencyReport;      // --latency-report <file>：退出时把延迟直方图写成 JSON
+    std::string compositor = "auto"; // --compositor auto|cpu|sdl：桌宠由 CPU 合成还是交给 SDL 逐个绘制，auto 只在软件渲染时用 CPU
+    std::string spriteGeometry = "trim"; // --sprite-geometry quad|trim|hull：整帧、不透明包围盒、凸多边形网格
+    bool pixelArtUpscale = false;   // --pixel-art-upscale：精灵用 Scale2x/Scale3x 预先放大到视图缩放（否则 GPU 最近邻放大）
+    bool checkInputShape = false;   // --check-input-shape：每次设置输入区域后从 X 服务器读回核对（Linux/X11）
+    std::string metricsSocket;      // --metrics-socket <path>：在本地 Unix 域套接字上提供实时指标（文本或 JSON）
+};
+
 // 单例模式
 class Game
 {
@@ -33,15 +85,18 @@ public:
         return instance;
     }
 
-    void init();
-    void update(float deltaTime);
+    void init(const GameOptions& options = GameOptions());
+    void update(Uint64 deltaNs); // 虚拟时间前进 deltaNs（GameClock 本帧的帧长）
     void handleEvent();
-    void render();
+    void render(const RenderSnapshot& snapshot); // 只在拥有渲染器的主线程调用
     void run();
     void clean();
+    int getExitCode() const {return exitCode_;} // clean() 之后：命令行要求的检查（--check-input-shape）失败时为 1
 
     // getters 
     SDL_Renderer* getRenderer() const {return renderer_;}
+    const tools::SpatialGrid& getPetGrid() const {return petGrid_;}
+    DesktopPet* getPetAt(SDL_Point point) const; // 鼠标下最上层的宠物
 
     // Getters
     std::string getTitle();
@@ -51,9 +106,54 @@ private:
     Game(const Game&) = delete; // 禁止拷贝构造
     Game& operator=(const Game&) = delete;  // 禁止赋值操作
 
+    // 事件总线回调
+    static void onQuitEvent(void* userdata, SDL_Event& event);
+    static void onPointerEvent(void* userdata, SDL_Event& event); // 鼠标按键只交给鼠标下的桌宠
+    static void onClockKeyEvent(void* userdata, SDL_Event& event); // F9 暂停/继续虚拟时钟，F10 单步一帧
+    static void onPetEvent(void* userdata, const GameEvent& event); // 动画结束交回宠物，状态切换计数
+
+    void startInputStats();
+    void startCompositor();
+
+    // 主循环
+    // 单线程：事件 -> 模拟 -> 快照 -> 绘制 -> 等待，串行执行
+    // 多线程：模拟线程按固定节拍 step()，经三缓冲发布快照；主线程收 SDL 事件、绘制最新快照、present
+    //        present/垂直同步卡住时模拟照常推进，事件在 SDL 队列里保留原始时间戳
+    void runSingleThread();
+    void runThreaded();
+    void simulationMain();               // 模拟线程
+    void step();                         // 一个模拟帧：处理事件、更新、发布快照
+    void buildSnapshot(RenderSnapshot& out);
+    void forwardEvent(const SDL_Event& event); // 主线程：交给模拟线程
+    void endFrame(Uint64 start_ns);      // 帧间隔与 FPS 统计
+    void runStress();                    // 压力场景：每个人口生成宠物、跑固定帧数、记录、清除
+
+    // 桌宠的创建与释放
+    void addPet(DesktopPet* pet);        // 设置渲染器并初始化，加入列表（空间索引由调用者重建）
+    void rebuildPetGrid();
+    void removeAllPets();
+
+    // 输入到画面的延迟（主线程）
+    void collectLatency(uint64_t tick, Uint64 submitNs, Uint64 presentNs); // present 之后，记录已送达的交互
+    void runLatencyProbe(const RenderSnapshot& snapshot); // 按间隔向 SDL 队列投递合成点击
+
+    // 实时指标：init 开头注册，之后各线程只做原子写，服务线程（--metrics-socket）随时读取
+    void registerMetrics();
+
+#ifdef _WIN32
     // Windows窗口相关
     HWND hwnd_ = nullptr;    // 保存Windows窗口句柄
     bool is_transparent_ = false;    // 是否透明
+#endif
+
+    // 其他平台（X11）的点击穿透：窗口输入区域只包含宠物，区域外的点击交给下面的窗口（主线程）
+    void updateInputShape(const RenderSnapshot& snapshot);
+    bool inputShape_ = false;               // 窗口支持输入区域
+    std::vector<SDL_Rect> shapeRects_;      // 本帧的宠物区域（窗口坐标）
+    std::vector<SDL_Rect> appliedShape_;    // 已设置的区域，没变化时不再请求 X 服务器
+    uint64_t shapeUpdates_ = 0;             // 设置次数
+    uint64_t shapeMismatches_ = 0;          // --check-input-shape 核对失败的次数
+    int exitCode_ = 0;
 
     // SDL相关
     SDL_Window* window_ = nullptr;
@@ -64,17 +164,70 @@ private:
 
     // 游戏相关
     std::string title_ = "PatPat";   // 游戏标题
-    bool is_running_ = false;
+    std::atomic<bool> is_running_{false};
     Uint64 FPS_ = 60;  // 帧率
-    Uint64 frame_delay_ = 0; // 帧延时（间隔），即每帧耗时，单位ns
-    float dt = 0.0f; // 每帧时间差，单位秒，测试用
+    tools::FramePacer pacer_; // 帧率控制（绝对排期，睡眠 + 忙等）
     // FPS统计
     Uint64 fps_last_report_ns_ = 0; // 上次FPS上报的时间戳（ns）
     int fps_frame_count_ = 0;       // 统计周期内的帧计数
     float fps_last_value_ = 0.0f;   // 最近一次计算得到的FPS
+    uint64_t fps_last_presented_ = 0; // 上次上报时的 present 次数
+    double simulated_s_ = 0.0;      // 累计模拟时间（秒，GameClock）
+
+    // 模拟/渲染线程
+    bool threaded_ = false;
+    std::thread simThread_;
+    uint64_t simTick_ = 0;                        // 模拟帧序号
+    tools::TripleBuffer<RenderSnapshot> snapshots_; // 模拟线程写，主线程读
+    tools::SpscQueue<SDL_Event, 1024> inbox_;     // 主线程 -> 模拟线程的 SDL 事件
+    Uint32 wakeEvent_ = 0;                        // 发布快照后投递，唤醒等待事件的主线程
+    std::atomic<bool> wakePending_{false};        // 已有唤醒事件在队列里，不重复投递
+    std::atomic<uint64_t> presented_{0};
+    std::atomic<uint64_t> droppedInput_{0};
+    Uint64 phaseNs_[3] = {};                      // 最近一次 step() 的事件/更新/快照耗时
+
+    StressScenario stress_;
+
+    // 延迟统计
+    std::vector<tools::InputStamp> tickStamps_;     // 模拟线程：本帧产生的交互
+    tools::SpscQueue<tools::InputStamp, 256> stamps_; // 模拟线程 -> 主线程，先于快照发布
+    std::vector<tools::InputStamp> waitingStamps_;  // 主线程：快照还没画到的交互
+    int probeSent_ = 0;             // 已投递的合成点击
+    int probeLost_ = 0;             // 超时没有送达的合成点击
+    Uint64 probeNextNs_ = 0;        // 下一次点击的时刻
+    tools::RandomStream probeRng_{0x1A7E1C7};       // 点击间隔，独立于宠物的随机数流
+
+    // 录制/回放
+    GameOptions options_;
+    tools::ReplayRecorder recorder_;
+    tools::ReplayPlayer player_;
 
     // 桌宠相关
-    CatPet* pet_ = nullptr; // 桌宠指针
+    std::vector<DesktopPet*> pets_; // 桌宠列表，下标即 id，越靠后绘制越靠上
+    tools::SpatialGrid petGrid_;    // 桌宠空间索引，用于命中测试与邻近查询
+    tools::math::KinematicsBatch motion_; // 所有桌宠的移动，每帧在更新宠物之前批量积分（SIMD）
+    SpriteCacheOptions spriteOptions_; // 桌宠加载精灵时生成哪些变体（init 里按渲染器决定）
+    bool prescaleSprites_ = false;     // 预先放大到视图缩放：软件渲染或 --pixel-art-upscale
+    SDL_Rect getPetRect(const DesktopPet* pet) const; // 屏幕上的命中矩形
+    std::vector<uint8_t> petVisible_; // 上一份快照里是否可见（模拟线程），决定本帧能否降频更新
+    int visibleCount_ = 0;          // 本帧绘制的宠物数
+    int deferredCount_ = 0;         // 本帧降频（攒下 update）的宠物数
+
+    // 实时指标（指针指向 tools::Metrics 里的对象，程序结束前一直有效）
+    tools::MetricCounter* framesMetric_ = nullptr;   // endFrame
+    tools::MetricCounter* eventsMetric_ = nullptr;   // 模拟线程发布到总线的事件
+    tools::MetricCounter* wakeupsMetric_ = nullptr;  // 定时器触发 + 行为协程恢复
+    tools::MetricCounter* stateChangesMetric_ = nullptr; // 宠物状态切换（onPetEvent）
+    tools::MetricGauge* fpsMetric_ = nullptr;
+    tools::MetricGauge* wakeRateMetric_ = nullptr;
+    tools::MetricGauge* petsMetric_ = nullptr;
+    tools::MetricGauge* visibleMetric_ = nullptr;
+    tools::MetricGauge* deferredMetric_ = nullptr;
+    tools::MetricHistogram* frameMetric_ = nullptr;  // 真实帧间隔
+    tools::MetricHistogram* phaseMetrics_[3] = {};   // step() 的事件/更新/快照耗时
+    tools::MetricHistogram* renderMetric_ = nullptr; // 主线程绘制到 present 返回
+    uint64_t wakeupsSeen_ = 0;      // 上一帧时的唤醒总数（模拟线程）
+    uint64_t wakeupsLastReport_ = 0; // 上次 FPS 上报时的唤醒计数
 
 };
 
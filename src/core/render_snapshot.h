@@ -0,0 +1,47 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Animation;
+
+// 一只宠物的一次绘制：哪个片段的第几帧、画在哪里、是否翻转
+// 片段（Animation）在加载后只读，渲染线程按帧号绘制，不读模拟线程正在改的播放状态
+struct SpriteDraw{
+    const Animation* clip = nullptr;
+    int frame = 0;
+    SDL_Rect dst{0, 0, 0, 0};
+    bool flip = false;
+};
+
+// 对话气泡
+struct BubbleDraw{
+    std::string text;
+    float x = 0.0f; // 宠物头顶中心
+    float y = 0.0f;
+};
+
+// 模拟线程每帧生成一份，经三缓冲交给渲染线程
+// 三份快照轮流复用，vector/string 的容量保留下来，稳定后不再分配
+struct RenderSnapshot{
+    uint64_t tick = 0;            // 模拟帧序号
+    std::vector<SpriteDraw> sprites; // 按绘制顺序（越靠后越靠上）
+    std::vector<BubbleDraw> bubbles;
+    bool mouseOverPet = false;    // 鼠标是否在某只宠物上（决定窗口是否点击穿透）
+    size_t bubbleCount = 0;       // bubbles 前 bubbleCount 个有效（其余保留容量）
+
+    void clear(){
+        sprites.clear();
+        bubbleCount = 0;
+        mouseOverPet = false;
+    }
+    BubbleDraw& addBubble(){
+        if(bubbleCount == bubbles.size()) bubbles.emplace_back();
+        return bubbles[bubbleCount++];
+    }
+};
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,148 @@
+#include "spritecache.h"
+#include "../tools/memory_stats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+inline Uint32* row(SDL_Surface* s, int y){
+    return reinterpret_cast<Uint32*>(static_cast<Uint8*>(s->pixels) + y * s->pitch);
+}
+
+// 2x2 盒式滤波缩小一半，按 alpha 加权平均颜色，避免透明像素把边缘染黑
+SDL_Surface* downsampleHalf(SDL_Surface* src){
+    const int w = std::max(1, src->w / 2), h = std::max(1, src->h / 2);
+    SDL_Surface* dst = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_ARGB8888);
+    if(!dst) return nullptr;
+    for(int y = 0; y < h; y++){
+        const Uint32* s0 = row(src, std::min(y * 2, src->h - 1));
+        const Uint32* s1 = row(src, std::min(y * 2 + 1, src->h - 1));
+        Uint32* d = row(dst, y);
+        for(int x = 0; x < w; x++){
+            const int xa = std::min(x * 2, src->w - 1), xb = std::min(x * 2 + 1, src->w - 1);
+            const Uint32 px[4] = {s0[xa], s0[xb], s1[xa], s1[xb]};
+            Uint32 a = 0, r = 0, g = 0, b = 0;
+            for(Uint32 p : px){
+                const Uint32 pa = p >> 24;
+                a += pa;
+                r += ((p >> 16) & 0xFF) * pa;
+                g += ((p >> 8) & 0xFF) * pa;
+                b += (p & 0xFF) * pa;
+            }
+            if(a == 0){
+                d[x] = 0;
+            } else{
+                d[x] = ((a / 4) << 24) | ((r / a) << 16) | ((g / a) << 8) | (b / a);
+            }
+        }
+    }
+    return dst;
+}
+
+} // namespace
+
+SpriteCache::~SpriteCache()
+{
+    clean();
+}
+
+bool SpriteCache::build(SDL_Renderer* renderer, SDL_Surface* sheet, SDL_Surface* base,
+                        bool upscaled, const SpriteCacheOptions& options)
+{
+    clean();
+    if(renderer == nullptr || sheet == nullptr){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SpriteCache::build: renderer or sheet is null");
+        return false;
+    }
+    if(base == nullptr && (options.cpuPixels || options.mipLevels > 0)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SpriteCache::build: cpuPixels/mipLevels need the x1 sheet");
+        return false;
+    }
+
+    if(options.cpuPixels){
+        cpu_ = CpuSprite::premultiply(base);
+    }
+
+    // mip 层级，从最小的开始，保证 variants_ 按缩放升序
+    std::vector<SDL_Surface*> mips;
+    SDL_Surface* prev = base;
+    for(int level = 1; level <= options.mipLevels && prev && prev->w > 1 && prev->h > 1; level++){
+        SDL_Surface* m = downsampleHalf(prev);
+        if(!m) break;
+        mips.push_back(m);
+        prev = m;
+    }
+    for(int i = static_cast<int>(mips.size()) - 1; i >= 0; i--){
+        addVariant(renderer, mips[i], 1, 1 << (i + 1), false, SDL_SCALEMODE_LINEAR);
+        SDL_DestroySurface(mips[i]);
+    }
+
+    // 绘制用的一份（已经放大到 options.scale）
+    return addVariant(renderer, sheet, std::max(options.scale, 1), 1, upscaled, SDL_SCALEMODE_NEAREST);
+}
+
+bool SpriteCache::addVariant(SDL_Renderer* renderer, SDL_Surface* surface,
+                             int scaleNum, int scaleDen, bool upscaled, SDL_ScaleMode mode)
+{
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surface);
+    if(!tex){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SpriteCache: failed to create texture: %s", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(tex, mode);
+    tools::MemoryStats::getInstance().trackTexture(tex, label_);
+
+    SpriteVariant v;
+    v.texture = tex;
+    v.scaleNum = scaleNum;
+    v.scaleDen = scaleDen;
+    v.upscaled = upscaled;
+    variants_.push_back(v);
+    return true;
+}
+
+const SpriteVariant* SpriteCache::pick(float scale) const
+{
+    if(variants_.empty()) return nullptr;
+    scale = std::fabs(scale);
+
+    // 精确匹配：绘制时不需要重采样
+    for(const SpriteVariant& v : variants_){
+        if(std::fabs(v.scale() - scale) < 1e-3f) return &v;
+    }
+    // 否则取不小于目标的最小变体（只做小于 2 倍的缩小），都不够大就用最大的
+    for(const SpriteVariant& v : variants_){
+        if(v.scale() >= scale) return &v;
+    }
+    return &variants_.back();
+}
+
+SDL_FRect SpriteCache::mapRect(const SpriteVariant& v, const SDL_Rect& src)
+{
+    const float s = v.scale();
+    return SDL_FRect{
+        std::floor(src.x * s),
+        std::floor(src.y * s),
+        std::floor(src.w * s),
+        std::floor(src.h * s)
+    };
+}
+
+SDL_Texture* SpriteCache::getTexture() const
+{
+    return variants_.empty() ? nullptr : variants_.back().texture;
+}
+
+void SpriteCache::clean()
+{
+    for(SpriteVariant& v : variants_){
+        if(v.texture){
+            tools::MemoryStats::getInstance().untrackTexture(v.texture);
+            SDL_DestroyTexture(v.texture);
+            v.texture = nullptr;
+        }
+    }
+    variants_.clear();
+    cpu_ = CpuSprite();
+}
@@ -0,0 +1,64 @@
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+#include "compositor.h"
+
+// 精灵表的一个缓存变体（预缩放 / 像素画放大 / mip）
+struct SpriteVariant {
+    SDL_Texture* texture = nullptr;
+    int scaleNum = 1;       // 变体缩放 = scaleNum / scaleDen
+    int scaleDen = 1;
+    bool upscaled = false;  // 是否由像素画放大算法（Scale2x/Scale3x）生成
+
+    float scale() const {return static_cast<float>(scaleNum) / static_cast<float>(scaleDen);}
+};
+
+// 加载时生成哪些变体：只生成会被画到的缩放
+struct SpriteCacheOptions {
+    int scale = 1;                  // 绘制用纹理的整数放大倍数（软件渲染时等于视图缩放，绘制是 1:1 拷贝；GPU 渲染时为 1，由 GPU 最近邻放大）
+    bool pixelArtUpscale = false;   // scale 为 2/3 时用 Scale2x/Scale3x 代替最近邻（--pixel-art-upscale）
+    int mipLevels = 0;              // 1/2, 1/4 ... 的缩小层级，只在会缩小显示时需要
+    bool cpuPixels = false;         // 同时保留预乘 alpha 的 x1 像素，供 CPU 合成器使用
+};
+
+// 每个动画片段（一张精灵表）在加载时生成的缓存
+// 渲染时按目标缩放选择变体：预先放大到绘制缩放时，SDL_RenderTexture 做 1:1 拷贝而不是逐像素缩放
+class SpriteCache {
+public:
+    SpriteCache() = default;
+    ~SpriteCache();
+    SpriteCache(const SpriteCache&) = delete;
+    SpriteCache& operator=(const SpriteCache&) = delete;
+
+    // sheet：已经放大到 options.scale 的 ARGB8888 精灵表（upscaled 表示由 Scale2x/Scale3x 生成）
+    // base：原尺寸的同一张表，只在 cpuPixels 或 mipLevels 时需要（scale 为 1 时可以就是 sheet），其余情况可以为空
+    bool build(SDL_Renderer* renderer, SDL_Surface* sheet, SDL_Surface* base, bool upscaled,
+               const SpriteCacheOptions& options = SpriteCacheOptions{});
+
+    // 选择最适合目标缩放的变体：优先精确匹配，否则取略大于目标的变体
+    const SpriteVariant* pick(float scale) const;
+
+    // 把原始精灵表中的矩形映射到变体纹理坐标
+    static SDL_FRect mapRect(const SpriteVariant& v, const SDL_Rect& src);
+
+    SDL_Texture* getTexture() const; // options.scale 那一份（最大的变体）
+    const CpuSprite* getCpuSprite() const {return cpu_.empty() ? nullptr : &cpu_;}
+    // 内存统计里纹理记在这个名字下（一般是 "路径|变体"），build() 之前设置
+    void setLabel(const std::string& label) {label_ = label;}
+    const std::vector<SpriteVariant>& getVariants() const {return variants_;}
+
+    void clean();
+
+private:
+    bool addVariant(SDL_Renderer* renderer, SDL_Surface* surface,
+                    int scaleNum, int scaleDen, bool upscaled, SDL_ScaleMode mode);
+
+    std::vector<SpriteVariant> variants_; // 按缩放从小到大排列
+    CpuSprite cpu_; // 预乘 alpha 像素（只在 options.cpuPixels 时生成）
+    std::string label_ = "sprite";
+};
+
+#endif // SPRITECACHE_H
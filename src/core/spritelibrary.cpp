@@ -0,0 +1,350 @@
+#include "spritelibrary.h"
+#include "../tools/manifest_loader.h"
+#include "../tools/memory_stats.h"
+#include <algorithm>
+
+namespace {
+
+inline const Uint32* row(const SDL_Surface* s, int y){
+    return reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(s->pixels) + y * s->pitch);
+}
+
+inline Uint32 colorDistance(Uint32 a, Uint32 b){
+    Uint32 d = 0;
+    for(int shift = 0; shift < 32; shift += 8){
+        const int c = static_cast<int>((a >> shift) & 0xFF) - static_cast<int>((b >> shift) & 0xFF);
+        d += static_cast<Uint32>(c * c);
+    }
+    return d;
+}
+
+} // namespace
+
+Palette PaletteSwap::apply(const Palette& base) const
+{
+    Palette out = base;
+    for(int i = 1; i < out.count; i++){
+        for(const auto& r : remap){
+            if(base.colors[i] == r.first){
+                out.colors[i] = r.second;
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+// -------------------------------------------------------
+// IndexedSheet
+
+std::shared_ptr<IndexedSheet> IndexedSheet::quantize(SDL_Surface* sheet)
+{
+    if(!sheet || sheet->format != SDL_PIXELFORMAT_ARGB8888){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "IndexedSheet::quantize: expected an ARGB8888 surface");
+        return nullptr;
+    }
+    auto out = std::make_shared<IndexedSheet>();
+    out->width_ = sheet->w;
+    out->height_ = sheet->h;
+    out->indices_.resize(static_cast<size_t>(sheet->w) * sheet->h);
+
+    // 统计颜色，按第一次出现的顺序编号，保证同一张图每次得到同样的调色板
+    std::unordered_map<Uint32, Uint32> histogram;
+    std::vector<Uint32> order;
+    for(int y = 0; y < sheet->h; y++){
+        const Uint32* s = row(sheet, y);
+        for(int x = 0; x < sheet->w; x++){
+            const Uint32 c = s[x];
+            if((c >> 24) == 0) continue; // 全透明都归到下标 0
+            if(histogram[c]++ == 0) order.push_back(c);
+        }
+    }
+
+    if(order.size() > 255){
+        // 颜色太多：保留最常用的 255 种
+        std::stable_sort(order.begin(), order.end(),
+            [&histogram](Uint32 a, Uint32 b){ return histogram[a] > histogram[b]; });
+        order.resize(255);
+        out->lossy_ = true;
+        SDL_Log("IndexedSheet::quantize: %zu colors, keeping the 255 most used", histogram.size());
+    }
+
+    Palette& palette = out->palette_;
+    palette.colors[0] = 0;
+    palette.count = static_cast<int>(order.size()) + 1;
+    std::unordered_map<Uint32, Uint8> lookup;
+    for(size_t i = 0; i < order.size(); i++){
+        palette.colors[i + 1] = order[i];
+        lookup[order[i]] = static_cast<Uint8>(i + 1);
+    }
+
+    for(int y = 0; y < sheet->h; y++){
+        const Uint32* s = row(sheet, y);
+        Uint8* d = out->indices_.data() + static_cast<size_t>(y) * sheet->w;
+        for(int x = 0; x < sheet->w; x++){
+            const Uint32 c = s[x];
+            if((c >> 24) == 0){
+                d[x] = 0;
+                continue;
+            }
+            auto it = lookup.find(c);
+            if(it == lookup.end()){
+                // 被舍弃的颜色取最近色，结果记下来
+                Uint8 best = 1;
+                Uint32 bestDist = UINT32_MAX;
+                for(int i = 1; i < palette.count; i++){
+                    const Uint32 dist = colorDistance(c, palette.colors[i]);
+                    if(dist < bestDist){
+                        bestDist = dist;
+                        best = static_cast<Uint8>(i);
+                    }
+                }
+                it = lookup.emplace(c, best).first;
+            }
+            d[x] = it->second;
+        }
+    }
+    return out;
+}
+
+SDL_Surface* IndexedSheet::expand(const Palette& palette) const
+{
+    SDL_Surface* s = SDL_CreateSurface(width_, height_, SDL_PIXELFORMAT_ARGB8888);
+    if(!s){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "IndexedSheet::expand: %s", SDL_GetError());
+        return nullptr;
+    }
+    for(int y = 0; y < height_; y++){
+        const Uint8* src = indices_.data() + static_cast<size_t>(y) * width_;
+        Uint32* dst = reinterpret_cast<Uint32*>(static_cast<Uint8*>(s->pixels) + y * s->pitch);
+        for(int x = 0; x < width_; x++){
+            dst[x] = palette.colors[src[x]];
+        }
+    }
+    return s;
+}
+
+std::shared_ptr<IndexedSheet> IndexedSheet::scaled(int k, bool pixelArt, const std::vector<SDL_Rect>& frames) const
+{
+    auto out = std::make_shared<IndexedSheet>();
+    out->width_ = width_ * k;
+    out->height_ = height_ * k;
+    out->palette_ = palette_;
+    out->lossy_ = lossy_;
+    out->indices_.resize(static_cast<size_t>(out->width_) * out->height_);
+
+    // 最近邻整数倍放大
+    for(int y = 0; y < height_; y++){
+        const Uint8* s = indices_.data() + static_cast<size_t>(y) * width_;
+        for(int dy = 0; dy < k; dy++){
+            Uint8* d = out->indices_.data() + static_cast<size_t>(y * k + dy) * out->width_;
+            for(int x = 0; x < width_; x++){
+                std::fill_n(d + x * k, k, s[x]);
+            }
+        }
+    }
+    if(!pixelArt || (k != 2 && k != 3)) return out;
+
+    // Scale2x / Scale3x (AdvMAME)，帧外区域保持最近邻
+    // 原色调色板里每种颜色只有一个下标，比较下标与比较颜色等价
+    auto src = [this](int x, int y){ return indices_.data() + static_cast<size_t>(y) * width_ + x; };
+    auto dst = [&out](int x, int y){ return out->indices_.data() + static_cast<size_t>(y) * out->width_ + x; };
+    for(const SDL_Rect& f : frames){
+        const int x0 = std::max(f.x, 0), y0 = std::max(f.y, 0);
+        const int x1 = std::min(f.x + f.w, width_) - 1, y1 = std::min(f.y + f.h, height_) - 1;
+        for(int y = y0; y <= y1; y++){
+            const Uint8* up = src(0, std::max(y - 1, y0));
+            const Uint8* mid = src(0, y);
+            const Uint8* dn = src(0, std::min(y + 1, y1));
+            for(int x = x0; x <= x1; x++){
+                const int xl = std::max(x - 1, x0), xr = std::min(x + 1, x1);
+                const Uint8 A = up[xl], B = up[x], C = up[xr];
+                const Uint8 D = mid[xl], E = mid[x], F = mid[xr];
+                const Uint8 G = dn[xl], H = dn[x], I = dn[xr];
+                Uint8* r0 = dst(x * k, y * k);
+                Uint8* r1 = dst(x * k, y * k + 1);
+                if(k == 2){
+                    r0[0] = (D == B && B != F && D != H) ? D : E;
+                    r0[1] = (B == F && B != D && F != H) ? F : E;
+                    r1[0] = (D == H && D != B && H != F) ? D : E;
+                    r1[1] = (H == F && D != H && B != F) ? F : E;
+                } else{
+                    Uint8* r2 = dst(x * k, y * k + 2);
+                    const bool db = (D == B && B != F && D != H);
+                    const bool bf = (B == F && B != D && F != H);
+                    const bool dh = (D == H && D != B && H != F);
+                    const bool hf = (H == F && D != H && B != F);
+                    r0[0] = db ? D : E;
+                    r0[1] = ((db && E != C) || (bf && E != A)) ? B : E;
+                    r0[2] = bf ? F : E;
+                    r1[0] = ((db && E != G) || (dh && E != A)) ? D : E;
+                    r1[1] = E;
+                    r1[2] = ((bf && E != I) || (hf && E != C)) ? F : E;
+                    r2[0] = dh ? D : E;
+                    r2[1] = ((dh && E != I) || (hf && E != G)) ? H : E;
+                    r2[2] = hf ? F : E;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+SDL_Rect IndexedSheet::opaqueBounds(const SDL_Rect& rect, int* pixels, tools::math::RowSpans* spans) const
+{
+    const int x0 = std::max(rect.x, 0), y0 = std::max(rect.y, 0);
+    const int x1 = std::min(rect.x + rect.w, width_), y1 = std::min(rect.y + rect.h, height_);
+    int minX = x1, minY = y1, maxX = x0 - 1, maxY = y0 - 1, count = 0;
+    if(spans){
+        spans->top = y0;
+        spans->first.assign(static_cast<size_t>(std::max(y1 - y0, 0)), 0);
+        spans->last.assign(static_cast<size_t>(std::max(y1 - y0, 0)), -1);
+    }
+    for(int y = y0; y < y1; y++){
+        const Uint8* src = indices_.data() + static_cast<size_t>(y) * width_;
+        int first = x1, last = x0 - 1;
+        for(int x = x0; x < x1; x++){
+            if(src[x] != 0){
+                first = std::min(first, x);
+                last = x;
+                count++;
+            }
+        }
+        if(last < first) continue;
+        if(spans){
+            spans->first[y - y0] = first;
+            spans->last[y - y0] = last;
+        }
+        minX = std::min(minX, first);
+        maxX = std::max(maxX, last);
+        minY = std::min(minY, y);
+        maxY = y;
+    }
+    if(pixels) *pixels = count;
+    if(count == 0) return SDL_Rect{rect.x, rect.y, 0, 0};
+    return SDL_Rect{minX, minY, maxX - minX + 1, maxY - minY + 1};
+}
+
+// -------------------------------------------------------
+// SpriteLibrary
+
+std::shared_ptr<IndexedSheet> SpriteLibrary::loadSheet(const std::string& path)
+{
+    auto it = sheets_.find(path);
+    if(it != sheets_.end()) return it->second;
+
+    tools::MemoryScope scope(tools::MemTag::Assets);
+    SDL_Surface* surface = loadSurface(path);
+    if(!surface) return nullptr;
+    std::shared_ptr<IndexedSheet> sheet = IndexedSheet::quantize(surface);
+    SDL_DestroySurface(surface);
+    if(!sheet) return nullptr;
+
+    SDL_Log("SpriteLibrary: %s indexed, %d colors, %zu bytes", path.c_str(),
+        sheet->getPalette().count, sheet->getBytes());
+    sheets_.emplace(path, sheet);
+    return sheet;
+}
+
+std::shared_ptr<IndexedSheet> SpriteLibrary::loadScaledSheet(const std::string& path, int k, bool pixelArt,
+                                                             const std::vector<SDL_Rect>& frameRects)
+{
+    std::shared_ptr<IndexedSheet> sheet = loadSheet(path);
+    if(!sheet || k == 1) return sheet;
+
+    const std::string key = path + "|" + std::to_string(k) + "|" + (pixelArt ? "art" : "nearest");
+    auto it = scaledSheets_.find(key);
+    if(it != scaledSheets_.end()) return it->second;
+
+    tools::MemoryScope scope(tools::MemTag::Assets);
+    std::shared_ptr<IndexedSheet> scaled = sheet->scaled(k, pixelArt, frameRects);
+    SDL_Log("SpriteLibrary: %s scaled x%d (%s), %zu bytes", path.c_str(), k,
+        pixelArt ? "Scale2x/3x" : "nearest", scaled->getBytes());
+    scaledSheets_.emplace(key, scaled);
+    return scaled;
+}
+
+std::shared_ptr<SpriteCache> SpriteLibrary::acquire(SDL_Renderer* renderer, const std::string& path,
+                                                    const std::string& variant, const PaletteSwap* swap,
+                                                    const std::vector<SDL_Rect>& frameRects,
+                                                    const SpriteCacheOptions& options)
+{
+    tools::MemoryScope scope(tools::MemTag::Assets);
+    const int k = std::max(options.scale, 1);
+    const bool pixelArt = options.pixelArtUpscale && (k == 2 || k == 3); // 其他倍数总是最近邻
+    const std::string label = path + "|" + variant;
+    const std::string key = label + "|" + std::to_string(k) + "|" + (pixelArt ? "art" : "nearest")
+        + "|" + std::to_string(options.mipLevels) + "|" + (options.cpuPixels ? "cpu" : "gpu");
+    auto it = variants_.find(key);
+    if(it != variants_.end()){
+        if(std::shared_ptr<SpriteCache> cached = it->second.lock()){
+            hits_++;
+            return cached;
+        }
+    }
+
+    // 显存超出预算时不再生成新的颜色变体，退回原色（与其他宠物共享）
+    if(swap && tools::MemoryStats::getInstance().isOverBudget(tools::MemTag::Textures)){
+        if(!budgetLogged_){
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "SpriteLibrary: texture budget exceeded, '%s' falls back to original colors", variant.c_str());
+            budgetLogged_ = true;
+        }
+        return acquire(renderer, path, "", nullptr, frameRects, options);
+    }
+
+    std::shared_ptr<IndexedSheet> sheet = loadSheet(path);
+    std::shared_ptr<IndexedSheet> drawn = loadScaledSheet(path, k, pixelArt, frameRects);
+    if(!sheet || !drawn) return nullptr;
+
+    // 只在这里展开成 RGBA，且只展开绘制的那一份：上传纹理后立即释放
+    // 原尺寸只在 CPU 合成或 mip 需要时再展开一次
+    const Palette palette = swap ? swap->apply(sheet->getPalette()) : sheet->getPalette();
+    SDL_Surface* rgba = drawn->expand(palette);
+    if(!rgba) return nullptr;
+    SDL_Surface* base = nullptr;
+    if(options.cpuPixels || options.mipLevels > 0){
+        base = k == 1 ? rgba : sheet->expand(palette);
+        if(!base){
+            SDL_DestroySurface(rgba);
+            return nullptr;
+        }
+    }
+    auto sprites = std::make_shared<SpriteCache>();
+    sprites->setLabel(label);
+    const bool built = sprites->build(renderer, rgba, base, pixelArt, options);
+    if(base != rgba) SDL_DestroySurface(base);
+    SDL_DestroySurface(rgba);
+    if(!built) return nullptr;
+
+    builds_++;
+    variants_[key] = sprites;
+    return sprites;
+}
+
+void SpriteLibrary::clear()
+{
+    sheets_.clear();
+    scaledSheets_.clear();
+    variants_.clear();
+}
+
+size_t SpriteLibrary::getSheetBytes() const
+{
+    size_t bytes = 0;
+    for(const auto& kv : sheets_){
+        bytes += kv.second->getBytes();
+    }
+    for(const auto& kv : scaledSheets_){
+        bytes += kv.second->getBytes();
+    }
+    return bytes;
+}
+
+size_t SpriteLibrary::getLiveVariantCount() const
+{
+    size_t n = 0;
+    for(const auto& kv : variants_){
+        if(!kv.second.expired()) n++;
+    }
+    return n;
+}
@@ -0,0 +1,108 @@
+#ifndef SPRITELIBRARY_H
+#define SPRITELIBRARY_H
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "spritecache.h"
+#include "../tools/convex_hull.h"
+
+// 调色板（ARGB8888），下标 0 固定为全透明
+struct Palette {
+    std::array<Uint32, 256> colors{};
+    int count = 0;
+};
+
+// 换色表：把基础调色板中的某个颜色换成另一个颜色（ARGB8888）
+// 清单里写作 "palettes": {"gray": {"#d22f1e": "#4a4a58", ...}}
+struct PaletteSwap {
+    std::vector<std::pair<Uint32, Uint32>> remap;
+
+    Palette apply(const Palette& base) const;
+};
+
+// 8 位索引精灵表：像素只存调色板下标，每个片段（一张精灵表）一份调色板
+// 像素画颜色很少，加载时无损量化；超过 255 种颜色时保留最常用的 255 种，其余取最近色
+class IndexedSheet {
+public:
+    static std::shared_ptr<IndexedSheet> quantize(SDL_Surface* sheet);
+
+    int getWidth() const {return width_;}
+    int getHeight() const {return height_;}
+    const Palette& getPalette() const {return palette_;}
+    const std::vector<Uint8>& getIndices() const {return indices_;}
+    size_t getBytes() const {return indices_.size() + sizeof(Palette);}
+    bool isLossy() const {return lossy_;}
+
+    // 按调色板展开成 ARGB8888 表面（只在需要上传纹理时调用），调用者负责释放
+    SDL_Surface* expand(const Palette& palette) const;
+
+    // 整数倍放大（调色板不变）：最近邻，或 pixelArt 时 Scale2x/Scale3x（k 为 2/3）
+    // 在下标上做，结果在所有颜色变体之间共享；frames 限制放大算法的邻居采样，不越过帧边界
+    std::shared_ptr<IndexedSheet> scaled(int k, bool pixelArt, const std::vector<SDL_Rect>& frames) const;
+
+    // 矩形内不透明像素（下标非 0）的包围盒，没有不透明像素时 w/h 为 0
+    // pixels 返回不透明像素数，spans 不为空时同时记录逐行范围（用于求凸包）
+    SDL_Rect opaqueBounds(const SDL_Rect& rect, int* pixels = nullptr, tools::math::RowSpans* spans = nullptr) const;
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    Palette palette_;
+    std::vector<Uint8> indices_;
+    bool lossy_ = false;
+};
+
+// 精灵库（单例）
+// - 每个精灵表只加载、量化一次，索引数据在所有宠物、所有颜色变体之间共享
+// - 放大到绘制缩放也在索引数据上做，每个 (路径, 倍数) 只放大一次，所有颜色变体共享
+// - 颜色变体只是一份调色板；需要绘制时才把放大后的下标展开成 RGBA 并生成 SpriteCache，按 (路径, 变体, 选项) 缓存
+// - 同一变体的宠物共用同一组纹理；没有宠物再用时纹理随最后一个引用释放
+class SpriteLibrary {
+public:
+    static SpriteLibrary& getInstance(){
+        static SpriteLibrary instance;
+        return instance;
+    }
+
+    // 加载并量化精灵表（已加载则直接返回），失败返回空
+    std::shared_ptr<IndexedSheet> loadSheet(const std::string& path);
+
+    // 取得某个变体的纹理缓存，swap 为空表示原色
+    // 纹理显存超出 MemoryStats 的预算时，新的颜色变体退回原色
+    std::shared_ptr<SpriteCache> acquire(SDL_Renderer* renderer, const std::string& path,
+                                         const std::string& variant, const PaletteSwap* swap,
+                                         const std::vector<SDL_Rect>& frameRects,
+                                         const SpriteCacheOptions& options = SpriteCacheOptions{});
+
+    void clear(); // 释放索引数据与缓存表（纹理由持有者释放）
+
+    // 统计
+    size_t getSheetCount() const {return sheets_.size();}
+    size_t getSheetBytes() const;       // 所有索引数据（含放大后的副本）+ 调色板
+    size_t getLiveVariantCount() const; // 仍被引用的 (路径, 变体) 纹理缓存
+    uint64_t getVariantHits() const {return hits_;}
+    uint64_t getVariantBuilds() const {return builds_;}
+
+private:
+    SpriteLibrary() = default;
+    SpriteLibrary(const SpriteLibrary&) = delete;
+    SpriteLibrary& operator=(const SpriteLibrary&) = delete;
+
+    // 放大后的索引数据（倍数为 1 时就是原表），没有就生成
+    std::shared_ptr<IndexedSheet> loadScaledSheet(const std::string& path, int k, bool pixelArt,
+                                                  const std::vector<SDL_Rect>& frameRects);
+
+    std::unordered_map<std::string, std::shared_ptr<IndexedSheet>> sheets_;
+    std::unordered_map<std::string, std::shared_ptr<IndexedSheet>> scaledSheets_; // "路径|倍数|像素画放大"
+    std::unordered_map<std::string, std::weak_ptr<SpriteCache>> variants_; // "路径|变体|倍数|像素画放大|mip|cpu"
+    uint64_t hits_ = 0;
+    uint64_t builds_ = 0;
+    bool budgetLogged_ = false;
+};
+
+#endif // SPRITELIBRARY_H
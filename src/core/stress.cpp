@@ -0,0 +1,200 @@
+#include "stress.h"
+#include "../tools/string_format.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef PATPAT_VERSION
+#define PATPAT_VERSION "unknown"
+#endif
+
+namespace {
+
+const char* const kPhaseNames[kStressPhaseCount] = {"events", "update", "snapshot", "render", "frame"};
+const std::string kDefaultManifest;
+
+using tools::appendf;
+
+std::vector<std::string> splitList(const std::string& text)
+{
+    std::vector<std::string> out;
+    size_t start = 0;
+    while(start <= text.size()){
+        size_t end = text.find(',', start);
+        if(end == std::string::npos) end = text.size();
+        if(end > start) out.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
+// 路径里只会出现普通字符，反斜杠和引号转义即可
+std::string quote(const std::string& s)
+{
+    std::string out = "\"";
+    for(char c : s){
+        if(c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+double perFrame(uint64_t total, uint64_t frames)
+{
+    return frames ? static_cast<double>(total) / static_cast<double>(frames) : 0.0;
+}
+
+} // namespace
+
+const char* getStressPhaseName(StressPhase phase)
+{
+    const size_t i = static_cast<size_t>(phase);
+    return i < kStressPhaseCount ? kPhaseNames[i] : "unknown";
+}
+
+bool StressScenario::configure(const std::string& populations, const std::string& manifests, float seconds, uint64_t seed)
+{
+    populations_.clear();
+    for(const std::string& item : splitList(populations)){
+        const int n = std::atoi(item.c_str());
+        if(n <= 0){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StressScenario: bad population '%s'", item.c_str());
+            populations_.clear();
+            return false;
+        }
+        populations_.push_back(n);
+    }
+    manifests_ = splitList(manifests);
+    seconds_ = seconds > 0.0f ? seconds : 10.0f;
+    seed_ = seed;
+    points_.clear();
+    return !populations_.empty();
+}
+
+const std::string& StressScenario::getManifest(int petIndex) const
+{
+    if(manifests_.empty() || petIndex < 0) return kDefaultManifest;
+    return manifests_[static_cast<size_t>(petIndex) % manifests_.size()];
+}
+
+StressPoint& StressScenario::beginPoint(int pets)
+{
+    // 每个人口从同一个种子开始，曲线上的点只差在数量
+    rng_.seed(seed_ ^ 0x57E55ULL);
+    clickBudget_ = 0.0f;
+    points_.emplace_back();
+    points_.back().pets = pets;
+    return points_.back();
+}
+
+void StressScenario::placePet(int windowW, int windowH, int petW, int petH, float& x, float& y)
+{
+    x = static_cast<float>(rng_.randint(0, std::max(windowW - petW, 0)));
+    y = static_cast<float>(rng_.randint(0, std::max(windowH - petH, 0)));
+}
+
+int StressScenario::injectInput(const RenderSnapshot& snapshot, SDL_WindowID window, int windowW, int windowH, float dt)
+{
+    const Uint64 now = SDL_GetTicksNS();
+
+    // 每帧一次鼠标移动（事件总线会合并，走一遍过滤与分发）
+    SDL_Event e{};
+    e.type = SDL_EVENT_MOUSE_MOTION;
+    e.motion.timestamp = now;
+    e.motion.windowID = window;
+    e.motion.x = static_cast<float>(rng_.randint(0, std::max(windowW - 1, 0)));
+    e.motion.y = static_cast<float>(rng_.randint(0, std::max(windowH - 1, 0)));
+    SDL_PushEvent(&e);
+
+    clickBudget_ += kClicksPerSecond * dt;
+    int clicks = 0;
+    while(clickBudget_ >= 1.0f && !snapshot.sprites.empty()){
+        clickBudget_ -= 1.0f;
+        const int pick = rng_.randint(0, static_cast<int>(snapshot.sprites.size()) - 1);
+        const SDL_Rect& r = snapshot.sprites[static_cast<size_t>(pick)].dst;
+        SDL_Event c{};
+        c.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+        c.button.timestamp = now;
+        c.button.windowID = window;
+        c.button.button = SDL_BUTTON_LEFT;
+        c.button.down = true;
+        c.button.clicks = 1;
+        c.button.x = r.x + r.w * 0.5f;
+        c.button.y = r.y + r.h * 0.5f;
+        SDL_PushEvent(&c);
+        c.type = SDL_EVENT_MOUSE_BUTTON_UP;
+        c.button.down = false;
+        SDL_PushEvent(&c);
+        clicks++;
+    }
+    return clicks;
+}
+
+std::string StressScenario::toJson(const std::string& extra) const
+{
+    std::string out;
+    out.reserve(4096);
+    appendf(out, "{\n  \"version\": %s,\n  \"scenario\": {\"seed\": %llu, \"seconds\": %.3f, \"clicks_per_second\": %.1f, \"manifests\": [",
+        quote(PATPAT_VERSION).c_str(), static_cast<unsigned long long>(seed_), seconds_, kClicksPerSecond);
+    for(size_t i = 0; i < manifests_.size(); i++){
+        out += (i ? ", " : "") + quote(manifests_[i]);
+    }
+    out += "]";
+    if(!extra.empty()){
+        out += ", " + extra;
+    }
+    out += "},\n  \"unit\": \"us\",\n  \"points\": [";
+    for(size_t p = 0; p < points_.size(); p++){
+        const StressPoint& pt = points_[p];
+        appendf(out, "%s\n    {\"pets\": %d, \"frames\": %llu, \"spawn_ms\": %.1f, \"wall_s\": %.3f,\n     \"phases\": {",
+            p ? "," : "", pt.pets, static_cast<unsigned long long>(pt.frames), pt.spawnMs, pt.wallS);
+        for(size_t i = 0; i < kStressPhaseCount; i++){
+            const tools::LatencyHistogram& h = pt.phases[i];
+            appendf(out, "%s\"%s\": {\"mean\": %.1f, \"p50\": %llu, \"p99\": %llu, \"max\": %llu}",
+                i ? ", " : "", kPhaseNames[i], h.getMeanUs(),
+                static_cast<unsigned long long>(h.getPercentileUs(50.0)),
+                static_cast<unsigned long long>(h.getPercentileUs(99.0)),
+                static_cast<unsigned long long>(h.getMaxUs()));
+        }
+        appendf(out, "},\n     \"draw_calls_per_frame\": %.2f, \"visible_per_frame\": %.2f, \"deferred_per_frame\": %.2f,"
+                     " \"clicks\": %llu, \"wakeups_per_frame\": %.3f, \"heap_bytes\": %lld, \"texture_bytes\": %lld,"
+                     " \"quad_px_per_frame\": %.0f, \"drawn_px_per_frame\": %.0f}",
+            perFrame(pt.drawCalls, pt.frames), perFrame(pt.visible, pt.frames), perFrame(pt.deferred, pt.frames),
+            static_cast<unsigned long long>(pt.clicks), perFrame(pt.wakeups, pt.frames),
+            static_cast<long long>(pt.heapBytes), static_cast<long long>(pt.textureBytes),
+            pt.frames ? pt.quadPixels / static_cast<double>(pt.frames) : 0.0,
+            pt.frames ? pt.drawnPixels / static_cast<double>(pt.frames) : 0.0);
+    }
+    out += "\n  ]\n}\n";
+    return out;
+}
+
+bool StressScenario::dumpJson(const std::string& path, const std::string& extra) const
+{
+    const std::string json = toJson(extra);
+    SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "wb");
+    if(!io){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StressScenario: cannot open %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    const bool ok = SDL_WriteIO(io, json.data(), json.size()) == json.size();
+    SDL_CloseIO(io);
+    if(!ok){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StressScenario: write to %s failed: %s", path.c_str(), SDL_GetError());
+    }
+    return ok;
+}
+
+void StressScenario::logReport() const
+{
+    SDL_Log("Stress scaling (%.1f s simulated per population):", seconds_);
+    SDL_Log("  %6s | %9s %9s %9s %9s %9s | %7s | %8s | %9s", "pets", "events", "update", "snapshot", "render", "frame p99", "draws", "wakeups", "tex KB");
+    for(const StressPoint& pt : points_){
+        auto mean = [&pt](StressPhase phase){ return pt.phases[static_cast<size_t>(phase)].getMeanUs() / 1000.0; };
+        SDL_Log("  %6d | %9.3f %9.3f %9.3f %9.3f %9.3f | %7.1f | %8.3f | %9.1f", pt.pets,
+            mean(StressPhase::Events), mean(StressPhase::Update), mean(StressPhase::Snapshot), mean(StressPhase::Render),
+            pt.phases[static_cast<size_t>(StressPhase::Frame)].getPercentileUs(99.0) / 1000.0,
+            perFrame(pt.drawCalls, pt.frames), perFrame(pt.wakeups, pt.frames), pt.textureBytes / 1024.0);
+    }
+    SDL_Log("  (phase columns are mean ms per frame)");
+}
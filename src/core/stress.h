@@ -0,0 +1,81 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <string>
+#include <vector>
+#include "render_snapshot.h"
+#include "../tools/latency_stats.h"
+#include "../tools/random.h"
+
+// 压力场景：按人口列表（例如 1,10,100,1000,10000）依次生成宠物，无头跑完整的游戏循环，
+// 每个人口记录一个点，得到随宠物数量变化的开销曲线（JSON，便于跨版本对比）
+// 宠物位置、行为与合成输入（鼠标移动 + 点击）都由同一个种子决定
+
+// 一帧的各阶段
+enum class StressPhase : uint8_t {
+    Events,   // 取事件、分发
+    Update,   // 定时器、行为、宠物更新
+    Snapshot, // 剔除并生成渲染快照
+    Render,   // 绘制 + present
+    Frame,    // 整帧
+    Count
+};
+constexpr size_t kStressPhaseCount = static_cast<size_t>(StressPhase::Count);
+
+const char* getStressPhaseName(StressPhase phase);
+
+// 一个人口下的结果，计数都是整段运行的累计值
+struct StressPoint{
+    int pets = 0;
+    uint64_t frames = 0;
+    double spawnMs = 0.0;       // 创建宠物（加载清单与精灵）的耗时
+    double wallS = 0.0;         // 跑完所有帧的真实耗时
+    std::array<tools::LatencyHistogram, kStressPhaseCount> phases; // 每帧各阶段耗时
+    uint64_t drawCalls = 0;     // 宠物精灵 + 气泡
+    uint64_t visible = 0;       // 绘制的宠物
+    uint64_t deferred = 0;      // 降频更新的宠物
+    uint64_t clicks = 0;        // 合成点击
+    uint64_t wakeups = 0;       // 定时器触发 + 行为协程恢复
+    int64_t heapBytes = 0;      // 结束时的堆占用（需要 PATPAT_MEMORY_TRACKING）
+    int64_t textureBytes = 0;   // 结束时的纹理占用
+    double quadPixels = 0.0;    // 宠物精灵整帧四边形的面积
+    double drawnPixels = 0.0;   // 实际绘制的面积（裁剪之后）
+};
+
+class StressScenario{
+public:
+    // populations: 逗号分隔的宠物数量；manifests: 逗号分隔的清单路径，宠物轮流使用，空则用默认清单
+    bool configure(const std::string& populations, const std::string& manifests, float seconds, uint64_t seed);
+    bool isEnabled() const {return !populations_.empty();}
+
+    const std::vector<int>& getPopulations() const {return populations_;}
+    float getSeconds() const {return seconds_;}
+    uint64_t getSeed() const {return seed_;}
+    const std::string& getManifest(int petIndex) const; // 第 petIndex 只宠物用的清单，空为默认
+
+    // 开始一个人口：重置随机数流，返回记录结果的点
+    StressPoint& beginPoint(int pets);
+    // 宠物的随机初始位置（窗口内）
+    void placePet(int windowW, int windowH, int petW, int petH, float& x, float& y);
+    // 按固定频率向 SDL 队列投递合成输入，目标从快照里可见的宠物中选，返回本帧的点击数
+    int injectInput(const RenderSnapshot& snapshot, SDL_WindowID window, int windowW, int windowH, float dt);
+
+    std::string toJson(const std::string& extra) const; // extra：附加在 "scenario" 里的字段（已格式化的 JSON 片段）
+    bool dumpJson(const std::string& path, const std::string& extra) const;
+    void logReport() const;
+
+private:
+    static constexpr float kClicksPerSecond = 4.0f; // 整个场景每秒的点击数（与宠物数量无关）
+
+    std::vector<int> populations_;
+    std::vector<std::string> manifests_;
+    float seconds_ = 10.0f;
+    uint64_t seed_ = 0;
+    tools::RandomStream rng_;
+    float clickBudget_ = 0.0f; // 累计的点击配额，满 1 投递一次
+    std::vector<StressPoint> points_;
+};
+
+#endif // STRESS_H
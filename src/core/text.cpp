@@ -0,0 +1,455 @@
+#include "text.h"
+#include "../tools/memory_stats.h"
+#include <algorithm>
+
+namespace {
+
+// 解码一个 UTF-8 字符，非法字节按 U+FFFD 处理
+Uint32 decodeUtf8(const std::string& s, size_t& i){
+    const unsigned char c = static_cast<unsigned char>(s[i++]);
+    if(c < 0x80) return c;
+    int extra = 0;
+    Uint32 cp = 0;
+    if((c & 0xE0) == 0xC0){ extra = 1; cp = c & 0x1F;}
+    else if((c & 0xF0) == 0xE0){ extra = 2; cp = c & 0x0F;}
+    else if((c & 0xF8) == 0xF0){ extra = 3; cp = c & 0x07;}
+    else return 0xFFFD;
+    for(int k = 0; k < extra; k++){
+        if(i >= s.size() || (static_cast<unsigned char>(s[i]) & 0xC0) != 0x80) return 0xFFFD;
+        cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+    }
+    return cp;
+}
+
+SDL_FColor rgba(Uint8 r, Uint8 g, Uint8 b, Uint8 a){
+    return SDL_FColor{r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f};
+}
+
+const char* const kDefaultFonts[] = {
+    "resources/fonts/default.ttf",
+    "C:/Windows/Fonts/msyh.ttc",        // 微软雅黑
+    "C:/Windows/Fonts/simhei.ttf",
+    "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+};
+
+}
+
+// -------------------------------------------------------
+// GlyphAtlas
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font, int pageSize)
+    : renderer_(renderer), font_(font), pageSize_(pageSize)
+{
+    lineSkip_ = TTF_GetFontLineSkip(font_);
+    glyphs_.reserve(256);
+    addPage();
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    for(auto& p : pages_){
+        if(p.texture){
+            tools::MemoryStats::getInstance().untrackTexture(p.texture);
+            SDL_DestroyTexture(p.texture);
+        }
+    }
+}
+
+bool GlyphAtlas::addPage()
+{
+    if(static_cast<int>(pages_.size()) >= kMaxPages) return false;
+
+    SDL_Texture* tex = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, pageSize_, pageSize_);
+    if(!tex){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "GlyphAtlas: failed to create page: %s", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    tools::MemoryStats::getInstance().trackTexture(tex, "glyph-atlas");
+
+    // 清空为透明，左上角 4x4 为白色（气泡背景用）
+    std::vector<Uint32> pixels(static_cast<size_t>(pageSize_) * pageSize_, 0u);
+    for(int y = 0; y < 4; y++){
+        for(int x = 0; x < 4; x++){
+            pixels[static_cast<size_t>(y) * pageSize_ + x] = 0xFFFFFFFFu;
+        }
+    }
+    SDL_UpdateTexture(tex, nullptr, pixels.data(), pageSize_ * 4);
+
+    Page page;
+    page.texture = tex;
+    page.nextY = 5; // 跳过白色块
+    pages_.push_back(std::move(page));
+    return true;
+}
+
+bool GlyphAtlas::allocate(int w, int h, int& pageIndex, SDL_Rect& out)
+{
+    const int pw = w + 1, ph = h + 1; // 1 像素间隔，避免采样串色
+    if(pw > pageSize_ || ph > pageSize_) return false;
+
+    for(int attempt = 0; attempt < 2; attempt++){
+        // 只往最后一页放，前面的页已经满了
+        Page& page = pages_.back();
+        pageIndex = static_cast<int>(pages_.size()) - 1;
+
+        // 找一个高度合适的货架：不矮于字形，也不要高太多浪费空间
+        for(auto& shelf : page.shelves){
+            if(shelf.height >= ph && shelf.height <= ph + ph / 2 && shelf.x + pw <= pageSize_){
+                out = SDL_Rect{shelf.x, shelf.y, w, h};
+                shelf.x += pw;
+                return true;
+            }
+        }
+        // 开一个新货架
+        if(page.nextY + ph <= pageSize_){
+            Shelf shelf;
+            shelf.y = page.nextY;
+            shelf.height = ph;
+            shelf.x = pw;
+            page.nextY += ph;
+            page.shelves.push_back(shelf);
+            out = SDL_Rect{0, shelf.y, w, h};
+            return true;
+        }
+        if(!addPage()) return false;
+    }
+    return false;
+}
+
+const Glyph* GlyphAtlas::getGlyph(Uint32 codepoint)
+{
+    auto it = glyphs_.find(codepoint);
+    if(it != glyphs_.end()){
+        return &it->second;
+    }
+
+    Glyph g;
+    int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+    if(TTF_GetGlyphMetrics(font_, codepoint, &minx, &maxx, &miny, &maxy, &advance)){
+        g.advance = advance;
+    }
+
+    // 白色字形，整行高度，基线位置与其他字形一致
+    SDL_Surface* rendered = TTF_RenderGlyph_Blended(font_, codepoint, SDL_Color{255, 255, 255, 255});
+    if(rendered){
+        SDL_Surface* s = SDL_ConvertSurface(rendered, SDL_PIXELFORMAT_ARGB8888);
+        SDL_DestroySurface(rendered);
+        if(s && s->w > 0 && s->h > 0){
+            int page = -1;
+            SDL_Rect rect;
+            if(allocate(s->w, s->h, page, rect)){
+                SDL_UpdateTexture(pages_[page].texture, &rect, s->pixels, s->pitch);
+                g.page = page;
+                g.src = rect;
+            } else if(!fullLogged_){
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "GlyphAtlas: atlas is full, some glyphs will be missing");
+                fullLogged_ = true;
+            }
+            if(g.advance == 0) g.advance = s->w;
+        }
+        if(s) SDL_DestroySurface(s);
+    }
+    rasterized_++;
+    return &glyphs_.emplace(codepoint, g).first->second;
+}
+
+int GlyphAtlas::getKerning(Uint32 previous, Uint32 codepoint) const
+{
+    int kerning = 0;
+    if(TTF_GetGlyphKerning(font_, previous, codepoint, &kerning)){
+        return kerning;
+    }
+    return 0;
+}
+
+// -------------------------------------------------------
+// TextSystem
+
+bool TextSystem::init(SDL_Renderer* renderer, const std::string& fontPath, float size)
+{
+    renderer_ = renderer;
+    if(!renderer_){
+        return false;
+    }
+    if(!fontPath.empty()){
+        if(loadFont(fontPath, size) < 0){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TextSystem: cannot open font %s: %s", fontPath.c_str(), SDL_GetError());
+            return false;
+        }
+        return true;
+    }
+    for(const char* path : kDefaultFonts){
+        if(loadFont(path, size) >= 0){
+            SDL_Log("TextSystem: using font %s (%.0fpt)", path, size);
+            return true;
+        }
+    }
+    SDL_Log("TextSystem: no usable font found, speech bubbles disabled");
+    return false;
+}
+
+void TextSystem::shutdown()
+{
+    lru_.clear();
+    layouts_.clear();
+    runs_.clear();
+    batches_.clear();
+    layerBubbles_.clear();
+    layerStart_ = 0;
+    layerKind_ = LayerKind::Empty;
+    for(auto& f : fonts_){
+        f.atlas.reset();
+        if(f.font){
+            TTF_CloseFont(f.font);
+        }
+    }
+    fonts_.clear();
+    fontIndex_.clear();
+    renderer_ = nullptr;
+}
+
+TextSystem::FontId TextSystem::loadFont(const std::string& path, float size)
+{
+    tools::MemoryScope scope(tools::MemTag::UI);
+    const std::string key = path + "@" + std::to_string(size);
+    if(auto it = fontIndex_.find(key); it != fontIndex_.end()){
+        return it->second;
+    }
+    if(!renderer_) return -1;
+    TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+    if(!font){
+        return -1;
+    }
+    Font f;
+    f.key = key;
+    f.font = font;
+    f.atlas = std::make_unique<GlyphAtlas>(renderer_, font);
+    const FontId id = static_cast<FontId>(fonts_.size());
+    fonts_.push_back(std::move(f));
+    fontIndex_[key] = id;
+    return id;
+}
+
+void TextSystem::buildLayout(GlyphAtlas& atlas, const std::string& text, float maxWidth, TextLayout& out)
+{
+    out.quads.clear();
+    const float lineHeight = static_cast<float>(atlas.getLineSkip());
+    float penX = 0.0f, lineY = 0.0f, widest = 0.0f;
+    Uint32 previous = 0;
+
+    size_t i = 0;
+    while(i < text.size()){
+        const Uint32 cp = decodeUtf8(text, i);
+        if(cp == '\n'){
+            widest = std::max(widest, penX);
+            penX = 0.0f;
+            lineY += lineHeight;
+            previous = 0;
+            continue;
+        }
+        const Glyph* g = atlas.getGlyph(cp);
+        float kerning = previous ? static_cast<float>(atlas.getKerning(previous, cp)) : 0.0f;
+
+        // 逐字换行（中文没有空格可断），行首的空格丢掉
+        if(maxWidth > 0.0f && penX > 0.0f && penX + kerning + g->advance > maxWidth){
+            widest = std::max(widest, penX);
+            penX = 0.0f;
+            lineY += lineHeight;
+            kerning = 0.0f;
+            previous = 0;
+            if(cp == ' ') continue;
+        }
+        penX += kerning;
+        if(g->page >= 0){
+            out.quads.push_back(TextLayout::Quad{g->page,
+                SDL_FRect{penX, lineY, static_cast<float>(g->src.w), static_cast<float>(g->src.h)}, g->src});
+        }
+        penX += static_cast<float>(g->advance);
+        previous = cp;
+    }
+    out.width = std::max(widest, penX);
+    out.height = lineY + lineHeight;
+}
+
+const TextLayout* TextSystem::getLayout(const std::string& text, float maxWidth, FontId font)
+{
+    if(font < 0 || font >= static_cast<FontId>(fonts_.size())){
+        return nullptr;
+    }
+
+    // 键：字体|宽度|文字，复用同一个缓冲，命中时不分配
+    keyScratch_.clear();
+    keyScratch_ += std::to_string(font);
+    keyScratch_ += '|';
+    keyScratch_ += std::to_string(static_cast<int>(maxWidth));
+    keyScratch_ += '|';
+    keyScratch_ += text;
+
+    if(auto it = layouts_.find(keyScratch_); it != layouts_.end()){
+        lru_.splice(lru_.begin(), lru_, it->second); // 移到表头
+        hits_++;
+        return &it->second->layout;
+    }
+
+    misses_++;
+    tools::MemoryScope scope(tools::MemTag::UI);
+    lru_.emplace_front();
+    LayoutEntry& entry = lru_.front();
+    entry.key = keyScratch_;
+    buildLayout(*fonts_[font].atlas, text, maxWidth, entry.layout);
+    layouts_[entry.key] = lru_.begin();
+
+    while(lru_.size() > layoutCapacity_){
+        layouts_.erase(lru_.back().key);
+        lru_.pop_back();
+        evictions_++;
+    }
+    return &entry.layout;
+}
+
+void TextSystem::beginLayer()
+{
+    layerStart_ = runs_.size();
+    layerKind_ = LayerKind::Empty;
+    layerBubbles_.clear();
+}
+
+TextSystem::Batch& TextSystem::batchFor(FontId font, int page)
+{
+    // 一层里通常只有一两页，线性查找即可
+    for(size_t i = layerStart_; i < runs_.size(); i++){
+        if(runs_[i].font == font && runs_[i].page == page){
+            return batches_[i];
+        }
+    }
+    runs_.push_back(Run{font, page});
+    if(batches_.size() < runs_.size()){
+        batches_.resize(runs_.size());
+    }
+    return batches_[runs_.size() - 1];
+}
+
+void TextSystem::addQuad(Batch& batch, const GlyphAtlas& atlas, const SDL_FRect& dst, const SDL_Rect& src, SDL_FColor color)
+{
+    const float inv = 1.0f / static_cast<float>(atlas.getPageSize());
+    const float u0 = src.x * inv, v0 = src.y * inv;
+    const float u1 = (src.x + src.w) * inv, v1 = (src.y + src.h) * inv;
+    const int base = static_cast<int>(batch.vertices.size());
+
+    batch.vertices.push_back(SDL_Vertex{SDL_FPoint{dst.x, dst.y}, color, SDL_FPoint{u0, v0}});
+    batch.vertices.push_back(SDL_Vertex{SDL_FPoint{dst.x + dst.w, dst.y}, color, SDL_FPoint{u1, v0}});
+    batch.vertices.push_back(SDL_Vertex{SDL_FPoint{dst.x + dst.w, dst.y + dst.h}, color, SDL_FPoint{u1, v1}});
+    batch.vertices.push_back(SDL_Vertex{SDL_FPoint{dst.x, dst.y + dst.h}, color, SDL_FPoint{u0, v1}});
+    const int idx[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+    batch.indices.insert(batch.indices.end(), idx, idx + 6);
+}
+
+void TextSystem::addTriangle(Batch& batch, const GlyphAtlas& atlas, const SDL_FPoint (&p)[3], SDL_FColor color)
+{
+    const SDL_Rect white = atlas.getWhiteRect();
+    const float inv = 1.0f / static_cast<float>(atlas.getPageSize());
+    const SDL_FPoint uv = {(white.x + white.w * 0.5f) * inv, (white.y + white.h * 0.5f) * inv};
+    const int base = static_cast<int>(batch.vertices.size());
+    for(const SDL_FPoint& point : p){
+        batch.vertices.push_back(SDL_Vertex{point, color, uv});
+    }
+    const int idx[3] = {base, base + 1, base + 2};
+    batch.indices.insert(batch.indices.end(), idx, idx + 3);
+}
+
+void TextSystem::addText(const TextLayout& layout, float x, float y, SDL_FColor color, FontId font)
+{
+    const GlyphAtlas& atlas = *fonts_[font].atlas;
+    for(const auto& q : layout.quads){
+        SDL_FRect dst = {x + q.dst.x, y + q.dst.y, q.dst.w, q.dst.h};
+        addQuad(batchFor(font, q.page), atlas, dst, q.src, color);
+    }
+}
+
+void TextSystem::drawText(const std::string& text, float x, float y, SDL_FColor color, float maxWidth, FontId font)
+{
+    const TextLayout* layout = getLayout(text, maxWidth, font);
+    if(!layout) return;
+    // 没有背景的文字可以互相合并，但要画在之前的气泡之上
+    if(layerKind_ == LayerKind::Bubbles){
+        beginLayer();
+    }
+    layerKind_ = LayerKind::Text;
+    addText(*layout, x, y, color, font);
+}
+
+void TextSystem::drawBubble(const std::string& text, float anchorX, float anchorY, float maxWidth, FontId font)
+{
+    const TextLayout* layout = getLayout(text, maxWidth, font);
+    if(!layout) return;
+    const GlyphAtlas& atlas = *fonts_[font].atlas;
+
+    const float padding = 8.0f, border = 2.0f, tail = 8.0f;
+    const float w = SDL_floorf(layout->width + padding * 2.0f);
+    const float h = SDL_floorf(layout->height + padding * 2.0f);
+    const float left = SDL_floorf(anchorX - w * 0.5f);
+    const float top = SDL_floorf(anchorY - tail - h);
+    const SDL_FColor borderColor = rgba(60, 60, 60, 230);
+    const SDL_FColor fillColor = rgba(255, 255, 255, 240);
+
+    // 与当前层的气泡相交（或层里有普通文字、层已满）时开始新的一层，保证后画的气泡整个盖住先画的
+    const SDL_FRect bounds = {left, top, w, anchorY - top};
+    bool overlaps = layerKind_ == LayerKind::Text || layerBubbles_.size() >= kMaxLayerBubbles;
+    for(size_t i = 0; i < layerBubbles_.size() && !overlaps; i++){
+        const SDL_FRect& r = layerBubbles_[i];
+        overlaps = r.x < bounds.x + bounds.w && bounds.x < r.x + r.w && r.y < bounds.y + bounds.h && bounds.y < r.y + r.h;
+    }
+    if(overlaps){
+        beginLayer();
+    }
+    layerKind_ = LayerKind::Bubbles;
+    layerBubbles_.push_back(bounds);
+
+    // 背景用第 0 页的白色像素块：这种字体在层里第一次出现时第 0 页的批次最先建立，所以背景先于本层所有字形页绘制
+    Batch& bg = batchFor(font, 0);
+    const SDL_Rect white = atlas.getWhiteRect();
+    addQuad(bg, atlas, SDL_FRect{left, top, w, h}, white, borderColor);
+    addQuad(bg, atlas, SDL_FRect{left + border, top + border, w - border * 2.0f, h - border * 2.0f}, white, fillColor);
+    const SDL_FPoint outer[3] = {{anchorX - tail, top + h - border}, {anchorX + tail, top + h - border}, {anchorX, anchorY}};
+    addTriangle(bg, atlas, outer, borderColor);
+    const SDL_FPoint inner[3] = {{anchorX - tail + border * 1.5f, top + h - border - 0.5f},
+                                 {anchorX + tail - border * 1.5f, top + h - border - 0.5f},
+                                 {anchorX, anchorY - border * 1.5f}};
+    addTriangle(bg, atlas, inner, fillColor);
+
+    addText(*layout, left + padding, top + padding, rgba(40, 40, 40, 255), font);
+}
+
+void TextSystem::submit(FontId font, int page, Batch& batch)
+{
+    SDL_RenderGeometry(renderer_, fonts_[font].atlas->getPage(page),
+                       batch.vertices.data(), static_cast<int>(batch.vertices.size()),
+                       batch.indices.data(), static_cast<int>(batch.indices.size()));
+    // clear() 保留容量，下一帧不再分配
+    batch.vertices.clear();
+    batch.indices.clear();
+}
+
+void TextSystem::flush()
+{
+    size_t calls = 0;
+    for(size_t i = 0; i < runs_.size(); i++){
+        if(batches_[i].indices.empty()) continue;
+        submit(runs_[i].font, runs_[i].page, batches_[i]);
+        calls++;
+    }
+    drawCalls_ = calls;
+    runs_.clear();
+    beginLayer();
+}
+
+uint64_t TextSystem::getGlyphsRasterized() const
+{
+    uint64_t n = 0;
+    for(const auto& f : fonts_){
+        n += f.atlas->getRasterizedCount();
+    }
+    return n;
+}
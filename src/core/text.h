@@ -0,0 +1,174 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 图集中的一个字形：纹理页与源矩形，绘制时左上角对齐到行顶
+struct Glyph{
+    int page = -1;          // -1：没有可见像素（空格等）
+    SDL_Rect src = {0, 0, 0, 0};
+    int advance = 0;
+};
+
+// 字形图集：一种字体 + 字号一份
+// 字形第一次用到时用 TTF_RenderGlyph_Blended 光栅化（白色），用货架（shelf）算法装进纹理页，
+// 之后只查表；颜色由顶点颜色调制
+// 每页左上角预留一块白色像素，气泡背景用第 0 页的白色像素绘制，不需要另外的纹理
+class GlyphAtlas{
+public:
+    GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font, int pageSize = 512);
+    ~GlyphAtlas();
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    const Glyph* getGlyph(Uint32 codepoint);
+    int getKerning(Uint32 previous, Uint32 codepoint) const;
+    int getLineSkip() const {return lineSkip_;}
+    int getPageSize() const {return pageSize_;}
+    SDL_Texture* getPage(int page) const {return pages_[page].texture;}
+    int getPageCount() const {return static_cast<int>(pages_.size());}
+    SDL_Rect getWhiteRect() const {return SDL_Rect{1, 1, 2, 2};} // 白色像素块（每页相同位置）
+    uint64_t getRasterizedCount() const {return rasterized_;}
+
+    static constexpr int kMaxPages = 8;
+
+private:
+    struct Shelf{
+        int y = 0, height = 0, x = 0;
+    };
+    struct Page{
+        SDL_Texture* texture = nullptr;
+        std::vector<Shelf> shelves;
+        int nextY = 0;
+    };
+
+    bool addPage();
+    bool allocate(int w, int h, int& page, SDL_Rect& out);
+
+    SDL_Renderer* renderer_;
+    TTF_Font* font_;
+    int pageSize_;
+    int lineSkip_ = 0;
+    std::vector<Page> pages_;
+    std::unordered_map<Uint32, Glyph> glyphs_;
+    uint64_t rasterized_ = 0;
+    bool fullLogged_ = false;
+};
+
+// 排好版的一段文字：相对左上角的字形四边形，按字符串缓存
+struct TextLayout{
+    struct Quad{
+        int page;
+        SDL_FRect dst;
+        SDL_Rect src;
+    };
+    std::vector<Quad> quads;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// 文字系统（单例）
+// - 每种字体/字号一个 GlyphAtlas
+// - 排版结果按 (字体, 字符串, 换行宽度) 缓存，LRU 淘汰
+// - drawText()/drawBubble() 只往本帧的顶点批次里追加，flush() 按层的顺序提交，层内每个 (字体, 纹理页) 一次 SDL_RenderGeometry
+// - 层：互不相交的气泡合并成一层（最多 kMaxLayerBubbles 个），层内先画背景所在的第 0 页，再画其他页；
+//   与层内气泡相交的气泡开始新的一层，后画的气泡连同背景整个盖在先画的气泡上，和逐个绘制的结果相同
+// 稳定状态下（文字都见过）每帧不光栅化、不创建纹理，也不分配内存
+class TextSystem{
+public:
+    static TextSystem& getInstance(){
+        static TextSystem instance;
+        return instance;
+    }
+
+    using FontId = int;
+
+    // fontPath 为空时依次尝试内置字体与系统字体
+    bool init(SDL_Renderer* renderer, const std::string& fontPath = "", float size = 16.0f);
+    void shutdown();
+    bool isReady() const {return !fonts_.empty();}
+
+    FontId loadFont(const std::string& path, float size); // 同一路径与字号只打开一次，失败返回 -1
+    const TextLayout* getLayout(const std::string& text, float maxWidth = 0.0f, FontId font = 0);
+
+    void drawText(const std::string& text, float x, float y, SDL_FColor color, float maxWidth = 0.0f, FontId font = 0);
+    // 在 (anchorX, anchorY) 上方居中画一个对话气泡，尾巴指向锚点
+    void drawBubble(const std::string& text, float anchorX, float anchorY, float maxWidth = 180.0f, FontId font = 0);
+    void flush();
+
+    void setLayoutCapacity(size_t capacity) {layoutCapacity_ = capacity > 0 ? capacity : 1;}
+
+    // 统计
+    uint64_t getLayoutHits() const {return hits_;}
+    uint64_t getLayoutMisses() const {return misses_;}
+    uint64_t getLayoutEvictions() const {return evictions_;}
+    uint64_t getGlyphsRasterized() const;
+    size_t getDrawCalls() const {return drawCalls_;}
+
+private:
+    TextSystem() = default;
+    TextSystem(const TextSystem&) = delete;
+    TextSystem& operator=(const TextSystem&) = delete;
+
+    struct Font{
+        std::string key;
+        TTF_Font* font = nullptr;
+        std::unique_ptr<GlyphAtlas> atlas;
+    };
+
+    struct LayoutEntry{
+        std::string key;
+        TextLayout layout;
+    };
+
+    struct Batch{
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    };
+
+    // 一次 SDL_RenderGeometry：runs_[i] 的顶点在 batches_[i]
+    struct Run{
+        FontId font;
+        int page;
+    };
+
+    enum class LayerKind : uint8_t {Empty, Text, Bubbles};
+    static constexpr size_t kMaxLayerBubbles = 64; // 限制每个气泡的相交检查次数
+
+    void buildLayout(GlyphAtlas& atlas, const std::string& text, float maxWidth, TextLayout& out);
+    void beginLayer();
+    Batch& batchFor(FontId font, int page); // 当前层里的批次，没有时在层尾追加
+    void addText(const TextLayout& layout, float x, float y, SDL_FColor color, FontId font);
+    void submit(FontId font, int page, Batch& batch);
+    void addQuad(Batch& batch, const GlyphAtlas& atlas, const SDL_FRect& dst, const SDL_Rect& src, SDL_FColor color);
+    void addTriangle(Batch& batch, const GlyphAtlas& atlas, const SDL_FPoint (&p)[3], SDL_FColor color);
+
+    SDL_Renderer* renderer_ = nullptr;
+    std::vector<Font> fonts_;
+    std::unordered_map<std::string, FontId> fontIndex_;
+
+    // LRU：表头最新
+    std::list<LayoutEntry> lru_;
+    std::unordered_map<std::string, std::list<LayoutEntry>::iterator> layouts_;
+    size_t layoutCapacity_ = 256;
+    std::string keyScratch_; // 复用的查找键
+
+    // 本帧的提交顺序；batches_ 只增不减，跨帧复用容量
+    std::vector<Run> runs_;
+    std::vector<Batch> batches_;
+    size_t layerStart_ = 0;                 // 当前层的第一个 run
+    LayerKind layerKind_ = LayerKind::Empty;
+    std::vector<SDL_FRect> layerBubbles_;   // 当前层的气泡（含尾巴），两两不相交
+    size_t drawCalls_ = 0;
+
+    uint64_t hits_ = 0, misses_ = 0, evictions_ = 0;
+};
+
+#endif // TEXT_H
@@ -1,10 +1,93 @@
 #include "../src/core/game.h"
 #include "tools/tools.h"
+#include <cstdlib>
+#include <cstring>
+
+// 解析命令行参数，未知参数打印用法并返回 false
+static bool parseOptions(int argc, char *argv[], GameOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 0);
+            options.hasSeed = true;
+        } else if (std::strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(arg, "--fast") == 0) {
+            options.fastForward = true;
+        } else if (std::strcmp(arg, "--fps") == 0 && hasValue) {
+            options.fps = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(arg, "--vsync") == 0) {
+            options.vsync = true;
+        } else if (std::strcmp(arg, "--palette") == 0 && hasValue) {
+            options.palette = argv[++i];
+        } else if (std::strcmp(arg, "--pets") == 0 && hasValue) {
+            options.pets = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--memory-report") == 0 && hasValue) {
+            options.memoryReport = argv[++i];
+        } else if (std::strcmp(arg, "--texture-budget") == 0 && hasValue) {
+            options.textureBudgetMB = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(arg, "--input-stats") == 0) {
+            options.inputStats = true;
+            // 文件参数可省略
+            if (hasValue && std::strncmp(argv[i + 1], "--", 2) != 0) {
+                options.inputStatsPath = argv[++i];
+            }
+        } else if (std::strcmp(arg, "--synthetic-input") == 0 && hasValue) {
+            options.syntheticKeysPerMinute = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--latency-probe") == 0 && hasValue) {
+            options.latencyProbe = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--latency-report") == 0 && hasValue) {
+            options.latencyReport = argv[++i];
+        } else if (std::strcmp(arg, "--time-scale") == 0 && hasValue) {
+            options.timeScale = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--run-for") == 0 && hasValue) {
+            options.runFor = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--paused") == 0) {
+            options.paused = true;
+        } else if (std::strcmp(arg, "--lod") == 0 && hasValue) {
+            options.lodInterval = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--stress") == 0 && hasValue) {
+            options.stressPets = argv[++i];
+        } else if (std::strcmp(arg, "--stress-seconds") == 0 && hasValue) {
+            options.stressSeconds = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--stress-manifest") == 0 && hasValue) {
+            options.stressManifests = argv[++i];
+        } else if (std::strcmp(arg, "--stress-report") == 0 && hasValue) {
+            options.stressReport = argv[++i];
+        } else if (std::strcmp(arg, "--single-thread") == 0) {
+            options.singleThread = true;
+        } else if (std::strcmp(arg, "--compositor") == 0 && hasValue) {
+            options.compositor = argv[++i];
+        } else if (std::strcmp(arg, "--sprite-geometry") == 0 && hasValue) {
+            options.spriteGeometry = argv[++i];
+        } else if (std::strcmp(arg, "--pixel-art-upscale") == 0) {
+            options.pixelArtUpscale = true;
+        } else if (std::strcmp(arg, "--check-input-shape") == 0) {
+            options.checkInputShape = true;
+        } else if (std::strcmp(arg, "--metrics-socket") == 0 && hasValue) {
+            options.metricsSocket = argv[++i];
+        } else {
+            SDL_Log("Unknown argument: %s", arg);
+            SDL_Log("Usage: %s [--record <file>] [--replay <file>] [--seed <n>] [--headless] [--fast] [--fps <n>] [--vsync] [--palette <name>] [--pets <n>] [--memory-report <file>] [--texture-budget <MB>] [--input-stats [file]] [--synthetic-input <kpm>] [--compositor auto|cpu|sdl] [--sprite-geometry quad|trim|hull] [--pixel-art-upscale] [--time-scale <x>] [--run-for <s>] [--paused] [--lod <n>] [--stress <n,n,...>] [--stress-seconds <s>] [--stress-manifest <file,...>] [--stress-report <file>] [--single-thread] [--latency-probe <n>] [--latency-report <file>] [--check-input-shape] [--metrics-socket <path>]", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
 
 int main(int argc, char *argv[]) {
+    GameOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
     Game& game = Game::getInstance();
-    game.init();
+    game.init(options);
     game.run();
     game.clean();
-    return 0;
-}
\ No newline at end of file
+    return game.getExitCode();
+}
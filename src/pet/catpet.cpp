@@ -1,20 +1,13 @@
 #include "catpet.h"
-#include "../tools/tools.h"
 #include "../tools/manifest_loader.h"
 #include "../tools/random.h"
+#include "../tools/input_stats.h"
+#include "core/eventbus.h"
 #include <algorithm>
+#include <cmath>
 
-// map names in manifest to PetState(no caring about uppercase or lowercase)
-static PetState mapNameToState(std::string name){
-    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-    if(name == "idle") return PetState::IDLE;
-    if(name == "walk") return PetState::WALK;
-    if(name == "click") return PetState::CLICK;
-    // more states can be added here
-    return PetState::IDLE; // default
-}
-
-CatPet::CatPet()
+CatPet::CatPet(const std::string& palette, const std::string& manifest)
+    : palette_(palette), manifest_(manifest.empty() ? "resources/sprites/CatPet/manifest.json" : manifest)
 {
     // Nothing to do ?
     currentState_ = PetState::IDLE; // 默认状态
@@ -27,12 +20,10 @@ CatPet::~CatPet()
 
 void CatPet::init()
 {
-    // 初始化位置
-    int screenW = 0, screenH = 0;
-    tools::UI::getWindowSize(screenW, screenH);
-    posX_ = screenW / 2; // 居中
-    posY_ = static_cast<int> (screenH * 0.8f); // 屏幕下方
-    SDL_Log("CatPet::init screen: %dx%d, initial pos: (%d,%d)", screenW, screenH, posX_, posY_);
+    // 初始化位置（活动区域由 Game 设置，不查询显示器）
+    posX_ = screenW_ / 2.0f; // 居中
+    posY_ = screenH_ * 0.8f; // 屏幕下方
+    SDL_Log("CatPet::init screen: %dx%d, initial pos: (%.1f,%.1f)", screenW_, screenH_, posX_, posY_);
 
     // Atcually no need, since paths are in json
     // 初始化动画路径
@@ -54,74 +45,54 @@ void CatPet::init()
     // petHeight_ *= viewScale_;
     SDL_Log("CatPet::init: pet size: %dx%d", petWidth_, petHeight_);
 
-    // initialize timers
-    walkTimer_.start();
-    walkTimer_.setInterval(tools::Random::randfloat(walkInterval_min_, walkInterval_max_), true);
+    // initialize movement
+    body_.position = {posX_, posY_};
+    body_.params.maxSpeed = std::abs(moveSpeed_.x);
+    body_.params.acceleration = moveAcceleration_;
+
+    // start behavior
+    behavior_ = wanderBehavior();
+    behavior_.start();
 }
 
-void CatPet::update(float dt)
+void CatPet::update(Uint64 deltaNs)
 {
 
-    setWalkAction(dt);
-
     // 更新当前动画
-    auto it = animations_.find(currentState_);
-    if(it != animations_.end() && it->second){
+    if(Animation* anim = getSlotAnimation(currentSlot_)){
 
         // if move then update position
         if(getMovementState()){
             // updatePosition(dt);
-            walkAround(dt);
+            walkAround(static_cast<float>(static_cast<double>(deltaNs) / 1.0e9));
             //SDL_Log("CatPet::update: pet movement state=%d pos=(%d,%d)", (int)currentState_, posX_, posY_);
         }
-        it->second->update(dt);
-        // Just used simple method here
-        // Actually need better state machine
-        // while animation is finished and not looping, switch back to IDLE
-        if(!it->second->isLooping() && it->second->isFinished()){
-            setState(PetState::IDLE);
+        anim->advance(deltaNs);
+        // while animation is finished and not looping, switch back to IDLE (in onAnimationFinished)
+        // 队列满被丢弃时动画仍停在结束状态，下一帧会再 post 一次
+        if(!anim->isLooping() && anim->isFinished()){
+            GameEvent e;
+            e.type = GameEvent::Type::AnimationFinished;
+            e.pet = this;
+            e.to = currentState_.value();
+            EventBus::getInstance().post(e);
         }
     } else{
         // 没有当前状态动画
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No animation found for current state in CatPet::update");
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No animation found for state '%s' in CatPet::update", currentState_.c_str());
         // 尝试使用IDLE动画作为后备
-        auto idleIt = animations_.find(PetState::IDLE);
-        if(idleIt != animations_.end() && idleIt->second){
-            idleIt->second->update(dt);
+        if(Animation* idle = getSlotAnimation(idleSlot_)){
+            idle->advance(deltaNs);
         }
     }
 }
 
-void CatPet::render()
+void CatPet::onAnimationFinished(StateId state)
 {
-    // 周期性输出渲染信息，便于定位不可见问题
-    // static Uint64 lastLogNs = 0;
-    // Uint64 now = SDL_GetTicksNS();
-    // if(now - lastLogNs > 1'000'000'000ULL){
-    //     SDL_Log("CatPet::render state=%d pos=(%d,%d) size=%dx%d", (int)currentState_, posX_, posY_, petWidth_, petHeight_);
-    //     lastLogNs = now;
-    // }
-
-    // render with flipX_
-    if(flipX_){
-        float sx = 1.0f, sy = 1.0f; // scale of screen(renderer actually)
-        SDL_GetRenderScale(renderer_, &sx, &sy);
-
-        // translate to center, scale -1 in X, translate back
-        SDL_SetRenderScale(renderer_, -sx, sy);
-
-        // since scale is -1 in X, need to adjust position
-        int tempX = posX_;
-        posX_ = -(posX_ + petWidth_);
-
-        playAnimation(currentState_);
-
-        // back to normal
-        posX_ = tempX;
-        SDL_SetRenderScale(renderer_, sx, sy);
-    }else{
-        playAnimation(currentState_);
-    }
+    // 从 post 到分发之间状态已经换了（例如同一帧里被别的逻辑切走），这次结束作废
+    if(state != currentState_) return;
+    animSignal_.notify(true);
+    setState(PetState::IDLE);
 }
 
 void CatPet::handleEvent(SDL_Event &event)
@@ -133,13 +104,13 @@ void CatPet::handleEvent(SDL_Event &event)
 
 void CatPet::clean()
 {
+    // stop behavior first, it may still wait on timers or signals
+    behavior_ = Behavior();
+    motion_ = nullptr; // the batch is cleared together with the pets
+
     // clean up animations
-    for(auto &kv : animations_){
-        if(kv.second){
-            kv.second->clean();
-        }
-    }
-    animations_.clear();
+    clearStates();
+    extraStates_.clear();
 
     spriteSheet_ = nullptr;
 }
@@ -154,13 +125,26 @@ bool CatPet::loadAnimations()
     // first, load manifest
     Manifest mf;
     std::string err;
-    const std::string manifestPath = "resources/sprites/CatPet/manifest.json";
-    if(!loadManifest(manifestPath, mf, &err)){
+    if(!loadManifest(manifest_, mf, &err)){
         SDL_Log("CatPet::loadAnimations: Failed to load manifest: %s", err.c_str());
         return false;
     }
+    // sounds are decoded once and shared by every pet using this manifest
+    loadManifestSounds(mf);
     // SDL_Log("CatPet::loadAnimations: manifest loaded. basePath='%s', animations=%zu", mf.basePath.c_str(), mf.animations.size());
 
+    // colour variant: only a palette, the indexed pixels are shared by every cat
+    const PaletteSwap* swap = nullptr;
+    if(!palette_.empty()){
+        auto pit = mf.palettes.find(palette_);
+        if(pit != mf.palettes.end()){
+            swap = &pit->second;
+        } else{
+            SDL_Log("CatPet::loadAnimations: unknown palette '%s', using original colors", palette_.c_str());
+        }
+    }
+    SpriteLibrary& library = SpriteLibrary::getInstance();
+
     bool sizeSet = false;
 
     // then, run through animations in manifest and load their textures
@@ -171,24 +155,21 @@ bool CatPet::loadAnimations()
         // get full path
     const std::string fullPath = (mf.basePath.empty() ? desc.path : (mf.basePath + desc.path));
 
-        // load texture
+        // indexed sheet is loaded once and shared, RGBA textures are built per colour variant
         // SDL_Log("CatPet::loadAnimations: loading animation '%s' from '%s'", desc.name.c_str(), fullPath.c_str());
-        SDL_Texture* tex = loadTexture(renderer_, fullPath);
-        if(!tex){
+        std::shared_ptr<IndexedSheet> sheet = library.loadSheet(fullPath);
+        if(!sheet){
             SDL_Log("CatPet::loadAnimations: Failed to load texture: %s", fullPath.c_str());
             continue; // skip this animation
         }
 
         // extract frames
-        float texW = 0, texH = 0; // if cannot get frames, just caculate
-        // use SDL_GetTextureSize to get width and height
-    SDL_GetTextureSize(tex, &texW, &texH);
-    // SDL_Log("CatPet::loadAnimations: texture size for '%s': %.0fx%.0f", desc.name.c_str(), texW, texH);
+        const int texW = sheet->getWidth(), texH = sheet->getHeight();
         if(desc.frames <= 0){
             if(desc.layout == "grid" && desc.rows > 0 && desc.cols > 0){
                 desc.frames = desc.rows * desc.cols;
             } else if(desc.frameWidth > 0){
-                desc.frames = static_cast<int>(texW / desc.frameWidth);
+                desc.frames = texW / desc.frameWidth;
             }
         }
 
@@ -202,39 +183,72 @@ bool CatPet::loadAnimations()
 
         if(frames.empty()){
             SDL_Log("CatPet::loadAnimations: No frames extracted for animation: %s", fullPath.c_str());
-            SDL_DestroyTexture(tex);
+            continue; // skip this animation
+        }
+
+        // trim transparent borders: only the opaque part of each frame is drawn
+        trimFrames(*sheet, frames);
+
+        // one texture at the scale it is drawn: pre-scaled to viewScale_ (a 1:1 copy) or x1 scaled by the GPU
+        std::vector<SDL_Rect> frameRects;
+        frameRects.reserve(frames.size());
+        for(const auto& f : frames){
+            frameRects.push_back(f.souceRect);
+        }
+        SpriteCacheOptions cacheOptions = spriteOptions_;
+        cacheOptions.scale = prescaleSprites_ ? viewScale_ : 1;
+        std::shared_ptr<SpriteCache> sprites = library.acquire(renderer_, fullPath, palette_, swap, frameRects, cacheOptions);
+        if(!sprites){
+            SDL_Log("CatPet::loadAnimations: Failed to build sprite cache: %s", fullPath.c_str());
             continue; // skip this animation
         }
 
         // Now, create Animation and init it
         auto anim = std::make_unique<Animation>();
-        anim->init(tex, frames, desc.loop);
+        anim->init(sprites, frames, desc.loop);
+        anim->setCues(buildCues(desc, static_cast<int>(frames.size())));
 
         // then, set size of pet if first animation loaded
         if(!sizeSet){
-            setWidthAndHeight(tex, static_cast<int>(frames.size()));
+            setFrameSize(frames[0].souceRect.w, frames[0].souceRect.h);
             sizeSet = true;
         }
 
-        // now, store animation in map
-        PetState st = mapNameToState(desc.name);
-        // SDL_Log("CatPet::loadAnimations: animation '%s' mapped to state=%d, frames=%zu, loop=%d", desc.name.c_str(), (int)st, frames.size(), (int)desc.loop);
-        animations_[st] = std::move(anim);  // store animation
-        movementStates_[st] = desc.is_movement; // store movement state
+        // now, store animation under its interned name, any name is a state
+        // SDL_Log("CatPet::loadAnimations: animation '%s' -> state 0x%08x, frames=%zu, loop=%d", desc.name.c_str(), desc.id.value(), frames.size(), (int)desc.loop);
+        addState(desc.id, std::move(anim), desc.is_movement);
+        if(!desc.is_movement && desc.id != PetState::IDLE && desc.id != PetState::WALK && desc.id != PetState::CLICK){
+            extraStates_.push_back(desc.id); // sleep, groom... played now and then while resting
+        }
     }
 
-    if(animations_.empty()){
+    if(states_.empty()){
         SDL_Log("CatPet::loadAnimations: no animations loaded.");
     }
-    return !animations_.empty();
+    // manifest order is not stable (hash map), keep the random picks reproducible
+    std::sort(extraStates_.begin(), extraStates_.end(),
+        [](StateId a, StateId b){ return a.value() < b.value(); });
+    return !states_.empty();
 }
 
-void CatPet::setState(PetState state){
+void CatPet::setState(StateId state){
     // update state and reset animation
+    bool wasMoving = getMovementState();
     DesktopPet::setState(state);
-    auto it = animations_.find(state);
-    if(it != animations_.end() && it->second){
-        it->second->resetAnimation();
+    // leaving a movement state drops the remaining velocity
+    if(!getMovementState()){
+        body_.stop();
+        if(motion_){
+            motion_->stop(motionSlot_);
+        }
+        if(wasMoving){
+            moveSignal_.notify(false); // interrupted, e.g. by a click
+        }
+    } else if(motion_){
+        startMove(); // integrated by the batch from the next Game::update on
+    }
+    if(Animation* anim = getSlotAnimation(currentSlot_)){
+        anim->resetAnimation();
     }
 }
 
@@ -242,62 +256,105 @@ void CatPet::handleEventClick(SDL_Event& event){
     if(event.type == SDL_EVENT_MOUSE_BUTTON_DOWN){
         if(event.button.button == SDL_BUTTON_LEFT){
             setState(PetState::CLICK);
+            markInput(event); // latency is measured until the first CLICK frame is presented
+            say("喵~", 1.5f);
             // SDL_Log("CatPet::handleEventClick: Cat clicked, switching to CLICK state");
         }
     }
 }
 
 // actual actions
-void CatPet::setWalkAction(float dt){
-    // 如果触发
-    if(walkTimer_.update(dt)){
-        // do not break if already walking
-        if(currentState_ == PetState::WALK){
-            return;
+BehaviorSignal::Awaiter CatPet::walkTo(glm::vec2 target){
+    target_position_ = target;
+    moveSignal_.reset();
+    setState(PetState::WALK);
+    return moveSignal_.wait();
+}
+
+Behavior CatPet::wanderBehavior(){
+    for(;;){
+        // 清单里有额外的状态（sleep、groom……）时，偶尔先演一段；没有则不抽随机数
+        if(!extraStates_.empty() && rng_.randint(0, 3) == 0){
+            const int pick = rng_.randint(0, static_cast<int>(extraStates_.size()) - 1);
+            co_await play(extraStates_[pick]);
         }
-        // reset interval for next walk
-        walkTimer_.setInterval(tools::Random::randfloat(walkInterval_min_, walkInterval_max_), true);
-        target_positionX_ = tools::Random::randint(300, 800);
-        SDL_Log("CatPet::walkAround: Walking to new target position X=%d", target_positionX_);
-        setState(PetState::WALK);
+        // 主人打字越快，猫越安静：每分钟每 150 次按键多休息一倍，最多 4 倍
+        // 随机数照常抽取，统计只缩放时长，不改变随机序列
+        const float rest = rng_.randfloat(walkInterval_min_, walkInterval_max_);
+        const float kpm = static_cast<float>(tools::InputStats::getInstance().getKeysPerMinute());
+        co_await waitFor(rest * (1.0f + std::min(kpm / 150.0f, 3.0f)));
+        // stay on the ground for now, the body itself moves in 2D
+        // anywhere the whole (scaled) frame stays inside the window
+        const int maxX = std::max(0, screenW_ - petWidth_);
+        glm::vec2 target = {static_cast<float>(rng_.randint(0, maxX)), posY_};
+        SDL_Log("CatPet::wanderBehavior: Walking to new target position (%.0f,%.0f)", target.x, target.y);
+        co_await walkTo(target);
     }
 }
 
-void CatPet::walkAround(float dt){
+void CatPet::setPosition(float x, float y){
+    DesktopPet::setPosition(x, y);
+    body_.position = {posX_, posY_};
+    if(motion_){
+        motion_->setPosition(motionSlot_, body_.position);
+    }
+}
 
-    int dx = target_positionX_ - posX_; // distance to target
-    if(dx == 0){
-        // reached
-        setState(PetState::IDLE);
+void CatPet::attachMotion(tools::math::KinematicsBatch* batch){
+    motion_ = batch;
+    if(!motion_){
         return;
     }
-    bool toRight = (dx > 0);    // direction
-    
-    // set move speed direction
-    float baseSpeed = std::abs(moveSpeed_.x);
-    moveSpeed_.x = toRight ? baseSpeed : -baseSpeed;
+    body_.position = {posX_, posY_};
+    motionSlot_ = motion_->add(body_);
+    if(getMovementState()){
+        startMove();
+    }
+}
 
-    // set animation flipping based on direction
-    flipX_ = !toRight;
+void CatPet::startMove(){
+    // keeps the current velocity when only the target changed (walkTo while walking)
+    motion_->setPosition(motionSlot_, glm::vec2(posX_, posY_));
+    motion_->setTarget(motionSlot_, target_position_);
+}
 
-    // move pet
-    int step = static_cast<int>(moveSpeed_.x * dt);
-    // avoid stop when step is 0 (since there is a float to int conversion)
-    if(step == 0){
-        step = toRight ? 1 : -1;
+void CatPet::walkAround(float dt){
+
+    if(motion_){
+        // already integrated together with all other pets at the start of Game::update
+        const glm::vec2 position = motion_->getPosition(motionSlot_);
+        posX_ = position.x;
+        posY_ = position.y;
+        const glm::vec2 velocity = motion_->getVelocity(motionSlot_);
+        if(velocity.x != 0.0f){
+            flipX_ = velocity.x < 0.0f;
+        }
+        if(motion_->arrived(motionSlot_)){
+            moveSignal_.notify(true);
+            setState(PetState::IDLE);
+            SDL_Log("CatPet::walkAround: Reached target position (%.0f,%.0f)", target_position_.x, target_position_.y);
+        }
+        return;
     }
 
-    int newX = posX_ + step;
+    // sync in case position was set from outside
+    body_.position = {posX_, posY_};
+    if(!body_.moving || body_.target.x != target_position_.x || body_.target.y != target_position_.y){
+        body_.moveTo(target_position_);
+    }
 
-    // check if overshoot
-    if((toRight && newX >= target_positionX_) || (!toRight && newX <= target_positionX_)){
-        // reached or overshoot
-        posX_ = target_positionX_;
-        setState(PetState::IDLE);
-        SDL_Log("CatPet::walkAround: Reached target position X=%d", target_positionX_);
-        return;
+    bool arrived = body_.step(dt);
+    posX_ = body_.position.x;
+    posY_ = body_.position.y;
+
+    // set animation flipping based on direction
+    if(body_.velocity.x != 0.0f){
+        flipX_ = body_.velocity.x < 0.0f;
     }
 
-    // updatePosition(dt);
-    posX_ = newX;
-}
\ No newline at end of file
+    if(arrived){
+        moveSignal_.notify(true);
+        setState(PetState::IDLE);
+        SDL_Log("CatPet::walkAround: Reached target position (%.0f,%.0f)", target_position_.x, target_position_.y);
+    }
+}
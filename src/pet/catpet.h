@@ -2,40 +2,54 @@
 #define CATPET_H
 
 #include "core/desktoppet.h"
-#include "../tools/Timer.h"
+#include "../tools/kinematics.h"
 
 class CatPet : public DesktopPet{
 public:
-    CatPet();
+    // palette：清单 "palettes" 中的颜色变体，空为原色；manifest：动画清单路径，空为默认的猫
+    explicit CatPet(const std::string& palette = "", const std::string& manifest = "");
     ~CatPet();
 
     void init() override;
-    void update(float dt) override;
-    void render() override;
+    void update(Uint64 deltaNs) override;
     void handleEvent(SDL_Event& event) override;
+    void onAnimationFinished(StateId state) override;
     void clean() override;
     bool loadAnimations() override;
+    void setPosition(float x, float y) override;
+    void attachMotion(tools::math::KinematicsBatch* batch) override;
 
     // actual actions
     void walkAround(float dt); // 四处走动
-    void setWalkAction(float dt);
+
+    // behaviors, `co_await walkTo(target)` resumes with true when reached, false when interrupted
+    BehaviorSignal::Awaiter walkTo(glm::vec2 target);
+    Behavior wanderBehavior(); // 随机等待一段时间后走到随机位置，循环
 
 protected:
-    virtual void setState(PetState state) override; // 设置状态
+    virtual void setState(StateId state) override; // 设置状态
     virtual void handleEventClick(SDL_Event& event) override; // 处理点击事件
 
     glm::vec2 moveSpeed_ = {360, 0}; // 移动速度（像素/秒）
-
-    // Timer
-    Timer walkTimer_;
-    float walkInterval_min_ = 1.0f; // 每隔5秒尝试走动一次
-    float walkInterval_max_ = 5.0f; // 每隔15秒尝试走动一次
+    float moveAcceleration_ = 1800.0f; // 起步/减速的加速度（像素/秒^2）
+    tools::math::KinematicBody body_; // 浮点位置与速度（没有批量积分器时逐只积分）
+    tools::math::KinematicsBatch* motion_ = nullptr; // 批量积分器，位置与速度以其中的槽位为准
+    size_t motionSlot_ = 0;
+    void startMove(); // 进入移动状态：从当前位置朝 target_position_ 出发
+
+    // behavior
+    Behavior behavior_;         // 当前运行的行为
+    BehaviorSignal moveSignal_; // 走到目标/被打断
+    float walkInterval_min_ = 1.0f; // 每次走动前最少等待的秒数
+    float walkInterval_max_ = 5.0f; // 每次走动前最多等待的秒数
 
     // actual actions
-    int target_positionX_ = 500;  // walk to target position X
+    glm::vec2 target_position_ = {500, 0};  // walk to target position
 
     // animations
-    bool flipX_ = false; // 是否水平翻转
+    std::string palette_; // 颜色变体名
+    std::string manifest_; // 动画清单路径
+    std::vector<StateId> extraStates_; // 清单里 idle/walk/click 以外的非移动状态
     int viewScale_ = 3; // 视图缩放
     void changePetScale() override {petWidth_ *= viewScale_; petHeight_ *= viewScale_;} // 改变宠物缩放
 };
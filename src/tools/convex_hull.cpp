@@ -0,0 +1,112 @@
+#include "convex_hull.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tools{
+
+    namespace math{
+
+        namespace{
+
+            struct Vec{
+                double x, y;
+            };
+
+            inline Vec sub(Vec a, Vec b) {return Vec{a.x - b.x, a.y - b.y};}
+            inline double cross(Vec a, Vec b) {return a.x * b.y - a.y * b.x;}
+
+            // Andrew 单调链，去掉共线点
+            std::vector<Vec> hullOf(std::vector<Vec> points){
+                std::sort(points.begin(), points.end(), [](Vec a, Vec b){ return a.x < b.x || (a.x == b.x && a.y < b.y); });
+                points.erase(std::unique(points.begin(), points.end(), [](Vec a, Vec b){ return a.x == b.x && a.y == b.y; }), points.end());
+                if(points.size() < 3){
+                    return points;
+                }
+                std::vector<Vec> hull(points.size() * 2);
+                size_t k = 0;
+                for(size_t i = 0; i < points.size(); i++){
+                    while(k >= 2 && cross(sub(hull[k - 1], hull[k - 2]), sub(points[i], hull[k - 2])) <= 0) k--;
+                    hull[k++] = points[i];
+                }
+                for(size_t i = points.size() - 1, lower = k + 1; i-- > 0;){
+                    while(k >= lower && cross(sub(hull[k - 1], hull[k - 2]), sub(points[i], hull[k - 2])) <= 0) k--;
+                    hull[k++] = points[i];
+                }
+                hull.resize(k - 1);
+                return hull;
+            }
+
+        }
+
+        std::vector<SDL_FPoint> coverHull(const RowSpans& spans, const SDL_Rect& bounds, int maxVertices){
+            // 每行不透明范围的四个角点
+            std::vector<Vec> points;
+            for(size_t i = 0; i < spans.first.size(); i++){
+                if(spans.last[i] < spans.first[i]) continue;
+                const double y = spans.top + static_cast<double>(i);
+                const double x0 = spans.first[i], x1 = spans.last[i] + 1.0;
+                points.push_back(Vec{x0, y});
+                points.push_back(Vec{x1, y});
+                points.push_back(Vec{x0, y + 1.0});
+                points.push_back(Vec{x1, y + 1.0});
+            }
+            std::vector<Vec> hull = hullOf(std::move(points));
+            if(hull.size() < 3){
+                return {};
+            }
+
+            // 逐次去掉一条边：相邻两边延长到交点，选增加面积最小的；交点必须在两边的前方且不出 bounds
+            constexpr double kEps = 1e-6;
+            maxVertices = std::max(maxVertices, 3);
+            while(static_cast<int>(hull.size()) > maxVertices){
+                const size_t n = hull.size();
+                size_t best = n;
+                double bestArea = std::numeric_limits<double>::max();
+                Vec bestPoint{0.0, 0.0};
+                for(size_t i = 0; i < n; i++){
+                    const Vec a = hull[(i + n - 1) % n], b = hull[i], c = hull[(i + 1) % n], d = hull[(i + 2) % n];
+                    const Vec d1 = sub(b, a), d2 = sub(c, d);
+                    const double denom = cross(d1, d2);
+                    if(std::abs(denom) < kEps) continue; // 平行，不相交
+                    const double t = cross(sub(d, a), d2) / denom;
+                    const double s = cross(sub(d, a), d1) / denom;
+                    if(t <= 1.0 || s <= 1.0) continue;
+                    const Vec p{a.x + t * d1.x, a.y + t * d1.y};
+                    if(p.x < bounds.x - kEps || p.y < bounds.y - kEps ||
+                       p.x > bounds.x + bounds.w + kEps || p.y > bounds.y + bounds.h + kEps) continue;
+                    const double area = std::abs(cross(sub(c, b), sub(p, b))) * 0.5;
+                    if(area < bestArea){
+                        bestArea = area;
+                        best = i;
+                        bestPoint = p;
+                    }
+                }
+                if(best == n){
+                    return {};
+                }
+                hull[best] = bestPoint;
+                hull.erase(hull.begin() + static_cast<std::ptrdiff_t>((best + 1) % n));
+            }
+
+            std::vector<SDL_FPoint> out;
+            out.reserve(hull.size());
+            for(const Vec& v : hull){
+                out.push_back(SDL_FPoint{static_cast<float>(v.x), static_cast<float>(v.y)});
+            }
+            return out;
+        }
+
+        float polygonArea(const std::vector<SDL_FPoint>& polygon){
+            double twice = 0.0;
+            for(size_t i = 0, n = polygon.size(); i < n; i++){
+                const SDL_FPoint& a = polygon[i];
+                const SDL_FPoint& b = polygon[(i + 1) % n];
+                twice += static_cast<double>(a.x) * b.y - static_cast<double>(b.x) * a.y;
+            }
+            return static_cast<float>(std::abs(twice) * 0.5);
+        }
+
+    }
+
+}
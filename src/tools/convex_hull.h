@@ -0,0 +1,26 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+namespace tools{
+
+    namespace math{
+
+        // 一帧里不透明像素的逐行范围：第 top + i 行是 [first[i], last[i]]（含两端），last < first 表示整行透明
+        struct RowSpans{
+            int top = 0;
+            std::vector<int> first;
+            std::vector<int> last;
+        };
+
+        // 包住所有不透明像素的凸多边形（像素角点坐标，顶点按顺序排列）
+        // 先求精确凸包，再把最短的边并入相邻两边的延长线，直到不超过 maxVertices 个顶点；
+        // 多边形只会变大、不会越出 bounds（不采样到相邻的帧），做不到时返回空
+        std::vector<SDL_FPoint> coverHull(const RowSpans& spans, const SDL_Rect& bounds, int maxVertices);
+
+        float polygonArea(const std::vector<SDL_FPoint>& polygon);
+
+    }
+
+}
@@ -0,0 +1,68 @@
+#include "embedded_assets.h"
+
+#ifdef PATPAT_EMBED_ASSETS
+// 由 tools/asset_baker 在构建目录生成：kEmbeddedFiles / kEmbeddedManifests 及其数量
+#include "embedded_assets_data.h"
+#else
+namespace tools::assets{
+namespace{
+constexpr const EmbeddedFile* kEmbeddedFiles = nullptr;
+constexpr size_t kEmbeddedFileCount = 0;
+constexpr const EmbeddedManifest* kEmbeddedManifests = nullptr;
+constexpr size_t kEmbeddedManifestCount = 0;
+}
+}
+#endif
+
+namespace tools{
+
+namespace assets{
+
+namespace{
+
+// 路径比较时 '\\' 与 '/' 视为相同（Windows 上的旧路径写法）
+bool samePath(const char* embedded, const std::string& path){
+    size_t i = 0;
+    for(; embedded[i] != '\0'; i++){
+        if(i >= path.size()) return false;
+        const char a = embedded[i], b = path[i] == '\\' ? '/' : path[i];
+        if(a != b) return false;
+    }
+    return i == path.size();
+}
+
+}
+
+bool hasEmbeddedAssets(){
+    return kEmbeddedFileCount > 0 || kEmbeddedManifestCount > 0;
+}
+
+const EmbeddedManifest* findManifest(const std::string& path){
+    for(size_t i = 0; i < kEmbeddedManifestCount; i++){
+        if(samePath(kEmbeddedManifests[i].path, path)) return &kEmbeddedManifests[i];
+    }
+    return nullptr;
+}
+
+const EmbeddedFile* findFile(const std::string& path){
+    for(size_t i = 0; i < kEmbeddedFileCount; i++){
+        if(samePath(kEmbeddedFiles[i].path, path)) return &kEmbeddedFiles[i];
+    }
+    return nullptr;
+}
+
+SDL_IOStream* openFile(const std::string& path){
+    const EmbeddedFile* file = findFile(path);
+    if(!file){
+        return nullptr;
+    }
+    SDL_IOStream* io = SDL_IOFromConstMem(file->data, file->size);
+    if(!io){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Embedded asset %s: %s", path.c_str(), SDL_GetError());
+    }
+    return io;
+}
+
+} // namespace assets
+
+} // namespace tools
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <string>
+
+// 编译期嵌入的资源（-DPATPAT_EMBED_ASSETS=ON）
+// 构建时 tools/asset_baker 校验清单，把帧矩形、时长等生成 constexpr 表，图片与音效的字节直接编进可执行文件，
+// 运行时按原来的相对路径查表，用 SDL_IOFromConstMem 读取，不访问文件系统也不解析 JSON
+// 没有开启时表为空，所有查询返回空，调用者照常读文件
+
+namespace tools{
+
+namespace assets{
+
+struct EmbeddedFile{
+    const char* path;           // 与运行时的相对路径相同，例如 "resources/sprites/CatPet/idle_anim.png"
+    const unsigned char* data;
+    size_t size;
+};
+
+struct EmbeddedFrame{
+    int x, y, w, h;
+    int durationMS;
+};
+
+struct EmbeddedCue{
+    int frame;
+    const char* sound;
+    int priority;
+    float volume;
+};
+
+// 帧已按默认值补全、按网格展开，运行时不再需要纹理尺寸
+struct EmbeddedAnimation{
+    const char* name;
+    const char* path;           // 相对 basePath
+    const EmbeddedFrame* frames;
+    size_t frameCount;
+    const EmbeddedCue* cues;
+    size_t cueCount;
+    int frameWidth, frameHeight;
+    int fps;
+    bool loop;
+    bool isMovement;
+};
+
+struct EmbeddedSound{
+    const char* name;
+    const char* path;           // 相对 basePath
+    float volume;
+};
+
+struct EmbeddedColor{
+    Uint32 from, to;            // ARGB8888
+};
+
+struct EmbeddedPalette{
+    const char* name;
+    const EmbeddedColor* colors;
+    size_t count;
+};
+
+struct EmbeddedManifest{
+    const char* path;           // 清单的相对路径
+    int version;
+    const char* basePath;       // 已补上末尾的 '/'
+    const EmbeddedAnimation* animations;
+    size_t animationCount;
+    const EmbeddedSound* sounds;
+    size_t soundCount;
+    const EmbeddedPalette* palettes;
+    size_t paletteCount;
+};
+
+// 是否编进了资源
+bool hasEmbeddedAssets();
+
+// 按路径查找（'\\' 与 '/' 视为相同），没有嵌入返回空
+const EmbeddedManifest* findManifest(const std::string& path);
+const EmbeddedFile* findFile(const std::string& path);
+
+// 嵌入的文件打开为只读流（SDL_IOFromConstMem，不复制），没有嵌入返回空；调用者负责关闭
+SDL_IOStream* openFile(const std::string& path);
+
+} // namespace assets
+
+} // namespace tools
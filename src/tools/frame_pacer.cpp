@@ -0,0 +1,149 @@
+#include "frame_pacer.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace tools{
+
+const char* FramePacer::getModeName(Mode mode)
+{
+    switch(mode){
+    case Mode::Sleep:  return "sleep";
+    case Mode::Hybrid: return "hybrid";
+    case Mode::VSync:  return "vsync";
+    }
+    return "unknown";
+}
+
+void FramePacer::setTargetFps(double fps)
+{
+    if(fps <= 0.0) fps = 60.0;
+    periodNs_ = static_cast<uint64_t>(1.0e9 / fps + 0.5);
+}
+
+void FramePacer::calibrate()
+{
+    // 请求 1ms 睡眠若干次，取最大超时
+    overshootNs_ = 0;
+    for(int i = 0; i < 8; i++){
+        const uint64_t before = SDL_GetTicksNS();
+        SDL_DelayNS(1'000'000);
+        const uint64_t slept = SDL_GetTicksNS() - before;
+        if(slept > 1'000'000){
+            overshootNs_ = std::max(overshootNs_, slept - 1'000'000);
+        }
+    }
+    slackNs_ = std::clamp(overshootNs_ + kSlackMarginNs, kMinSlackNs, kMaxSlackNs);
+    SDL_Log("FramePacer: sleep overshoot %.3f ms, spin slack %.3f ms",
+        overshootNs_ / 1.0e6, slackNs_ / 1.0e6);
+}
+
+void FramePacer::start()
+{
+    lastFrameNs_ = SDL_GetTicksNS();
+    deadline_ = lastFrameNs_ + periodNs_;
+}
+
+void FramePacer::sleepUntil(uint64_t deadline)
+{
+    const uint64_t now = SDL_GetTicksNS();
+    if(now >= deadline) return;
+    const uint64_t requested = deadline - now;
+    SDL_DelayNS(requested);
+    const uint64_t slept = SDL_GetTicksNS() - now;
+
+    // 余量跟踪睡眠超时：变大立即跟上，变小时缓慢衰减
+    const uint64_t overshoot = slept > requested ? slept - requested : 0;
+    overshootNs_ = std::max(overshoot, overshootNs_ - overshootNs_ / 32);
+    slackNs_ = std::clamp(overshootNs_ + kSlackMarginNs, kMinSlackNs, kMaxSlackNs);
+}
+
+void FramePacer::spinUntil(uint64_t deadline)
+{
+    const uint64_t begin = SDL_GetTicksNS();
+    uint64_t now = begin;
+    while(now < deadline){
+        // 离目标还远时让出时间片，最后 50us 纯忙等
+        if(deadline - now > 50'000){
+            std::this_thread::yield();
+        } else{
+            SDL_CPUPauseInstruction();
+        }
+        now = SDL_GetTicksNS();
+    }
+    spinNs_ += now - begin;
+}
+
+void FramePacer::waitForNextFrame()
+{
+    if(mode_ == Mode::VSync){
+        // 呈现已经等过垂直同步，这里只统计呈现间隔相对刷新周期的偏差
+        const uint64_t now = SDL_GetTicksNS();
+        recordError(static_cast<int64_t>(now - lastFrameNs_) - static_cast<int64_t>(periodNs_));
+        lastFrameNs_ = now;
+        return;
+    }
+
+    uint64_t now = SDL_GetTicksNS();
+    if(now >= deadline_ + periodNs_){
+        // 落后超过一帧：丢掉错过的排期，从现在重新开始，不连续补帧
+        missed_++;
+        frames_++;
+        deadline_ = now + periodNs_;
+        return;
+    }
+
+    if(now < deadline_){
+        if(mode_ == Mode::Hybrid){
+            if(deadline_ - now > slackNs_){
+                sleepUntil(deadline_ - slackNs_);
+            }
+            spinUntil(deadline_);
+        } else{
+            sleepUntil(deadline_);
+        }
+        now = SDL_GetTicksNS();
+    }
+    recordError(static_cast<int64_t>(now - deadline_));
+    deadline_ += periodNs_; // 绝对排期：下一帧目标只由起点和周期决定
+}
+
+void FramePacer::recordError(int64_t errorNs)
+{
+    frames_++;
+    const double e = static_cast<double>(errorNs);
+    const uint64_t magnitude = static_cast<uint64_t>(errorNs < 0 ? -errorNs : errorNs);
+    jitterMax_ = std::max(jitterMax_, magnitude);
+    errorSum_ += static_cast<double>(magnitude);
+
+    const uint64_t n = frames_ - missed_;
+    const double delta = e - errorMean_;
+    errorMean_ += delta / static_cast<double>(n);
+    errorM2_ += delta * (e - errorMean_);
+}
+
+double FramePacer::getJitterMeanNs() const
+{
+    const uint64_t n = frames_ - missed_;
+    return n > 0 ? errorSum_ / static_cast<double>(n) : 0.0;
+}
+
+double FramePacer::getJitterStdDevNs() const
+{
+    const uint64_t n = frames_ - missed_;
+    return n > 1 ? std::sqrt(errorM2_ / static_cast<double>(n - 1)) : 0.0;
+}
+
+void FramePacer::resetStats()
+{
+    frames_ = 0;
+    missed_ = 0;
+    errorSum_ = 0.0;
+    errorMean_ = 0.0;
+    errorM2_ = 0.0;
+    jitterMax_ = 0;
+    spinNs_ = 0;
+}
+
+} // namespace tools
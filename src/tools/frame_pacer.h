@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tools{
+
+// 帧率控制
+// - 按绝对时间点排期：第 k 帧的目标时刻 = 起点 + k * 周期，误差不会逐帧累积
+// - Hybrid：先粗睡到目标前一小段（余量按实测的睡眠超时自动校准），剩下的忙等/让出 CPU
+// - Sleep：只睡眠（对比用，精度取决于系统定时器）
+// - VSync：由 SDL_RenderPresent 阻塞等待垂直同步，这里只做统计
+// 落后超过一整帧时不补帧，直接以当前时间重新排期
+// 抖动 = 实际醒来（VSync 模式下为两次呈现间隔）与目标的偏差
+class FramePacer{
+public:
+    enum class Mode {Sleep, Hybrid, VSync};
+
+    void setTargetFps(double fps);
+    double getTargetFps() const {return 1.0e9 / static_cast<double>(periodNs_);}
+    uint64_t getPeriodNs() const {return periodNs_;}
+    float getPeriodSeconds() const {return static_cast<float>(periodNs_) / 1.0e9f;}
+
+    void setMode(Mode mode) {mode_ = mode;}
+    Mode getMode() const {return mode_;}
+    static const char* getModeName(Mode mode);
+
+    // 测几次短睡眠的超时，作为初始余量
+    void calibrate();
+    // 以当前时间为起点开始排期
+    void start();
+    // 阻塞到本帧的目标时刻，然后排下一帧
+    void waitForNextFrame();
+
+    // 统计（自上次 resetStats() 起）
+    uint64_t getFrameCount() const {return frames_;}
+    uint64_t getMissedCount() const {return missed_;}
+    double getJitterMeanNs() const;     // 偏差绝对值的平均
+    double getJitterStdDevNs() const;   // 偏差（带符号）的标准差
+    uint64_t getJitterMaxNs() const {return jitterMax_;}
+    uint64_t getSpinNs() const {return spinNs_;}    // 忙等累计耗时
+    uint64_t getSlackNs() const {return slackNs_;}
+    void resetStats();
+
+private:
+    void sleepUntil(uint64_t deadline);
+    void spinUntil(uint64_t deadline);
+    void recordError(int64_t errorNs);
+
+    static constexpr uint64_t kMinSlackNs = 200'000;     // 0.2ms
+    static constexpr uint64_t kMaxSlackNs = 4'000'000;   // 4ms
+    static constexpr uint64_t kSlackMarginNs = 100'000;  // 在实测超时上再留 0.1ms
+
+    Mode mode_ = Mode::Hybrid;
+    uint64_t periodNs_ = 16'666'667;
+    uint64_t deadline_ = 0;         // 本帧目标时刻（SDL_GetTicksNS）
+    uint64_t lastFrameNs_ = 0;      // VSync：上一帧开始时刻
+
+    uint64_t slackNs_ = 2'000'000;  // 提前醒来的余量
+    uint64_t overshootNs_ = 0;      // 睡眠超时的衰减最大值
+
+    uint64_t frames_ = 0;
+    uint64_t missed_ = 0;
+    double errorSum_ = 0.0;         // Welford
+    double errorMean_ = 0.0;
+    double errorM2_ = 0.0;
+    uint64_t jitterMax_ = 0;
+    uint64_t spinNs_ = 0;
+};
+
+} // namespace tools
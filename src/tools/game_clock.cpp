@@ -0,0 +1,50 @@
+#include "game_clock.h"
+#include <cmath>
+
+namespace tools{
+
+uint64_t GameClock::sampleFrame(uint64_t nominalNs)
+{
+    uint64_t frame = 0;
+    if(mode_ == Mode::Scaled && !paused_){
+        if(scale_ == 1.0){
+            frame = nominalNs;
+        } else{
+            const double scaled = static_cast<double>(nominalNs) * scale_ + carry_;
+            const double whole = std::floor(scaled);
+            carry_ = scaled - whole;
+            frame = static_cast<uint64_t>(whole);
+        }
+    }
+    frame += pendingNs_;
+    pendingNs_ = 0;
+    return advanceExact(frame);
+}
+
+uint64_t GameClock::advanceExact(uint64_t frameNs)
+{
+    frameNs_ = frameNs;
+    nowNs_ += frameNs;
+    frames_++;
+    return frameNs;
+}
+
+void GameClock::setTimeScale(double scale)
+{
+    scale_ = scale > 0.0 ? scale : 0.0;
+    carry_ = 0.0;
+}
+
+void GameClock::reset()
+{
+    nowNs_ = 0;
+    frameNs_ = 0;
+    frames_ = 0;
+    pendingNs_ = 0;
+    scale_ = 1.0;
+    carry_ = 0.0;
+    paused_ = false;
+    mode_ = Mode::Scaled;
+}
+
+} // namespace tools
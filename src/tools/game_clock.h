@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tools{
+
+// 虚拟游戏时钟（单例）：整数纳秒，每帧开始时采样一次，一帧之内读到的时间不变
+// 模拟里的时间（定时器、动画、行为）都从这里来，帧率控制与性能统计仍用真实时间
+// - 倍率：每帧前进 名义帧长 x 倍率，不足 1 ns 的部分累计到下一帧，长时间运行不漂移
+// - 暂停：帧照常跑、画面照常画，虚拟时间不动；step() 可以单步
+// - 步进模式（测试用）：只在 step() 时前进，与真实帧率无关
+// 只在模拟线程使用，不加锁
+class GameClock{
+public:
+    enum class Mode : uint8_t {Scaled, Stepped};
+
+    static GameClock& getInstance(){
+        static GameClock instance;
+        return instance;
+    }
+
+    // 每帧调用一次：按名义帧长推进（暂停/步进模式下为 0），加上 step() 请求的时间，返回本帧帧长
+    uint64_t sampleFrame(uint64_t nominalNs);
+    // 每帧调用一次：按给定帧长精确推进，忽略倍率与暂停（回放录制的帧长）
+    uint64_t advanceExact(uint64_t frameNs);
+    // 请求下一次采样额外前进 ns（暂停时单步、步进模式）
+    void step(uint64_t ns) {pendingNs_ += ns;}
+
+    uint64_t getNowNs() const {return nowNs_;}         // 本帧的虚拟时间
+    uint64_t getFrameNs() const {return frameNs_;}     // 本帧的虚拟帧长
+    float getFrameSeconds() const {return static_cast<float>(static_cast<double>(frameNs_) / 1.0e9);}
+    double getNowSeconds() const {return static_cast<double>(nowNs_) / 1.0e9;}
+    uint64_t getFrameIndex() const {return frames_;}
+
+    void setTimeScale(double scale);   // < 0 按 0 处理
+    double getTimeScale() const {return scale_;}
+    void pause() {paused_ = true;}
+    void resume() {paused_ = false;}
+    bool isPaused() const {return paused_;}
+    void setMode(Mode mode) {mode_ = mode;}
+    Mode getMode() const {return mode_;}
+
+    void reset(); // 回到 0，倍率 1，不暂停（测试用）
+
+private:
+    GameClock() = default;
+    GameClock(const GameClock&) = delete;
+    GameClock& operator=(const GameClock&) = delete;
+
+    uint64_t nowNs_ = 0;
+    uint64_t frameNs_ = 0;
+    uint64_t frames_ = 0;
+    uint64_t pendingNs_ = 0;  // step() 请求的时间
+    double scale_ = 1.0;
+    double carry_ = 0.0;      // 倍率换算后不足 1 ns 的余量
+    bool paused_ = false;
+    Mode mode_ = Mode::Scaled;
+};
+
+} // namespace tools
@@ -0,0 +1,147 @@
+#include "tools.h"
+#include <algorithm>
+
+// X11 的头文件定义了 None/Bool/Status 等宏，只在这个文件里包含
+#ifdef PATPAT_HAVE_X11
+#include <X11/Xlib.h>
+#include <X11/extensions/shape.h>
+#endif
+
+namespace tools{
+
+    namespace UI{
+
+#ifdef PATPAT_HAVE_X11
+        namespace{
+
+            struct X11Target{
+                Display* display = nullptr;
+                ::Window window = 0;
+            };
+
+            // SDL 用 X11 驱动时才有这两个属性（Wayland、dummy 驱动下为空）
+            bool getX11Target(SDL_Window* window, X11Target& out){
+                if(!window){
+                    return false;
+                }
+                const SDL_PropertiesID props = SDL_GetWindowProperties(window);
+                out.display = static_cast<Display*>(SDL_GetPointerProperty(props, SDL_PROP_WINDOW_X11_DISPLAY_POINTER, nullptr));
+                out.window = static_cast<::Window>(SDL_GetNumberProperty(props, SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0));
+                return out.display && out.window;
+            }
+
+            // 两组矩形覆盖的区域是否相同：按所有边坐标切成网格，逐格比较（只用于检查，矩形数量不多）
+            bool sameCoverage(const std::vector<SDL_Rect>& a, const std::vector<SDL_Rect>& b){
+                std::vector<int> xs, ys;
+                for(const auto* set : {&a, &b}){
+                    for(const SDL_Rect& r : *set){
+                        if(r.w <= 0 || r.h <= 0) continue;
+                        xs.push_back(r.x); xs.push_back(r.x + r.w);
+                        ys.push_back(r.y); ys.push_back(r.y + r.h);
+                    }
+                }
+                std::sort(xs.begin(), xs.end());
+                xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+                std::sort(ys.begin(), ys.end());
+                ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+                auto covers = [](const std::vector<SDL_Rect>& set, int x, int y){
+                    const SDL_Point p{x, y};
+                    for(const SDL_Rect& r : set){
+                        if(SDL_PointInRect(&p, &r)) return true;
+                    }
+                    return false;
+                };
+                for(size_t i = 0; i + 1 < xs.size(); i++){
+                    for(size_t j = 0; j + 1 < ys.size(); j++){
+                        // 每格取左上角的像素，格内覆盖情况一致
+                        if(covers(a, xs[i], ys[j]) != covers(b, xs[i], ys[j])){
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+
+        }
+
+        bool SupportsInputShape(SDL_Window* window){
+            X11Target target;
+            if(!getX11Target(window, target)){
+                return false;
+            }
+            // 输入区域（ShapeInput）需要 SHAPE 1.1
+            int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+            if(!XShapeQueryExtension(target.display, &eventBase, &errorBase) ||
+               !XShapeQueryVersion(target.display, &major, &minor)){
+                return false;
+            }
+            return major > 1 || (major == 1 && minor >= 1);
+        }
+
+        bool SetWindowInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects){
+            X11Target target;
+            if(!getX11Target(window, target)){
+                return false;
+            }
+            // XRectangle 是 16 位坐标，裁剪到范围内
+            std::vector<XRectangle> shape;
+            shape.reserve(rects.size());
+            for(const SDL_Rect& r : rects){
+                const int x0 = std::clamp(r.x, -32768, 32767), y0 = std::clamp(r.y, -32768, 32767);
+                const int x1 = std::clamp(r.x + r.w, -32768, 32767), y1 = std::clamp(r.y + r.h, -32768, 32767);
+                if(x1 <= x0 || y1 <= y0) continue;
+                shape.push_back(XRectangle{static_cast<short>(x0), static_cast<short>(y0),
+                                           static_cast<unsigned short>(x1 - x0), static_cast<unsigned short>(y1 - y0)});
+            }
+            // 空列表即空的输入区域：整个窗口点击穿透
+            XShapeCombineRectangles(target.display, target.window, ShapeInput, 0, 0,
+                                    shape.data(), static_cast<int>(shape.size()), ShapeSet, Unsorted);
+            XFlush(target.display);
+            return true;
+        }
+
+        bool CheckInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects){
+            X11Target target;
+            if(!getX11Target(window, target)){
+                return false;
+            }
+            XSync(target.display, False); // 先让服务器处理完之前的请求
+            int count = 0, ordering = 0;
+            XRectangle* got = XShapeGetRectangles(target.display, target.window, ShapeInput, &count, &ordering);
+            std::vector<SDL_Rect> actual;
+            actual.reserve(static_cast<size_t>(std::max(count, 0)));
+            for(int i = 0; i < count; i++){
+                actual.push_back(SDL_Rect{got[i].x, got[i].y, got[i].width, got[i].height});
+            }
+            if(got){
+                XFree(got);
+            }
+            if(!sameCoverage(rects, actual)){
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "X11: input shape mismatch, expected %zu rects, server has %d", rects.size(), count);
+                return false;
+            }
+            return true;
+        }
+
+#else
+        bool SupportsInputShape(SDL_Window* window){
+            (void)window;
+            return false;
+        }
+
+        bool SetWindowInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects){
+            (void)window;
+            (void)rects;
+            return false;
+        }
+
+        bool CheckInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects){
+            (void)window;
+            (void)rects;
+            return false;
+        }
+#endif // PATPAT_HAVE_X11
+
+    }
+}
@@ -0,0 +1,488 @@
+#include "input_stats.h"
+#include "random.h"
+#include <chrono>
+#include <cmath>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace tools{
+
+namespace{
+
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kRecordSize = 8 + 4 * kInputKindCount;
+
+void putFixed(uint8_t* out, uint64_t v, int bytes){
+    for(int i = 0; i < bytes; i++){
+        out[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+uint64_t getFixed(const uint8_t* in, int bytes){
+    uint64_t v = 0;
+    for(int i = 0; i < bytes; i++){
+        v |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return v;
+}
+
+uint64_t currentUnixMinute(){
+    SDL_Time now = 0;
+    if(!SDL_GetCurrentTime(&now) || now < 0){
+        return 0;
+    }
+    return static_cast<uint64_t>(now) / 60'000'000'000ULL;
+}
+
+} // namespace
+
+// -------------------------------------------------------
+// SDLInputSource
+
+bool SDLInputSource::start(InputStats& stats, int sourceId)
+{
+    stats_ = &stats;
+    sourceId_ = sourceId;
+    return true;
+}
+
+void SDLInputSource::count(const SDL_Event& event)
+{
+    if(!stats_) return;
+    switch(event.type){
+    case SDL_EVENT_KEY_DOWN:
+        if(!event.key.repeat){ // 按住不放的自动重复不算
+            stats_->record(sourceId_, InputKind::Key);
+        }
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        stats_->record(sourceId_, InputKind::MouseButton);
+        break;
+    case SDL_EVENT_MOUSE_WHEEL:
+        stats_->record(sourceId_, InputKind::Wheel);
+        break;
+    case SDL_EVENT_MOUSE_MOTION:
+        stats_->record(sourceId_, InputKind::MouseMove);
+        break;
+    default:
+        break;
+    }
+}
+
+void SDLInputSource::onEvent(void* userdata, SDL_Event& event)
+{
+    static_cast<SDLInputSource*>(userdata)->count(event);
+}
+
+// -------------------------------------------------------
+// SyntheticInputSource
+
+SyntheticInputSource::SyntheticInputSource(float keysPerMinute, float clicksPerMinute, uint64_t seed)
+    : keysPerMinute_(keysPerMinute), clicksPerMinute_(clicksPerMinute), seed_(seed)
+{
+}
+
+bool SyntheticInputSource::start(InputStats& stats, int sourceId)
+{
+    if(thread_.joinable()) return true;
+    stopping_ = false;
+    thread_ = std::thread(&SyntheticInputSource::threadMain, this, &stats, sourceId);
+    return true;
+}
+
+void SyntheticInputSource::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if(thread_.joinable()){
+        thread_.join();
+    }
+}
+
+void SyntheticInputSource::threadMain(InputStats* stats, int sourceId)
+{
+    using Clock = std::chrono::steady_clock;
+    RandomStream rng(seed_);
+    // 泊松过程：下一次事件的间隔 = -ln(U) / 速率
+    auto nextGap = [&rng](float perMinute) -> Clock::duration {
+        const double seconds = -std::log(1.0 - rng.unitDouble()) * 60.0 / perMinute;
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    };
+    const Clock::time_point never = Clock::time_point::max();
+    Clock::time_point nextKey = keysPerMinute_ > 0.0f ? Clock::now() + nextGap(keysPerMinute_) : never;
+    Clock::time_point nextClick = clicksPerMinute_ > 0.0f ? Clock::now() + nextGap(clicksPerMinute_) : never;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!stopping_){
+        const Clock::time_point deadline = nextKey < nextClick ? nextKey : nextClick;
+        if(deadline == never){
+            wake_.wait(lock, [this]{ return stopping_; });
+            break;
+        }
+        if(wake_.wait_until(lock, deadline, [this]{ return stopping_; })){
+            break;
+        }
+        const Clock::time_point now = Clock::now();
+        while(nextKey <= now){
+            stats->record(sourceId, InputKind::Key);
+            nextKey += nextGap(keysPerMinute_);
+        }
+        while(nextClick <= now){
+            stats->record(sourceId, InputKind::MouseButton);
+            nextClick += nextGap(clicksPerMinute_);
+        }
+    }
+}
+
+// -------------------------------------------------------
+// GlobalHookInputSource
+
+#ifdef _WIN32
+namespace{
+
+// 低级钩子回调没有 userdata，同一时间只允许一个钩子来源
+std::atomic<InputStats*> g_hookStats{nullptr};
+int g_hookSourceId = -1;
+bool g_keyDown[256] = {}; // 只在钩子线程访问，用来过滤自动重复
+
+LRESULT CALLBACK keyboardHookProc(int code, WPARAM wParam, LPARAM lParam)
+{
+    InputStats* stats = g_hookStats.load(std::memory_order_relaxed);
+    if(code == HC_ACTION && stats){
+        const KBDLLHOOKSTRUCT* info = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+        const DWORD vk = info->vkCode & 0xFF;
+        if(wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN){
+            if(!g_keyDown[vk]){
+                g_keyDown[vk] = true;
+                stats->record(g_hookSourceId, InputKind::Key);
+            }
+        } else if(wParam == WM_KEYUP || wParam == WM_SYSKEYUP){
+            g_keyDown[vk] = false;
+        }
+    }
+    return CallNextHookEx(nullptr, code, wParam, lParam);
+}
+
+LRESULT CALLBACK mouseHookProc(int code, WPARAM wParam, LPARAM lParam)
+{
+    InputStats* stats = g_hookStats.load(std::memory_order_relaxed);
+    if(code == HC_ACTION && stats){
+        switch(wParam){
+        case WM_LBUTTONDOWN:
+        case WM_RBUTTONDOWN:
+        case WM_MBUTTONDOWN:
+        case WM_XBUTTONDOWN:
+            stats->record(g_hookSourceId, InputKind::MouseButton);
+            break;
+        case WM_MOUSEWHEEL:
+        case WM_MOUSEHWHEEL:
+            stats->record(g_hookSourceId, InputKind::Wheel);
+            break;
+        case WM_MOUSEMOVE:
+            stats->record(g_hookSourceId, InputKind::MouseMove);
+            break;
+        default:
+            break;
+        }
+    }
+    return CallNextHookEx(nullptr, code, wParam, lParam);
+}
+
+} // namespace
+
+bool GlobalHookInputSource::start(InputStats& stats, int sourceId)
+{
+    InputStats* expected = nullptr;
+    if(!g_hookStats.compare_exchange_strong(expected, &stats)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "GlobalHookInputSource: another hook source is already running");
+        return false;
+    }
+    g_hookSourceId = sourceId;
+    thread_ = std::thread(&GlobalHookInputSource::threadMain, this);
+    return true;
+}
+
+void GlobalHookInputSource::stop()
+{
+    if(!thread_.joinable()) return;
+    // 等线程建好消息队列（拿到线程 id）后再投递 WM_QUIT
+    unsigned long id = 0;
+    while((id = threadId_.load(std::memory_order_acquire)) == 0){
+        std::this_thread::yield();
+    }
+    PostThreadMessageW(id, WM_QUIT, 0, 0);
+    thread_.join();
+    threadId_.store(0, std::memory_order_relaxed);
+    g_hookStats.store(nullptr, std::memory_order_relaxed);
+}
+
+void GlobalHookInputSource::threadMain()
+{
+    MSG msg;
+    PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE); // 创建本线程的消息队列
+    HINSTANCE module = GetModuleHandleW(nullptr);
+    HHOOK keyboard = SetWindowsHookExW(WH_KEYBOARD_LL, keyboardHookProc, module, 0);
+    HHOOK mouse = SetWindowsHookExW(WH_MOUSE_LL, mouseHookProc, module, 0);
+    if(!keyboard || !mouse){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "GlobalHookInputSource: SetWindowsHookEx failed (%lu)", GetLastError());
+    }
+    threadId_.store(GetCurrentThreadId(), std::memory_order_release);
+
+    // 低级钩子的回调在本线程的消息循环里执行
+    while(GetMessageW(&msg, nullptr, 0, 0) > 0){
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+
+    if(keyboard) UnhookWindowsHookEx(keyboard);
+    if(mouse) UnhookWindowsHookEx(mouse);
+}
+#endif // _WIN32
+
+// -------------------------------------------------------
+// InputStats
+
+int InputStats::addSource(std::unique_ptr<InputSource> source)
+{
+    if(!source) return -1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(inputs_.size() >= static_cast<size_t>(kMaxSources)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputStats: too many sources (max %d)", kMaxSources);
+        return -1;
+    }
+    const int id = static_cast<int>(inputs_.size());
+    if(running_ && !source->start(*this, id)){
+        return -1;
+    }
+    inputs_.push_back(std::move(source));
+    return id;
+}
+
+bool InputStats::start(const std::string& persistPath)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(running_) return true;
+    if(!persistPath.empty()){
+        openPersistFile(persistPath); // 失败只是不持久化
+    }
+    for(size_t i = 0; i < inputs_.size(); i++){
+        if(!inputs_[i]->start(*this, static_cast<int>(i))){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputStats: source '%s' failed to start", inputs_[i]->getName());
+        }
+    }
+    stopping_ = false;
+    running_ = true;
+    thread_ = std::thread(&InputStats::threadMain, this);
+    return true;
+}
+
+void InputStats::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!running_) return;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+
+    // 来源停下后再做最后一次汇总，不满一分钟的部分也写进文件
+    for(auto& input : inputs_){
+        input->stop();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    rollSecond();
+    appendRecord(minuteAcc_);
+    minuteAcc_ = Bucket{};
+    if(file_){
+        SDL_CloseIO(file_);
+        file_ = nullptr;
+    }
+    inputs_.clear();
+    // 本次会话的计数已经写进文件，清零以便再次 start() 时重新读回
+    for(auto& source : sources_){
+        for(auto& c : source.counts){
+            c.store(0, std::memory_order_relaxed);
+        }
+    }
+    lastSeen_ = {};
+    running_ = false;
+}
+
+void InputStats::threadMain()
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point next = Clock::now() + std::chrono::seconds(1);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!wake_.wait_until(lock, next, [this]{ return stopping_; })){
+        const Clock::time_point now = Clock::now();
+        // 休眠/挂起回来时不逐秒补，只补一分钟以内的
+        if(now - next > std::chrono::minutes(1)){
+            next = now;
+        }
+        while(next <= now){
+            rollSecond();
+            next += std::chrono::seconds(1);
+        }
+    }
+}
+
+void InputStats::tick()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    rollSecond();
+}
+
+void InputStats::rollSecond()
+{
+    Bucket& second = seconds_.push(); // 最旧的一格
+    for(size_t k = 0; k < kInputKindCount; k++){
+        uint64_t total = 0;
+        for(const auto& source : sources_){
+            total += source.counts[k].load(std::memory_order_relaxed);
+        }
+        const uint64_t delta64 = total - lastSeen_[k];
+        const uint32_t delta = delta64 > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(delta64);
+        lastSeen_[k] = total;
+
+        // 滚动和：加上新的一秒，减去被覆盖的最旧一秒
+        rollingSum_[k] = rollingSum_[k] + delta - second[k];
+        second[k] = delta;
+        minuteAcc_[k] += delta;
+        rates_[k].store(rollingSum_[k], std::memory_order_relaxed);
+    }
+
+    if(++secondInMinute_ < kSeconds) return;
+    secondInMinute_ = 0;
+    minutes_.push() = minuteAcc_;
+    appendRecord(minuteAcc_);
+    for(size_t k = 0; k < kInputKindCount; k++){
+        hourAcc_[k] += minuteAcc_[k];
+    }
+    minuteAcc_ = Bucket{};
+
+    if(++minuteInHour_ < kMinutes) return;
+    minuteInHour_ = 0;
+    hours_.push() = hourAcc_;
+    hourAcc_ = Bucket{};
+}
+
+void InputStats::appendRecord(const Bucket& minute)
+{
+    if(!file_) return;
+    bool empty = true;
+    for(uint32_t v : minute){
+        if(v) empty = false;
+    }
+    if(empty) return; // 没有输入的分钟不写，文件只随活跃时间增长
+
+    uint8_t record[kRecordSize];
+    putFixed(record, currentUnixMinute(), 8);
+    for(size_t k = 0; k < kInputKindCount; k++){
+        putFixed(record + 8 + 4 * k, minute[k], 4);
+    }
+    if(SDL_WriteIO(file_, record, sizeof(record)) != sizeof(record)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputStats: write failed: %s", SDL_GetError());
+        SDL_CloseIO(file_);
+        file_ = nullptr;
+    }
+}
+
+bool InputStats::openPersistFile(const std::string& path)
+{
+    // 读回以前的记录，算出累计总数
+    size_t size = 0;
+    uint8_t* data = static_cast<uint8_t*>(SDL_LoadFile(path.c_str(), &size));
+    size_t valid = 0; // 完整记录的字节数（含文件头）
+    for(auto& p : persisted_){
+        p.store(0, std::memory_order_relaxed);
+    }
+    if(data){
+        if(size >= kHeaderSize &&
+           getFixed(data, 4) == kFileMagic &&
+           getFixed(data + 4, 2) == kFileVersion){
+            valid = kHeaderSize + (size - kHeaderSize) / kRecordSize * kRecordSize;
+            for(size_t off = kHeaderSize; off < valid; off += kRecordSize){
+                for(size_t k = 0; k < kInputKindCount; k++){
+                    persisted_[k].fetch_add(getFixed(data + off + 8 + 4 * k, 4), std::memory_order_relaxed);
+                }
+            }
+        } else{
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputStats: %s is not an input stats file, starting over", path.c_str());
+        }
+    }
+
+    if(data && valid == size){
+        file_ = SDL_IOFromFile(path.c_str(), "ab");
+    } else{
+        // 新文件，或者末尾有不完整的记录（上次写到一半退出）：重写有效部分
+        file_ = SDL_IOFromFile(path.c_str(), "wb");
+        if(file_){
+            uint8_t header[kHeaderSize];
+            putFixed(header, kFileMagic, 4);
+            putFixed(header + 4, kFileVersion, 2);
+            putFixed(header + 6, 0, 2);
+            bool ok = SDL_WriteIO(file_, header, sizeof(header)) == sizeof(header);
+            if(ok && valid > kHeaderSize){
+                ok = SDL_WriteIO(file_, data + kHeaderSize, valid - kHeaderSize) == valid - kHeaderSize;
+            }
+            if(!ok){
+                SDL_CloseIO(file_);
+                file_ = nullptr;
+            }
+        }
+    }
+    SDL_free(data);
+
+    if(!file_){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputStats: cannot open %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+uint64_t InputStats::getSessionTotal(InputKind kind) const
+{
+    uint64_t total = 0;
+    for(const auto& source : sources_){
+        total += source.counts[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t InputStats::getTotal(InputKind kind) const
+{
+    return persisted_[static_cast<size_t>(kind)].load(std::memory_order_relaxed) + getSessionTotal(kind);
+}
+
+uint64_t InputStats::getSourceCount(int sourceId, InputKind kind) const
+{
+    if(sourceId < 0 || sourceId >= kMaxSources) return 0;
+    return sources_[sourceId].counts[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+void InputStats::getHistory(Resolution resolution, InputKind kind, std::vector<uint32_t>& out) const
+{
+    const size_t k = static_cast<size_t>(kind);
+    auto copy = [&out, k](const auto& ring){
+        const size_t n = ring.buckets.size();
+        out.resize(n);
+        for(size_t i = 0; i < n; i++){
+            out[i] = ring.buckets[(ring.next + i) % n][k];
+        }
+    };
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch(resolution){
+    case Resolution::Second: copy(seconds_); break;
+    case Resolution::Minute: copy(minutes_); break;
+    case Resolution::Hour:   copy(hours_); break;
+    }
+}
+
+} // namespace tools
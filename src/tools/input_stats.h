@@ -0,0 +1,195 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tools{
+
+// 输入种类
+enum class InputKind : uint8_t {Key, MouseButton, MouseMove, Wheel, Count};
+constexpr size_t kInputKindCount = static_cast<size_t>(InputKind::Count);
+
+class InputStats;
+
+// 输入来源接口：来源在自己的线程（或事件回调）里调用 InputStats::record()
+class InputSource{
+public:
+    virtual ~InputSource() = default;
+    virtual const char* getName() const = 0;
+    virtual bool start(InputStats& stats, int sourceId) = 0;
+    virtual void stop() {}
+};
+
+// SDL 事件来源：被动来源，由事件总线把键盘/鼠标按键/滚轮事件交给 onEvent()
+// 只能看到发给本进程窗口的输入
+class SDLInputSource : public InputSource{
+public:
+    const char* getName() const override {return "sdl";}
+    bool start(InputStats& stats, int sourceId) override;
+    void stop() override {stats_ = nullptr;}
+
+    void count(const SDL_Event& event);
+    // 与 EventBus::EventCallback 签名一致，userdata 为 SDLInputSource*
+    static void onEvent(void* userdata, SDL_Event& event);
+
+private:
+    InputStats* stats_ = nullptr;
+    int sourceId_ = -1;
+};
+
+// 合成来源（测试用）：后台线程按给定速率（次/分钟）产生输入，间隔服从指数分布
+class SyntheticInputSource : public InputSource{
+public:
+    SyntheticInputSource(float keysPerMinute, float clicksPerMinute = 0.0f, uint64_t seed = 1);
+    ~SyntheticInputSource() override {stop();}
+
+    const char* getName() const override {return "synthetic";}
+    bool start(InputStats& stats, int sourceId) override;
+    void stop() override;
+
+private:
+    void threadMain(InputStats* stats, int sourceId);
+
+    float keysPerMinute_;
+    float clicksPerMinute_;
+    uint64_t seed_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+#ifdef _WIN32
+// 全局低级键盘/鼠标钩子（WH_KEYBOARD_LL / WH_MOUSE_LL），在独立线程的消息循环里运行
+// 窗口不在前台时也能计数；只记录次数，不记录按了哪个键
+class GlobalHookInputSource : public InputSource{
+public:
+    ~GlobalHookInputSource() override {stop();}
+
+    const char* getName() const override {return "win32-hook";}
+    bool start(InputStats& stats, int sourceId) override;
+    void stop() override;
+
+private:
+    void threadMain();
+
+    std::thread thread_;
+    std::atomic<unsigned long> threadId_{0};
+};
+#endif
+
+// 输入统计（单例）
+// - record() 可在任意线程调用：每个来源一块独立缓存行上的计数器，relaxed 原子加，无锁
+// - 汇总线程每秒把计数器的增量滚进 秒(60)/分(60)/时(24) 三级环形缓冲，
+//   同时增量维护最近 60 秒的滚动和（即每分钟次数）
+// - 每满一分钟向持久化文件追加一条定长记录，启动时读回累计总数
+// 帧线程只会读 getRatePerMinute()/getTotal() 这类原子量
+class InputStats{
+public:
+    static InputStats& getInstance(){
+        static InputStats instance;
+        return instance;
+    }
+
+    static constexpr int kMaxSources = 8;
+    static constexpr size_t kSeconds = 60;
+    static constexpr size_t kMinutes = 60;
+    static constexpr size_t kHours = 24;
+
+    enum class Resolution {Second, Minute, Hour};
+
+    // 持久化文件格式（小端）
+    //   文件头: "PPIS" | u16 版本 | u16 保留
+    //   记录:   u64 Unix 分钟数 | u32 次数 x kInputKindCount
+    static constexpr uint32_t kFileMagic = 0x53495050; // "PPIS"
+    static constexpr uint16_t kFileVersion = 1;
+
+    // 来源交给 InputStats 管理，start() 时一起启动；返回来源 id，失败返回 -1
+    int addSource(std::unique_ptr<InputSource> source);
+    // persistPath 为空时不持久化
+    bool start(const std::string& persistPath = "");
+    void stop();
+    bool isRunning() const {return running_;}
+
+    void record(int sourceId, InputKind kind, uint32_t count = 1){
+        sources_[sourceId].counts[static_cast<size_t>(kind)].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // 最近 60 秒内的次数（每分钟速率），每秒更新一次
+    uint32_t getRatePerMinute(InputKind kind) const {
+        return rates_[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+    }
+    uint32_t getKeysPerMinute() const {return getRatePerMinute(InputKind::Key);}
+    // 累计总数（含之前会话持久化的部分）与本次会话的次数
+    uint64_t getTotal(InputKind kind) const;
+    uint64_t getSessionTotal(InputKind kind) const;
+    uint64_t getSourceCount(int sourceId, InputKind kind) const;
+
+    // 按时间从旧到新复制某一级的历史
+    void getHistory(Resolution resolution, InputKind kind, std::vector<uint32_t>& out) const;
+
+    // 手动推进一秒（不启动汇总线程时使用，例如测试）
+    void tick();
+
+private:
+    InputStats() = default;
+    ~InputStats() {stop();}
+    InputStats(const InputStats&) = delete;
+    InputStats& operator=(const InputStats&) = delete;
+
+    struct alignas(64) SourceCounters{
+        std::array<std::atomic<uint64_t>, kInputKindCount> counts{};
+    };
+    using Bucket = std::array<uint32_t, kInputKindCount>;
+
+    template <size_t N>
+    struct Ring{
+        std::array<Bucket, N> buckets{};
+        size_t next = 0;    // 下一个写入位置，也就是最旧的一格
+        Bucket& push(){
+            Bucket& b = buckets[next];
+            next = (next + 1) % N;
+            return b;
+        }
+    };
+
+    void threadMain();
+    void rollSecond();                  // 需持有 mutex_
+    void appendRecord(const Bucket& minute); // 需持有 mutex_
+    bool openPersistFile(const std::string& path);
+
+    std::array<SourceCounters, kMaxSources> sources_{};
+    std::vector<std::unique_ptr<InputSource>> inputs_; // 下标即来源 id
+
+    // 汇总状态，由 mutex_ 保护
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+    bool running_ = false;
+
+    std::array<uint64_t, kInputKindCount> lastSeen_{}; // 上一秒时各来源计数之和
+    Ring<kSeconds> seconds_;
+    Ring<kMinutes> minutes_;
+    Ring<kHours> hours_;
+    Bucket rollingSum_{};   // seconds_ 中所有格子之和
+    Bucket minuteAcc_{};    // 当前分钟已累计
+    Bucket hourAcc_{};      // 当前小时已累计
+    size_t secondInMinute_ = 0;
+    size_t minuteInHour_ = 0;
+
+    std::array<std::atomic<uint32_t>, kInputKindCount> rates_{};
+    std::array<std::atomic<uint64_t>, kInputKindCount> persisted_{}; // 以前会话的累计
+
+    SDL_IOStream* file_ = nullptr;
+};
+
+} // namespace tools
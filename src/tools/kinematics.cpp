@@ -0,0 +1,281 @@
+#include "kinematics.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define KINEMATICS_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KINEMATICS_SSE2 1
+#endif
+
+namespace tools{
+
+    namespace math{
+
+        namespace{
+
+            constexpr float kEpsilon = 1e-6f;
+            constexpr float kInstantAccel = 1e9f; // acceleration <= 0 时使用
+
+            inline float effectiveAccel(float a){
+                return a > 0.0f ? a : kInstantAccel;
+            }
+
+#if defined(KINEMATICS_SSE2)
+            // mask ? a : b
+            inline __m128 select(__m128 mask, __m128 a, __m128 b){
+                return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+            }
+#endif
+
+            // 标量内核，SIMD 内核逐条对应这里的公式
+            inline bool stepScalar(float& px, float& py, float& vx, float& vy,
+                                   float tx, float ty,
+                                   float maxSpeed, float accel, float arriveRadius, float dt)
+            {
+                const float dx = tx - px, dy = ty - py;
+                const float dist2 = dx * dx + dy * dy;
+                const float dist = std::sqrt(dist2);
+
+                // 期望速度：朝向目标，且保证能在剩余距离内减速停下 (v^2 = 2ad)
+                const float speed = std::min(maxSpeed, std::sqrt(2.0f * accel * dist));
+                const float inv = dist > kEpsilon ? speed / dist : 0.0f;
+                const float dvx = dx * inv - vx, dvy = dy * inv - vy;
+
+                // 速度变化量受加速度限制
+                const float dv = std::sqrt(dvx * dvx + dvy * dvy);
+                const float k = std::min(1.0f, accel * dt / std::max(dv, kEpsilon));
+                vx += dvx * k;
+                vy += dvy * k;
+
+                const float sx = vx * dt, sy = vy * dt;
+                const bool arrive = dist <= arriveRadius || (sx * sx + sy * sy) >= dist2;
+                if(arrive){
+                    px = tx; py = ty;
+                    vx = 0.0f; vy = 0.0f;
+                } else{
+                    px += sx; py += sy;
+                }
+                return arrive;
+            }
+
+        }
+
+        bool KinematicBody::step(float dt)
+        {
+            if(!moving || dt <= 0.0f){
+                return false;
+            }
+            bool arrive = stepScalar(position.x, position.y, velocity.x, velocity.y,
+                                     target.x, target.y,
+                                     params.maxSpeed, effectiveAccel(params.acceleration),
+                                     params.arriveRadius, dt);
+            if(arrive){
+                moving = false;
+            }
+            return arrive;
+        }
+
+        // -------------------------------------------------------
+
+        size_t KinematicsBatch::add(const KinematicBody& body)
+        {
+            size_t index = count_;
+            count_++;
+            grow();
+            set(index, body);
+            return index;
+        }
+
+        void KinematicsBatch::set(size_t index, const KinematicBody& body)
+        {
+            px_[index] = body.position.x;
+            py_[index] = body.position.y;
+            vx_[index] = body.velocity.x;
+            vy_[index] = body.velocity.y;
+            tx_[index] = body.target.x;
+            ty_[index] = body.target.y;
+            maxSpeed_[index] = body.params.maxSpeed;
+            accel_[index] = effectiveAccel(body.params.acceleration);
+            arriveRadius_[index] = body.params.arriveRadius;
+            moving_[index] = body.moving ? 1.0f : 0.0f;
+            arrived_[index] = 0;
+        }
+
+        void KinematicsBatch::get(size_t index, KinematicBody& body) const
+        {
+            body.position = glm::vec2(px_[index], py_[index]);
+            body.velocity = glm::vec2(vx_[index], vy_[index]);
+            body.target = glm::vec2(tx_[index], ty_[index]);
+            body.moving = isMoving(index);
+        }
+
+        void KinematicsBatch::setTarget(size_t index, glm::vec2 target)
+        {
+            tx_[index] = target.x;
+            ty_[index] = target.y;
+            moving_[index] = 1.0f;
+            arrived_[index] = 0;
+        }
+
+        void KinematicsBatch::setPosition(size_t index, glm::vec2 position)
+        {
+            px_[index] = position.x;
+            py_[index] = position.y;
+        }
+
+        void KinematicsBatch::stop(size_t index)
+        {
+            vx_[index] = 0.0f;
+            vy_[index] = 0.0f;
+            moving_[index] = 0.0f;
+            arrived_[index] = 0;
+        }
+
+        void KinematicsBatch::clear()
+        {
+            count_ = 0;
+            for(auto* v : {&px_, &py_, &vx_, &vy_, &tx_, &ty_, &maxSpeed_, &accel_, &arriveRadius_, &moving_}){
+                v->clear();
+            }
+            arrived_.clear();
+        }
+
+        void KinematicsBatch::grow()
+        {
+            const size_t padded = (count_ + 7) & ~static_cast<size_t>(7);
+            if(padded == px_.size()) return;
+            for(auto* v : {&px_, &py_, &vx_, &vy_, &tx_, &ty_, &maxSpeed_, &arriveRadius_, &moving_}){
+                v->resize(padded, 0.0f);
+            }
+            accel_.resize(padded, kInstantAccel);
+            arrived_.resize(padded, 0);
+        }
+
+        const char* KinematicsBatch::kernelName()
+        {
+#if defined(KINEMATICS_AVX)
+            return "avx";
+#elif defined(KINEMATICS_SSE2)
+            return "sse2";
+#else
+            return "scalar";
+#endif
+        }
+
+        void KinematicsBatch::integrate(float dt)
+        {
+            if(count_ == 0 || dt <= 0.0f) return;
+            const size_t n = px_.size(); // 已按 8 对齐
+            size_t i = 0;
+
+#if defined(KINEMATICS_AVX)
+            const __m256 vdt = _mm256_set1_ps(dt);
+            const __m256 eps = _mm256_set1_ps(kEpsilon);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            for(; i + 8 <= n; i += 8){
+                __m256 px = _mm256_loadu_ps(&px_[i]), py = _mm256_loadu_ps(&py_[i]);
+                __m256 vx = _mm256_loadu_ps(&vx_[i]), vy = _mm256_loadu_ps(&vy_[i]);
+                const __m256 tx = _mm256_loadu_ps(&tx_[i]), ty = _mm256_loadu_ps(&ty_[i]);
+                const __m256 ms = _mm256_loadu_ps(&maxSpeed_[i]);
+                const __m256 ac = _mm256_loadu_ps(&accel_[i]);
+                const __m256 ar = _mm256_loadu_ps(&arriveRadius_[i]);
+                const __m256 active = _mm256_cmp_ps(_mm256_loadu_ps(&moving_[i]), _mm256_setzero_ps(), _CMP_GT_OQ);
+
+                const __m256 dx = _mm256_sub_ps(tx, px), dy = _mm256_sub_ps(ty, py);
+                const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+                const __m256 d = _mm256_sqrt_ps(d2);
+                const __m256 speed = _mm256_min_ps(ms, _mm256_sqrt_ps(_mm256_mul_ps(_mm256_mul_ps(two, ac), d)));
+                const __m256 inv = _mm256_and_ps(_mm256_div_ps(speed, _mm256_max_ps(d, eps)),
+                                                 _mm256_cmp_ps(d, eps, _CMP_GT_OQ));
+                const __m256 dvx = _mm256_sub_ps(_mm256_mul_ps(dx, inv), vx);
+                const __m256 dvy = _mm256_sub_ps(_mm256_mul_ps(dy, inv), vy);
+                const __m256 dv = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dvx, dvx), _mm256_mul_ps(dvy, dvy)));
+                const __m256 k = _mm256_min_ps(one, _mm256_div_ps(_mm256_mul_ps(ac, vdt), _mm256_max_ps(dv, eps)));
+                vx = _mm256_add_ps(vx, _mm256_mul_ps(dvx, k));
+                vy = _mm256_add_ps(vy, _mm256_mul_ps(dvy, k));
+
+                const __m256 sx = _mm256_mul_ps(vx, vdt), sy = _mm256_mul_ps(vy, vdt);
+                const __m256 s2 = _mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy));
+                const __m256 arrive = _mm256_and_ps(active,
+                    _mm256_or_ps(_mm256_cmp_ps(d, ar, _CMP_LE_OQ), _mm256_cmp_ps(s2, d2, _CMP_GE_OQ)));
+
+                // 停止的槽位保持原值
+                const __m256 nx = _mm256_blendv_ps(_mm256_add_ps(px, sx), tx, arrive);
+                const __m256 ny = _mm256_blendv_ps(_mm256_add_ps(py, sy), ty, arrive);
+                _mm256_storeu_ps(&px_[i], _mm256_blendv_ps(px, nx, active));
+                _mm256_storeu_ps(&py_[i], _mm256_blendv_ps(py, ny, active));
+                _mm256_storeu_ps(&vx_[i], _mm256_blendv_ps(_mm256_loadu_ps(&vx_[i]), _mm256_andnot_ps(arrive, vx), active));
+                _mm256_storeu_ps(&vy_[i], _mm256_blendv_ps(_mm256_loadu_ps(&vy_[i]), _mm256_andnot_ps(arrive, vy), active));
+                _mm256_storeu_ps(&moving_[i], _mm256_and_ps(_mm256_andnot_ps(arrive, active), one));
+
+                const int mask = _mm256_movemask_ps(arrive);
+                for(int l = 0; l < 8; l++){
+                    arrived_[i + l] = static_cast<uint8_t>((mask >> l) & 1);
+                }
+            }
+#elif defined(KINEMATICS_SSE2)
+            const __m128 vdt = _mm_set1_ps(dt);
+            const __m128 eps = _mm_set1_ps(kEpsilon);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            for(; i + 4 <= n; i += 4){
+                __m128 px = _mm_loadu_ps(&px_[i]), py = _mm_loadu_ps(&py_[i]);
+                __m128 vx = _mm_loadu_ps(&vx_[i]), vy = _mm_loadu_ps(&vy_[i]);
+                const __m128 tx = _mm_loadu_ps(&tx_[i]), ty = _mm_loadu_ps(&ty_[i]);
+                const __m128 ms = _mm_loadu_ps(&maxSpeed_[i]);
+                const __m128 ac = _mm_loadu_ps(&accel_[i]);
+                const __m128 ar = _mm_loadu_ps(&arriveRadius_[i]);
+                const __m128 active = _mm_cmpgt_ps(_mm_loadu_ps(&moving_[i]), _mm_setzero_ps());
+
+                const __m128 dx = _mm_sub_ps(tx, px), dy = _mm_sub_ps(ty, py);
+                const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                const __m128 d = _mm_sqrt_ps(d2);
+                const __m128 speed = _mm_min_ps(ms, _mm_sqrt_ps(_mm_mul_ps(_mm_mul_ps(two, ac), d)));
+                const __m128 inv = _mm_and_ps(_mm_div_ps(speed, _mm_max_ps(d, eps)), _mm_cmpgt_ps(d, eps));
+                const __m128 dvx = _mm_sub_ps(_mm_mul_ps(dx, inv), vx);
+                const __m128 dvy = _mm_sub_ps(_mm_mul_ps(dy, inv), vy);
+                const __m128 dv = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dvx, dvx), _mm_mul_ps(dvy, dvy)));
+                const __m128 k = _mm_min_ps(one, _mm_div_ps(_mm_mul_ps(ac, vdt), _mm_max_ps(dv, eps)));
+                vx = _mm_add_ps(vx, _mm_mul_ps(dvx, k));
+                vy = _mm_add_ps(vy, _mm_mul_ps(dvy, k));
+
+                const __m128 sx = _mm_mul_ps(vx, vdt), sy = _mm_mul_ps(vy, vdt);
+                const __m128 s2 = _mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy));
+                const __m128 arrive = _mm_and_ps(active, _mm_or_ps(_mm_cmple_ps(d, ar), _mm_cmpge_ps(s2, d2)));
+
+                // SSE2 没有 blendv，用 and/andnot/or 选择；停止的槽位保持原值
+                const __m128 nx = select(arrive, tx, _mm_add_ps(px, sx));
+                const __m128 ny = select(arrive, ty, _mm_add_ps(py, sy));
+                _mm_storeu_ps(&px_[i], select(active, nx, px));
+                _mm_storeu_ps(&py_[i], select(active, ny, py));
+                _mm_storeu_ps(&vx_[i], select(active, _mm_andnot_ps(arrive, vx), _mm_loadu_ps(&vx_[i])));
+                _mm_storeu_ps(&vy_[i], select(active, _mm_andnot_ps(arrive, vy), _mm_loadu_ps(&vy_[i])));
+                _mm_storeu_ps(&moving_[i], _mm_and_ps(_mm_andnot_ps(arrive, active), one));
+
+                const int mask = _mm_movemask_ps(arrive);
+                for(int l = 0; l < 4; l++){
+                    arrived_[i + l] = static_cast<uint8_t>((mask >> l) & 1);
+                }
+            }
+#endif
+            // 标量实现（或 SIMD 的尾部）
+            for(; i < n; i++){
+                if(moving_[i] == 0.0f){
+                    arrived_[i] = 0;
+                    continue;
+                }
+                const bool arrive = stepScalar(px_[i], py_[i], vx_[i], vy_[i], tx_[i], ty_[i],
+                                               maxSpeed_[i], accel_[i], arriveRadius_[i], dt);
+                arrived_[i] = arrive ? 1 : 0;
+                if(arrive){
+                    moving_[i] = 0.0f;
+                }
+            }
+        }
+
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "t_math.h"
+
+namespace tools{
+
+    namespace math{
+
+        // 运动参数
+        struct MotionParams{
+            float maxSpeed = 360.0f;        // 最大速度（像素/秒）
+            float acceleration = 1800.0f;   // 加速度（像素/秒^2），<= 0 表示瞬间达到最大速度
+            float arriveRadius = 0.5f;      // 到达判定半径（像素）
+        };
+
+        // 单个物体：浮点位置与速度，朝目标加速、接近时减速，越过目标时吸附到目标
+        // 速度与步长都按秒计算，结果与帧率无关
+        struct KinematicBody{
+            glm::vec2 position{0.0f, 0.0f};
+            glm::vec2 velocity{0.0f, 0.0f};
+            glm::vec2 target{0.0f, 0.0f};
+            MotionParams params;
+            bool moving = false;
+
+            void moveTo(glm::vec2 t) {target = t; moving = true;}
+            void stop() {velocity = glm::vec2(0.0f, 0.0f); moving = false;}
+
+            // 前进 dt 秒，本步到达目标时返回 true
+            bool step(float dt);
+        };
+
+        // 按缓动曲线在固定时长内从 from 移动到 to（脚本化移动用）
+        struct EasedMotion{
+            glm::vec2 from{0.0f, 0.0f};
+            glm::vec2 to{0.0f, 0.0f};
+            float duration = 1.0f;  // 秒
+            float elapsed = 0.0f;
+            Ease curve = Ease::SmoothStep;
+
+            glm::vec2 step(float dt){
+                elapsed += dt;
+                float t = duration > 0.0f ? elapsed / duration : 1.0f;
+                return lerp(from, to, ease(curve, t));
+            }
+            bool isDone() const {return elapsed >= duration;}
+        };
+
+        // 批量积分器：结构体数组拆成按分量存储的数组（SoA），一次处理 4/8 个
+        // 编译期选择 AVX / SSE2 内核，其余平台使用标量实现，三者计算公式一致
+        // 每个槽位与 KinematicBody 一一对应：不在移动的槽位积分时保持不变，到达后自动停下
+        class KinematicsBatch{
+        public:
+            size_t add(const KinematicBody& body);  // 返回下标
+            void set(size_t index, const KinematicBody& body);
+            void get(size_t index, KinematicBody& body) const;
+            void setTarget(size_t index, glm::vec2 target); // 朝新目标移动
+            void setPosition(size_t index, glm::vec2 position);
+            void stop(size_t index);                // 速度清零并停下
+            void clear();
+
+            // 积分所有移动中的物体
+            void integrate(float dt);
+
+            size_t size() const {return count_;}
+            glm::vec2 getPosition(size_t index) const {return glm::vec2(px_[index], py_[index]);}
+            glm::vec2 getVelocity(size_t index) const {return glm::vec2(vx_[index], vy_[index]);}
+            bool isMoving(size_t index) const {return moving_[index] != 0.0f;}
+            bool arrived(size_t index) const {return arrived_[index] != 0;} // 最近一次 integrate 时到达（之后的步不再为 true）
+
+            static const char* kernelName(); // "avx" / "sse2" / "scalar"
+
+        private:
+            void grow();
+
+            size_t count_ = 0;
+            // 长度按 8 对齐，填充项不在移动，不影响结果
+            std::vector<float> px_, py_, vx_, vy_, tx_, ty_;
+            std::vector<float> maxSpeed_, accel_, arriveRadius_;
+            std::vector<float> moving_;     // 1 移动中 / 0 停止（浮点，便于 SIMD 直接生成掩码）
+            std::vector<uint8_t> arrived_;
+        };
+
+    }
+}
@@ -0,0 +1,145 @@
+#include "latency_stats.h"
+#include "string_format.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace tools{
+
+namespace{
+
+const char* const kStageNames[kLatencyStageCount] = {
+    "input_to_handled", "handled_to_published", "published_to_submit", "submit_to_present", "total"
+};
+
+// 时间戳可能乱序（例如事件时间戳晚于处理时刻的取值），差值按 0 计
+inline uint64_t span(uint64_t from, uint64_t to){
+    return to > from ? to - from : 0;
+}
+
+} // namespace
+
+const char* getLatencyStageName(LatencyStage stage)
+{
+    const size_t i = static_cast<size_t>(stage);
+    return i < kLatencyStageCount ? kStageNames[i] : "unknown";
+}
+
+// -------------------------------------------------------
+// LatencyHistogram
+
+int LatencyHistogram::bucketOf(uint64_t us)
+{
+    if(us < kLinear) return static_cast<int>(us);
+    us = std::min<uint64_t>(us, 0xFFFFFFFFull);
+    const int exp = static_cast<int>(std::bit_width(us)) - 1; // >= 6
+    const int sub = static_cast<int>((us >> (exp - 5)) & (kSubBuckets - 1));
+    return kLinear + (exp - 6) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperUs(int bucket)
+{
+    if(bucket < kLinear) return static_cast<uint64_t>(bucket);
+    const int exp = (bucket - kLinear) / kSubBuckets + 6;
+    const uint64_t sub = static_cast<uint64_t>((bucket - kLinear) % kSubBuckets);
+    const uint64_t width = 1ull << (exp - 5);
+    return (kSubBuckets + sub) * width + width - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns)
+{
+    const uint64_t us = ns / 1000;
+    buckets_[bucketOf(us)]++;
+    count_++;
+    sumUs_ += us;
+    maxUs_ = std::max(maxUs_, us);
+}
+
+void LatencyHistogram::reset()
+{
+    buckets_.fill(0);
+    count_ = 0;
+    sumUs_ = 0;
+    maxUs_ = 0;
+}
+
+uint64_t LatencyHistogram::getPercentileUs(double p) const
+{
+    if(count_ == 0) return 0;
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for(int i = 0; i < kBuckets; i++){
+        seen += buckets_[i];
+        if(seen >= target) return std::min(bucketUpperUs(i), maxUs_);
+    }
+    return maxUs_;
+}
+
+// -------------------------------------------------------
+// LatencyStats
+
+void LatencyStats::recordStamp(const InputStamp& stamp, uint64_t submitNs, uint64_t presentNs)
+{
+    stages_[static_cast<size_t>(LatencyStage::InputToHandled)].record(span(stamp.inputNs, stamp.handledNs));
+    stages_[static_cast<size_t>(LatencyStage::HandledToPublished)].record(span(stamp.handledNs, stamp.publishedNs));
+    stages_[static_cast<size_t>(LatencyStage::PublishedToSubmit)].record(span(stamp.publishedNs, submitNs));
+    stages_[static_cast<size_t>(LatencyStage::SubmitToPresent)].record(span(submitNs, presentNs));
+    stages_[static_cast<size_t>(LatencyStage::Total)].record(span(stamp.inputNs, presentNs));
+}
+
+void LatencyStats::reset()
+{
+    for(LatencyHistogram& h : stages_){
+        h.reset();
+    }
+}
+
+std::string LatencyStats::toJson() const
+{
+    std::string out;
+    out.reserve(1024);
+    appendf(out, "{\n  \"interactions\": %llu,\n  \"unit\": \"us\",\n  \"stages\": {", static_cast<unsigned long long>(getCount()));
+    for(size_t i = 0; i < kLatencyStageCount; i++){
+        const LatencyHistogram& h = stages_[i];
+        appendf(out, "%s\n    \"%s\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu}",
+            i == 0 ? "" : ",", kStageNames[i],
+            static_cast<unsigned long long>(h.getCount()), h.getMeanUs(),
+            static_cast<unsigned long long>(h.getPercentileUs(50.0)),
+            static_cast<unsigned long long>(h.getPercentileUs(90.0)),
+            static_cast<unsigned long long>(h.getPercentileUs(99.0)),
+            static_cast<unsigned long long>(h.getMaxUs()));
+    }
+    out += "\n  }\n}\n";
+    return out;
+}
+
+bool LatencyStats::dumpJson(const std::string& path) const
+{
+    const std::string json = toJson();
+    SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "wb");
+    if(!io){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LatencyStats: cannot open %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    const bool ok = SDL_WriteIO(io, json.data(), json.size()) == json.size();
+    SDL_CloseIO(io);
+    if(!ok){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LatencyStats: write to %s failed: %s", path.c_str(), SDL_GetError());
+    }
+    return ok;
+}
+
+void LatencyStats::logReport() const
+{
+    if(getCount() == 0) return;
+    SDL_Log("Input-to-photon latency over %llu interactions:", static_cast<unsigned long long>(getCount()));
+    for(size_t i = 0; i < kLatencyStageCount; i++){
+        const LatencyHistogram& h = stages_[i];
+        SDL_Log("  %-20s mean %8.2f ms | p50 %8.2f | p90 %8.2f | p99 %8.2f | max %8.2f",
+            kStageNames[i], h.getMeanUs() / 1000.0,
+            h.getPercentileUs(50.0) / 1000.0, h.getPercentileUs(90.0) / 1000.0,
+            h.getPercentileUs(99.0) / 1000.0, h.getMaxUs() / 1000.0);
+    }
+}
+
+} // namespace tools
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tools{
+
+// 一次交互（例如点击桌宠）经过各阶段的时间戳，单位 SDL_GetTicksNS 纳秒
+struct InputStamp{
+    uint64_t inputNs = 0;     // SDL 事件自带的时间戳（操作系统送来输入的时刻）
+    uint64_t handledNs = 0;   // 模拟线程处理事件、切换状态的时刻
+    uint64_t publishedNs = 0; // 含新状态第一帧的快照发布的时刻
+    uint64_t tick = 0;        // 该快照的模拟帧序号，主线程画到这一帧时才算送达
+};
+
+// 延迟分段
+enum class LatencyStage : uint8_t {
+    InputToHandled,     // 事件排队 + 等待模拟线程
+    HandledToPublished, // 本帧剩余的模拟
+    PublishedToSubmit,  // 等待主线程取走快照
+    SubmitToPresent,    // 绘制 + SDL_RenderPresent
+    Total,              // 输入到 present 返回
+    Count
+};
+constexpr size_t kLatencyStageCount = static_cast<size_t>(LatencyStage::Count);
+
+const char* getLatencyStageName(LatencyStage stage);
+
+// 对数分桶直方图（微秒）：64 µs 以下每桶 1 µs，之后每个 2 的幂区间 32 桶（相对误差 < 3.2%）
+// 不分配内存，记录是 O(1)
+class LatencyHistogram{
+public:
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t getCount() const {return count_;}
+    double getMeanUs() const {return count_ ? static_cast<double>(sumUs_) / static_cast<double>(count_) : 0.0;}
+    uint64_t getMaxUs() const {return maxUs_;}
+    uint64_t getPercentileUs(double p) const; // p 取 0..100，返回所在桶的上界
+
+    // 分桶规则（实时指标 tools::MetricHistogram 共用）
+    static constexpr int kLinear = 64;
+    static constexpr int kSubBuckets = 32;
+    static constexpr int kBuckets = kLinear + (32 - 6) * kSubBuckets;
+
+    static int bucketOf(uint64_t us);
+    static uint64_t bucketUpperUs(int bucket);
+
+private:
+    std::array<uint32_t, kBuckets> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sumUs_ = 0;
+    uint64_t maxUs_ = 0;
+};
+
+// 输入到画面的延迟统计（单例）
+// 只在主线程（present 之后）记录与读取，不加锁
+class LatencyStats{
+public:
+    static LatencyStats& getInstance(){
+        static LatencyStats instance;
+        return instance;
+    }
+
+    // 一次交互在 presentNs 时刻送达屏幕，submitNs 为开始绘制该帧的时刻
+    void recordStamp(const InputStamp& stamp, uint64_t submitNs, uint64_t presentNs);
+    const LatencyHistogram& getHistogram(LatencyStage stage) const {return stages_[static_cast<size_t>(stage)];}
+    uint64_t getCount() const {return getHistogram(LatencyStage::Total).getCount();}
+    void reset();
+
+    std::string toJson() const;
+    bool dumpJson(const std::string& path) const;
+    void logReport() const;
+
+private:
+    LatencyStats() = default;
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    std::array<LatencyHistogram, kLatencyStageCount> stages_;
+};
+
+} // namespace tools
@@ -1,9 +1,29 @@
 #include "manifest_loader.h"
 #include "minijson.h"
+#include "memory_stats.h"
+#include "embedded_assets.h"
 
 #include <fstream>
 #include <sstream>
 
+// "#RRGGBB" 或 "#RRGGBBAA" -> ARGB8888
+static bool parseColor(const std::string& text, Uint32& out){
+    if(text.size() != 7 && text.size() != 9) return false;
+    if(text[0] != '#') return false;
+    Uint32 v = 0;
+    for(size_t i = 1; i < text.size(); i++){
+        const char c = text[i];
+        Uint32 d = 0;
+        if(c >= '0' && c <= '9') d = c - '0';
+        else if(c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') d = c - 'A' + 10;
+        else return false;
+        v = (v << 4) | d;
+    }
+    out = text.size() == 7 ? (0xFF000000u | v) : ((v & 0xFF) << 24) | (v >> 8);
+    return true;
+}
+
 static std::string readFileText(const std::string& path){
     std::ifstream ifs(path, std::ios::binary);
     if(!ifs.is_open())  return "";
@@ -12,8 +32,54 @@ static std::string readFileText(const std::string& path){
     return oss.str();
 }
 
+// 编译期嵌入的清单：已校验、已展开帧，只需要拷贝成运行时结构
+static bool loadEmbeddedManifest(const tools::assets::EmbeddedManifest& em, Manifest& out){
+    out.version = em.version;
+    out.basePath = em.basePath;
+    for(size_t i = 0; i < em.animationCount; i++){
+        const tools::assets::EmbeddedAnimation& ea = em.animations[i];
+        AnimationDescription desc;
+        desc.name = ea.name;
+        desc.id = tools::StringTable::getInstance().intern(desc.name);
+        if(!desc.id.isValid()) continue; // 与已有名字冲突，日志已记录
+        desc.path = ea.path;
+        desc.frames = static_cast<int>(ea.frameCount);
+        desc.frameWidth = ea.frameWidth;
+        desc.frameHeight = ea.frameHeight;
+        desc.fps = ea.fps;
+        desc.loop = ea.loop;
+        desc.layout = "row";
+        desc.is_movement = ea.isMovement;
+        desc.rects.reserve(ea.frameCount);
+        for(size_t f = 0; f < ea.frameCount; f++){
+            const tools::assets::EmbeddedFrame& ef = ea.frames[f];
+            desc.rects.push_back(AnimFrameRect{ef.x, ef.y, ef.w, ef.h, ef.durationMS});
+        }
+        for(size_t c = 0; c < ea.cueCount; c++){
+            const tools::assets::EmbeddedCue& ec = ea.cues[c];
+            desc.cues.push_back(AnimCueDescription{ec.frame, ec.sound, ec.priority, ec.volume});
+        }
+        out.animations.emplace(desc.name, std::move(desc));
+    }
+    for(size_t i = 0; i < em.soundCount; i++){
+        out.sounds.emplace(em.sounds[i].name, SoundDescription{em.sounds[i].path, em.sounds[i].volume});
+    }
+    for(size_t i = 0; i < em.paletteCount; i++){
+        PaletteSwap swap;
+        for(size_t c = 0; c < em.palettes[i].count; c++){
+            swap.remap.emplace_back(em.palettes[i].colors[c].from, em.palettes[i].colors[c].to);
+        }
+        out.palettes.emplace(em.palettes[i].name, std::move(swap));
+    }
+    return !out.animations.empty();
+}
+
 bool loadManifest(const std::string& jsonPath, Manifest& out, std::string* outErr){
+    tools::MemoryScope scope(tools::MemTag::Parser); // 文本与 JSON DOM
     out = Manifest{};
+    if(const tools::assets::EmbeddedManifest* embedded = tools::assets::findManifest(jsonPath)){
+        return loadEmbeddedManifest(*embedded, out);
+    }
     std::string text = readFileText(jsonPath);
     if(text.empty()){
         if(outErr) *outErr = "Failed to read file: " + jsonPath;
@@ -71,6 +137,8 @@ bool loadManifest(const std::string& jsonPath, Manifest& out, std::string* outEr
 
             AnimationDescription desc;
             desc.name = name;
+            desc.id = tools::StringTable::getInstance().intern(name);
+            if(!desc.id.isValid()) continue; // 与已有名字冲突，日志已记录
             desc.path = val.getString("path", "");
             // 可选字段：frames
             desc.frames = val.getInt("frames", -1);
@@ -84,6 +152,18 @@ bool loadManifest(const std::string& jsonPath, Manifest& out, std::string* outEr
             desc.is_movement = val.getBool("is_movement", false);
         
 
+            if(auto cues = val.getArray("cues")){
+                for(const auto& item : *cues){
+                    if(!item.isObject()) continue;
+                    AnimCueDescription cue;
+                    cue.frame = item.getInt("frame", 0);
+                    cue.sound = item.getString("sound", "");
+                    cue.priority = item.getInt("priority", 0);
+                    cue.volume = static_cast<float>(item.getNumber("volume", 1.0));
+                    if(!cue.sound.empty()) desc.cues.push_back(std::move(cue));
+                }
+            }
+
             if(auto rects = val.getArray("rects")){
                 for(const auto& item : *rects){
                     if(!item.isObject()) continue;
@@ -101,9 +181,70 @@ bool loadManifest(const std::string& jsonPath, Manifest& out, std::string* outEr
         }
     }
 
+    // sounds: "name": "file.ogg" 或 "name": {"path": "file.ogg", "volume": 0.8}
+    if(auto sounds = root.getObject("sounds")){
+        for(const auto& kv : *sounds){
+            SoundDescription sd;
+            if(kv.second.isString()){
+                sd.path = kv.second.s;
+            } else if(kv.second.isObject()){
+                sd.path = kv.second.getString("path", "");
+                sd.volume = static_cast<float>(kv.second.getNumber("volume", 1.0));
+            }
+            if(!sd.path.empty()) out.sounds.emplace(kv.first, std::move(sd));
+        }
+    }
+
+    // palettes: "name": {"#d22f1e": "#4a4a58", ...}，作用于所有动画的调色板
+    if(auto palettes = root.getObject("palettes")){
+        for(const auto& kv : *palettes){
+            if(!kv.second.isObject()) continue;
+            PaletteSwap swap;
+            for(const auto& entry : kv.second.o){
+                Uint32 from = 0, to = 0;
+                if(entry.second.isString() && parseColor(entry.first, from) && parseColor(entry.second.s, to)){
+                    swap.remap.emplace_back(from, to);
+                } else{
+                    SDL_Log("loadManifest: palette '%s': bad color entry '%s'", kv.first.c_str(), entry.first.c_str());
+                }
+            }
+            out.palettes.emplace(kv.first, std::move(swap));
+        }
+    }
+
     return !out.animations.empty();
 }
 
+int loadManifestSounds(const Manifest& mf){
+    int loaded = 0;
+    AudioSystem& audio = AudioSystem::getInstance();
+    for(const auto& kv : mf.sounds){
+        const std::string fullPath = mf.basePath + kv.second.path;
+        if(audio.loadSound(kv.first, fullPath, kv.second.volume) != kInvalidSound){
+            loaded++;
+        }
+    }
+    return loaded;
+}
+
+std::vector<AnimationCue> buildCues(const AnimationDescription& d, int frameCount){
+    std::vector<AnimationCue> cues;
+    cues.reserve(d.cues.size());
+    for(const auto& c : d.cues){
+        if(c.frame < 0 || c.frame >= frameCount){
+            SDL_Log("Cue '%s' of animation '%s' is out of range (frame %d of %d)", c.sound.c_str(), d.name.c_str(), c.frame, frameCount);
+            continue;
+        }
+        SoundId id = AudioSystem::getInstance().findSound(c.sound);
+        if(id == kInvalidSound){
+            SDL_Log("Cue '%s' of animation '%s' refers to an unknown sound", c.sound.c_str(), d.name.c_str());
+            continue;
+        }
+        cues.push_back(AnimationCue{c.frame, id, c.priority, c.volume});
+    }
+    return cues;
+}
+
 void normalizeDesc(AnimationDescription& d, const Defaults& def){
     if(d.fps <= 0) d.fps = def.fps;
     if(d.frameWidth <= 0) d.frameWidth = def.frameWidth;
@@ -166,8 +307,28 @@ std::vector<AnimationFrame> buildFramesFromGrid(const AnimationDescription& d, i
     return frames;
 }
 
+void trimFrames(const IndexedSheet& sheet, std::vector<AnimationFrame>& frames, int maxHullVertices){
+    // 凸包比包围盒小得不多时不值得走三角形光栅化
+    constexpr float kHullWorthRatio = 0.85f;
+    tools::math::RowSpans spans;
+    for(auto& f : frames){
+        f.trimRect = sheet.opaqueBounds(f.souceRect, &f.opaquePixels, &spans);
+        f.trimmed = true;
+        f.hull.clear();
+        f.hullArea = 0.0f;
+        if(f.trimRect.w <= 0 || f.trimRect.h <= 0) continue;
+        std::vector<SDL_FPoint> hull = tools::math::coverHull(spans, f.trimRect, maxHullVertices);
+        const float area = tools::math::polygonArea(hull);
+        if(!hull.empty() && area < kHullWorthRatio * f.trimRect.w * f.trimRect.h){
+            f.hull = std::move(hull);
+            f.hullArea = area;
+        }
+    }
+}
+
 SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& fullpath){
-    SDL_Texture* t = IMG_LoadTexture(renderer, fullpath.c_str());
+    SDL_IOStream* embedded = tools::assets::openFile(fullpath);
+    SDL_Texture* t = embedded ? IMG_LoadTexture_IO(renderer, embedded, true) : IMG_LoadTexture(renderer, fullpath.c_str());
     if(!t){
         SDL_Log("Failed to load texture: %s, error: %s", fullpath.c_str(), SDL_GetError());
     }
@@ -178,4 +339,21 @@ SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& fullpath){
         SDL_Log("Texture loaded: %s (%.0fx%.0f), blend=BLEND", fullpath.c_str(), w, h);
     }
     return t;
-}
\ No newline at end of file
+}
+
+SDL_Surface* loadSurface(const std::string& fullpath){
+    SDL_IOStream* embedded = tools::assets::openFile(fullpath);
+    SDL_Surface* loaded = embedded ? IMG_Load_IO(embedded, true) : IMG_Load(fullpath.c_str());
+    if(!loaded){
+        SDL_Log("Failed to load surface: %s, error: %s", fullpath.c_str(), SDL_GetError());
+        return nullptr;
+    }
+    SDL_Surface* s = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_ARGB8888);
+    SDL_DestroySurface(loaded);
+    if(!s){
+        SDL_Log("Failed to convert surface: %s, error: %s", fullpath.c_str(), SDL_GetError());
+        return nullptr;
+    }
+    SDL_Log("Surface loaded: %s (%dx%d)", fullpath.c_str(), s->w, s->h);
+    return s;
+}
@@ -19,5 +19,18 @@ std::vector<AnimationFrame> buildFramesFromRects(const AnimationDescription& d);
 // Create AnimationFrame from Grid, needing texture width and height
 std::vector<AnimationFrame> buildFramesFromGrid(const AnimationDescription& d, int texW, int texH);
 
+// Trim frames to the opaque pixels of the sheet (alpha bounds, and a convex hull of at most maxHullVertices)
+// placement stays relative to souceRect, so drawing the trimmed part gives the same image
+void trimFrames(const IndexedSheet& sheet, std::vector<AnimationFrame>& frames, int maxHullVertices = 8);
+
+// Decode every sound of the manifest into the shared AudioSystem cache, returns the number loaded
+int loadManifestSounds(const Manifest& mf);
+
+// Resolve the cue descriptions of an animation against the loaded sounds
+std::vector<AnimationCue> buildCues(const AnimationDescription& d, int frameCount);
+
 // Simple texture loader
-SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& fullpath);
\ No newline at end of file
+SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& fullpath);
+
+// Load image into a CPU surface (ARGB8888), e.g. for building SpriteCache variants
+SDL_Surface* loadSurface(const std::string& fullpath);
\ No newline at end of file
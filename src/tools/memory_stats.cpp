@@ -0,0 +1,347 @@
+#include "memory_stats.h"
+#include "string_format.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace tools{
+
+namespace{
+
+// 计数放在常量初始化的全局数组里：operator new 在任何静态对象构造之前就可能被调用
+struct TagCounters{
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> budget{0};
+    std::atomic<bool> overBudget{false};
+};
+TagCounters g_tags[kMemTagCount];
+
+thread_local MemTag t_scope = MemTag::General;
+
+const char* const kTagNames[kMemTagCount] = {
+    "general", "parser", "assets", "pets", "ui", "audio", "textures"
+};
+
+} // namespace
+
+// operator new 直接调用这两个函数，不经过 MemoryStats::getInstance()：单例本身的构造也可能分配内存
+namespace detail{
+void addBytes(MemTag tag, size_t bytes);
+void subBytes(MemTag tag, size_t bytes);
+}
+
+void detail::addBytes(MemTag tag, size_t bytes)
+{
+    TagCounters& c = g_tags[static_cast<size_t>(tag)];
+    const int64_t live = c.live.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    int64_t peak = c.peak.load(std::memory_order_relaxed);
+    while(live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)){}
+
+    // 越过预算只报一次，回落到预算以内后重新报
+    const uint64_t budget = c.budget.load(std::memory_order_relaxed);
+    if(budget > 0 && live > static_cast<int64_t>(budget) && !c.overBudget.exchange(true, std::memory_order_relaxed)){
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "MemoryStats: '%s' over budget (%lld / %llu bytes)",
+            kTagNames[static_cast<size_t>(tag)], static_cast<long long>(live), static_cast<unsigned long long>(budget));
+    }
+}
+
+void detail::subBytes(MemTag tag, size_t bytes)
+{
+    TagCounters& c = g_tags[static_cast<size_t>(tag)];
+    const int64_t live = c.live.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed) - static_cast<int64_t>(bytes);
+    const uint64_t budget = c.budget.load(std::memory_order_relaxed);
+    if(budget > 0 && live <= static_cast<int64_t>(budget)){
+        c.overBudget.store(false, std::memory_order_relaxed);
+    }
+}
+
+namespace{
+
+void appendJsonString(std::string& out, const std::string& s)
+{
+    out.push_back('"');
+    for(char c : s){
+        switch(c){
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20){
+                appendf(out, "\\u%04x", static_cast<unsigned>(c));
+            } else{
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace
+
+const char* getMemTagName(MemTag tag)
+{
+    const size_t i = static_cast<size_t>(tag);
+    return i < kMemTagCount ? kTagNames[i] : "unknown";
+}
+
+// -------------------------------------------------------
+// MemoryScope
+
+MemoryScope::MemoryScope(MemTag tag)
+    : previous_(t_scope)
+{
+    t_scope = tag;
+}
+
+MemoryScope::~MemoryScope()
+{
+    t_scope = previous_;
+}
+
+MemTag MemoryScope::current()
+{
+    return t_scope;
+}
+
+// -------------------------------------------------------
+// counters
+
+void MemoryStats::add(MemTag tag, size_t bytes)
+{
+    detail::addBytes(tag, bytes);
+}
+
+void MemoryStats::sub(MemTag tag, size_t bytes)
+{
+    detail::subBytes(tag, bytes);
+}
+
+int64_t MemoryStats::getLive(MemTag tag) const
+{
+    return g_tags[static_cast<size_t>(tag)].live.load(std::memory_order_relaxed);
+}
+
+int64_t MemoryStats::getPeak(MemTag tag) const
+{
+    return g_tags[static_cast<size_t>(tag)].peak.load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryStats::getAllocations(MemTag tag) const
+{
+    return g_tags[static_cast<size_t>(tag)].allocations.load(std::memory_order_relaxed);
+}
+
+int64_t MemoryStats::getTotalLive() const
+{
+    int64_t total = 0;
+    for(size_t i = 0; i < kMemTagCount; i++){
+        if(static_cast<MemTag>(i) != MemTag::Textures){
+            total += g_tags[i].live.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void MemoryStats::setBudget(MemTag tag, size_t bytes)
+{
+    TagCounters& c = g_tags[static_cast<size_t>(tag)];
+    c.budget.store(bytes, std::memory_order_relaxed);
+    c.overBudget.store(false, std::memory_order_relaxed);
+}
+
+size_t MemoryStats::getBudget(MemTag tag) const
+{
+    return static_cast<size_t>(g_tags[static_cast<size_t>(tag)].budget.load(std::memory_order_relaxed));
+}
+
+bool MemoryStats::isOverBudget(MemTag tag) const
+{
+    return wouldExceed(tag, 0);
+}
+
+bool MemoryStats::wouldExceed(MemTag tag, size_t bytes) const
+{
+    const size_t budget = getBudget(tag);
+    return budget > 0 && getLive(tag) + static_cast<int64_t>(bytes) > static_cast<int64_t>(budget);
+}
+
+bool MemoryStats::isAllocationTrackingEnabled()
+{
+#ifdef PATPAT_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// -------------------------------------------------------
+// textures
+
+size_t MemoryStats::estimateTextureBytes(SDL_Texture* texture)
+{
+    if(!texture) return 0;
+    float w = 0.0f, h = 0.0f;
+    if(!SDL_GetTextureSize(texture, &w, &h)) return 0;
+    const SDL_PixelFormat format = static_cast<SDL_PixelFormat>(SDL_GetNumberProperty(
+        SDL_GetTextureProperties(texture), SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN));
+    // FourCC（YUV 等）格式没有固定的每像素字节数，按 4 字节估算
+    size_t bpp = SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_BYTESPERPIXEL(format);
+    if(bpp == 0) bpp = 4;
+    return static_cast<size_t>(w) * static_cast<size_t>(h) * bpp;
+}
+
+size_t MemoryStats::estimateVramBytes(size_t textureBytes)
+{
+    // 驱动一般按 4KB 页（小纹理也至少一页）分配显存
+    constexpr size_t kPage = 4096;
+    return (textureBytes + kPage - 1) / kPage * kPage;
+}
+
+void MemoryStats::trackTexture(SDL_Texture* texture, const std::string& clip)
+{
+    if(!texture) return;
+    const size_t bytes = estimateTextureBytes(texture);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(texture);
+        if(it != textures_.end()) return; // 已记账
+        textures_.emplace(texture, TextureEntry{clip, bytes});
+        ClipUsage& usage = clips_[clip];
+        usage.textures++;
+        usage.bytes += bytes;
+        usage.vramBytes += estimateVramBytes(bytes);
+    }
+    add(MemTag::Textures, estimateVramBytes(bytes));
+}
+
+void MemoryStats::untrackTexture(SDL_Texture* texture)
+{
+    size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(texture);
+        if(it == textures_.end()) return;
+        bytes = it->second.bytes;
+        auto cit = clips_.find(it->second.clip);
+        if(cit != clips_.end()){
+            ClipUsage& usage = cit->second;
+            usage.textures--;
+            usage.bytes -= bytes;
+            usage.vramBytes -= estimateVramBytes(bytes);
+            if(usage.textures == 0) clips_.erase(cit);
+        }
+        textures_.erase(it);
+    }
+    sub(MemTag::Textures, estimateVramBytes(bytes));
+}
+
+// -------------------------------------------------------
+// report
+
+std::string MemoryStats::toJson() const
+{
+    std::string out;
+    out.reserve(1024);
+    appendf(out, "{\n  \"allocationTracking\": %s,\n  \"tags\": {", isAllocationTrackingEnabled() ? "true" : "false");
+    for(size_t i = 0; i < kMemTagCount; i++){
+        const MemTag tag = static_cast<MemTag>(i);
+        appendf(out, "%s\n    \"%s\": {\"live\": %lld, \"peak\": %lld, \"allocations\": %llu, \"budget\": %llu}",
+            i == 0 ? "" : ",", getMemTagName(tag),
+            static_cast<long long>(getLive(tag)), static_cast<long long>(getPeak(tag)),
+            static_cast<unsigned long long>(getAllocations(tag)),
+            static_cast<unsigned long long>(getBudget(tag)));
+    }
+    out += "\n  },\n  \"clips\": [";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool first = true;
+        for(const auto& kv : clips_){
+            out += first ? "\n    {\"name\": " : ",\n    {\"name\": ";
+            first = false;
+            appendJsonString(out, kv.first);
+            appendf(out, ", \"textures\": %zu, \"textureBytes\": %zu, \"vramBytes\": %zu}",
+                kv.second.textures, kv.second.bytes, kv.second.vramBytes);
+        }
+    }
+    out += "\n  ]\n}\n";
+    return out;
+}
+
+bool MemoryStats::dumpJson(const std::string& path) const
+{
+    const std::string json = toJson();
+    SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "wb");
+    if(!io){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MemoryStats: cannot open %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    const bool ok = SDL_WriteIO(io, json.data(), json.size()) == json.size();
+    SDL_CloseIO(io);
+    if(!ok){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MemoryStats: write to %s failed: %s", path.c_str(), SDL_GetError());
+    }
+    return ok;
+}
+
+void MemoryStats::logReport() const
+{
+    SDL_Log("Memory: %s", toJson().c_str());
+}
+
+} // namespace tools
+
+// -------------------------------------------------------
+// 全局 operator new：每块前面放一个 16 字节的头，记下大小与标签，释放时记回同一个标签
+
+#ifdef PATPAT_MEMORY_TRACKING
+namespace{
+
+struct alignas(16) AllocHeader{
+    size_t size;
+    tools::MemTag tag;
+};
+static_assert(sizeof(AllocHeader) == 16, "header must keep default new alignment");
+
+void* trackedAlloc(size_t size)
+{
+    AllocHeader* h = static_cast<AllocHeader*>(std::malloc(sizeof(AllocHeader) + size));
+    if(!h) return nullptr;
+    h->size = size;
+    h->tag = tools::MemoryScope::current();
+    tools::detail::addBytes(h->tag, size);
+    return h + 1;
+}
+
+void trackedFree(void* p)
+{
+    if(!p) return;
+    AllocHeader* h = static_cast<AllocHeader*>(p) - 1;
+    tools::detail::subBytes(h->tag, h->size);
+    std::free(h);
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if(void* p = trackedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+    if(void* p = trackedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {return trackedAlloc(size);}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {return trackedAlloc(size);}
+void operator delete(void* p) noexcept {trackedFree(p);}
+void operator delete[](void* p) noexcept {trackedFree(p);}
+void operator delete(void* p, std::size_t) noexcept {trackedFree(p);}
+void operator delete[](void* p, std::size_t) noexcept {trackedFree(p);}
+void operator delete(void* p, const std::nothrow_t&) noexcept {trackedFree(p);}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {trackedFree(p);}
+#endif // PATPAT_MEMORY_TRACKING
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tools{
+
+// 内存分类
+// Textures 是估算的显存（纹理），其余为 CPU 内存
+enum class MemTag : uint8_t {General, Parser, Assets, Pets, UI, Audio, Textures, Count};
+constexpr size_t kMemTagCount = static_cast<size_t>(MemTag::Count);
+
+const char* getMemTagName(MemTag tag);
+
+// 作用域标签：构造到析构之间本线程的 new 记到 tag 名下（可嵌套）
+// 只有定义了 PATPAT_MEMORY_TRACKING 时全局 operator new 才会统计，否则只是一个空操作
+class MemoryScope{
+public:
+    explicit MemoryScope(MemTag tag);
+    ~MemoryScope();
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+    static MemTag current();
+
+private:
+    MemTag previous_;
+};
+
+// 内存统计（单例）
+// - 每个标签一组原子计数：当前、峰值、分配次数，任意线程可调用，不分配内存
+// - 大块资源（纹理、解码后的音效、索引像素）由持有者显式 add/sub，不依赖 operator new 统计
+// - 纹理按片段名记账：字节数由 SDL_GetTextureSize 与像素格式算出
+// - 预算：超过时记一次日志；isOverBudget()/wouldExceed() 供调用方拒绝新的分配
+class MemoryStats{
+public:
+    static MemoryStats& getInstance(){
+        static MemoryStats instance;
+        return instance;
+    }
+
+    void add(MemTag tag, size_t bytes);
+    void sub(MemTag tag, size_t bytes);
+
+    int64_t getLive(MemTag tag) const;
+    int64_t getPeak(MemTag tag) const;
+    uint64_t getAllocations(MemTag tag) const;
+    int64_t getTotalLive() const;   // 不含显存
+
+    // 预算（字节），0 表示不限
+    void setBudget(MemTag tag, size_t bytes);
+    size_t getBudget(MemTag tag) const;
+    bool isOverBudget(MemTag tag) const;
+    bool wouldExceed(MemTag tag, size_t bytes) const;
+
+    // 纹理记账
+    static size_t estimateTextureBytes(SDL_Texture* texture);
+    static size_t estimateVramBytes(size_t textureBytes); // 按驱动的分配粒度向上取整
+    void trackTexture(SDL_Texture* texture, const std::string& clip);
+    void untrackTexture(SDL_Texture* texture);
+
+    // JSON 报告
+    std::string toJson() const;
+    bool dumpJson(const std::string& path) const;
+    void logReport() const;
+
+    static bool isAllocationTrackingEnabled(); // 是否带 PATPAT_MEMORY_TRACKING 编译
+
+private:
+    MemoryStats() = default;
+    MemoryStats(const MemoryStats&) = delete;
+    MemoryStats& operator=(const MemoryStats&) = delete;
+
+    struct TextureEntry{
+        std::string clip;
+        size_t bytes = 0;
+    };
+    struct ClipUsage{
+        size_t textures = 0;
+        size_t bytes = 0;
+        size_t vramBytes = 0;
+    };
+
+    mutable std::mutex mutex_; // 保护下面两张表
+    std::unordered_map<SDL_Texture*, TextureEntry> textures_;
+    std::unordered_map<std::string, ClipUsage> clips_;
+};
+
+} // namespace tools
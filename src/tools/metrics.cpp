@@ -0,0 +1,388 @@
+#include "metrics.h"
+#include "string_format.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace tools{
+
+namespace{
+
+constexpr uint64_t kWindowNs = 10'000'000'000ULL;  // 分位数窗口每 10 秒轮换一次
+constexpr int kPollMs = 200;                        // 服务线程检查停止标志的间隔
+constexpr int kRequestWaitMs = 50;                  // 等客户端发来格式的时间，不发就按文本
+constexpr int kWriteTimeoutMs = 1000;               // 客户端不读时放弃
+
+// NaN/无穷在 JSON 里没有表示，按 0 输出
+inline double finite(double v){
+    return std::isfinite(v) ? v : 0.0;
+}
+
+} // namespace
+
+// -------------------------------------------------------
+// MetricHistogram
+
+void MetricHistogram::load(Buckets& out) const
+{
+    for(size_t i = 0; i < out.size(); i++){
+        out[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+}
+
+MetricHistogram::Summary MetricHistogram::summarize()
+{
+    Buckets now;
+    load(now);
+
+    Summary s;
+    uint64_t window[LatencyHistogram::kBuckets];
+    for(size_t i = 0; i < now.size(); i++){
+        s.count += now[i];
+        window[i] = now[i] - std::min(now[i], older_[i]);
+        s.windowCount += window[i];
+    }
+    s.sumSeconds = static_cast<double>(sumUs_.load(std::memory_order_relaxed)) / 1.0e6;
+    const uint64_t maxUs = maxUs_.load(std::memory_order_relaxed);
+    s.maxSeconds = static_cast<double>(maxUs) / 1.0e6;
+
+    // 与 LatencyHistogram::getPercentileUs 相同：返回所在桶的上界，不超过最大值
+    auto percentile = [&](double p) -> double{
+        if(s.windowCount == 0) return 0.0;
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(s.windowCount))));
+        uint64_t seen = 0;
+        for(int i = 0; i < LatencyHistogram::kBuckets; i++){
+            seen += window[i];
+            if(seen >= target) return static_cast<double>(std::min(LatencyHistogram::bucketUpperUs(i), maxUs)) / 1.0e6;
+        }
+        return s.maxSeconds;
+    };
+    s.p50 = percentile(50.0);
+    s.p90 = percentile(90.0);
+    s.p99 = percentile(99.0);
+    return s;
+}
+
+void MetricHistogram::rotateWindow()
+{
+    older_ = newer_;
+    load(newer_);
+}
+
+// -------------------------------------------------------
+// Metrics
+
+Metrics::~Metrics()
+{
+    stopServer();
+}
+
+Metrics::Entry* Metrics::find(const char* name, Kind kind)
+{
+    const size_t n = count_.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < n; i++){
+        if(std::strcmp(entries_[i].name, name) != 0) continue;
+        if(entries_[i].kind != kind){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: %s already registered with another type", name);
+            return nullptr;
+        }
+        return &entries_[i];
+    }
+    return nullptr;
+}
+
+Metrics::Entry* Metrics::append(const char* name, const char* help, Kind kind)
+{
+    const size_t n = count_.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < n; i++){
+        if(std::strcmp(entries_[i].name, name) == 0) return nullptr; // 类型不同，find 已报错
+    }
+    if(n >= kCapacity){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: registry full, %s is not exported", name);
+        return nullptr;
+    }
+    Entry& e = entries_[n];
+    e.kind = kind;
+    e.name = name;
+    e.help = help;
+    return &e;
+}
+
+MetricCounter& Metrics::counter(const char* name, const char* help)
+{
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    if(Entry* e = find(name, Kind::Counter)) return *e->counter;
+    Entry* e = append(name, help, Kind::Counter);
+    if(!e) return spareCounter_;
+    e->counter = std::make_unique<MetricCounter>();
+    count_.fetch_add(1, std::memory_order_release);
+    return *e->counter;
+}
+
+MetricGauge& Metrics::gauge(const char* name, const char* help)
+{
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    if(Entry* e = find(name, Kind::Gauge)) return *e->gauge;
+    Entry* e = append(name, help, Kind::Gauge);
+    if(!e) return spareGauge_;
+    e->gauge = std::make_unique<MetricGauge>();
+    count_.fetch_add(1, std::memory_order_release);
+    return *e->gauge;
+}
+
+MetricHistogram& Metrics::histogram(const char* name, const char* help)
+{
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    if(Entry* e = find(name, Kind::Histogram)) return *e->histogram;
+    Entry* e = append(name, help, Kind::Histogram);
+    if(!e) return spareHistogram_;
+    e->histogram = std::make_unique<MetricHistogram>();
+    count_.fetch_add(1, std::memory_order_release);
+    return *e->histogram;
+}
+
+void Metrics::sampled(const char* name, const char* help, std::function<double()> sample)
+{
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    // 已发布的条目不再修改（读者可能正在调用），重复注册保留第一次的函数
+    if(find(name, Kind::Sampled)) return;
+    Entry* e = append(name, help, Kind::Sampled);
+    if(!e) return;
+    e->sample = std::move(sample);
+    count_.fetch_add(1, std::memory_order_release);
+}
+
+void Metrics::rotateWindows(uint64_t nowNs)
+{
+    if(nowNs - windowNs_ < kWindowNs) return;
+    windowNs_ = nowNs;
+    const size_t n = count_.load(std::memory_order_acquire);
+    for(size_t i = 0; i < n; i++){
+        if(entries_[i].kind == Kind::Histogram){
+            entries_[i].histogram->rotateWindow();
+        }
+    }
+}
+
+std::string Metrics::toText()
+{
+    std::string out;
+    out.reserve(4096);
+    appendf(out, "# HELP patpat_uptime_seconds Seconds since SDL initialization.\n# TYPE patpat_uptime_seconds gauge\npatpat_uptime_seconds %.3f\n",
+        static_cast<double>(SDL_GetTicksNS()) / 1.0e9);
+    const size_t n = count_.load(std::memory_order_acquire);
+    for(size_t i = 0; i < n; i++){
+        Entry& e = entries_[i];
+        switch(e.kind){
+        case Kind::Counter:
+            appendf(out, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", e.name, e.help, e.name, e.name,
+                static_cast<unsigned long long>(e.counter->get()));
+            break;
+        case Kind::Gauge:
+        case Kind::Sampled:
+            appendf(out, "# HELP %s %s\n# TYPE %s gauge\n%s %.15g\n", e.name, e.help, e.name, e.name,
+                e.kind == Kind::Gauge ? e.gauge->get() : e.sample());
+            break;
+        case Kind::Histogram:{
+            const MetricHistogram::Summary s = e.histogram->summarize();
+            appendf(out, "# HELP %s %s\n# TYPE %s summary\n", e.name, e.help, e.name);
+            appendf(out, "%s{quantile=\"0.5\"} %.6f\n%s{quantile=\"0.9\"} %.6f\n%s{quantile=\"0.99\"} %.6f\n",
+                e.name, s.p50, e.name, s.p90, e.name, s.p99);
+            appendf(out, "%s_sum %.6f\n%s_count %llu\n", e.name, s.sumSeconds, e.name, static_cast<unsigned long long>(s.count));
+            // summary 没有最大值，单独导出为仪表
+            appendf(out, "# TYPE %s_max gauge\n%s_max %.6f\n", e.name, e.name, s.maxSeconds);
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+std::string Metrics::toJson()
+{
+    std::string out;
+    out.reserve(4096);
+    appendf(out, "{\n  \"uptime_s\": %.3f,\n  \"metrics\": {", static_cast<double>(SDL_GetTicksNS()) / 1.0e9);
+    const size_t n = count_.load(std::memory_order_acquire);
+    for(size_t i = 0; i < n; i++){
+        Entry& e = entries_[i];
+        appendf(out, "%s\n    \"%s\": ", i == 0 ? "" : ",", e.name);
+        switch(e.kind){
+        case Kind::Counter:
+            appendf(out, "{\"type\": \"counter\", \"value\": %llu}", static_cast<unsigned long long>(e.counter->get()));
+            break;
+        case Kind::Gauge:
+        case Kind::Sampled:
+            appendf(out, "{\"type\": \"gauge\", \"value\": %.15g}", finite(e.kind == Kind::Gauge ? e.gauge->get() : e.sample()));
+            break;
+        case Kind::Histogram:{
+            const MetricHistogram::Summary s = e.histogram->summarize();
+            appendf(out, "{\"type\": \"summary\", \"count\": %llu, \"sum\": %.6f, \"max\": %.6f, \"window_count\": %llu, \"p50\": %.6f, \"p90\": %.6f, \"p99\": %.6f}",
+                static_cast<unsigned long long>(s.count), s.sumSeconds, s.maxSeconds,
+                static_cast<unsigned long long>(s.windowCount), s.p50, s.p90, s.p99);
+            break;
+        }
+        }
+    }
+    out += "\n  }\n}\n";
+    return out;
+}
+
+// -------------------------------------------------------
+// 服务线程
+
+#ifdef _WIN32
+
+bool Metrics::startServer(const std::string& socketPath)
+{
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: Unix socket endpoint %s is not supported on Windows", socketPath.c_str());
+    return false;
+}
+
+void Metrics::stopServer()
+{
+}
+
+void Metrics::serverMain(int)
+{
+}
+
+#else
+
+namespace{
+
+// 等待 fd 可读/可写，超时或出错返回 false
+bool waitFd(int fd, short events, int timeoutMs){
+    pollfd p{fd, events, 0};
+    for(;;){
+        const int r = poll(&p, 1, timeoutMs);
+        if(r < 0 && errno == EINTR) continue;
+        return r > 0 && (p.revents & events);
+    }
+}
+
+bool setNonBlocking(int fd){
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+// 非阻塞写完整个缓冲；客户端在 kWriteTimeoutMs 内不读就放弃
+void sendAll(int fd, const std::string& data){
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;    // 客户端提前断开时不产生 SIGPIPE
+#else
+    constexpr int kFlags = 0;
+#endif
+    size_t sent = 0;
+    while(sent < data.size()){
+        const ssize_t n = send(fd, data.data() + sent, data.size() - sent, kFlags);
+        if(n > 0){
+            sent += static_cast<size_t>(n);
+        } else if(n < 0 && errno == EINTR){
+            continue;
+        } else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitFd(fd, POLLOUT, kWriteTimeoutMs)){
+            continue;
+        } else{
+            return;
+        }
+    }
+}
+
+} // namespace
+
+bool Metrics::startServer(const std::string& socketPath)
+{
+    if(server_.joinable()) return true;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if(socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: socket path must be 1..%zu bytes: %s", sizeof(addr.sun_path) - 1, socketPath.c_str());
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+
+    // 上次异常退出留下的套接字文件先删掉；同名的普通文件不动
+    struct stat st{};
+    if(lstat(socketPath.c_str(), &st) == 0){
+        if(!S_ISSOCK(st.st_mode)){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: %s exists and is not a socket", socketPath.c_str());
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: socket() failed: %s", std::strerror(errno));
+        return false;
+    }
+    if(!setNonBlocking(fd) || bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Metrics: cannot listen on %s: %s", socketPath.c_str(), std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    socketPath_ = socketPath;
+    windowNs_ = SDL_GetTicksNS();
+    stop_.store(false, std::memory_order_relaxed);
+    server_ = std::thread(&Metrics::serverMain, this, fd);
+    SDL_Log("Metrics: serving on unix:%s (send \"json\" for JSON, anything else for text)", socketPath.c_str());
+    return true;
+}
+
+void Metrics::stopServer()
+{
+    if(!server_.joinable()) return;
+    stop_.store(true, std::memory_order_relaxed);
+    server_.join();
+    unlink(socketPath_.c_str());
+    SDL_Log("Metrics: server stopped after %llu scrapes", static_cast<unsigned long long>(getScrapeCount()));
+    socketPath_.clear();
+}
+
+void Metrics::serverMain(int listenFd)
+{
+    while(!stop_.load(std::memory_order_relaxed)){
+        rotateWindows(SDL_GetTicksNS());
+        if(!waitFd(listenFd, POLLIN, kPollMs)) continue;
+
+        const int client = accept(listenFd, nullptr, nullptr);
+        if(client < 0) continue;
+        if(!setNonBlocking(client)){
+            close(client);
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        const int one = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        // 请求只看第一行的开头："json" 返回 JSON，其余（包括不发送）返回文本
+        char request[64] = {};
+        bool json = false;
+        if(waitFd(client, POLLIN, kRequestWaitMs)){
+            const ssize_t n = recv(client, request, sizeof(request) - 1, 0);
+            json = n >= 4 && std::strncmp(request, "json", 4) == 0;
+        }
+        sendAll(client, json ? toJson() : toText());
+        close(client);
+        scrapes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    close(listenFd);
+}
+
+#endif
+
+} // namespace tools
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "latency_stats.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace tools{
+
+// 计数器：只增，任意线程可调用（一次 relaxed fetch_add）
+class MetricCounter{
+public:
+    void add(uint64_t n = 1) {value_.fetch_add(n, std::memory_order_relaxed);}
+    uint64_t get() const {return value_.load(std::memory_order_relaxed);}
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// 仪表：最近一次设置的值（一次 relaxed store）
+class MetricGauge{
+public:
+    void set(double value) {value_.store(value, std::memory_order_relaxed);}
+    double get() const {return value_.load(std::memory_order_relaxed);}
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// 耗时直方图：分桶与 LatencyHistogram 相同（微秒，相对误差 < 3.2%）
+// 每个直方图只有一个写线程（例如模拟线程的阶段耗时），记录是几次 relaxed load/store，没有原子读改写；
+// 读者（服务线程）随时读取，各桶之间不是同一瞬间的快照，对统计而言足够
+// 分位数按滑动窗口（最近 10~20 秒）计算，_sum/_count 从启动起累计
+class MetricHistogram{
+public:
+    void record(uint64_t ns){
+        const uint64_t us = ns / 1000;
+        bump(buckets_[LatencyHistogram::bucketOf(us)], 1);
+        bump(sumUs_, us);
+        if(us > maxUs_.load(std::memory_order_relaxed)){
+            maxUs_.store(us, std::memory_order_relaxed);
+        }
+    }
+
+    struct Summary{
+        uint64_t count = 0;         // 累计
+        double sumSeconds = 0.0;    // 累计
+        double maxSeconds = 0.0;    // 启动以来
+        uint64_t windowCount = 0;   // 窗口内的样本数
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0; // 窗口内的分位数（秒）
+    };
+
+    // 以下只由读者线程调用
+    Summary summarize();
+    void rotateWindow();            // 窗口起点后移：旧基线 <- 新基线 <- 当前
+
+private:
+    static void bump(std::atomic<uint64_t>& v, uint64_t n){
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    using Buckets = std::array<uint64_t, LatencyHistogram::kBuckets>;
+    void load(Buckets& out) const;
+
+    std::array<std::atomic<uint64_t>, LatencyHistogram::kBuckets> buckets_{};
+    std::atomic<uint64_t> sumUs_{0};
+    std::atomic<uint64_t> maxUs_{0};
+
+    // 读者私有
+    Buckets older_{};
+    Buckets newer_{};
+};
+
+// 实时指标注册表（单例）
+// - 注册只追加、不删除：先写好条目再以 release 发布数量，读者 acquire 读取数量后无锁遍历
+//   注册之间用互斥量串行，读者与记录者从不加锁
+// - 同名重复注册返回已有的指标；超出容量时返回一个不会被导出的占位指标
+// - 导出为 Prometheus 文本格式或 JSON，直方图导出为 summary（分位数 0.5/0.9/0.99）
+// - 可选的服务线程在本地 Unix 域套接字上提供快照：连接后发送一行 "json" 得到 JSON，
+//   其他内容或不发送得到文本；服务线程只读原子变量，不会阻塞帧线程
+class Metrics{
+public:
+    static Metrics& getInstance(){
+        static Metrics instance;
+        return instance;
+    }
+
+    // 名字与说明必须是静态字符串（不复制）
+    MetricCounter& counter(const char* name, const char* help);
+    MetricGauge& gauge(const char* name, const char* help);
+    MetricHistogram& histogram(const char* name, const char* help);
+    // 抓取时在服务线程求值的仪表，sample 必须线程安全（例如只读原子变量）
+    void sampled(const char* name, const char* help, std::function<double()> sample);
+
+    // 同一时刻只能有一个读者（服务线程；服务停止后才可在其他线程调用）
+    std::string toText();
+    std::string toJson();
+
+    // 服务线程（POSIX）；Windows 上只记录日志并返回 false
+    bool startServer(const std::string& socketPath);
+    void stopServer();
+    bool isServing() const {return server_.joinable();}
+    uint64_t getScrapeCount() const {return scrapes_.load(std::memory_order_relaxed);}
+
+private:
+    Metrics() = default;
+    ~Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    enum class Kind : uint8_t {Counter, Gauge, Sampled, Histogram};
+
+    struct Entry{
+        Kind kind = Kind::Counter;
+        const char* name = nullptr;
+        const char* help = nullptr;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+        std::function<double()> sample;
+    };
+
+    static constexpr size_t kCapacity = 64;
+
+    Entry* find(const char* name, Kind kind); // 需持有 registerMutex_
+    Entry* append(const char* name, const char* help, Kind kind); // 需持有 registerMutex_，满时返回空
+    void rotateWindows(uint64_t nowNs);
+    void serverMain(int listenFd);
+
+    std::array<Entry, kCapacity> entries_;
+    std::atomic<size_t> count_{0};
+    std::mutex registerMutex_;
+
+    // 超出容量时的占位
+    MetricCounter spareCounter_;
+    MetricGauge spareGauge_;
+    MetricHistogram spareHistogram_;
+
+    uint64_t windowNs_ = 0;         // 上次窗口轮换的时刻（服务线程）
+
+    std::thread server_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> scrapes_{0};
+    std::string socketPath_;
+};
+
+} // namespace tools
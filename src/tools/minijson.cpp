@@ -109,7 +109,7 @@ static bool parseNumber(Lexer& lx, double& out, std::string& err){
 static bool parseValue(Lexer& lx, Value& out, std::string& err);
 
 static bool parseArray(Lexer& lx, Value& v, std::string& err){
-    if(!lx.match('[]')) {
+    if(!lx.match('[')) {
         err = "Expected '[' at beginning of array";
         return false;
     }
@@ -1,54 +1,199 @@
 #pragma once
 
 #include <random>
-#include <chrono>
-#include <vector>
-#include <stdexcept>
-#include <numeric>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
 #include <algorithm>
 
-inline std::mt19937& rng() {
-    static thread_local std::mt19937 eng{ std::random_device{}() };
-    return eng;
-}
-
 namespace tools
 {
 
+// xoshiro256** 随机数流：32 字节状态，每次抽取只有几次移位/乘法
+// 通过 jump()（前进 2^128 步）切分出互不重叠的子流，每只宠物/每个系统各用一条，
+// 并行更新时互不干扰，给定种子结果可复现
+// 满足 UniformRandomBitGenerator，可直接用于 std::shuffle 等
+class RandomStream{
+public:
+    using result_type = uint64_t;
+
+    RandomStream() {seed(0x9E3779B97F4A7C15ULL);}
+    explicit RandomStream(uint64_t seedValue) {seed(seedValue);}
+
+    // 用 splitmix64 展开种子
+    void seed(uint64_t seedValue){
+        seed_ = seedValue;
+        uint64_t x = seedValue;
+        for(auto& s : s_){
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            s = z ^ (z >> 31);
+        }
+    }
+    uint64_t getSeed() const {return seed_;}
+
+    static constexpr result_type min() {return 0;}
+    static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+    result_type operator()() {return next();}
+
+    uint64_t next(){
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+    uint32_t next32() {return static_cast<uint32_t>(next() >> 32);}
+
+    // 前进 2^128 步
+    void jump(){
+        static constexpr uint64_t kJump[] = {
+            0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+        applyJump(kJump);
+    }
+    // 前进 2^192 步，用于在更高一层切分（例如每个线程）
+    void longJump(){
+        static constexpr uint64_t kLongJump[] = {
+            0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL};
+        applyJump(kLongJump);
+    }
+
+    // 返回一条从当前位置开始的子流，自身前进 2^128 步，两者不会重叠
+    RandomStream split(){
+        RandomStream child = *this;
+        jump();
+        return child;
+    }
+
+    // [0, range)，Lemire 乘法取高位，只有极少数情况需要一次取模来去除偏差
+    uint32_t bounded(uint32_t range){
+        uint64_t m = static_cast<uint64_t>(next32()) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if(low < range){
+            const uint32_t threshold = static_cast<uint32_t>(-range) % range;
+            while(low < threshold){
+                m = static_cast<uint64_t>(next32()) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // int [a, b]
+    int randint(int min, int max){
+        if(min > max){ std::swap(min, max);}
+        const uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min + 1);
+        if(range == 0){
+            return static_cast<int>(next32()); // 整个 int 范围
+        }
+        return static_cast<int>(static_cast<int64_t>(min) + bounded(range));
+    }
+
+    // [0, 1)，取高 24 位
+    float unitFloat() {return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);}
+    // [0, 1)，取高 53 位
+    double unitDouble() {return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);}
+
+    // float [min., max.)
+    float randfloat(float min, float max){
+        if(min > max){std::swap(min, max);}
+        float r = min + (max - min) * unitFloat();
+        return r < max ? r : min; // 舍入可能落到 max
+    }
+
+    // return true with probability p [0, 1]
+    bool chance(double p){
+        if(p <= 0.0) return false;
+        if(p >= 1.0) return true;
+        return unitDouble() < p;
+    }
+
+    // 批量填充
+    void fill(float* out, size_t count, float min, float max){
+        if(min > max){std::swap(min, max);}
+        const float span = max - min;
+        for(size_t i = 0; i < count; i++){
+            float r = min + span * unitFloat();
+            out[i] = r < max ? r : min;
+        }
+    }
+    void fill(int* out, size_t count, int min, int max){
+        if(min > max){ std::swap(min, max);}
+        const uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min + 1);
+        for(size_t i = 0; i < count; i++){
+            out[i] = range == 0 ? static_cast<int>(next32())
+                                : static_cast<int>(static_cast<int64_t>(min) + bounded(range));
+        }
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {return (x << k) | (x >> (64 - k));}
+
+    void applyJump(const uint64_t (&table)[4]){
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for(uint64_t word : table){
+            for(int b = 0; b < 64; b++){
+                if(word & (1ULL << b)){
+                    s0 ^= s_[0];
+                    s1 ^= s_[1];
+                    s2 ^= s_[2];
+                    s3 ^= s_[3];
+                }
+                next();
+            }
+        }
+        s_[0] = s0; s_[1] = s1; s_[2] = s2; s_[3] = s3;
+    }
+
+    uint64_t s_[4];
+    uint64_t seed_ = 0;
+};
+
+// 全局入口：每个线程一条流，默认由 random_device 播种
 class Random{
 public:
 
     // set seed outside for reproducibility
     static void setSeed(uint64_t seed){
-        uint32_t low = static_cast<uint32_t>(seed);
-        uint32_t high = static_cast<uint32_t>(seed >> 32);
-        std::seed_seq seq{low, high};
-        rng().seed(seq);
+        stream().seed(seed);
+    }
+    static uint64_t getSeed(){
+        return stream().getSeed();
+    }
+
+    // 当前线程的全局流
+    static RandomStream& stream(){
+        static thread_local RandomStream eng{
+            (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()};
+        return eng;
+    }
+
+    // 从全局流切出一条独立子流（每只宠物/每个系统一条）
+    static RandomStream split(){
+        return stream().split();
     }
 
     // int [a, b]
     static int randint(int min, int max){
-        if(min > max){ std::swap(min, max);}
-        std::uniform_int_distribution<int> dist(min, max);
-        return dist(rng());
+        return stream().randint(min, max);
     }
 
     // float [min., max.)
     static float randfloat(float min, float max){
-        if(min > max){std::swap(min, max);}
-        std::uniform_real_distribution<float> dist(min, max);
-        return dist(rng());
+        return stream().randfloat(min, max);
     }
 
     // return true with probability p [0, 1]
     static bool chance(double p){
-        if(p <= 0.0) return false;
-        if(p >= 1.0) return true;
-        std::bernoulli_distribution dist(p);    // 伯努利分布，随机返回 true/false
-        return dist(rng());
+        return stream().chance(p);
     }
 };
 
 
 }
-
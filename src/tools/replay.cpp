@@ -0,0 +1,381 @@
+#include "replay.h"
+#include <cstring>
+
+namespace tools{
+
+namespace{
+
+enum class EventKind : uint8_t{
+    Quit = 1,
+    Window,
+    Key,
+    MouseMotion,
+    MouseButton,
+    MouseWheel,
+};
+
+// ---------------- 编码 ----------------
+
+void putU8(std::vector<uint8_t>& out, uint8_t v){
+    out.push_back(v);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v){
+    while(v >= 0x80){
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t v){
+    putVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); // zigzag
+}
+
+void putFixed(std::vector<uint8_t>& out, uint64_t v, int bytes){
+    for(int i = 0; i < bytes; i++){
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+void putF32(std::vector<uint8_t>& out, float v){
+    uint32_t bits = 0;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putFixed(out, bits, 4);
+}
+
+// ---------------- 解码 ----------------
+
+struct Reader{
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint8_t u8(){
+        if(p >= end){ ok = false; return 0;}
+        return *p++;
+    }
+    uint64_t varint(){
+        uint64_t v = 0;
+        for(int shift = 0; shift < 64; shift += 7){
+            uint8_t b = u8();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if(!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+    int64_t sint(){
+        uint64_t v = varint();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+    uint64_t fixed(int bytes){
+        uint64_t v = 0;
+        for(int i = 0; i < bytes; i++){
+            v |= static_cast<uint64_t>(u8()) << (8 * i);
+        }
+        return v;
+    }
+    float f32(){
+        uint32_t bits = static_cast<uint32_t>(fixed(4));
+        float v = 0.0f;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+};
+
+bool isWindowEvent(Uint32 type){
+    return type >= SDL_EVENT_WINDOW_FIRST && type <= SDL_EVENT_WINDOW_LAST;
+}
+
+bool encodeEvent(std::vector<uint8_t>& out, const SDL_Event& e){
+    switch(e.type){
+    case SDL_EVENT_QUIT:
+        putU8(out, static_cast<uint8_t>(EventKind::Quit));
+        return true;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        putU8(out, static_cast<uint8_t>(EventKind::Key));
+        putVarint(out, e.key.windowID);
+        putVarint(out, e.key.which);
+        putVarint(out, static_cast<uint64_t>(e.key.scancode));
+        putVarint(out, e.key.key);
+        putVarint(out, e.key.mod);
+        putVarint(out, e.key.raw);
+        putU8(out, static_cast<uint8_t>((e.key.down ? 1 : 0) | (e.key.repeat ? 2 : 0)));
+        return true;
+    case SDL_EVENT_MOUSE_MOTION:
+        putU8(out, static_cast<uint8_t>(EventKind::MouseMotion));
+        putVarint(out, e.motion.windowID);
+        putVarint(out, e.motion.which);
+        putVarint(out, e.motion.state);
+        putF32(out, e.motion.x);
+        putF32(out, e.motion.y);
+        putF32(out, e.motion.xrel);
+        putF32(out, e.motion.yrel);
+        return true;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        putU8(out, static_cast<uint8_t>(EventKind::MouseButton));
+        putVarint(out, e.button.windowID);
+        putVarint(out, e.button.which);
+        putU8(out, e.button.button);
+        putU8(out, e.button.down ? 1 : 0);
+        putU8(out, e.button.clicks);
+        putF32(out, e.button.x);
+        putF32(out, e.button.y);
+        return true;
+    case SDL_EVENT_MOUSE_WHEEL:
+        putU8(out, static_cast<uint8_t>(EventKind::MouseWheel));
+        putVarint(out, e.wheel.windowID);
+        putVarint(out, e.wheel.which);
+        putF32(out, e.wheel.x);
+        putF32(out, e.wheel.y);
+        putU8(out, static_cast<uint8_t>(e.wheel.direction));
+        putF32(out, e.wheel.mouse_x);
+        putF32(out, e.wheel.mouse_y);
+        return true;
+    default:
+        if(isWindowEvent(e.type)){
+            putU8(out, static_cast<uint8_t>(EventKind::Window));
+            putVarint(out, e.type - SDL_EVENT_WINDOW_FIRST);
+            putVarint(out, e.window.windowID);
+            putSigned(out, e.window.data1);
+            putSigned(out, e.window.data2);
+            return true;
+        }
+        return false;
+    }
+}
+
+bool decodeEvent(Reader& in, SDL_Event& e){
+    SDL_zero(e);
+    const EventKind kind = static_cast<EventKind>(in.u8());
+    switch(kind){
+    case EventKind::Quit:
+        e.type = SDL_EVENT_QUIT;
+        break;
+    case EventKind::Key:
+        e.key.windowID = static_cast<SDL_WindowID>(in.varint());
+        e.key.which = static_cast<SDL_KeyboardID>(in.varint());
+        e.key.scancode = static_cast<SDL_Scancode>(in.varint());
+        e.key.key = static_cast<SDL_Keycode>(in.varint());
+        e.key.mod = static_cast<SDL_Keymod>(in.varint());
+        e.key.raw = static_cast<Uint16>(in.varint());
+        {
+            const uint8_t flags = in.u8();
+            e.key.down = (flags & 1) != 0;
+            e.key.repeat = (flags & 2) != 0;
+        }
+        e.type = e.key.down ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+        break;
+    case EventKind::MouseMotion:
+        e.type = SDL_EVENT_MOUSE_MOTION;
+        e.motion.windowID = static_cast<SDL_WindowID>(in.varint());
+        e.motion.which = static_cast<SDL_MouseID>(in.varint());
+        e.motion.state = static_cast<SDL_MouseButtonFlags>(in.varint());
+        e.motion.x = in.f32();
+        e.motion.y = in.f32();
+        e.motion.xrel = in.f32();
+        e.motion.yrel = in.f32();
+        break;
+    case EventKind::MouseButton:
+        e.button.windowID = static_cast<SDL_WindowID>(in.varint());
+        e.button.which = static_cast<SDL_MouseID>(in.varint());
+        e.button.button = in.u8();
+        e.button.down = in.u8() != 0;
+        e.button.clicks = in.u8();
+        e.button.x = in.f32();
+        e.button.y = in.f32();
+        e.type = e.button.down ? SDL_EVENT_MOUSE_BUTTON_DOWN : SDL_EVENT_MOUSE_BUTTON_UP;
+        break;
+    case EventKind::MouseWheel:
+        e.type = SDL_EVENT_MOUSE_WHEEL;
+        e.wheel.windowID = static_cast<SDL_WindowID>(in.varint());
+        e.wheel.which = static_cast<SDL_MouseID>(in.varint());
+        e.wheel.x = in.f32();
+        e.wheel.y = in.f32();
+        e.wheel.direction = static_cast<SDL_MouseWheelDirection>(in.u8());
+        e.wheel.mouse_x = in.f32();
+        e.wheel.mouse_y = in.f32();
+        break;
+    case EventKind::Window:
+        e.type = SDL_EVENT_WINDOW_FIRST + static_cast<Uint32>(in.varint());
+        e.window.windowID = static_cast<SDL_WindowID>(in.varint());
+        e.window.data1 = static_cast<Sint32>(in.sint());
+        e.window.data2 = static_cast<Sint32>(in.sint());
+        if(!isWindowEvent(e.type)) in.ok = false;
+        break;
+    default:
+        in.ok = false;
+        break;
+    }
+    e.common.timestamp = SDL_GetTicksNS();
+    return in.ok;
+}
+
+}
+
+// -------------------------------------------------------
+// recorder
+
+bool ReplayRecorder::open(const std::string& path, uint64_t seed)
+{
+    close();
+    io_ = SDL_IOFromFile(path.c_str(), "wb");
+    if(!io_){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayRecorder: cannot open %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    frame_.clear();
+    putFixed(frame_, kReplayMagic, 4);
+    putFixed(frame_, kReplayVersion, 2);
+    putFixed(frame_, 0, 2);
+    putFixed(frame_, seed, 8);
+    if(SDL_WriteIO(io_, frame_.data(), frame_.size()) != frame_.size()){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayRecorder: write failed: %s", SDL_GetError());
+        close();
+        return false;
+    }
+    bytes_ = frame_.size();
+    frames_ = 0;
+    events_.clear();
+    eventCount_ = 0;
+    events_.reserve(256);
+    frame_.reserve(256);
+    SDL_Log("Recording replay to %s (seed %llu)", path.c_str(), static_cast<unsigned long long>(seed));
+    return true;
+}
+
+void ReplayRecorder::close()
+{
+    if(io_){
+        SDL_CloseIO(io_);
+        io_ = nullptr;
+        SDL_Log("Replay recorded: %llu frames, %llu bytes",
+            static_cast<unsigned long long>(frames_), static_cast<unsigned long long>(bytes_));
+    }
+}
+
+void ReplayRecorder::recordEvent(const SDL_Event& event)
+{
+    if(!io_) return;
+    if(encodeEvent(events_, event)){
+        eventCount_++;
+    }
+}
+
+void ReplayRecorder::endFrame(uint64_t deltaNs)
+{
+    if(!io_) return;
+    frame_.clear();
+    putVarint(frame_, deltaNs);
+    putVarint(frame_, eventCount_);
+    frame_.insert(frame_.end(), events_.begin(), events_.end());
+    if(SDL_WriteIO(io_, frame_.data(), frame_.size()) != frame_.size()){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayRecorder: write failed, recording stopped: %s", SDL_GetError());
+        close();
+        return;
+    }
+    bytes_ += frame_.size();
+    frames_++;
+    events_.clear();
+    eventCount_ = 0;
+}
+
+// -------------------------------------------------------
+// player
+
+bool ReplayPlayer::open(const std::string& path)
+{
+    close();
+    size_t size = 0;
+    void* raw = SDL_LoadFile(path.c_str(), &size);
+    if(!raw){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayPlayer: cannot load %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(raw);
+    data_.assign(bytes, bytes + size);
+    SDL_free(raw);
+
+    Reader in{data_.data(), data_.data() + data_.size()};
+    const uint32_t magic = static_cast<uint32_t>(in.fixed(4));
+    const uint16_t version = static_cast<uint16_t>(in.fixed(2));
+    in.fixed(2);
+    seed_ = in.fixed(8);
+    if(!in.ok || magic != kReplayMagic){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayPlayer: %s is not a replay file", path.c_str());
+        close();
+        return false;
+    }
+    if(version != kReplayVersion && version != 1){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayPlayer: unsupported replay version %u", version);
+        close();
+        return false;
+    }
+    version_ = version;
+    pos_ = static_cast<size_t>(in.p - data_.data());
+    SDL_Log("Replaying %s (seed %llu, %zu bytes)", path.c_str(), static_cast<unsigned long long>(seed_), size);
+    return true;
+}
+
+void ReplayPlayer::close()
+{
+    data_.clear();
+    pos_ = 0;
+    seed_ = 0;
+    version_ = 0;
+    frameNs_ = 0;
+    pendingEvents_ = 0;
+    frames_ = 0;
+    finished_ = false;
+}
+
+bool ReplayPlayer::beginFrame()
+{
+    if(finished_ || data_.empty()) return false;
+
+    // 上一帧没取完的事件直接跳过
+    SDL_Event skipped;
+    while(pendingEvents_ > 0 && pollEvent(skipped)) {}
+
+    if(pos_ >= data_.size()){
+        finished_ = true;
+        return false;
+    }
+    Reader in{data_.data() + pos_, data_.data() + data_.size()};
+    if(version_ == 1){
+        const float dt = in.f32();
+        frameNs_ = dt > 0.0f ? static_cast<uint64_t>(static_cast<double>(dt) * 1.0e9 + 0.5) : 0;
+    } else{
+        frameNs_ = in.varint();
+    }
+    pendingEvents_ = static_cast<uint32_t>(in.varint());
+    if(!in.ok){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayPlayer: truncated frame %llu", static_cast<unsigned long long>(frames_));
+        finished_ = true;
+        return false;
+    }
+    pos_ = static_cast<size_t>(in.p - data_.data());
+    frames_++;
+    return true;
+}
+
+bool ReplayPlayer::pollEvent(SDL_Event& event)
+{
+    if(pendingEvents_ == 0) return false;
+    Reader in{data_.data() + pos_, data_.data() + data_.size()};
+    if(!decodeEvent(in, event)){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ReplayPlayer: corrupt event in frame %llu", static_cast<unsigned long long>(frames_));
+        pendingEvents_ = 0;
+        finished_ = true;
+        pos_ = data_.size();
+        return false;
+    }
+    pos_ = static_cast<size_t>(in.p - data_.data());
+    pendingEvents_--;
+    return true;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tools{
+
+// 录制/回放日志格式（小端）
+//   文件头: "PPRP" | u16 版本 | u16 保留 | u64 随机数种子
+//   每帧:   varint dt（纳秒，GameClock 的帧长）| varint 事件数 | 事件...   （版本 1 的 dt 是 f32 秒，仍可回放）
+//   事件:   u8 种类 | 各字段（整数用 varint，坐标用 f32）
+// 只记录宠物会用到的事件：退出、窗口、键盘、鼠标移动/按键/滚轮，其余丢弃
+// 时间戳不记录，回放时填当前时间
+constexpr uint32_t kReplayMagic = 0x50525050; // "PPRP"
+constexpr uint16_t kReplayVersion = 2;
+
+// 录制：每帧的事件先写入内存缓冲，endFrame() 时连同 dt 一起写入文件
+class ReplayRecorder{
+public:
+    ReplayRecorder() = default;
+    ~ReplayRecorder() {close();}
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    bool open(const std::string& path, uint64_t seed);
+    void close();
+    bool isOpen() const {return io_ != nullptr;}
+
+    void recordEvent(const SDL_Event& event);  // 不支持的事件类型直接忽略
+    void endFrame(uint64_t deltaNs);
+
+    uint64_t getFrameCount() const {return frames_;}
+    uint64_t getBytesWritten() const {return bytes_;}
+
+private:
+    SDL_IOStream* io_ = nullptr;
+    std::vector<uint8_t> events_;   // 本帧已编码的事件
+    uint32_t eventCount_ = 0;
+    std::vector<uint8_t> frame_;    // 写文件用的拼接缓冲，复用避免每帧分配
+    uint64_t frames_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+// 回放：整个日志读入内存，逐帧解码
+class ReplayPlayer{
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const {return !data_.empty();}
+
+    uint64_t getSeed() const {return seed_;}
+
+    // 读入下一帧，日志结束（或损坏）时返回 false
+    bool beginFrame();
+    // 依次取出本帧的事件
+    bool pollEvent(SDL_Event& event);
+    uint64_t getFrameNs() const {return frameNs_;}
+    uint64_t getFrameIndex() const {return frames_;}
+    bool isFinished() const {return finished_;}
+
+private:
+    std::vector<uint8_t> data_;
+    size_t pos_ = 0;
+    uint64_t seed_ = 0;
+    uint16_t version_ = 0;
+    uint64_t frameNs_ = 0;
+    uint32_t pendingEvents_ = 0;
+    uint64_t frames_ = 0;
+    bool finished_ = false;
+};
+
+}
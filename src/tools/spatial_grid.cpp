@@ -0,0 +1,231 @@
+#include "spatial_grid.h"
+#include <algorithm>
+
+namespace tools{
+
+SpatialGrid::SpatialGrid(int cellSize)
+    : cellSize_(cellSize > 0 ? cellSize : 128)
+{
+}
+
+int SpatialGrid::cellCoord(int v) const
+{
+    // 向下取整，负坐标（多屏时窗口左侧/上方）也能落到正确的格子
+    return v >= 0 ? v / cellSize_ : -((-v + cellSize_ - 1) / cellSize_);
+}
+
+uint64_t SpatialGrid::cellKey(int cx, int cy)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+uint32_t SpatialGrid::nextStamp() const
+{
+    if(++stamp_ == 0){
+        // 回绕时清零所有标记，避免误判为已访问
+        for(const Entry& e : entries_) e.stamp = 0;
+        stamp_ = 1;
+    }
+    return stamp_;
+}
+
+void SpatialGrid::link(int id, const Entry& e)
+{
+    for(int cy = e.cy0; cy <= e.cy1; cy++){
+        for(int cx = e.cx0; cx <= e.cx1; cx++){
+            cells_[cellKey(cx, cy)].push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::unlink(int id, const Entry& e)
+{
+    for(int cy = e.cy0; cy <= e.cy1; cy++){
+        for(int cx = e.cx0; cx <= e.cx1; cx++){
+            auto it = cells_.find(cellKey(cx, cy));
+            if(it == cells_.end()) continue;
+            auto& ids = it->second;
+            auto pos = std::find(ids.begin(), ids.end(), id);
+            if(pos != ids.end()){
+                *pos = ids.back();
+                ids.pop_back();
+            }
+        }
+    }
+}
+
+void SpatialGrid::insert(int id, const SDL_Rect& rect, int z)
+{
+    if(id < 0) return;
+    if(contains(id)){
+        setZ(id, z);
+        update(id, rect);
+        return;
+    }
+    if(static_cast<size_t>(id) >= entries_.size()){
+        entries_.resize(static_cast<size_t>(id) + 1);
+    }
+    Entry& e = entries_[id];
+    e.rect = rect;
+    e.z = z;
+    e.alive = true;
+    if(rect.w > 0 && rect.h > 0){
+        e.cx0 = cellCoord(rect.x);
+        e.cy0 = cellCoord(rect.y);
+        e.cx1 = cellCoord(rect.x + rect.w - 1);
+        e.cy1 = cellCoord(rect.y + rect.h - 1);
+    } else{
+        e.cx0 = e.cy0 = 0;
+        e.cx1 = e.cy1 = -1;
+    }
+    link(id, e);
+    count_++;
+}
+
+void SpatialGrid::update(int id, const SDL_Rect& rect)
+{
+    if(!contains(id)) return;
+    Entry& e = entries_[id];
+    e.rect = rect;
+
+    int cx0 = 0, cy0 = 0, cx1 = -1, cy1 = -1;
+    if(rect.w > 0 && rect.h > 0){
+        cx0 = cellCoord(rect.x);
+        cy0 = cellCoord(rect.y);
+        cx1 = cellCoord(rect.x + rect.w - 1);
+        cy1 = cellCoord(rect.y + rect.h - 1);
+    }
+    // 大多数帧里宠物只移动几个像素，格子范围不变
+    if(cx0 == e.cx0 && cy0 == e.cy0 && cx1 == e.cx1 && cy1 == e.cy1){
+        return;
+    }
+    unlink(id, e);
+    e.cx0 = cx0; e.cy0 = cy0; e.cx1 = cx1; e.cy1 = cy1;
+    link(id, e);
+}
+
+void SpatialGrid::setZ(int id, int z)
+{
+    if(contains(id)){
+        entries_[id].z = z;
+    }
+}
+
+void SpatialGrid::remove(int id)
+{
+    if(!contains(id)) return;
+    Entry& e = entries_[id];
+    unlink(id, e);
+    e = Entry{};
+    count_--;
+}
+
+void SpatialGrid::clear()
+{
+    entries_.clear();
+    cells_.clear();
+    count_ = 0;
+}
+
+bool SpatialGrid::contains(int id) const
+{
+    return id >= 0 && static_cast<size_t>(id) < entries_.size() && entries_[id].alive;
+}
+
+bool SpatialGrid::isAbove(int a, int b) const
+{
+    const int za = entries_[a].z, zb = entries_[b].z;
+    return za != zb ? za > zb : a > b;
+}
+
+int SpatialGrid::queryPoint(SDL_Point p) const
+{
+    auto it = cells_.find(cellKey(cellCoord(p.x), cellCoord(p.y)));
+    if(it == cells_.end()) return -1;
+
+    int best = -1;
+    for(int id : it->second){
+        const SDL_Rect& r = entries_[id].rect;
+        if(p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h){
+            if(best < 0 || isAbove(id, best)){
+                best = id;
+            }
+        }
+    }
+    return best;
+}
+
+void SpatialGrid::queryPoint(SDL_Point p, std::vector<int>& out) const
+{
+    out.clear();
+    auto it = cells_.find(cellKey(cellCoord(p.x), cellCoord(p.y)));
+    if(it == cells_.end()) return;
+
+    for(int id : it->second){
+        const SDL_Rect& r = entries_[id].rect;
+        if(p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h){
+            out.push_back(id);
+        }
+    }
+    std::sort(out.begin(), out.end(), [this](int a, int b){ return isAbove(a, b); });
+}
+
+void SpatialGrid::queryRect(const SDL_Rect& rect, std::vector<int>& out) const
+{
+    out.clear();
+    if(rect.w <= 0 || rect.h <= 0) return;
+
+    const uint32_t stamp = nextStamp();
+    const int cx0 = cellCoord(rect.x), cy0 = cellCoord(rect.y);
+    const int cx1 = cellCoord(rect.x + rect.w - 1), cy1 = cellCoord(rect.y + rect.h - 1);
+    for(int cy = cy0; cy <= cy1; cy++){
+        for(int cx = cx0; cx <= cx1; cx++){
+            auto it = cells_.find(cellKey(cx, cy));
+            if(it == cells_.end()) continue;
+            for(int id : it->second){
+                const Entry& e = entries_[id];
+                if(e.stamp == stamp) continue;
+                e.stamp = stamp;
+                const SDL_Rect& r = e.rect;
+                if(r.x < rect.x + rect.w && rect.x < r.x + r.w &&
+                   r.y < rect.y + rect.h && rect.y < r.y + r.h){
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(SDL_FPoint center, float radius, std::vector<int>& out) const
+{
+    out.clear();
+    if(radius < 0.0f) return;
+
+    const uint32_t stamp = nextStamp();
+    const float r2 = radius * radius;
+    const int cx0 = cellCoord(static_cast<int>(center.x - radius) - 1);
+    const int cy0 = cellCoord(static_cast<int>(center.y - radius) - 1);
+    const int cx1 = cellCoord(static_cast<int>(center.x + radius) + 1);
+    const int cy1 = cellCoord(static_cast<int>(center.y + radius) + 1);
+    for(int cy = cy0; cy <= cy1; cy++){
+        for(int cx = cx0; cx <= cx1; cx++){
+            auto it = cells_.find(cellKey(cx, cy));
+            if(it == cells_.end()) continue;
+            for(int id : it->second){
+                const Entry& e = entries_[id];
+                if(e.stamp == stamp) continue;
+                e.stamp = stamp;
+                // 圆心到矩形的最近点
+                const SDL_Rect& r = e.rect;
+                const float nx = std::clamp(center.x, static_cast<float>(r.x), static_cast<float>(r.x + r.w));
+                const float ny = std::clamp(center.y, static_cast<float>(r.y), static_cast<float>(r.y + r.h));
+                const float dx = center.x - nx, dy = center.y - ny;
+                if(dx * dx + dy * dy <= r2){
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+}
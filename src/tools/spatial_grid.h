@@ -0,0 +1,59 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tools{
+
+// 均匀网格空间索引（空间哈希），用于桌宠的命中测试与邻近查询
+// id 为非负的小整数（例如宠物在列表中的下标），z 越大越靠上，z 相同时 id 大的在上
+// 物体移动时调用 update()，只有覆盖的格子范围变化时才会改动格子
+class SpatialGrid{
+public:
+    explicit SpatialGrid(int cellSize = 128);
+
+    void insert(int id, const SDL_Rect& rect, int z = 0);
+    void update(int id, const SDL_Rect& rect);
+    void setZ(int id, int z);
+    void remove(int id);
+    void clear();
+
+    bool contains(int id) const;
+    size_t size() const {return count_;}
+    int getCellSize() const {return cellSize_;}
+
+    // 点查询：返回最上层的 id，没有命中返回 -1
+    int queryPoint(SDL_Point p) const;
+    // 点查询：所有命中，按从上到下排序
+    void queryPoint(SDL_Point p, std::vector<int>& out) const;
+    // 矩形查询：与 rect 相交的所有 id（无序）
+    void queryRect(const SDL_Rect& rect, std::vector<int>& out) const;
+    // 半径查询：与圆相交的所有 id（无序）
+    void queryRadius(SDL_FPoint center, float radius, std::vector<int>& out) const;
+
+private:
+    struct Entry{
+        SDL_Rect rect{0, 0, 0, 0};
+        int z = 0;
+        int cx0 = 0, cy0 = 0, cx1 = -1, cy1 = -1; // 覆盖的格子范围（闭区间）
+        bool alive = false;
+        mutable uint32_t stamp = 0; // 查询去重
+    };
+
+    int cellCoord(int v) const;
+    static uint64_t cellKey(int cx, int cy);
+    void link(int id, const Entry& e);
+    void unlink(int id, const Entry& e);
+    bool isAbove(int a, int b) const; // a 是否在 b 之上
+    uint32_t nextStamp() const;
+
+    int cellSize_;
+    size_t count_ = 0;
+    std::vector<Entry> entries_; // 按 id 索引
+    std::unordered_map<uint64_t, std::vector<int>> cells_;
+    mutable uint32_t stamp_ = 0;
+};
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace tools{
+
+// 定长无锁环形队列：一个生产者线程 push，一个消费者线程 pop
+// 容量必须是 2 的幂；满了 push 返回 false（由调用方决定丢弃还是重试）
+template<typename T, size_t Capacity>
+class SpscQueue{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+    bool push(const T& item){
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if(tail - headCache_ == Capacity){
+            headCache_ = head_.load(std::memory_order_acquire);
+            if(tail - headCache_ == Capacity) return false;
+        }
+        items_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item){
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if(head == tailCache_){
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if(head == tailCache_) return false;
+        }
+        item = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t sizeApprox() const {return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);}
+
+private:
+    std::array<T, Capacity> items_{};
+    alignas(64) std::atomic<size_t> head_{0}; // 消费者写
+    size_t tailCache_ = 0;                    // 消费者看到的 tail_
+    alignas(64) std::atomic<size_t> tail_{0}; // 生产者写
+    size_t headCache_ = 0;                    // 生产者看到的 head_
+};
+
+} // namespace tools
@@ -0,0 +1,45 @@
+#include "string_format.h"
+#include <cstdio>
+
+namespace tools{
+
+void vappendf(std::string& out, const char* fmt, va_list ap)
+{
+    char buffer[256];
+    va_list copy;
+    va_copy(copy, ap);
+    const int n = std::vsnprintf(buffer, sizeof(buffer), fmt, copy);
+    va_end(copy);
+    if(n <= 0){
+        return; // 空串或格式错误
+    }
+    const size_t length = static_cast<size_t>(n);
+    if(length < sizeof(buffer)){
+        out.append(buffer, length);
+        return;
+    }
+    // 第二遍直接写进 out：vsnprintf 的结尾 '\0' 落在 out[size()] 上
+    const size_t start = out.size();
+    out.resize(start + length);
+    std::vsnprintf(out.data() + start, length + 1, fmt, ap);
+}
+
+void appendf(std::string& out, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vappendf(out, fmt, ap);
+    va_end(ap);
+}
+
+std::string format(const char* fmt, ...)
+{
+    std::string out;
+    va_list ap;
+    va_start(ap, fmt);
+    vappendf(out, fmt, ap);
+    va_end(ap);
+    return out;
+}
+
+} // namespace tools
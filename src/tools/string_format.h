@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdarg>
+#include <string>
+
+// printf 风格的格式检查（GCC/Clang）；不依赖 SDL，资源烘焙工具也能用
+#if defined(__GNUC__) || defined(__clang__)
+#define TOOLS_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define TOOLS_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+namespace tools{
+
+// 格式化追加到 out 末尾，长度不限（不截断）：短行先写进栈上的缓冲区，放不下时按算出的长度再格式化一次
+void vappendf(std::string& out, const char* fmt, va_list ap);
+void appendf(std::string& out, const char* fmt, ...) TOOLS_PRINTF_FORMAT(2, 3);
+std::string format(const char* fmt, ...) TOOLS_PRINTF_FORMAT(1, 2);
+
+} // namespace tools
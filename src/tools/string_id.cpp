@@ -0,0 +1,61 @@
+#include "string_id.h"
+#include <SDL3/SDL.h>
+
+namespace tools{
+
+namespace {
+
+inline char lower(char c){
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+} // namespace
+
+const char* StringId::c_str() const
+{
+    const char* name = StringTable::getInstance().getName(*this);
+    return name ? name : "?";
+}
+
+StringId StringTable::intern(std::string_view name)
+{
+    const StringId id(name);
+    if(!id.isValid()){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StringTable: '%.*s' hashes to 0", static_cast<int>(name.size()), name.data());
+        return StringId();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = names_.find(id.value());
+    if(it == names_.end()){
+        names_.emplace(id.value(), std::string(name));
+        return id;
+    }
+    // 同一个名字（不计大小写）重复登记是正常的
+    const std::string& known = it->second;
+    bool same = known.size() == name.size();
+    for(size_t i = 0; same && i < name.size(); i++){
+        same = lower(known[i]) == lower(name[i]);
+    }
+    if(!same){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StringTable: '%.*s' collides with '%s' (0x%08x)",
+            static_cast<int>(name.size()), name.data(), known.c_str(), id.value());
+        return StringId();
+    }
+    return id;
+}
+
+const char* StringTable::getName(StringId id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = names_.find(id.value());
+    return it == names_.end() ? nullptr : it->second.c_str();
+}
+
+size_t StringTable::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+} // namespace tools
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace tools{
+
+// FNV-1a 32 位哈希，ASCII 大小写不敏感（清单里的名字历来不区分大小写）
+// constexpr：代码里写死的名字在编译期就变成整数
+constexpr uint32_t fnv1a(std::string_view s){
+    uint32_t h = 2166136261u;
+    for(char c : s){
+        const unsigned char u = static_cast<unsigned char>(c);
+        h ^= (u >= 'A' && u <= 'Z') ? static_cast<uint32_t>(u + ('a' - 'A')) : u;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 字符串 id：只是一个 32 位哈希，比较、拷贝、做下标都不碰 std::string
+// 清单里的名字在加载时通过 StringTable::intern() 登记（用于反查名字和检查冲突）
+class StringId{
+public:
+    constexpr StringId() = default;
+    constexpr explicit StringId(std::string_view name) : hash_(fnv1a(name)) {}
+    static constexpr StringId fromValue(uint32_t hash){StringId id; id.hash_ = hash; return id;}
+
+    constexpr uint32_t value() const {return hash_;}
+    constexpr bool isValid() const {return hash_ != 0;}
+    const char* c_str() const; // 登记过的名字，否则 "?"（只用于日志）
+
+    constexpr bool operator==(StringId other) const {return hash_ == other.hash_;}
+    constexpr bool operator!=(StringId other) const {return hash_ != other.hash_;}
+
+private:
+    uint32_t hash_ = 0; // 0 表示无效
+};
+
+namespace literals{
+    constexpr StringId operator""_sid(const char* s, size_t n){return StringId(std::string_view(s, n));}
+}
+
+// 全局字符串表（单例）：id -> 名字
+// 只在加载资源时写入，帧循环里不需要查它
+class StringTable{
+public:
+    static StringTable& getInstance(){
+        static StringTable instance;
+        return instance;
+    }
+
+    // 登记名字并返回 id；和已登记的另一个名字哈希冲突时记日志并返回无效 id
+    StringId intern(std::string_view name);
+    const char* getName(StringId id) const; // 未登记返回 nullptr
+    size_t size() const;
+
+private:
+    StringTable() = default;
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, std::string> names_; // 节点地址稳定，getName 返回的指针一直有效
+};
+
+} // namespace tools
+
+namespace std{
+template<>
+struct hash<tools::StringId>{
+    size_t operator()(tools::StringId id) const noexcept {return id.value();}
+};
+} // namespace std
@@ -11,10 +11,21 @@ namespace tools{
 
         // 获取当前屏幕大小
         void getWindowSize(int& w, int& h){
+#ifdef _WIN32
             w = GetSystemMetrics(SM_CXSCREEN);
             h = GetSystemMetrics(SM_CYSCREEN);
+#else
+            // 主显示器的桌面区域（SDL 视频子系统初始化之后才有）
+            SDL_Rect bounds{0, 0, 800, 600};
+            if(!SDL_GetDisplayBounds(SDL_GetPrimaryDisplay(), &bounds)){
+                SDL_Log("SDL_GetDisplayBounds failed: %s", SDL_GetError());
+            }
+            w = bounds.w;
+            h = bounds.h;
+#endif
         }
 
+#ifdef _WIN32
         // 获取鼠标位置
         SDL_Point getClientMousePosition(HWND hwnd){
             POINT p;
@@ -76,6 +87,7 @@ namespace tools{
 
             return;
         }
+#endif // _WIN32
 
         // isFunctions
 
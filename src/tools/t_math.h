@@ -7,5 +7,50 @@ namespace tools{
 
     namespace math{
 
+        inline float clamp01(float t){
+            return t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        }
+
+        inline float lerp(float a, float b, float t){
+            return a + (b - a) * t;
+        }
+
+        inline glm::vec2 lerp(glm::vec2 a, glm::vec2 b, float t){
+            return glm::vec2(lerp(a.x, b.x, t), lerp(a.y, b.y, t));
+        }
+
+        // 缓动曲线，输入输出都在 [0, 1]
+        enum class Ease{
+            Linear,
+            QuadIn,
+            QuadOut,
+            QuadInOut,
+            CubicIn,
+            CubicOut,
+            CubicInOut,
+            SineInOut,
+            SmoothStep
+        };
+
+        inline float ease(Ease type, float t){
+            t = clamp01(t);
+            switch(type){
+                case Ease::QuadIn:      return t * t;
+                case Ease::QuadOut:     return t * (2.0f - t);
+                case Ease::QuadInOut:   return t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+                case Ease::CubicIn:     return t * t * t;
+                case Ease::CubicOut:    {float u = 1.0f - t; return 1.0f - u * u * u;}
+                case Ease::CubicInOut:  {
+                    if(t < 0.5f) return 4.0f * t * t * t;
+                    float u = 2.0f - 2.0f * t;
+                    return 1.0f - u * u * u * 0.5f;
+                }
+                case Ease::SineInOut:   return 0.5f - 0.5f * cosf(t * 3.14159265f);
+                case Ease::SmoothStep:  return t * t * (3.0f - 2.0f * t);
+                case Ease::Linear:
+                default:                return t;
+            }
+        }
+
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,348 @@
+#include "timer_service.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace tools{
+
+namespace{
+
+inline int countTrailingZeros(uint64_t v){
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+inline uint64_t rotateRight(uint64_t v, int n){
+    n &= 63;
+    return n == 0 ? v : ((v >> n) | (v << (64 - n)));
+}
+
+// 第 level 层中，从当前槽的下一个开始（含回到当前槽，即 64 个之后）第一个非空槽的偏移 [1, 64]
+inline int firstOccupiedOffset(uint64_t occupied, int current){
+    uint64_t r = rotateRight(occupied, current + 1);
+    return countTrailingZeros(r) + 1;
+}
+
+}
+
+TimerService::TimerService(uint64_t tickNs)
+    : tickNs_(tickNs > 0 ? tickNs : 1'000'000ULL)
+{
+    for(auto& level : heads_){
+        std::fill(std::begin(level), std::end(level), kNil);
+    }
+}
+
+// -------------------------------------------------------
+// nodes
+
+TimerService::Node* TimerService::lookup(TimerId id)
+{
+    const uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    const uint32_t gen = static_cast<uint32_t>(id >> 32);
+    if(id == 0 || index >= nodes_.size()) return nullptr;
+    Node& n = nodes_[index];
+    return (n.state != State::Free && n.generation == gen) ? &n : nullptr;
+}
+
+const TimerService::Node* TimerService::lookup(TimerId id) const
+{
+    return const_cast<TimerService*>(this)->lookup(id);
+}
+
+uint32_t TimerService::allocNode()
+{
+    if(!freeList_.empty()){
+        uint32_t index = freeList_.back();
+        freeList_.pop_back();
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerService::freeNode(uint32_t index)
+{
+    Node& n = nodes_[index];
+    if(n.state == State::Scheduled){
+        unlink(index);
+    }
+    n.state = State::Free;
+    n.callback = nullptr;
+    n.fired = 0;
+    n.generation++;
+    if(n.generation == 0) n.generation = 1; // id 永远不为 0
+    freeList_.push_back(index);
+}
+
+uint64_t TimerService::toTicks(uint64_t ns) const
+{
+    // 向上取整，至少 1 tick，保证不会提前触发
+    uint64_t ticks = (ns + tickNs_ - 1) / tickNs_;
+    return ticks > 0 ? ticks : 1;
+}
+
+// -------------------------------------------------------
+// wheel
+
+void TimerService::link(uint32_t index)
+{
+    Node& n = nodes_[index];
+    // 只有下放时会出现 expiry == now_，此时放进第 0 层当前槽，本 tick 稍后就会触发
+    const uint64_t maxDelta = (1ULL << (kSlotBits * kLevels)) - 1;
+    if(n.expiry < now_) n.expiry = now_;
+    if(n.expiry - now_ > maxDelta) n.expiry = now_ + maxDelta;
+
+    const uint64_t delta = n.expiry - now_;
+    int level = 0;
+    while(level < kLevels - 1 && delta >= (1ULL << (kSlotBits * (level + 1)))){
+        level++;
+    }
+    const int slot = static_cast<int>((n.expiry >> (kSlotBits * level)) & (kSlots - 1));
+
+    n.level = static_cast<uint8_t>(level);
+    n.slot = static_cast<uint8_t>(slot);
+    n.prev = kNil;
+    n.next = heads_[level][slot];
+    if(n.next != kNil) nodes_[n.next].prev = index;
+    heads_[level][slot] = index;
+    occupied_[level] |= (1ULL << slot);
+    n.state = State::Scheduled;
+    scheduled_++;
+}
+
+void TimerService::unlink(uint32_t index)
+{
+    Node& n = nodes_[index];
+    if(n.prev != kNil){
+        nodes_[n.prev].next = n.next;
+    } else{
+        heads_[n.level][n.slot] = n.next;
+        if(n.next == kNil) occupied_[n.level] &= ~(1ULL << n.slot);
+    }
+    if(n.next != kNil) nodes_[n.next].prev = n.prev;
+    n.prev = n.next = kNil;
+    n.state = State::Idle;
+    scheduled_--;
+}
+
+void TimerService::cascade(int level, int slot)
+{
+    uint32_t index = heads_[level][slot];
+    heads_[level][slot] = kNil;
+    occupied_[level] &= ~(1ULL << slot);
+    while(index != kNil){
+        uint32_t next = nodes_[index].next;
+        scheduled_--;
+        link(index); // 相对新的 now_ 重新放置，会落到更低的层
+        index = next;
+    }
+}
+
+void TimerService::tickOnce()
+{
+    now_++;
+
+    // 从对齐的最高层往下逐层下放，保证高层下放的定时器能继续落到低层
+    int top = 0;
+    while(top < kLevels - 1 && (now_ & ((1ULL << (kSlotBits * (top + 1))) - 1)) == 0){
+        top++;
+    }
+    for(int level = top; level >= 1; level--){
+        const int slot = static_cast<int>((now_ >> (kSlotBits * level)) & (kSlots - 1));
+        if(occupied_[level] & (1ULL << slot)){
+            cascade(level, slot);
+        }
+    }
+
+    // 触发第 0 层当前槽：逐个取出头节点，回调中调度/取消其他定时器都是安全的
+    // （新调度的定时器至少在 1 tick 之后，不会落回这个槽）
+    const int slot = static_cast<int>(now_ & (kSlots - 1));
+    while(heads_[0][slot] != kNil){
+        const uint32_t index = heads_[0][slot];
+        unlink(index);
+        Node& n = nodes_[index];
+        n.fired++;
+        firedTotal_++;
+
+        if(n.period > 0){
+            n.expiry += n.period;
+            link(index);
+        }
+        // 先取出回调：回调里可能取消自己或调度新的定时器导致 nodes_ 扩容
+        const bool release = (n.period == 0 && !n.persistent);
+        Callback cb = release ? std::move(n.callback) : n.callback;
+        if(release){
+            freeNode(index);
+        }
+        if(cb){
+            cb();
+        }
+    }
+}
+
+uint64_t TimerService::nextEventTick() const
+{
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for(int level = 0; level < kLevels; level++){
+        if(occupied_[level] == 0) continue;
+        const int shift = kSlotBits * level;
+        const uint64_t bucket = now_ >> shift;
+        const int current = static_cast<int>(bucket & (kSlots - 1));
+        const int offset = firstOccupiedOffset(occupied_[level], current);
+        best = std::min(best, (bucket + static_cast<uint64_t>(offset)) << shift);
+    }
+    return best;
+}
+
+void TimerService::advance(uint64_t ns)
+{
+    remainderNs_ += ns;
+    const uint64_t ticks = remainderNs_ / tickNs_;
+    remainderNs_ -= ticks * tickNs_;
+    const uint64_t target = now_ + ticks;
+
+    while(now_ < target){
+        // 跳过中间没有任何事情发生的 tick
+        const uint64_t next = scheduled_ > 0 ? nextEventTick() : std::numeric_limits<uint64_t>::max();
+        if(next > target){
+            now_ = target;
+            break;
+        }
+        now_ = next - 1;
+        tickOnce();
+    }
+}
+
+uint64_t TimerService::getNextDeadlineNs() const
+{
+    if(scheduled_ == 0) return std::numeric_limits<uint64_t>::max();
+
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for(int level = 0; level < kLevels; level++){
+        if(occupied_[level] == 0) continue;
+        const int shift = kSlotBits * level;
+        const int current = static_cast<int>((now_ >> shift) & (kSlots - 1));
+        const int slot = (current + firstOccupiedOffset(occupied_[level], current)) & (kSlots - 1);
+        if(level == 0){
+            // 第 0 层的槽就是精确的到期 tick
+            best = std::min(best, nodes_[heads_[0][slot]].expiry);
+        } else{
+            // 高层一个槽覆盖多个 tick，扫描这个槽取最早的
+            for(uint32_t i = heads_[level][slot]; i != kNil; i = nodes_[i].next){
+                best = std::min(best, nodes_[i].expiry);
+            }
+        }
+    }
+    const uint64_t ticks = best > now_ ? best - now_ : 0;
+    const uint64_t ns = ticks * tickNs_;
+    return ns > remainderNs_ ? ns - remainderNs_ : 0;
+}
+
+// -------------------------------------------------------
+// public api
+
+TimerId TimerService::schedule(uint64_t delayNs, uint64_t periodNs, Callback callback, bool persistent)
+{
+    const uint32_t index = allocNode();
+    Node& n = nodes_[index];
+    n.callback = std::move(callback);
+    n.persistent = persistent;
+    n.fired = 0;
+    n.period = periodNs > 0 ? toTicks(periodNs) : 0;
+    n.expiry = now_ + toTicks(delayNs + remainderNs_);
+    link(index);
+    return (static_cast<uint64_t>(n.generation) << 32) | index;
+}
+
+bool TimerService::reschedule(TimerId id, uint64_t delayNs, uint64_t periodNs)
+{
+    Node* n = lookup(id);
+    if(!n) return false;
+    const uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    if(n->state == State::Scheduled) unlink(index);
+    n->fired = 0;
+    n->period = periodNs > 0 ? toTicks(periodNs) : 0;
+    n->expiry = now_ + toTicks(delayNs + remainderNs_);
+    link(index);
+    return true;
+}
+
+bool TimerService::cancel(TimerId id)
+{
+    if(!lookup(id)) return false;
+    freeNode(static_cast<uint32_t>(id & 0xFFFFFFFFu));
+    return true;
+}
+
+bool TimerService::pause(TimerId id)
+{
+    Node* n = lookup(id);
+    if(!n || n->state != State::Scheduled) return false;
+    n->remaining = n->expiry - now_;
+    unlink(static_cast<uint32_t>(id & 0xFFFFFFFFu));
+    n->state = State::Paused;
+    return true;
+}
+
+bool TimerService::resume(TimerId id)
+{
+    Node* n = lookup(id);
+    if(!n || n->state != State::Paused) return false;
+    n->expiry = now_ + std::max<uint64_t>(n->remaining, 1);
+    link(static_cast<uint32_t>(id & 0xFFFFFFFFu));
+    return true;
+}
+
+void TimerService::setCallback(TimerId id, Callback callback)
+{
+    if(Node* n = lookup(id)){
+        n->callback = std::move(callback);
+    }
+}
+
+bool TimerService::isValid(TimerId id) const
+{
+    return lookup(id) != nullptr;
+}
+
+bool TimerService::isScheduled(TimerId id) const
+{
+    const Node* n = lookup(id);
+    return n && n->state == State::Scheduled;
+}
+
+uint32_t TimerService::takeFired(TimerId id)
+{
+    Node* n = lookup(id);
+    if(!n) return 0;
+    uint32_t fired = n->fired;
+    n->fired = 0;
+    return fired;
+}
+
+uint64_t TimerService::getRemainingNs(TimerId id) const
+{
+    const Node* n = lookup(id);
+    if(!n) return 0;
+    uint64_t ticks = 0;
+    if(n->state == State::Scheduled){
+        ticks = n->expiry - now_;
+    } else if(n->state == State::Paused){
+        ticks = n->remaining;
+    } else{
+        return 0;
+    }
+    const uint64_t ns = ticks * tickNs_;
+    return ns > remainderNs_ ? ns - remainderNs_ : 0;
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tools{
+
+// 定时器 id：高 32 位为代数（防止复用后误操作），低 32 位为节点下标，0 表示无效
+using TimerId = uint64_t;
+
+// 分层时间轮定时服务
+// 6 层 x 64 槽，每 tick 默认 1ms，最长约 2 年；调度与取消都是 O(1)
+// 每帧由游戏循环调用一次 advance()，没有到期/需要下放的槽时直接跳过，
+// 不再逐个轮询定时器
+// 到期通知两种方式：回调（callback），或累计触发次数由持有者 takeFired() 取走（事件）
+class TimerService{
+public:
+    using Callback = std::function<void()>;
+
+    static TimerService& getInstance(){
+        static TimerService instance;
+        return instance;
+    }
+
+    explicit TimerService(uint64_t tickNs = 1'000'000ULL);
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    // delayNs 后触发，periodNs > 0 时按周期重复
+    // persistent = false：一次性定时器触发后自动释放（回调方式）
+    // persistent = true：触发后保留，直到 cancel()，用于 takeFired() 方式
+    TimerId schedule(uint64_t delayNs, uint64_t periodNs, Callback callback, bool persistent = false);
+    // 重新设置已有定时器（保留 id），失效的 id 返回 false
+    bool reschedule(TimerId id, uint64_t delayNs, uint64_t periodNs);
+    bool cancel(TimerId id);    // 取消并释放
+    bool pause(TimerId id);     // 暂停，保留剩余时间
+    bool resume(TimerId id);    // 继续
+    void setCallback(TimerId id, Callback callback);
+
+    bool isValid(TimerId id) const;
+    bool isScheduled(TimerId id) const;
+    uint32_t takeFired(TimerId id);         // 取走并清零触发次数
+    uint64_t getRemainingNs(TimerId id) const;
+
+    // 推进时间，触发到期定时器的回调
+    void advance(uint64_t ns);
+
+    // 距离最近一个到期时间的纳秒数，没有定时器时返回 UINT64_MAX
+    uint64_t getNextDeadlineNs() const;
+
+    uint64_t getNowNs() const {return now_ * tickNs_ + remainderNs_;}
+    uint64_t getTickNs() const {return tickNs_;}
+    size_t getScheduledCount() const {return scheduled_;}
+    uint64_t getFiredTotal() const {return firedTotal_;} // 累计触发次数（唤醒次数）
+
+private:
+    static constexpr int kLevels = 6;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr uint32_t kNil = 0xFFFFFFFFu;
+
+    enum class State : uint8_t {Free, Scheduled, Paused, Idle};
+
+    struct Node{
+        uint64_t expiry = 0;    // tick
+        uint64_t period = 0;    // tick，0 表示一次性
+        uint64_t remaining = 0; // 暂停时保存的剩余 tick
+        Callback callback;
+        uint32_t prev = kNil, next = kNil;
+        uint32_t generation = 1;
+        uint32_t fired = 0;
+        uint8_t level = 0, slot = 0;
+        State state = State::Free;
+        bool persistent = false;
+    };
+
+    Node* lookup(TimerId id);
+    const Node* lookup(TimerId id) const;
+    uint32_t allocNode();
+    void freeNode(uint32_t index);
+    uint64_t toTicks(uint64_t ns) const;
+
+    void link(uint32_t index);      // 按 expiry 放入对应层与槽
+    void unlink(uint32_t index);
+    void tickOnce();                // now_ + 1，下放高层槽并触发第 0 层当前槽
+    void cascade(int level, int slot);
+    uint64_t nextEventTick() const; // 下一个需要处理（触发或下放）的 tick
+
+    uint64_t tickNs_;
+    uint64_t now_ = 0;          // 当前 tick
+    uint64_t remainderNs_ = 0;  // 不足 1 tick 的余量
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeList_;
+    uint32_t heads_[kLevels][kSlots];
+    uint64_t occupied_[kLevels] = {}; // 每层非空槽的位图
+    size_t scheduled_ = 0;
+    uint64_t firedTotal_ = 0;
+};
+
+}
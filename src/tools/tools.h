@@ -3,7 +3,9 @@
 #include <iostream>
 #include <vector>
 #include <SDL3/SDL.h>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 
 // 工具类
@@ -17,11 +19,19 @@ namespace tools{
 
         // getters
         void getWindowSize(int& w, int& h);
+#ifdef _WIN32
         SDL_Point getClientMousePosition(HWND hwnd);
 
         // changers, which is real workers
+        // Windows：按鼠标是否在桌宠上切换 WS_EX_TRANSPARENT（需要每帧查询鼠标位置）
         void ChangeWindowTransparent(HWND hwnd, bool isInArea, bool &transparentState);
         void ChangeTransparentState(HWND hwnd, SDL_Point point, SDL_Rect rect, bool &transparentState);  // 功能整合函数
+#endif
+
+        // 输入区域（X11 SHAPE 扩展）：窗口只在 rects 的并集内接收鼠标，其余点击直接落到下面的窗口，不需要轮询
+        // rects 为窗口坐标；不支持时（Windows、Wayland、dummy 驱动、没有 X11 编译）返回 false
+        bool SupportsInputShape(SDL_Window* window);
+        bool SetWindowInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects);
 
         // Isfunctions, which is used for checking states
         bool IsPointInRect(SDL_Rect rect, SDL_Point point);
@@ -29,6 +39,7 @@ namespace tools{
         // checkers, just for debugging
         bool CheckClickThrough(SDL_Window* window, bool is_transparent); // 检查窗口是否点击穿透
         bool CheckIsInAnyRects(std::vector<SDL_Rect>& rects, SDL_Point mouse_point, bool is_tansparent); // 检查鼠标是否在任意一个矩形内
+        bool CheckInputShape(SDL_Window* window, const std::vector<SDL_Rect>& rects); // 从 X 服务器读回输入区域，与 rects 的并集比较（可在 Xvfb 下自动测试）
     }
 
     // to do ...
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tools{
+
+// 无锁三缓冲：一个生产者、一个消费者
+// - 生产者总在自己的一份里写，publish() 与中间份交换，从不等待
+// - 消费者 consume() 取走最新发布的一份（中间的旧帧直接被覆盖），没有新帧时继续用手里这份
+// - 两边各持有一份，中间一份用于交换，所以写和读永远不会碰到同一份
+template<typename T>
+class TripleBuffer{
+public:
+    // 生产者
+    T& write() {return slots_[back_];}
+    void publish(){
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) & kIndex;
+    }
+
+    // 消费者：有新发布的一份返回 true
+    bool consume(){
+        if((middle_.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const T& read() const {return slots_[front_];}
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4; // 中间份是否还没被消费
+
+    std::array<T, 3> slots_{};
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t back_ = 0;  // 只有生产者访问
+    alignas(64) uint8_t front_ = 2; // 只有消费者访问
+};
+
+} // namespace tools
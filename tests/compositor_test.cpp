@@ -0,0 +1,176 @@
+// CPU 合成：SSE2/AVX2 行内核与标量内核逐字节一致（各种长度与未对齐的起点），标量内核与浮点参考相差不超过 1；
+// CpuCanvas 的缩放/翻转 blit 与逐像素参考一致，begin() 清掉画过的区域
+// 当前 CPU 不支持（或没有编译）的内核跳过
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "core/compositor.h"
+
+#include "test_expect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+// 随机的预乘像素：偏向全透明/不透明，颜色分量不超过 alpha
+Uint32 randomPixel(std::mt19937& rng){
+    const uint32_t pick = rng() % 8;
+    const Uint32 a = pick < 2 ? 0 : (pick < 4 ? 255 : rng() % 256);
+    Uint32 p = a << 24;
+    for(int shift = 0; shift < 24; shift += 8){
+        p |= (a ? rng() % (a + 1) : 0) << shift;
+    }
+    return p;
+}
+
+struct Kernel{
+    const char* name;
+    compose::BlendRowFn fn;
+};
+
+std::vector<Kernel> availableKernels(){
+    std::vector<Kernel> kernels;
+    compose::BlendRowFn fn = compose::getBlendRowSSE2();
+    if(fn && SDL_HasSSE2()) kernels.push_back({"sse2", fn});
+    fn = compose::getBlendRowAVX2();
+    if(fn && SDL_HasAVX2()) kernels.push_back({"avx2", fn});
+    return kernels;
+}
+
+void testScalarReference(){
+    std::mt19937 rng(1);
+    std::vector<Uint32> src(4096), dst(4096), out;
+    for(int round = 0; round < 50; round++){
+        for(size_t i = 0; i < src.size(); i++){
+            src[i] = randomPixel(rng);
+            dst[i] = randomPixel(rng);
+        }
+        out = dst;
+        compose::blendRowScalar(out.data(), src.data(), static_cast<int>(src.size()));
+        for(size_t i = 0; i < src.size(); i++){
+            const Uint32 a = src[i] >> 24;
+            for(int shift = 0; shift < 32; shift += 8){
+                const double ref = std::min(255.0, ((src[i] >> shift) & 0xFF) + ((dst[i] >> shift) & 0xFF) * (255 - a) / 255.0);
+                const int got = static_cast<int>((out[i] >> shift) & 0xFF);
+                expect(std::abs(got - static_cast<int>(std::lround(ref))) <= 1, "scalar vs reference", static_cast<uint64_t>(got), static_cast<uint64_t>(std::lround(ref)));
+            }
+        }
+    }
+}
+
+void testKernelsMatchScalar(const std::vector<Kernel>& kernels){
+    std::mt19937 rng(2);
+    constexpr int kMax = 160;
+    std::vector<Uint32> src(kMax + 8), base(kMax + 8), want, got;
+    for(const Kernel& kernel : kernels){
+        for(int round = 0; round < 400; round++){
+            for(size_t i = 0; i < src.size(); i++){
+                src[i] = randomPixel(rng);
+                base[i] = randomPixel(rng);
+            }
+            // 长度覆盖 0、不满一个向量、整向量和尾部；起点错开，覆盖未对齐的访问
+            const int count = round < kMax ? round : static_cast<int>(rng() % kMax);
+            const int srcOffset = static_cast<int>(rng() % 8), dstOffset = static_cast<int>(rng() % 8);
+            want = base;
+            got = base;
+            compose::blendRowScalar(want.data() + dstOffset, src.data() + srcOffset, count);
+            kernel.fn(got.data() + dstOffset, src.data() + srcOffset, count);
+            for(size_t i = 0; i < got.size(); i++){
+                if(got[i] != want[i]){
+                    std::printf("%s: count %d, pixel %zu\n", kernel.name, count, i);
+                    expectEq("kernel vs scalar", got[i], want[i]);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void testCanvasBlit(const std::vector<Kernel>& kernels){
+    std::mt19937 rng(3);
+    CpuSprite sprite;
+    sprite.width = 40;
+    sprite.height = 24;
+    sprite.pixels.resize(static_cast<size_t>(sprite.width) * sprite.height);
+    for(Uint32& p : sprite.pixels) p = randomPixel(rng);
+
+    constexpr int kWidth = 120, kHeight = 80;
+    std::vector<Kernel> all = kernels;
+    all.insert(all.begin(), Kernel{"scalar", compose::blendRowScalar});
+    std::vector<Uint32> first;
+    for(const Kernel& kernel : all){
+        CpuCanvas canvas;
+        expect(canvas.resize(kWidth, kHeight), "resize", 0, 1);
+        canvas.setKernel(kernel.fn);
+        canvas.begin();
+
+        // 第一块：3 倍放大 + 翻转，左侧越出画布
+        const SDL_Rect src{4, 2, 16, 10}, dst{-8, 10, 48, 30};
+        canvas.blit(sprite, src, dst, true);
+        for(int y = 0; y < kHeight; y++){
+            for(int x = 0; x < kWidth; x++){
+                Uint32 want = 0;
+                if(x >= std::max(dst.x, 0) && x < dst.x + dst.w && y >= dst.y && y < dst.y + dst.h){
+                    const int u = src.w - 1 - (x - dst.x) * src.w / dst.w;
+                    const int v = (y - dst.y) * src.h / dst.h;
+                    want = sprite.pixels[static_cast<size_t>(src.y + v) * sprite.width + src.x + u];
+                    if((want >> 24) == 0) want = 0; // 混到全透明的画布上
+                }
+                const Uint32 got = canvas.getPixels()[static_cast<size_t>(y) * kWidth + x];
+                if(got != want){
+                    std::printf("%s: blit pixel (%d, %d)\n", kernel.name, x, y);
+                    expectEq("blit", got, want);
+                    y = kHeight;
+                    break;
+                }
+            }
+        }
+        const SDL_Rect& dirty = canvas.getDirtyRect();
+        expect(dirty.x == 0 && dirty.y == 10 && dirty.w == 40 && dirty.h == 30, "dirty rect",
+               static_cast<uint64_t>(dirty.w), 40);
+
+        // 第二块叠在上面（缩小），脏矩形取并集；不同内核的画布结果完全相同
+        canvas.blit(sprite, SDL_Rect{0, 0, 40, 24}, SDL_Rect{30, 40, 27, 13}, false);
+        const SDL_Rect& united = canvas.getDirtyRect();
+        expect(united.x == 0 && united.y == 10 && united.w == 57 && united.h == 43, "united dirty rect",
+               static_cast<uint64_t>(united.w), 57);
+        std::vector<Uint32> pixels(canvas.getPixels(), canvas.getPixels() + kWidth * kHeight);
+        if(first.empty()){
+            first = pixels;
+        } else{
+            expect(pixels == first, "canvas same across kernels", 0, 1);
+        }
+
+        // begin() 清掉上一帧画过的区域
+        canvas.begin();
+        expect(std::all_of(canvas.getPixels(), canvas.getPixels() + kWidth * kHeight, [](Uint32 p){return p == 0;}),
+               "begin clears", 0, 1);
+        expectEq("begin resets dirty", canvas.getDirtyRect().w, 0);
+
+        // 完全在画布外/空矩形不画
+        canvas.blit(sprite, src, SDL_Rect{kWidth, 0, 10, 10}, false);
+        canvas.blit(sprite, SDL_Rect{0, 0, 0, 4}, SDL_Rect{0, 0, 10, 10}, false);
+        expectEq("offscreen dirty", canvas.getDirtyRect().w, 0);
+    }
+}
+
+} // namespace
+
+int main(){
+    const std::vector<Kernel> kernels = availableKernels();
+    const char* selected = nullptr;
+    compose::selectBlendRow(&selected);
+    std::printf("compositor_test: %zu SIMD kernel(s), selected %s\n", kernels.size(), selected ? selected : "?");
+
+    testScalarReference();
+    testKernelsMatchScalar(kernels);
+    testCanvasBlit(kernels);
+    return test::finish("compositor_test");
+}
@@ -0,0 +1,151 @@
+// EventBus 内部事件：只有订阅了的类型进队列，按 post 顺序分发，回调里 post 的留到下一次，队列满时丢弃
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "core/eventbus.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+// 只当作身份标记，不解引用
+DesktopPet* fakePet(int i){
+    static char pets[8];
+    return reinterpret_cast<DesktopPet*>(&pets[i]);
+}
+
+GameEvent makeEvent(GameEvent::Type type, int pet, uint32_t to){
+    GameEvent e;
+    e.type = type;
+    e.pet = fakePet(pet);
+    e.to = to;
+    return e;
+}
+
+struct Recorder{
+    std::vector<GameEvent> events;
+    bool repost = false; // 回调里再 post 一个
+};
+
+void record(void* userdata, const GameEvent& event){
+    Recorder* r = static_cast<Recorder*>(userdata);
+    r->events.push_back(event);
+    if(r->repost){
+        r->repost = false;
+        EventBus::getInstance().post(makeEvent(GameEvent::Type::AnimationFinished, 7, 99));
+    }
+}
+
+void testUnsubscribedDropped(){
+    EventBus& bus = EventBus::getInstance();
+    bus.clear();
+
+    // 没有任何订阅：post 成功但不进队列
+    expectEq("no subscriber post", bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 1)), 1);
+    expectEq("no subscriber queued", bus.getQueuedGameEvents(), 0);
+
+    // 只订阅动画结束：状态切换直接丢掉，也不挤占队列
+    Recorder r;
+    bus.subscribe(EventMask::AnimationFinished, &record, &r);
+    for(int i = 0; i < 3 * static_cast<int>(EventBus::kQueueCapacity); i++){
+        bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 1));
+    }
+    expectEq("unsubscribed kind queued", bus.getQueuedGameEvents(), 0);
+    expectEq("unsubscribed kind dropped count", bus.getDroppedGameEvents(), 0);
+    bus.post(makeEvent(GameEvent::Type::AnimationFinished, 1, 42));
+    expectEq("subscribed kind queued", bus.getQueuedGameEvents(), 1);
+    bus.dispatchGameEvents();
+    expectEq("subscribed kind delivered", r.events.size(), 1);
+    bus.clear();
+}
+
+void testDeliveryOrder(){
+    EventBus& bus = EventBus::getInstance();
+    bus.clear();
+    Recorder all, finished;
+    bus.subscribe(EventMask::AllGame, &record, &all);
+    bus.subscribe(EventMask::AnimationFinished, &record, &finished);
+
+    bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 10));
+    bus.post(makeEvent(GameEvent::Type::AnimationFinished, 1, 11));
+    bus.post(makeEvent(GameEvent::Type::StateChanged, 2, 12));
+    expectEq("nothing before dispatch", all.events.size(), 0);
+    bus.dispatchGameEvents();
+
+    // 按 post 顺序，每个订阅者只收到自己掩码里的类型，内容原样带回
+    expectEq("all count", all.events.size(), 3);
+    for(size_t i = 0; i < all.events.size(); i++){
+        expect(all.events[i].pet == fakePet(static_cast<int>(i)), "all pet", i, i);
+        expectEq("all to", all.events[i].to, 10 + i);
+    }
+    expectEq("filtered count", finished.events.size(), 1);
+    if(!finished.events.empty()){
+        expect(finished.events[0].type == GameEvent::Type::AnimationFinished, "filtered type",
+               static_cast<uint64_t>(finished.events[0].type), static_cast<uint64_t>(GameEvent::Type::AnimationFinished));
+        expectEq("filtered to", finished.events[0].to, 11);
+    }
+    expectEq("queue empty after dispatch", bus.getQueuedGameEvents(), 0);
+
+    // 回调里 post 的事件留到下一次分发
+    all.events.clear();
+    finished.events.clear();
+    finished.repost = true;
+    bus.post(makeEvent(GameEvent::Type::AnimationFinished, 3, 13));
+    bus.dispatchGameEvents();
+    expectEq("repost not delivered yet", finished.events.size(), 1);
+    expectEq("repost queued", bus.getQueuedGameEvents(), 1);
+    bus.dispatchGameEvents();
+    expectEq("repost delivered next", finished.events.size(), 2);
+    if(finished.events.size() == 2){
+        expectEq("repost to", finished.events[1].to, 99);
+    }
+    bus.clear();
+}
+
+void testUnsubscribe(){
+    EventBus& bus = EventBus::getInstance();
+    bus.clear();
+    Recorder r;
+    const EventBus::SubscriptionId id = bus.subscribe(EventMask::StateChanged, &record, &r);
+    bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 1));
+    bus.unsubscribe(id);
+    // 取消之后新的事件不再入队；已经在队列里的照常分发但没有人收
+    bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 2));
+    expectEq("queued after unsubscribe", bus.getQueuedGameEvents(), 1);
+    bus.dispatchGameEvents();
+    expectEq("delivered after unsubscribe", r.events.size(), 0);
+    bus.clear();
+}
+
+void testQueueFull(){
+    EventBus& bus = EventBus::getInstance();
+    bus.clear();
+    Recorder r;
+    bus.subscribe(EventMask::StateChanged, &record, &r);
+    const uint64_t droppedBefore = bus.getDroppedGameEvents();
+    for(size_t i = 0; i < EventBus::kQueueCapacity; i++){
+        bus.post(makeEvent(GameEvent::Type::StateChanged, 0, static_cast<uint32_t>(i)));
+    }
+    expectEq("post when full", bus.post(makeEvent(GameEvent::Type::StateChanged, 0, 0)), 0);
+    expectEq("dropped when full", bus.getDroppedGameEvents() - droppedBefore, 1);
+    bus.dispatchGameEvents();
+    expectEq("delivered when full", r.events.size(), EventBus::kQueueCapacity);
+    if(!r.events.empty()){
+        expectEq("last kept", r.events.back().to, EventBus::kQueueCapacity - 1);
+    }
+    bus.clear();
+}
+
+} // namespace
+
+int main(){
+    testUnsubscribedDropped();
+    testDeliveryOrder();
+    testUnsubscribe();
+    testQueueFull();
+    return test::finish("event_bus_test");
+}
@@ -0,0 +1,80 @@
+// GameClock：步进模式每次 step() 只前进一个 tick，暂停时单步与倍率余量的累计
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/game_clock.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+constexpr uint64_t kFrameNs = 16666667; // 名义帧长（60 fps）
+constexpr uint64_t kTickNs = 1000000;   // 步进的 tick（1 ms）
+
+void testSteppedMode(){
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    clock.reset();
+    clock.setMode(tools::GameClock::Mode::Stepped);
+
+    // 没有 step() 时，不管名义帧长多大都不前进
+    for(int i = 0; i < 10; i++){
+        expectEq("stepped idle frame", clock.sampleFrame(kFrameNs), 0);
+    }
+    expectEq("stepped idle now", clock.getNowNs(), 0);
+
+    // 每次 step() 之后的一帧恰好前进一个 tick，下一帧又回到 0
+    for(uint64_t i = 1; i <= 100; i++){
+        clock.step(kTickNs);
+        expectEq("stepped frame", clock.sampleFrame(kFrameNs), kTickNs);
+        expectEq("stepped now", clock.getNowNs(), i * kTickNs);
+        expectEq("stepped frame after", clock.sampleFrame(kFrameNs), 0);
+        expectEq("stepped now after", clock.getNowNs(), i * kTickNs);
+    }
+    expectEq("stepped frame index", clock.getFrameIndex(), 10 + 200);
+
+    // 倍率对步进模式没有影响
+    clock.setTimeScale(4.0);
+    clock.step(kTickNs);
+    expectEq("stepped scaled frame", clock.sampleFrame(kFrameNs), kTickNs);
+}
+
+void testPauseStep(){
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    clock.reset();
+    expectEq("running frame", clock.sampleFrame(kFrameNs), kFrameNs);
+
+    clock.pause();
+    expectEq("paused frame", clock.sampleFrame(kFrameNs), 0);
+    clock.step(kFrameNs); // F10
+    expectEq("paused step", clock.sampleFrame(kFrameNs), kFrameNs);
+    expectEq("paused after step", clock.sampleFrame(kFrameNs), 0);
+    expectEq("paused now", clock.getNowNs(), 2 * kFrameNs);
+
+    clock.resume();
+    expectEq("resumed frame", clock.sampleFrame(kFrameNs), kFrameNs);
+}
+
+void testScaleCarry(){
+    // 1/3 倍率：每帧不足 1 ns 的余量累计下来，3 帧合计不丢时间
+    tools::GameClock& clock = tools::GameClock::getInstance();
+    clock.reset();
+    clock.setTimeScale(1.0 / 3.0);
+    for(int i = 0; i < 3000; i++){
+        clock.sampleFrame(1000);
+    }
+    const uint64_t now = clock.getNowNs();
+    expect(now >= 999999 && now <= 1000000, "scaled total", now, 1000000);
+}
+
+} // namespace
+
+int main(){
+    testSteppedMode();
+    testPauseStep();
+    testScaleCarry();
+    tools::GameClock::getInstance().reset();
+    return test::finish("game_clock_test");
+}
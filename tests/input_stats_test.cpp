@@ -0,0 +1,214 @@
+// InputStats：手动 tick() 时秒/分/时三级历史与滚动 60 秒的速率与逐秒模型一致；多线程 record() 不丢计数；
+// 持久化文件跨会话累计总数，末尾不完整的记录被丢弃
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/input_stats.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+using tools::InputKind;
+using tools::InputStats;
+
+const char* kPersistPath = "input_stats_test.bin";
+
+// 逐秒模型
+struct Model{
+    std::vector<uint32_t> seconds; // 每秒的次数（某一种类）
+
+    uint32_t sumLast(size_t n, size_t end) const{
+        uint32_t sum = 0;
+        for(size_t i = end > n ? end - n : 0; i < end; i++) sum += seconds[i];
+        return sum;
+    }
+};
+
+void checkHistory(const InputStats& stats, const Model& model, InputKind kind, const char* label){
+    std::vector<uint32_t> history;
+    const size_t now = model.seconds.size();
+
+    // 秒：最近 60 秒，从旧到新
+    stats.getHistory(InputStats::Resolution::Second, kind, history);
+    expectEq("second history size", history.size(), InputStats::kSeconds);
+    for(size_t i = 0; i < history.size(); i++){
+        const size_t second = now + i - InputStats::kSeconds; // 可能回绕成很大的数，表示还没有这一秒
+        const uint32_t want = second < now ? model.seconds[second] : 0;
+        if(history[i] != want){
+            std::printf("%s: second %zu\n", label, i);
+            expectEq("second history", history[i], want);
+            break;
+        }
+    }
+
+    // 分：最近 60 个完整的分钟
+    stats.getHistory(InputStats::Resolution::Minute, kind, history);
+    expectEq("minute history size", history.size(), InputStats::kMinutes);
+    const size_t minutes = now / 60;
+    for(size_t i = 0; i < history.size(); i++){
+        const size_t minute = minutes + i - InputStats::kMinutes;
+        const uint32_t want = minute < minutes ? model.sumLast(60, (minute + 1) * 60) : 0;
+        if(history[i] != want){
+            std::printf("%s: minute %zu\n", label, i);
+            expectEq("minute history", history[i], want);
+            break;
+        }
+    }
+
+    // 时：最近 24 个完整的小时
+    stats.getHistory(InputStats::Resolution::Hour, kind, history);
+    expectEq("hour history size", history.size(), InputStats::kHours);
+    const size_t hours = now / 3600;
+    for(size_t i = 0; i < history.size(); i++){
+        const size_t hour = hours + i - InputStats::kHours;
+        const uint32_t want = hour < hours ? model.sumLast(3600, (hour + 1) * 3600) : 0;
+        if(history[i] != want){
+            std::printf("%s: hour %zu\n", label, i);
+            expectEq("hour history", history[i], want);
+            break;
+        }
+    }
+}
+
+void testManualTicks(InputStats& stats, int keySource, int clickSource){
+    std::mt19937 rng(4);
+    Model keys, clicks;
+    uint64_t keyTotal = 0, clickTotal = 0;
+
+    // 两个多小时：有活跃期也有整分钟的空闲
+    constexpr size_t kTicks = 2 * 3600 + 17 * 60 + 23;
+    for(size_t t = 0; t < kTicks; t++){
+        const bool idle = (t / 60) % 7 == 3;
+        const uint32_t k = idle ? 0 : rng() % 6;
+        const uint32_t c = idle ? 0 : (rng() % 10 == 0 ? 1 + rng() % 3 : 0);
+        // 同一秒里可能分多次、从两个来源记录
+        for(uint32_t i = 0; i < k; i++){
+            stats.record(i % 2 ? keySource : clickSource, InputKind::Key);
+        }
+        if(c) stats.record(clickSource, InputKind::MouseButton, c);
+        stats.tick();
+        keys.seconds.push_back(k);
+        clicks.seconds.push_back(c);
+        keyTotal += k;
+        clickTotal += c;
+
+        expectEq("keys per minute", stats.getKeysPerMinute(), keys.sumLast(60, keys.seconds.size()));
+        expectEq("clicks per minute", stats.getRatePerMinute(InputKind::MouseButton), clicks.sumLast(60, clicks.seconds.size()));
+        if(t % 997 == 0 || t == kTicks - 1){
+            checkHistory(stats, keys, InputKind::Key, "keys");
+            checkHistory(stats, clicks, InputKind::MouseButton, "clicks");
+        }
+    }
+    expectEq("key session total", stats.getSessionTotal(InputKind::Key), keyTotal);
+    expectEq("click session total", stats.getSessionTotal(InputKind::MouseButton), clickTotal);
+    expectEq("click source count", stats.getSourceCount(clickSource, InputKind::MouseButton), clickTotal);
+    expectEq("wheel untouched", stats.getSessionTotal(InputKind::Wheel), 0);
+
+    // 一分钟没有输入后速率回到 0
+    for(int i = 0; i < 60; i++) stats.tick();
+    expectEq("rate decays", stats.getKeysPerMinute(), 0);
+}
+
+void testConcurrentRecord(InputStats& stats, const std::vector<int>& sources){
+    const uint64_t before = stats.getSessionTotal(InputKind::Wheel);
+    constexpr uint32_t kPerThread = 200000;
+    std::vector<std::thread> threads;
+    for(int id : sources){
+        threads.emplace_back([&stats, id]{
+            for(uint32_t i = 0; i < kPerThread; i++) stats.record(id, InputKind::Wheel);
+        });
+    }
+    // 汇总与记录同时进行
+    for(int i = 0; i < 30; i++) stats.tick();
+    for(std::thread& t : threads) t.join();
+    stats.tick();
+    const uint64_t total = static_cast<uint64_t>(kPerThread) * sources.size();
+    expectEq("concurrent total", stats.getSessionTotal(InputKind::Wheel) - before, total);
+    for(int id : sources){
+        expectEq("concurrent per source", stats.getSourceCount(id, InputKind::Wheel), kPerThread);
+    }
+    expectEq("concurrent rate", stats.getRatePerMinute(InputKind::Wheel), total);
+}
+
+void testPersistence(InputStats& stats){
+    std::remove(kPersistPath);
+
+    auto first = std::make_unique<tools::SDLInputSource>();
+    tools::SDLInputSource* sdl = first.get();
+    expect(stats.addSource(std::move(first)) >= 0, "add sdl source", 0, 1);
+    expect(stats.start(kPersistPath), "start", 0, 1);
+    expectEq("fresh file total", stats.getTotal(InputKind::Key) - stats.getSessionTotal(InputKind::Key), 0);
+
+    // 事件总线交给 SDLInputSource 的事件：按住自动重复的按键不算
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = SDL_EVENT_KEY_DOWN;
+    for(int i = 0; i < 7; i++) sdl->count(e);
+    e.key.repeat = true;
+    for(int i = 0; i < 5; i++) sdl->count(e);
+    SDL_zero(e);
+    e.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+    tools::SDLInputSource::onEvent(sdl, e);
+    const uint64_t keys = stats.getSessionTotal(InputKind::Key);
+    const uint64_t clicks = stats.getSessionTotal(InputKind::MouseButton);
+    expectEq("sdl keys", stats.getSourceCount(0, InputKind::Key), 7);
+    stats.stop();
+    expect(!stats.isRunning(), "stopped", 1, 0);
+    expectEq("session cleared", stats.getSessionTotal(InputKind::Key), 0);
+
+    // 下一次会话读回累计总数
+    expect(stats.start(kPersistPath), "restart", 0, 1);
+    expectEq("persisted keys", stats.getTotal(InputKind::Key), keys);
+    expectEq("persisted clicks", stats.getTotal(InputKind::MouseButton), clicks);
+    stats.stop();
+
+    // 末尾写了一半的记录：丢弃，已有的记录照常读回
+    if(FILE* f = std::fopen(kPersistPath, "ab")){
+        std::fwrite("\x01\x02\x03\x04\x05", 1, 5, f);
+        std::fclose(f);
+    }
+    expect(stats.start(kPersistPath), "start with partial record", 0, 1);
+    expectEq("partial record dropped", stats.getTotal(InputKind::Key), keys);
+    stats.stop();
+
+    // 不是统计文件：从头开始
+    if(FILE* f = std::fopen(kPersistPath, "wb")){
+        std::fwrite("not a stats file", 1, 16, f);
+        std::fclose(f);
+    }
+    expect(stats.start(kPersistPath), "start with bad file", 0, 1);
+    expectEq("bad file total", stats.getTotal(InputKind::Key), 0);
+    stats.stop();
+    std::remove(kPersistPath);
+}
+
+} // namespace
+
+int main(){
+    InputStats& stats = InputStats::getInstance();
+
+    // 不启动汇总线程和来源，只用手动 tick() 推进；合成来源速率为 0，启动后也不产生输入
+    std::vector<int> sources;
+    for(int i = 0; i < InputStats::kMaxSources; i++){
+        sources.push_back(stats.addSource(std::make_unique<tools::SyntheticInputSource>(0.0f)));
+        expectEq("source id", static_cast<uint64_t>(sources.back()), static_cast<uint64_t>(i));
+    }
+    expectEq("too many sources", static_cast<uint64_t>(stats.addSource(std::make_unique<tools::SyntheticInputSource>(0.0f)) + 1), 0);
+
+    testManualTicks(stats, sources[0], sources[1]);
+    testConcurrentRecord(stats, sources);
+
+    // stop() 只在运行时清理；先启动再停止，清掉来源，给持久化测试腾出位置
+    stats.start();
+    stats.stop();
+    testPersistence(stats);
+    return test::finish("input_stats_test");
+}
@@ -0,0 +1,248 @@
+// Metrics 导出：Prometheus 文本每个样本都有 HELP/TYPE、名字合法、数值与指标一致；JSON 能被 minijson 解析且数值相同；
+// 同名注册返回同一个指标，类型冲突与超出容量的指标不导出；多线程计数不丢；
+// 服务线程（POSIX）在 Unix 域套接字上按请求返回 JSON 或文本
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/metrics.h"
+#include "tools/minijson.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+using test::expectNear;
+
+struct Exposition{
+    std::map<std::string, std::string> help;
+    std::map<std::string, std::string> type;
+    std::map<std::string, double> samples; // 带标签的样本按整行的名字部分存，例如 name{quantile="0.5"}
+    bool ok = true;
+};
+
+bool validName(const std::string& name){
+    if(name.empty()) return false;
+    for(size_t i = 0; i < name.size(); i++){
+        const char c = name[i];
+        const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+        if(!alpha && !(i > 0 && c >= '0' && c <= '9')) return false;
+    }
+    return true;
+}
+
+// 按 Prometheus 文本格式（0.0.4）解析，格式不对时记一次失败
+Exposition parseText(const std::string& text){
+    Exposition out;
+    size_t pos = 0;
+    while(pos < text.size()){
+        size_t end = text.find('\n', pos);
+        if(end == std::string::npos){
+            expect(false, "text ends with newline", 0, 1);
+            out.ok = false;
+            end = text.size();
+        }
+        const std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if(line.rfind("# HELP ", 0) == 0 || line.rfind("# TYPE ", 0) == 0){
+            const size_t space = line.find(' ', 7);
+            const std::string name = line.substr(7, space - 7);
+            const std::string rest = space == std::string::npos ? "" : line.substr(space + 1);
+            expect(validName(name), "comment metric name", 0, 1);
+            if(line[2] == 'H'){
+                out.help[name] = rest;
+            } else{
+                expect(rest == "counter" || rest == "gauge" || rest == "summary", "metric type", 0, 1);
+                expect(out.type.count(name) == 0, "type declared once", 0, 1);
+                out.type[name] = rest;
+            }
+            continue;
+        }
+        const size_t space = line.rfind(' ');
+        const std::string key = line.substr(0, space);
+        char* parsed = nullptr;
+        const double value = std::strtod(line.c_str() + space + 1, &parsed);
+        const std::string base = key.substr(0, key.find('{'));
+        if(space == std::string::npos || *parsed != '\0' || !validName(base)){
+            std::printf("bad sample line: %s\n", line.c_str());
+            expect(false, "sample line", 0, 1);
+            out.ok = false;
+            continue;
+        }
+        // 样本之前必须声明过类型；summary 的 _sum/_count 归在基本名下
+        std::string family = base;
+        for(const char* suffix : {"_sum", "_count"}){
+            const std::string s(suffix);
+            if(base.size() > s.size() && base.compare(base.size() - s.size(), s.size(), s) == 0
+               && out.type.count(base.substr(0, base.size() - s.size())) && out.type[base.substr(0, base.size() - s.size())] == "summary"){
+                family = base.substr(0, base.size() - s.size());
+            }
+        }
+        if(out.type.count(family) == 0){
+            std::printf("sample without TYPE: %s\n", line.c_str());
+            expect(false, "sample has TYPE", 0, 1);
+        }
+        out.samples[key] = value;
+    }
+    return out;
+}
+
+void testRegistryAndText(){
+    tools::Metrics& metrics = tools::Metrics::getInstance();
+    tools::MetricCounter& frames = metrics.counter("test_frames_total", "Frames simulated.");
+    expect(&frames == &metrics.counter("test_frames_total", "ignored"), "same counter", 0, 1);
+    tools::MetricGauge& pets = metrics.gauge("test_pets", "Pets alive.");
+    tools::MetricHistogram& frameTime = metrics.histogram("test_frame_seconds", "Frame time.");
+    expect(&frameTime == &metrics.histogram("test_frame_seconds", "ignored"), "same histogram", 0, 1);
+    metrics.sampled("test_sampled", "Sampled on scrape.", []{return 2.5;});
+    metrics.sampled("test_sampled", "ignored", []{return 99.0;}); // 重复注册保留第一次的函数
+
+    // 类型冲突：返回不导出的占位
+    tools::MetricGauge& clash = metrics.gauge("test_frames_total", "Clash.");
+    expect(&clash != &pets, "clash is spare", 0, 1);
+    clash.set(12345.0);
+
+    // 多线程计数
+    constexpr uint64_t kPerThread = 100000;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&frames]{
+            for(uint64_t i = 0; i < kPerThread; i++) frames.add();
+        });
+    }
+    for(std::thread& t : threads) t.join();
+    expectEq("counter threads", frames.get(), 4 * kPerThread);
+
+    pets.set(3.0);
+    for(uint64_t us = 1; us <= 1000; us++){
+        frameTime.record(us * 1000);
+    }
+
+    const Exposition text = parseText(metrics.toText());
+    expect(text.ok, "text parses", 0, 1);
+    expectEq("text counter", static_cast<uint64_t>(text.samples.at("test_frames_total")), 4 * kPerThread);
+    expect(text.type.at("test_frames_total") == "counter", "counter type", 0, 1);
+    expect(text.help.at("test_frames_total") == "Frames simulated.", "counter help", 0, 1);
+    expectNear("text gauge", text.samples.at("test_pets"), 3.0, 0.0);
+    expectNear("text sampled", text.samples.at("test_sampled"), 2.5, 0.0);
+    expect(text.type.at("test_frame_seconds") == "summary", "histogram type", 0, 1);
+    expectEq("summary count", static_cast<uint64_t>(text.samples.at("test_frame_seconds_count")), 1000);
+    expectNear("summary sum", text.samples.at("test_frame_seconds_sum"), 0.5005, 1e-6);
+    expectNear("summary max", text.samples.at("test_frame_seconds_max"), 0.001, 1e-9);
+    // 分桶的相对误差 < 3.2%，分位数取桶上界
+    expectNear("summary p50", text.samples.at("test_frame_seconds{quantile=\"0.5\"}"), 0.0005, 0.0005 * 0.032);
+    expectNear("summary p90", text.samples.at("test_frame_seconds{quantile=\"0.9\"}"), 0.0009, 0.0009 * 0.032);
+    expectNear("summary p99", text.samples.at("test_frame_seconds{quantile=\"0.99\"}"), 0.00099, 0.00099 * 0.032);
+    expect(text.samples.count("patpat_uptime_seconds") == 1, "uptime exported", 0, 1);
+    for(const auto& [key, value] : text.samples){
+        expect(value != 12345.0, "spare not exported", 0, 1);
+    }
+}
+
+void checkJson(const std::string& json){
+    const minijson::ParseResult parsed = minijson::parse(json);
+    expect(parsed.ok, "json parses", 0, 1);
+    if(!parsed.ok){
+        std::printf("json error: %s\n", parsed.error.c_str());
+        return;
+    }
+    const minijson::Value* all = parsed.root.get("metrics");
+    expect(all && all->isObject(), "json metrics object", 0, 1);
+    if(!all) return;
+    const minijson::Value* frames = all->get("test_frames_total");
+    expect(frames && frames->getString("type") == "counter", "json counter type", 0, 1);
+    if(frames) expectEq("json counter", static_cast<uint64_t>(frames->getNumber("value")), 400000);
+    const minijson::Value* frameTime = all->get("test_frame_seconds");
+    expect(frameTime && frameTime->getString("type") == "summary", "json summary type", 0, 1);
+    if(frameTime){
+        expectEq("json summary count", static_cast<uint64_t>(frameTime->getNumber("count")), 1000);
+        expectNear("json summary sum", frameTime->getNumber("sum"), 0.5005, 1e-6);
+        expectEq("json window count", static_cast<uint64_t>(frameTime->getNumber("window_count")), 1000);
+    }
+    const minijson::Value* sampled = all->get("test_sampled");
+    expect(sampled && sampled->getNumber("value") == 2.5, "json sampled", 0, 1);
+}
+
+#ifndef _WIN32
+std::string scrape(const std::string& path, const char* request){
+    std::string out;
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0) return out;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+    if(connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0){
+        if(request) send(fd, request, std::char_traits<char>::length(request), 0);
+        char buffer[4096];
+        ssize_t n;
+        while((n = recv(fd, buffer, sizeof(buffer), 0)) > 0){
+            out.append(buffer, static_cast<size_t>(n));
+        }
+    }
+    close(fd);
+    return out;
+}
+
+void testServer(){
+    tools::Metrics& metrics = tools::Metrics::getInstance();
+    const std::string path = "metrics_test.sock";
+
+    // 同名的普通文件不会被删掉
+    if(FILE* f = std::fopen(path.c_str(), "wb")) std::fclose(f);
+    expect(!metrics.startServer(path), "regular file refused", 1, 0);
+    std::remove(path.c_str());
+
+    expect(metrics.startServer(path), "start server", 0, 1);
+    checkJson(scrape(path, "json\n"));
+    const Exposition text = parseText(scrape(path, nullptr)); // 不发送请求得到文本
+    expect(text.ok && text.samples.count("test_frames_total") == 1, "server text", 0, 1);
+    parseText(scrape(path, "text\n"));
+    expectEq("scrape count", metrics.getScrapeCount(), 3);
+    metrics.stopServer();
+    expect(!metrics.isServing(), "server stopped", 1, 0);
+    expect(access(path.c_str(), F_OK) != 0, "socket removed", 1, 0);
+}
+#endif
+
+void testCapacity(){
+    // 注册表满了之后返回占位，已有的指标不受影响
+    tools::Metrics& metrics = tools::Metrics::getInstance();
+    static char names[80][24];
+    tools::MetricCounter* last = nullptr;
+    for(int i = 0; i < 80; i++){
+        std::snprintf(names[i], sizeof(names[i]), "test_fill_%d_total", i);
+        tools::MetricCounter& c = metrics.counter(names[i], "Filler.");
+        c.add(static_cast<uint64_t>(i));
+        last = &c;
+    }
+    const Exposition text = parseText(metrics.toText());
+    expect(text.samples.count("test_fill_0_total") == 1, "first filler exported", 0, 1);
+    expect(text.samples.count("test_fill_79_total") == 0, "overflow not exported", 1, 0);
+    expect(last != &metrics.counter("test_frames_total", ""), "overflow is spare", 0, 1);
+    expectEq("existing after full", metrics.counter("test_frames_total", "").get(), 400000);
+}
+
+} // namespace
+
+int main(){
+    testRegistryAndText();
+    checkJson(tools::Metrics::getInstance().toJson());
+#ifndef _WIN32
+    testServer();
+#endif
+    testCapacity();
+    return test::finish("metrics_test");
+}
@@ -0,0 +1,184 @@
+// RandomStream：splitmix64 播种与 xoshiro256** 输出对照参考实现，jump/split 切分出的子流互不重叠，
+// bounded/randint/unitFloat 的取值范围
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/random.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+// 参考实现：按 Vigna 的 xoshiro256starstar.c / splitmix64.c 逐字改写
+struct Reference{
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {return (x << k) | (x >> (64 - k));}
+
+    explicit Reference(uint64_t seed){
+        uint64_t x = seed;
+        for(auto& v : s){
+            uint64_t z = (x += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            v = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next(){
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    void jump(){
+        static const uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for(size_t i = 0; i < sizeof JUMP / sizeof *JUMP; i++){
+            for(int b = 0; b < 64; b++){
+                if(JUMP[i] & UINT64_C(1) << b){
+                    s0 ^= s[0];
+                    s1 ^= s[1];
+                    s2 ^= s[2];
+                    s3 ^= s[3];
+                }
+                next();
+            }
+        }
+        s[0] = s0; s[1] = s1; s[2] = s2; s[3] = s3;
+    }
+};
+
+void testSeedAndNext(){
+    // splitmix64(0) 的第一个输出是公开的测试向量
+    Reference zero(0);
+    expectEq("splitmix64 seed 0", zero.s[0], 0xE220A8397B1DCDAFULL);
+
+    for(uint64_t seed : {0ULL, 1ULL, 42ULL, 0x9E3779B97F4A7C15ULL, ~0ULL}){
+        tools::RandomStream stream(seed);
+        Reference ref(seed);
+        expectEq("getSeed", stream.getSeed(), seed);
+        for(int i = 0; i < 1000; i++){
+            expectEq("next vs reference", stream.next(), ref.next());
+        }
+    }
+
+    // 重新播种回到同一序列
+    tools::RandomStream a(5), b(6);
+    b.seed(5);
+    for(int i = 0; i < 100; i++){
+        expectEq("reseed", a(), b());
+    }
+}
+
+void testJumpAndSplit(){
+    tools::RandomStream stream(123);
+    Reference ref(123);
+    stream.jump();
+    ref.jump();
+    for(int i = 0; i < 100; i++){
+        expectEq("jump vs reference", stream.next(), ref.next());
+    }
+
+    // jump 是状态上的线性变换，与 next() 可交换
+    tools::RandomStream jumpFirst(9), stepFirst(9);
+    jumpFirst.jump();
+    for(int i = 0; i < 37; i++){
+        jumpFirst.next();
+        stepFirst.next();
+    }
+    stepFirst.jump();
+    expectEq("jump commutes with next", jumpFirst.next(), stepFirst.next());
+
+    tools::RandomStream longA(9), longB(9);
+    longA.longJump();
+    longB.jump();
+    expect(longA.next() != longB.next(), "longJump differs from jump", 0, 1);
+
+    // split：子流从当前位置开始，父流前进 2^128 步
+    tools::RandomStream parent(77);
+    tools::RandomStream copy = parent;
+    tools::RandomStream child = parent.split();
+    tools::RandomStream jumped = copy;
+    jumped.jump();
+    for(int i = 0; i < 100; i++){
+        expectEq("split child", child.next(), copy.next());
+        expectEq("split parent", parent.next(), jumped.next());
+    }
+
+    // 连续切出的几条子流前面若干个输出互不重复
+    tools::RandomStream root(2024);
+    std::unordered_set<uint64_t> seen;
+    constexpr int kStreams = 8, kDraws = 20000;
+    for(int s = 0; s < kStreams; s++){
+        tools::RandomStream sub = root.split();
+        for(int i = 0; i < kDraws; i++){
+            seen.insert(sub.next());
+        }
+    }
+    expectEq("split streams disjoint", seen.size(), kStreams * kDraws);
+}
+
+void testRanges(){
+    tools::RandomStream stream(31);
+
+    // bounded：[0, range)，各桶计数大致均匀
+    constexpr uint32_t kRange = 10;
+    constexpr uint32_t kDraws = 100000;
+    std::vector<uint32_t> counts(kRange, 0);
+    for(uint32_t i = 0; i < kDraws; i++){
+        const uint32_t v = stream.bounded(kRange);
+        expect(v < kRange, "bounded range", v, kRange);
+        if(v < kRange) counts[v]++;
+    }
+    for(uint32_t i = 0; i < kRange; i++){
+        expect(counts[i] > kDraws / kRange * 9 / 10 && counts[i] < kDraws / kRange * 11 / 10,
+               "bounded bucket", counts[i], kDraws / kRange);
+    }
+
+    // randint：闭区间，两端都能取到；参数颠倒时交换
+    bool sawMin = false, sawMax = false;
+    for(int i = 0; i < 10000; i++){
+        const int v = stream.randint(3, -2);
+        expect(v >= -2 && v <= 3, "randint range", static_cast<uint64_t>(v + 2), 0);
+        sawMin |= v == -2;
+        sawMax |= v == 3;
+    }
+    expect(sawMin && sawMax, "randint endpoints", sawMin + sawMax, 2);
+    expectEq("randint single", stream.randint(7, 7), 7);
+    stream.randint(INT32_MIN, INT32_MAX); // 整个 int 范围不溢出
+
+    for(int i = 0; i < 10000; i++){
+        const float f = stream.unitFloat();
+        expect(f >= 0.0f && f < 1.0f, "unitFloat range", static_cast<uint64_t>(f * 1000), 0);
+        const float r = stream.randfloat(2.0f, -1.0f);
+        expect(r >= -1.0f && r < 2.0f, "randfloat range", static_cast<uint64_t>((r + 1.0f) * 1000), 0);
+    }
+    expect(!stream.chance(0.0) && stream.chance(1.0), "chance endpoints", 0, 1);
+
+    int ints[256];
+    stream.fill(ints, 256, 0, 3);
+    for(int v : ints){
+        expect(v >= 0 && v <= 3, "fill int range", static_cast<uint64_t>(v), 3);
+    }
+}
+
+} // namespace
+
+int main(){
+    testSeedAndNext();
+    testJumpAndSplit();
+    testRanges();
+    return test::finish("random_stream_test");
+}
@@ -0,0 +1,239 @@
+// 录制/回放：随机生成若干帧的事件写入日志，再读回逐帧、逐字段比较；不支持的事件不录，截断/错误的文件能安全结束
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/replay.h"
+
+#include "test_expect.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+const char* kPath = "replay_test.pprp";
+const char* kTruncatedPath = "replay_test_truncated.pprp";
+
+struct Frame{
+    uint64_t deltaNs = 0;
+    std::vector<SDL_Event> events; // 只含会被录下的事件
+};
+
+float randomCoord(std::mt19937& rng){
+    return static_cast<float>(static_cast<int>(rng() % 8000) - 1000) * 0.25f;
+}
+
+SDL_Event randomEvent(std::mt19937& rng){
+    SDL_Event e;
+    SDL_zero(e);
+    switch(rng() % 6){
+    case 0:
+        e.type = SDL_EVENT_QUIT;
+        break;
+    case 1:
+        e.type = SDL_EVENT_WINDOW_FIRST + rng() % (SDL_EVENT_WINDOW_LAST - SDL_EVENT_WINDOW_FIRST + 1);
+        e.window.windowID = rng() % 4;
+        e.window.data1 = static_cast<Sint32>(rng()) / 2 - 7;
+        e.window.data2 = -static_cast<Sint32>(rng() % 5000);
+        break;
+    case 2:
+        e.type = rng() % 2 ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+        e.key.windowID = rng() % 4;
+        e.key.which = rng() % 3;
+        e.key.scancode = static_cast<SDL_Scancode>(rng() % 512);
+        e.key.key = static_cast<SDL_Keycode>(rng());
+        e.key.mod = static_cast<SDL_Keymod>(rng() % 0x10000);
+        e.key.raw = static_cast<Uint16>(rng());
+        e.key.down = e.type == SDL_EVENT_KEY_DOWN;
+        e.key.repeat = e.key.down && rng() % 2;
+        break;
+    case 3:
+        e.type = SDL_EVENT_MOUSE_MOTION;
+        e.motion.windowID = rng() % 4;
+        e.motion.which = rng() % 3;
+        e.motion.state = rng() % 32;
+        e.motion.x = randomCoord(rng);
+        e.motion.y = randomCoord(rng);
+        e.motion.xrel = randomCoord(rng) * 0.01f;
+        e.motion.yrel = -randomCoord(rng) * 0.01f;
+        break;
+    case 4:
+        e.type = rng() % 2 ? SDL_EVENT_MOUSE_BUTTON_DOWN : SDL_EVENT_MOUSE_BUTTON_UP;
+        e.button.windowID = rng() % 4;
+        e.button.which = rng() % 3;
+        e.button.button = static_cast<Uint8>(1 + rng() % 5);
+        e.button.down = e.type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+        e.button.clicks = static_cast<Uint8>(1 + rng() % 3);
+        e.button.x = randomCoord(rng);
+        e.button.y = randomCoord(rng);
+        break;
+    default:
+        e.type = SDL_EVENT_MOUSE_WHEEL;
+        e.wheel.windowID = rng() % 4;
+        e.wheel.which = rng() % 3;
+        e.wheel.x = randomCoord(rng) * 0.1f;
+        e.wheel.y = -1.5f;
+        e.wheel.direction = rng() % 2 ? SDL_MOUSEWHEEL_FLIPPED : SDL_MOUSEWHEEL_NORMAL;
+        e.wheel.mouse_x = randomCoord(rng);
+        e.wheel.mouse_y = randomCoord(rng);
+        break;
+    }
+    return e;
+}
+
+// 逐字段比较（时间戳不录，回放时填当前时间）
+bool sameEvent(const SDL_Event& a, const SDL_Event& b){
+    if(a.type != b.type) return false;
+    switch(a.type){
+    case SDL_EVENT_QUIT:
+        return true;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        return a.key.windowID == b.key.windowID && a.key.which == b.key.which && a.key.scancode == b.key.scancode
+            && a.key.key == b.key.key && a.key.mod == b.key.mod && a.key.raw == b.key.raw
+            && a.key.down == b.key.down && a.key.repeat == b.key.repeat;
+    case SDL_EVENT_MOUSE_MOTION:
+        return a.motion.windowID == b.motion.windowID && a.motion.which == b.motion.which && a.motion.state == b.motion.state
+            && a.motion.x == b.motion.x && a.motion.y == b.motion.y && a.motion.xrel == b.motion.xrel && a.motion.yrel == b.motion.yrel;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        return a.button.windowID == b.button.windowID && a.button.which == b.button.which && a.button.button == b.button.button
+            && a.button.down == b.button.down && a.button.clicks == b.button.clicks && a.button.x == b.button.x && a.button.y == b.button.y;
+    case SDL_EVENT_MOUSE_WHEEL:
+        return a.wheel.windowID == b.wheel.windowID && a.wheel.which == b.wheel.which && a.wheel.x == b.wheel.x && a.wheel.y == b.wheel.y
+            && a.wheel.direction == b.wheel.direction && a.wheel.mouse_x == b.wheel.mouse_x && a.wheel.mouse_y == b.wheel.mouse_y;
+    default:
+        return a.window.windowID == b.window.windowID && a.window.data1 == b.window.data1 && a.window.data2 == b.window.data2;
+    }
+}
+
+std::vector<Frame> recordRandom(uint64_t seed, int frameCount){
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::vector<Frame> frames(frameCount);
+    tools::ReplayRecorder recorder;
+    expect(recorder.open(kPath, seed), "recorder open", 0, 1);
+    for(Frame& frame : frames){
+        const int count = rng() % 4 == 0 ? 0 : static_cast<int>(rng() % 12);
+        for(int i = 0; i < count; i++){
+            // 夹杂不支持的事件，应被丢弃
+            if(rng() % 5 == 0){
+                SDL_Event ignored;
+                SDL_zero(ignored);
+                ignored.type = SDL_EVENT_USER;
+                recorder.recordEvent(ignored);
+            }
+            frame.events.push_back(randomEvent(rng));
+            recorder.recordEvent(frame.events.back());
+        }
+        // 帧长跨越 varint 的各个长度，含 0
+        frame.deltaNs = rng() % 8 == 0 ? 0 : (static_cast<uint64_t>(rng()) << (rng() % 24));
+        recorder.endFrame(frame.deltaNs);
+    }
+    expectEq("recorded frames", recorder.getFrameCount(), frames.size());
+    recorder.close();
+    return frames;
+}
+
+void testRoundTrip(){
+    constexpr uint64_t kSeed = 0xDEADBEEFCAFEULL;
+    const std::vector<Frame> frames = recordRandom(kSeed, 500);
+
+    tools::ReplayPlayer player;
+    expect(player.open(kPath), "player open", 0, 1);
+    expectEq("seed", player.getSeed(), kSeed);
+    size_t index = 0;
+    while(player.beginFrame()){
+        if(index >= frames.size()){
+            index++;
+            continue;
+        }
+        const Frame& frame = frames[index];
+        expectEq("frame ns", player.getFrameNs(), frame.deltaNs);
+        size_t events = 0;
+        SDL_Event e;
+        while(player.pollEvent(e)){
+            if(events < frame.events.size()){
+                expect(sameEvent(e, frame.events[events]), "event fields", index, events);
+            }
+            events++;
+        }
+        expectEq("event count", events, frame.events.size());
+        index++;
+    }
+    expectEq("played frames", index, frames.size());
+    expect(player.isFinished(), "finished", 0, 1);
+    expect(!player.beginFrame(), "no frame after end", 1, 0);
+
+    // 没取完的事件在下一帧开始时跳过
+    expect(player.open(kPath), "reopen", 0, 1);
+    player.beginFrame();
+    player.beginFrame();
+    expectEq("skip unread events", player.getFrameNs(), frames[1].deltaNs);
+}
+
+std::vector<uint8_t> readFile(const char* path){
+    std::vector<uint8_t> data;
+    if(FILE* f = std::fopen(path, "rb")){
+        uint8_t buffer[4096];
+        size_t n;
+        while((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0){
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        std::fclose(f);
+    }
+    return data;
+}
+
+void writeFile(const char* path, const uint8_t* data, size_t size){
+    if(FILE* f = std::fopen(path, "wb")){
+        std::fwrite(data, 1, size, f);
+        std::fclose(f);
+    }
+}
+
+void testDamagedFiles(){
+    recordRandom(3, 50);
+    const std::vector<uint8_t> data = readFile(kPath);
+    expect(data.size() > 16, "replay file size", data.size(), 16);
+
+    // 任意位置截断：不会越界，只回放完整的帧后结束
+    for(size_t cut = 16; cut < data.size(); cut += 7){
+        writeFile(kTruncatedPath, data.data(), cut);
+        tools::ReplayPlayer player;
+        expect(player.open(kTruncatedPath), "truncated open", 0, 1);
+        uint64_t frames = 0;
+        SDL_Event e;
+        while(player.beginFrame() && frames < 1000){
+            while(player.pollEvent(e)) {}
+            frames++;
+        }
+        expect(frames <= 50, "truncated frames", frames, 50);
+        expect(player.isFinished(), "truncated finished", 0, 1);
+    }
+
+    // 文件头不对
+    std::vector<uint8_t> bad = data;
+    bad[0] ^= 0xFF;
+    writeFile(kTruncatedPath, bad.data(), bad.size());
+    tools::ReplayPlayer player;
+    expect(!player.open(kTruncatedPath), "bad magic rejected", 1, 0);
+    bad = data;
+    bad[4] = 99;
+    writeFile(kTruncatedPath, bad.data(), bad.size());
+    expect(!player.open(kTruncatedPath), "bad version rejected", 1, 0);
+    expect(!player.open("replay_test_missing.pprp"), "missing file", 1, 0);
+}
+
+} // namespace
+
+int main(){
+    testRoundTrip();
+    testDamagedFiles();
+    std::remove(kPath);
+    std::remove(kTruncatedPath);
+    return test::finish("replay_test");
+}
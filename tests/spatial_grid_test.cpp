@@ -0,0 +1,176 @@
+// SpatialGrid：随机插入/移动/删除/改 z 之后，点、矩形、半径查询与暴力遍历的结果一致（含负坐标与跨格子的大矩形）
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/spatial_grid.h"
+
+#include "test_expect.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+struct Item{
+    SDL_Rect rect{0, 0, 0, 0};
+    int z = 0;
+    bool alive = false;
+};
+
+// 暴力参考：与 SpatialGrid 的约定相同（点查询半开区间，z 大的在上，z 相同时 id 大的在上）
+bool above(const std::vector<Item>& items, int a, int b){
+    return items[a].z != items[b].z ? items[a].z > items[b].z : a > b;
+}
+
+bool hitPoint(const SDL_Rect& r, SDL_Point p){
+    return p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h;
+}
+
+bool hitRect(const SDL_Rect& r, const SDL_Rect& q){
+    return r.w > 0 && r.h > 0 && q.w > 0 && q.h > 0 && r.x < q.x + q.w && q.x < r.x + r.w && r.y < q.y + q.h && q.y < r.y + r.h;
+}
+
+bool hitRadius(const SDL_Rect& r, SDL_FPoint c, float radius){
+    if(radius < 0.0f || r.w <= 0 || r.h <= 0) return false;
+    const float nx = std::clamp(c.x, static_cast<float>(r.x), static_cast<float>(r.x + r.w));
+    const float ny = std::clamp(c.y, static_cast<float>(r.y), static_cast<float>(r.y + r.h));
+    const float dx = c.x - nx, dy = c.y - ny;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+SDL_Rect randomRect(std::mt19937& rng){
+    // 大多数是宠物大小，少数跨很多格子或为空
+    const int size = rng() % 10 == 0 ? 600 : 160;
+    SDL_Rect r;
+    r.x = static_cast<int>(rng() % 3000) - 1000;
+    r.y = static_cast<int>(rng() % 2000) - 700;
+    r.w = rng() % 20 == 0 ? 0 : 1 + static_cast<int>(rng() % size);
+    r.h = 1 + static_cast<int>(rng() % size);
+    return r;
+}
+
+void checkQueries(const tools::SpatialGrid& grid, const std::vector<Item>& items, std::mt19937& rng){
+    std::vector<int> got, want;
+    for(int q = 0; q < 200; q++){
+        // 点查询：一半取在矩形边界上，覆盖半开区间的两端
+        SDL_Point p{static_cast<int>(rng() % 3400) - 1100, static_cast<int>(rng() % 2400) - 800};
+        const int pick = static_cast<int>(rng() % items.size());
+        if(q % 2 == 0 && items[pick].alive){
+            const SDL_Rect& r = items[pick].rect;
+            p.x = rng() % 2 ? r.x : r.x + r.w - (rng() % 2);
+            p.y = rng() % 2 ? r.y : r.y + r.h - (rng() % 2);
+        }
+        want.clear();
+        int top = -1;
+        for(int id = 0; id < static_cast<int>(items.size()); id++){
+            if(items[id].alive && hitPoint(items[id].rect, p)){
+                want.push_back(id);
+                if(top < 0 || above(items, id, top)) top = id;
+            }
+        }
+        std::sort(want.begin(), want.end(), [&](int a, int b){return above(items, a, b);});
+        expectEq("queryPoint top", static_cast<uint64_t>(grid.queryPoint(p) + 1), static_cast<uint64_t>(top + 1));
+        grid.queryPoint(p, got);
+        expect(got == want, "queryPoint order", got.size(), want.size());
+
+        const SDL_Rect area = randomRect(rng);
+        want.clear();
+        for(int id = 0; id < static_cast<int>(items.size()); id++){
+            if(items[id].alive && hitRect(items[id].rect, area)) want.push_back(id);
+        }
+        grid.queryRect(area, got);
+        std::sort(got.begin(), got.end());
+        expect(got == want, "queryRect", got.size(), want.size());
+
+        const SDL_FPoint center{static_cast<float>(p.x) + 0.5f, static_cast<float>(p.y) - 0.25f};
+        const float radius = static_cast<float>(rng() % 400);
+        want.clear();
+        for(int id = 0; id < static_cast<int>(items.size()); id++){
+            if(items[id].alive && hitRadius(items[id].rect, center, radius)) want.push_back(id);
+        }
+        grid.queryRadius(center, radius, got);
+        std::sort(got.begin(), got.end());
+        expect(got == want, "queryRadius", got.size(), want.size());
+    }
+}
+
+void testRandomAgainstBruteForce(){
+    for(int cellSize : {16, 128, 1000}){
+        std::mt19937 rng(static_cast<uint32_t>(cellSize));
+        tools::SpatialGrid grid(cellSize);
+        std::vector<Item> items(150);
+
+        for(int round = 0; round < 20; round++){
+            for(int op = 0; op < 200; op++){
+                const int id = static_cast<int>(rng() % items.size());
+                Item& item = items[id];
+                switch(rng() % 6){
+                case 0:
+                case 1:
+                    item.rect = randomRect(rng);
+                    item.z = static_cast<int>(rng() % 4);
+                    item.alive = true;
+                    grid.insert(id, item.rect, item.z);
+                    break;
+                case 2:
+                case 3:
+                    // 移动：大多只挪几个像素
+                    if(item.alive){
+                        const int step = rng() % 4 == 0 ? 300 : 6;
+                        item.rect.x += static_cast<int>(rng() % (2 * step + 1)) - step;
+                        item.rect.y += static_cast<int>(rng() % (2 * step + 1)) - step;
+                    }
+                    grid.update(id, item.rect);
+                    break;
+                case 4:
+                    if(item.alive) item.z = static_cast<int>(rng() % 4);
+                    grid.setZ(id, item.z);
+                    break;
+                default:
+                    item = Item{};
+                    grid.remove(id);
+                    break;
+                }
+            }
+            const size_t alive = static_cast<size_t>(std::count_if(items.begin(), items.end(), [](const Item& i){return i.alive;}));
+            expectEq("size", grid.size(), alive);
+            for(int id = 0; id < static_cast<int>(items.size()); id++){
+                expect(grid.contains(id) == items[id].alive, "contains", grid.contains(id), items[id].alive);
+            }
+            checkQueries(grid, items, rng);
+        }
+
+        grid.clear();
+        expectEq("cleared size", grid.size(), 0);
+        expectEq("cleared query", static_cast<uint64_t>(grid.queryPoint({0, 0}) + 1), 0);
+    }
+}
+
+void testStacking(){
+    tools::SpatialGrid grid(64);
+    grid.insert(0, {0, 0, 100, 100}, 0);
+    grid.insert(1, {50, 50, 100, 100}, 0);
+    grid.insert(2, {-30, -30, 40, 40}, 0);
+    expectEq("same z larger id on top", grid.queryPoint({60, 60}), 1);
+    grid.setZ(0, 1);
+    expectEq("higher z on top", grid.queryPoint({60, 60}), 0);
+    expectEq("negative coords", grid.queryPoint({-30, -1}), 2);
+    expectEq("half-open right edge", static_cast<uint64_t>(grid.queryPoint({10, -30 + 40}) + 1), 1); // (10, 10) 落在 0 里
+    expectEq("half-open outside", static_cast<uint64_t>(grid.queryPoint({150, 60}) + 1), 0);
+    grid.remove(0);
+    expectEq("removed", grid.queryPoint({60, 60}), 1);
+    expect(!grid.contains(0), "removed contains", 1, 0);
+    grid.insert(-1, {0, 0, 10, 10});
+    expectEq("negative id ignored", grid.size(), 2);
+}
+
+} // namespace
+
+int main(){
+    testRandomAgainstBruteForce();
+    testStacking();
+    return test::finish("spatial_grid_test");
+}
@@ -0,0 +1,203 @@
+// 加载时裁剪：trimFrames 的包围盒/像素数与逐像素统计一致；凸包不超过顶点上限、是凸的、不越出包围盒，
+// 并且包住每个不透明像素；形状接近矩形时不生成凸包
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "core/spritelibrary.h"
+#include "tools/convex_hull.h"
+#include "tools/manifest_loader.h"
+
+#include "test_expect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+using test::expectNear;
+
+constexpr int kFrameSize = 64;
+constexpr Uint32 kColors[] = {0xFF202830, 0xFFD22F1E, 0x80FFFFFF};
+
+enum class Shape {Empty, Full, Disc, Diamond, Triangle, Corner, Dot, Noise};
+
+bool inside(Shape shape, int x, int y, std::mt19937& rng){
+    const int c = kFrameSize / 2;
+    switch(shape){
+    case Shape::Empty: return false;
+    case Shape::Full: return true;
+    case Shape::Disc: return (x - c) * (x - c) + (y - c + 5) * (y - c + 5) <= 22 * 22;
+    case Shape::Diamond: return std::abs(x - c) + std::abs(y - c) <= 30;
+    case Shape::Triangle: return y >= 4 && y < 60 && std::abs(2 * x - kFrameSize) <= y;
+    case Shape::Corner: return x < 20 || y >= kFrameSize - 6; // 凹形，贴着帧的边
+    case Shape::Dot: return x == 40 && y == 9;
+    case Shape::Noise: return x >= 10 && x < 50 && y >= 20 && y < 44 && rng() % 3 == 0;
+    }
+    return false;
+}
+
+// 凸多边形（任意绕向）是否包含点，边上算包含
+bool polygonContains(const std::vector<SDL_FPoint>& poly, double x, double y, double sign){
+    for(size_t i = 0, n = poly.size(); i < n; i++){
+        const SDL_FPoint& a = poly[i];
+        const SDL_FPoint& b = poly[(i + 1) % n];
+        const double cross = (static_cast<double>(b.x) - a.x) * (y - a.y) - (static_cast<double>(b.y) - a.y) * (x - a.x);
+        if(cross * sign < -1e-3) return false;
+    }
+    return true;
+}
+
+double signedArea(const std::vector<SDL_FPoint>& poly){
+    double twice = 0.0;
+    for(size_t i = 0, n = poly.size(); i < n; i++){
+        twice += static_cast<double>(poly[i].x) * poly[(i + 1) % n].y - static_cast<double>(poly[(i + 1) % n].x) * poly[i].y;
+    }
+    return twice * 0.5;
+}
+
+void checkHull(const std::vector<SDL_FPoint>& hull, const SDL_Rect& bounds, int maxVertices,
+               const std::vector<uint8_t>& mask, int maskWidth, const SDL_Rect& frame){
+    expect(static_cast<int>(hull.size()) <= maxVertices && hull.size() >= 3, "hull vertices", hull.size(), static_cast<uint64_t>(maxVertices));
+    const double area = signedArea(hull);
+    const double sign = area >= 0.0 ? 1.0 : -1.0;
+    expectNear("polygonArea", tools::math::polygonArea(hull), std::abs(area), 1e-2);
+    for(size_t i = 0, n = hull.size(); i < n; i++){
+        const SDL_FPoint& a = hull[i];
+        const SDL_FPoint& b = hull[(i + 1) % n];
+        const SDL_FPoint& c = hull[(i + 2) % n];
+        const double turn = (static_cast<double>(b.x) - a.x) * (c.y - b.y) - (static_cast<double>(b.y) - a.y) * (c.x - b.x);
+        expect(turn * sign > -1e-3, "hull convex", i, n);
+        expect(a.x >= bounds.x - 1e-3 && a.y >= bounds.y - 1e-3 && a.x <= bounds.x + bounds.w + 1e-3 && a.y <= bounds.y + bounds.h + 1e-3,
+               "hull inside bounds", i, n);
+    }
+    for(int y = frame.y; y < frame.y + frame.h; y++){
+        for(int x = frame.x; x < frame.x + frame.w; x++){
+            if(!mask[static_cast<size_t>(y) * maskWidth + x]) continue;
+            const bool covered = polygonContains(hull, x, y, sign) && polygonContains(hull, x + 1.0, y, sign)
+                              && polygonContains(hull, x, y + 1.0, sign) && polygonContains(hull, x + 1.0, y + 1.0, sign);
+            expect(covered, "hull covers pixel", static_cast<uint64_t>(x), static_cast<uint64_t>(y));
+        }
+    }
+}
+
+void testTrimFrames(){
+    const std::vector<Shape> shapes = {Shape::Empty, Shape::Full, Shape::Disc, Shape::Diamond,
+                                       Shape::Triangle, Shape::Corner, Shape::Dot, Shape::Noise};
+    const int width = kFrameSize * static_cast<int>(shapes.size());
+    SDL_Surface* surface = SDL_CreateSurface(width, kFrameSize, SDL_PIXELFORMAT_ARGB8888);
+    expect(surface != nullptr, "create surface", 0, 1);
+    if(!surface) return;
+
+    std::mt19937 rng(11);
+    std::vector<uint8_t> mask(static_cast<size_t>(width) * kFrameSize, 0);
+    std::vector<AnimationFrame> frames;
+    for(size_t i = 0; i < shapes.size(); i++){
+        const int x0 = static_cast<int>(i) * kFrameSize;
+        for(int y = 0; y < kFrameSize; y++){
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + static_cast<size_t>(y) * surface->pitch);
+            for(int x = 0; x < kFrameSize; x++){
+                const bool opaque = inside(shapes[i], x, y, rng);
+                // 全透明但颜色分量不为 0 的像素也算透明
+                row[x0 + x] = opaque ? kColors[(x + y) % 3] : (rng() % 2 ? 0x00FFFFFFu : 0u);
+                mask[static_cast<size_t>(y) * width + x0 + x] = opaque;
+            }
+        }
+        AnimationFrame f;
+        f.souceRect = SDL_Rect{x0, 0, kFrameSize, kFrameSize};
+        f.duration = 100;
+        frames.push_back(f);
+    }
+    std::shared_ptr<IndexedSheet> sheet = IndexedSheet::quantize(surface);
+    SDL_DestroySurface(surface);
+    expect(sheet != nullptr, "quantize", 0, 1);
+    if(!sheet) return;
+
+    for(int maxVertices : {3, 4, 6, 8}){
+        trimFrames(*sheet, frames, maxVertices);
+        for(size_t i = 0; i < frames.size(); i++){
+            const AnimationFrame& f = frames[i];
+            int minX = INT32_MAX, minY = INT32_MAX, maxX = -1, maxY = -1, count = 0;
+            for(int y = f.souceRect.y; y < f.souceRect.y + f.souceRect.h; y++){
+                for(int x = f.souceRect.x; x < f.souceRect.x + f.souceRect.w; x++){
+                    if(!mask[static_cast<size_t>(y) * width + x]) continue;
+                    minX = std::min(minX, x); maxX = std::max(maxX, x);
+                    minY = std::min(minY, y); maxY = std::max(maxY, y);
+                    count++;
+                }
+            }
+            expect(f.trimmed, "trimmed", i, 1);
+            expectEq("opaque pixels", f.opaquePixels, count);
+            if(count == 0){
+                expect(f.trimRect.w == 0 && f.trimRect.h == 0, "empty trim", i, 0);
+                expect(f.hull.empty(), "empty hull", i, 0);
+                continue;
+            }
+            expectEq("trim x", f.trimRect.x, minX);
+            expectEq("trim y", f.trimRect.y, minY);
+            expectEq("trim w", f.trimRect.w, maxX - minX + 1);
+            expectEq("trim h", f.trimRect.h, maxY - minY + 1);
+            if(f.hull.empty()) continue;
+            // 只有明显比包围盒小时才保留凸包
+            expect(f.hullArea < 0.85f * f.trimRect.w * f.trimRect.h, "hull worth it", i, static_cast<uint64_t>(maxVertices));
+            expectNear("hull area", f.hullArea, tools::math::polygonArea(f.hull), 1e-2);
+            checkHull(f.hull, f.trimRect, maxVertices, mask, width, f.souceRect);
+        }
+        expect(frames[1].hull.empty(), "full frame no hull", 1, 0);
+        expect(frames[6].hull.empty(), "single pixel no hull", 1, 0);
+        // 圆、菱形、三角形在 8 个顶点内都应该值得用凸包
+        if(maxVertices == 8){
+            expect(!frames[2].hull.empty() && !frames[3].hull.empty() && !frames[4].hull.empty(), "round shapes get hulls", 0, 1);
+        }
+    }
+}
+
+void testCoverHullRandom(){
+    // 随机的逐行范围：凸包包住所有像素，顶点数不超上限，不出 bounds；做不到时返回空
+    std::mt19937 rng(5);
+    int checked = 0;
+    for(int round = 0; round < 300; round++){
+        const SDL_Rect bounds{static_cast<int>(rng() % 50) - 25, static_cast<int>(rng() % 50) - 25,
+                              4 + static_cast<int>(rng() % 60), 4 + static_cast<int>(rng() % 60)};
+        tools::math::RowSpans spans;
+        spans.top = bounds.y;
+        std::vector<uint8_t> mask(static_cast<size_t>(bounds.w) * bounds.h, 0);
+        for(int y = 0; y < bounds.h; y++){
+            int first = static_cast<int>(rng() % bounds.w);
+            int last = static_cast<int>(rng() % bounds.w);
+            if(first > last) std::swap(first, last);
+            if(rng() % 6 == 0) last = first - 1; // 整行透明
+            // 保证第一行/最后一行、最左/最右列都有像素，bounds 就是包围盒
+            if(y == 0 || y == bounds.h - 1) last = std::max(last, first);
+            if(y == bounds.h / 2){ first = 0; last = bounds.w - 1;}
+            spans.first.push_back(bounds.x + first);
+            spans.last.push_back(bounds.x + last);
+            for(int x = first; x <= last; x++) mask[static_cast<size_t>(y) * bounds.w + x] = 1;
+        }
+        const int maxVertices = 3 + static_cast<int>(rng() % 8);
+        const std::vector<SDL_FPoint> hull = tools::math::coverHull(spans, bounds, maxVertices);
+        if(hull.empty()) continue;
+        checked++;
+        // mask 用 bounds 内的局部坐标：把凸包平移回去再检查
+        std::vector<SDL_FPoint> local = hull;
+        for(SDL_FPoint& p : local){ p.x -= static_cast<float>(bounds.x); p.y -= static_cast<float>(bounds.y);}
+        checkHull(local, SDL_Rect{0, 0, bounds.w, bounds.h}, maxVertices, mask, bounds.w, SDL_Rect{0, 0, bounds.w, bounds.h});
+    }
+    expect(checked > 200, "random hulls checked", checked, 200);
+
+    // 退化情况：少于 3 个不同角点时没有凸包
+    tools::math::RowSpans empty;
+    expect(tools::math::coverHull(empty, SDL_Rect{0, 0, 4, 4}, 8).empty(), "no spans", 1, 0);
+    expectNear("empty area", tools::math::polygonArea({}), 0.0, 0.0);
+    expectNear("square area", tools::math::polygonArea({{0, 0}, {3, 0}, {3, 2}, {0, 2}}), 6.0, 1e-6);
+}
+
+} // namespace
+
+int main(){
+    testTrimFrames();
+    testCoverHullRandom();
+    return test::finish("sprite_trim_test");
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// tests/ 共用的检查：失败时打印出错的检查并计数，main 末尾用 finish() 的返回值退出（非 0 供 ctest 判失败）
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace test{
+
+inline int failures = 0;
+
+inline void expect(bool ok, const char* what, uint64_t got, uint64_t want){
+    if(!ok){
+        std::printf("FAIL %s: got %llu, want %llu\n", what,
+                    static_cast<unsigned long long>(got), static_cast<unsigned long long>(want));
+        failures++;
+    }
+}
+
+inline void expectEq(const char* what, uint64_t got, uint64_t want){
+    expect(got == want, what, got, want);
+}
+
+inline void expectNear(const char* what, double got, double want, double tolerance){
+    if(!(std::fabs(got - want) <= tolerance)){
+        std::printf("FAIL %s: got %.9g, want %.9g (+-%.3g)\n", what, got, want, tolerance);
+        failures++;
+    }
+}
+
+inline int finish(const char* name){
+    if(failures == 0){
+        std::printf("%s: ok\n", name);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace test
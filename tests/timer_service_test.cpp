@@ -0,0 +1,146 @@
+// TimerService 时间轮：跨层的定时器恰好在到期 tick 触发（不早不晚），周期、取消、暂停/继续与 id 代数
+// 失败时打印出错的检查并返回非 0，供 ctest 使用
+#include "tools/timer_service.h"
+
+#include "test_expect.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+using test::expect;
+using test::expectEq;
+
+constexpr uint64_t kTickNs = 1000000;
+
+// 随机延迟，覆盖 6 层中的前 5 层（每层 64 槽）
+uint64_t randomDelayTicks(std::mt19937_64& rng){
+    const int level = static_cast<int>(rng() % 5);
+    const uint64_t span = 1ULL << (6 * (level + 1));
+    return 1 + rng() % span;
+}
+
+void testOneShotAcrossLevels(){
+    tools::TimerService timers(kTickNs);
+    std::mt19937_64 rng(7);
+
+    constexpr int kCount = 2000;
+    std::vector<uint64_t> expected(kCount), firedAt(kCount, 0);
+    std::vector<int> fireCount(kCount, 0);
+    uint64_t last = 0;
+    for(int i = 0; i < kCount; i++){
+        const uint64_t ticks = randomDelayTicks(rng);
+        expected[i] = ticks;
+        last = std::max(last, ticks);
+        // 延迟不是整 tick 时向上取整
+        const uint64_t delayNs = ticks * kTickNs - (rng() % 2 ? kTickNs / 2 : 0);
+        timers.schedule(delayNs, 0, [&timers, &firedAt, &fireCount, i]{
+            firedAt[i] = timers.getNowNs() / kTickNs;
+            fireCount[i]++;
+        });
+    }
+    expectEq("scheduled count", timers.getScheduledCount(), kCount);
+    expectEq("first deadline", timers.getNextDeadlineNs(), *std::min_element(expected.begin(), expected.end()) * kTickNs);
+
+    // 每次推进的步长随机，从不足 1 tick 到跨越多个高层槽
+    while(timers.getNowNs() / kTickNs <= last){
+        const uint64_t step = rng() % 4 == 0 ? (rng() % (kTickNs * 5000)) : (rng() % (kTickNs * 3));
+        timers.advance(step);
+    }
+    for(int i = 0; i < kCount; i++){
+        expectEq("one-shot fire count", fireCount[i], 1);
+        expectEq("one-shot fire tick", firedAt[i], expected[i]);
+    }
+    expectEq("one-shot released", timers.getScheduledCount(), 0);
+    expectEq("fired total", timers.getFiredTotal(), kCount);
+    expectEq("idle deadline", timers.getNextDeadlineNs(), UINT64_MAX);
+}
+
+void testPeriodic(){
+    tools::TimerService timers(kTickNs);
+    std::vector<uint64_t> ticks;
+    const tools::TimerId id = timers.schedule(5 * kTickNs, 70 * kTickNs, [&]{ticks.push_back(timers.getNowNs() / kTickNs);});
+    timers.advance((5 + 70 * 100) * kTickNs);
+    expectEq("periodic count", ticks.size(), 101);
+    for(size_t i = 0; i < ticks.size(); i++){
+        expectEq("periodic tick", ticks[i], 5 + 70 * i);
+    }
+    expect(timers.isScheduled(id), "periodic still scheduled", 0, 1);
+    expect(timers.cancel(id), "periodic cancel", 0, 1);
+    expect(!timers.isValid(id), "cancelled id invalid", 1, 0);
+    expect(!timers.cancel(id), "double cancel", 1, 0);
+}
+
+void testPersistentAndReuse(){
+    tools::TimerService timers(kTickNs);
+    // persistent 一次性定时器：触发后保留，用 takeFired() 取走次数
+    const tools::TimerId event = timers.schedule(3 * kTickNs, 0, nullptr, true);
+    timers.advance(10 * kTickNs);
+    expect(timers.isValid(event), "persistent kept", 0, 1);
+    expect(!timers.isScheduled(event), "persistent idle", 1, 0);
+    expectEq("takeFired", timers.takeFired(event), 1);
+    expectEq("takeFired cleared", timers.takeFired(event), 0);
+    expect(timers.reschedule(event, 2 * kTickNs, 0), "reschedule", 0, 1);
+    timers.advance(2 * kTickNs);
+    expectEq("rescheduled fired", timers.takeFired(event), 1);
+
+    // 释放后复用同一个节点：旧 id 的代数不同，不能误操作新定时器
+    timers.cancel(event);
+    int fired = 0;
+    const tools::TimerId reused = timers.schedule(1 * kTickNs, 0, [&]{fired++;});
+    expectEq("node reused", reused & 0xFFFFFFFFu, event & 0xFFFFFFFFu);
+    expect(reused != event, "generation bumped", reused, event);
+    expect(!timers.cancel(event), "stale id cancel", 1, 0);
+    timers.advance(kTickNs);
+    expectEq("reused fired", fired, 1);
+}
+
+void testPauseResume(){
+    tools::TimerService timers(kTickNs);
+    uint64_t firedTick = 0;
+    const tools::TimerId id = timers.schedule(100 * kTickNs, 0, [&]{firedTick = timers.getNowNs() / kTickNs;});
+    timers.advance(40 * kTickNs);
+    expect(timers.pause(id), "pause", 0, 1);
+    expectEq("paused remaining", timers.getRemainingNs(id), 60 * kTickNs);
+    expectEq("paused not counted", timers.getScheduledCount(), 0);
+    timers.advance(1000 * kTickNs);
+    expectEq("paused not fired", firedTick, 0);
+    expect(timers.resume(id), "resume", 0, 1);
+    timers.advance(59 * kTickNs);
+    expectEq("resume not early", firedTick, 0);
+    timers.advance(kTickNs);
+    expectEq("resume fired tick", firedTick, 1100);
+}
+
+void testScheduleFromCallback(){
+    tools::TimerService timers(kTickNs);
+    // 回调里调度的新定时器至少在 1 tick 之后，不会在同一 tick 里触发
+    std::vector<uint64_t> ticks;
+    std::function<void()> chain = [&]{
+        ticks.push_back(timers.getNowNs() / kTickNs);
+        if(ticks.size() < 5){
+            timers.schedule(0, 0, chain);
+        }
+    };
+    timers.schedule(64 * kTickNs, 0, chain);
+    timers.advance(200 * kTickNs);
+    expectEq("chain count", ticks.size(), 5);
+    for(size_t i = 0; i < ticks.size(); i++){
+        expectEq("chain tick", ticks[i], 64 + i);
+    }
+}
+
+} // namespace
+
+int main(){
+    testOneShotAcrossLevels();
+    testPeriodic();
+    testPersistentAndReuse();
+    testPauseResume();
+    testScheduleFromCallback();
+    return test::finish("timer_service_test");
+}
@@ -0,0 +1,557 @@
+// 资源烘焙（构建时运行，-DPATPAT_EMBED_ASSETS=ON）
+// 用法：asset-baker -o <embedded_assets_data.h> <manifest.json>...
+// 在源码根目录运行，清单与图片的路径和运行时一样是相对路径
+// - 校验清单：字段类型、图片是否存在且是 PNG、帧是否落在精灵表内、音效引用、颜色写法，任何错误都让构建失败
+// - 按与 loadManifest / normalizeDesc / buildFramesFrom* 相同的规则补全默认值、展开帧，生成 constexpr 表
+// - 图片与音效的字节原样编进表里，运行时用 SDL_IOFromConstMem 读取
+// 不依赖 SDL，只用 minijson
+#include "tools/minijson.h"
+#include "tools/string_format.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Frame{
+    int x = 0, y = 0, w = 0, h = 0;
+    int durationMS = 0;
+};
+
+struct Cue{
+    int frame = 0;
+    std::string sound;
+    int priority = 0;
+    double volume = 1.0;
+};
+
+struct Animation{
+    std::string name;
+    std::string path;
+    std::vector<Frame> frames;
+    std::vector<Cue> cues;
+    int frameWidth = 0, frameHeight = 0;
+    int fps = 0;
+    bool loop = true;
+    bool isMovement = false;
+};
+
+struct Sound{
+    std::string name;
+    std::string path;
+    double volume = 1.0;
+};
+
+struct Palette{
+    std::string name;
+    std::vector<std::pair<unsigned, unsigned>> colors;
+};
+
+struct Manifest{
+    std::string path;
+    int version = 1;
+    std::string basePath;
+    std::vector<Animation> animations;
+    std::vector<Sound> sounds;
+    std::vector<Palette> palettes;
+};
+
+struct File{
+    std::string path;
+    std::string bytes;
+};
+
+int errors = 0;
+
+void fail(const std::string& where, const std::string& what){
+    std::fprintf(stderr, "%s: error: %s\n", where.c_str(), what.c_str());
+    errors++;
+}
+
+bool readFile(const std::string& path, std::string& out){
+    std::ifstream ifs(path, std::ios::binary);
+    if(!ifs.is_open()) return false;
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    out = oss.str();
+    return true;
+}
+
+// PNG 的宽高在 IHDR 块里：8 字节签名 + 4 字节长度 + "IHDR" + 宽 + 高（大端）
+bool pngSize(const std::string& bytes, int& w, int& h){
+    static const unsigned char kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if(bytes.size() < 24 || std::memcmp(bytes.data(), kSignature, 8) != 0 || bytes.compare(12, 4, "IHDR") != 0){
+        return false;
+    }
+    auto be32 = [&bytes](size_t at){
+        unsigned v = 0;
+        for(size_t i = 0; i < 4; i++) v = (v << 8) | static_cast<unsigned char>(bytes[at + i]);
+        return v;
+    };
+    w = static_cast<int>(be32(16));
+    h = static_cast<int>(be32(20));
+    return w > 0 && h > 0;
+}
+
+// 与 manifest_loader.cpp 的 parseColor 相同："#RRGGBB" 或 "#RRGGBBAA" -> ARGB8888
+bool parseColor(const std::string& text, unsigned& out){
+    if(text.size() != 7 && text.size() != 9) return false;
+    if(text[0] != '#') return false;
+    unsigned v = 0;
+    for(size_t i = 1; i < text.size(); i++){
+        const char c = text[i];
+        unsigned d = 0;
+        if(c >= '0' && c <= '9') d = c - '0';
+        else if(c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') d = c - 'A' + 10;
+        else return false;
+        v = (v << 4) | d;
+    }
+    out = text.size() == 7 ? (0xFF000000u | v) : ((v & 0xFF) << 24) | (v >> 8);
+    return true;
+}
+
+// 清单的对象是哈希表，按名字排序，生成的文件与平台无关、可复现
+std::vector<const minijson::Object::value_type*> sorted(const minijson::Object& o){
+    std::vector<const minijson::Object::value_type*> out;
+    out.reserve(o.size());
+    for(const auto& kv : o) out.push_back(&kv);
+    std::sort(out.begin(), out.end(), [](auto a, auto b){ return a->first < b->first; });
+    return out;
+}
+
+// 字段存在但类型不对时报错（运行时会静默使用默认值）
+bool checkType(const std::string& where, const minijson::Value& obj, const char* key, minijson::Value::Type type, const char* typeName){
+    const minijson::Value* v = obj.get(key);
+    if(v && v->type != type){
+        fail(where, std::string("\"") + key + "\" must be " + typeName);
+        return false;
+    }
+    return true;
+}
+
+class Baker{
+public:
+    // 文件按路径去重，返回下标
+    size_t addFile(const std::string& path, std::string bytes){
+        auto it = fileIndex_.find(path);
+        if(it != fileIndex_.end()) return it->second;
+        files_.push_back(File{path, std::move(bytes)});
+        fileIndex_.emplace(path, files_.size() - 1);
+        return files_.size() - 1;
+    }
+
+    void bakeManifest(const std::string& path);
+    std::string generate() const;
+
+private:
+    void bakeAnimation(const std::string& where, const Manifest& mf, const std::string& name,
+                       const minijson::Value& val, const minijson::Value* defaults, Animation& out);
+
+    std::vector<File> files_;
+    std::map<std::string, size_t> fileIndex_;
+    std::vector<Manifest> manifests_;
+};
+
+void Baker::bakeManifest(const std::string& path){
+    const int errorsBefore = errors;
+    std::string text;
+    if(!readFile(path, text)){
+        fail(path, "cannot read manifest");
+        return;
+    }
+    minijson::ParseResult res = minijson::parse(text);
+    if(!res.ok || !res.root.isObject()){
+        fail(path, "invalid JSON: " + (res.ok ? std::string("root is not an object") : res.error));
+        return;
+    }
+    const minijson::Value& root = res.root;
+    using Type = minijson::Value::Type;
+
+    Manifest mf;
+    mf.path = path;
+    checkType(path, root, "version", Type::Number, "a number");
+    checkType(path, root, "basePath", Type::String, "a string");
+    mf.version = root.getInt("version", 1);
+    mf.basePath = root.getString("basePath", "");
+    if(!mf.basePath.empty() && mf.basePath.back() != '/' && mf.basePath.back() != '\\'){
+        mf.basePath.push_back('/');
+    }
+
+    const minijson::Value* defaults = root.get("defaults");
+    if(defaults){
+        if(!defaults->isObject()){
+            fail(path, "\"defaults\" must be an object");
+            defaults = nullptr;
+        } else{
+            const std::string where = path + ": defaults";
+            checkType(where, *defaults, "frameWidth", Type::Number, "a number");
+            checkType(where, *defaults, "frameHeight", Type::Number, "a number");
+            checkType(where, *defaults, "fps", Type::Number, "a number");
+            checkType(where, *defaults, "loop", Type::Bool, "true or false");
+            checkType(where, *defaults, "layout", Type::String, "a string");
+            checkType(where, *defaults, "is_movement", Type::Bool, "true or false");
+        }
+    }
+
+    // 音效在动画之前：动画的 cue 要引用它们
+    if(const minijson::Value* sounds = root.get("sounds")){
+        if(!sounds->isObject()){
+            fail(path, "\"sounds\" must be an object");
+        } else{
+            for(const auto* kv : sorted(sounds->o)){
+                const std::string where = path + ": sounds." + kv->first;
+                Sound sd;
+                sd.name = kv->first;
+                if(kv->second.isString()){
+                    sd.path = kv->second.s;
+                } else if(kv->second.isObject()){
+                    checkType(where, kv->second, "volume", Type::Number, "a number");
+                    sd.path = kv->second.getString("path", "");
+                    sd.volume = kv->second.getNumber("volume", 1.0);
+                }
+                if(sd.path.empty()){
+                    fail(where, "missing \"path\"");
+                    continue;
+                }
+                std::string bytes;
+                if(!readFile(mf.basePath + sd.path, bytes)){
+                    fail(where, "cannot read " + mf.basePath + sd.path);
+                    continue;
+                }
+                addFile(mf.basePath + sd.path, std::move(bytes));
+                mf.sounds.push_back(std::move(sd));
+            }
+        }
+    }
+
+    const minijson::Object* animations = root.getObject("animations");
+    if(!animations || animations->empty()){
+        fail(path, "\"animations\" must be a non-empty object");
+    } else{
+        for(const auto* kv : sorted(*animations)){
+            const std::string where = path + ": animations." + kv->first;
+            if(!kv->second.isObject()){
+                fail(where, "must be an object");
+                continue;
+            }
+            Animation anim;
+            bakeAnimation(where, mf, kv->first, kv->second, defaults, anim);
+            mf.animations.push_back(std::move(anim));
+        }
+    }
+
+    if(const minijson::Value* palettes = root.get("palettes")){
+        if(!palettes->isObject()){
+            fail(path, "\"palettes\" must be an object");
+        } else{
+            for(const auto* kv : sorted(palettes->o)){
+                const std::string where = path + ": palettes." + kv->first;
+                if(!kv->second.isObject()){
+                    fail(where, "must be an object");
+                    continue;
+                }
+                Palette pal;
+                pal.name = kv->first;
+                for(const auto* entry : sorted(kv->second.o)){
+                    unsigned from = 0, to = 0;
+                    if(!entry->second.isString() || !parseColor(entry->first, from) || !parseColor(entry->second.s, to)){
+                        fail(where, "bad color entry \"" + entry->first + "\" (expected \"#RRGGBB\" or \"#RRGGBBAA\")");
+                        continue;
+                    }
+                    pal.colors.emplace_back(from, to);
+                }
+                mf.palettes.push_back(std::move(pal));
+            }
+        }
+    }
+
+    if(errors == errorsBefore){
+        manifests_.push_back(std::move(mf));
+    }
+}
+
+void Baker::bakeAnimation(const std::string& where, const Manifest& mf, const std::string& name,
+                          const minijson::Value& val, const minijson::Value* defaults, Animation& out){
+    using Type = minijson::Value::Type;
+    for(const char* key : {"frames", "frameWidth", "frameHeight", "rows", "cols", "fps"}){
+        checkType(where, val, key, Type::Number, "a number");
+    }
+    checkType(where, val, "loop", Type::Bool, "true or false");
+    checkType(where, val, "is_movement", Type::Bool, "true or false");
+    checkType(where, val, "layout", Type::String, "a string");
+
+    // 与 loadManifest + normalizeDesc 一致
+    auto def = [defaults](const char* key, int fallback){ return defaults ? defaults->getInt(key, fallback) : fallback; };
+    out.name = name;
+    out.path = val.getString("path", "");
+    int frames = val.getInt("frames", -1);
+    out.frameWidth = val.getInt("frameWidth", -1);
+    out.frameHeight = val.getInt("frameHeight", -1);
+    const int rows = val.getInt("rows", -1);
+    const int cols = val.getInt("cols", -1);
+    out.fps = val.getInt("fps", -1);
+    out.loop = val.getBool("loop", true);
+    std::string layout = val.getString("layout", "row");
+    out.isMovement = val.getBool("is_movement", false);
+    if(out.fps <= 0) out.fps = def("fps", 8);
+    if(out.frameWidth <= 0) out.frameWidth = def("frameWidth", 48);
+    if(out.frameHeight <= 0) out.frameHeight = def("frameHeight", 48);
+    if(layout.empty()) layout = defaults ? defaults->getString("layout", "row") : "row";
+    if(!out.isMovement) out.isMovement = defaults ? defaults->getBool("is_movement", false) : false;
+
+    if(out.path.empty()){
+        fail(where, "missing \"path\"");
+        return;
+    }
+    const std::string fullPath = mf.basePath + out.path;
+    std::string bytes;
+    if(!readFile(fullPath, bytes)){
+        fail(where, "cannot read " + fullPath);
+        return;
+    }
+    int texW = 0, texH = 0;
+    if(!pngSize(bytes, texW, texH)){
+        fail(where, fullPath + " is not a PNG image");
+        return;
+    }
+    addFile(fullPath, std::move(bytes));
+
+    // 帧：与 CatPet::loadAnimations、buildFramesFromRects / buildFramesFromGrid 一致
+    const int per = 1000 / (out.fps > 0 ? out.fps : 8);
+    if(const minijson::Value* rects = val.get("rects")){
+        if(!rects->isArray()){
+            fail(where, "\"rects\" must be an array");
+            return;
+        }
+        for(const minijson::Value& item : rects->a){
+            if(!item.isObject()) continue;
+            const int durationMS = item.getInt("durationMS", 100);
+            out.frames.push_back(Frame{item.getInt("x", 0), item.getInt("y", 0), item.getInt("w", 0), item.getInt("h", 0),
+                                       durationMS > 0 ? durationMS : per});
+        }
+    } else{
+        if(frames <= 0){
+            if(layout == "grid" && rows > 0 && cols > 0){
+                frames = rows * cols;
+            } else if(out.frameWidth > 0){
+                frames = texW / out.frameWidth;
+            }
+        }
+        if(layout == "grid" && rows > 0 && cols > 0){
+            for(int r = 0; r < rows && static_cast<int>(out.frames.size()) < frames; r++){
+                for(int c = 0; c < cols && static_cast<int>(out.frames.size()) < frames; c++){
+                    out.frames.push_back(Frame{c * out.frameWidth, r * out.frameHeight, out.frameWidth, out.frameHeight, per});
+                }
+            }
+        } else{
+            for(int i = 0; i < frames; i++){
+                out.frames.push_back(Frame{i * out.frameWidth, 0, out.frameWidth, out.frameHeight, per});
+            }
+        }
+    }
+    if(out.frames.empty()){
+        fail(where, "no frames");
+        return;
+    }
+    for(size_t i = 0; i < out.frames.size(); i++){
+        const Frame& f = out.frames[i];
+        if(f.w <= 0 || f.h <= 0 || f.x < 0 || f.y < 0 || f.x + f.w > texW || f.y + f.h > texH){
+            fail(where, "frame " + std::to_string(i) + " (" + std::to_string(f.x) + "," + std::to_string(f.y) + " " +
+                 std::to_string(f.w) + "x" + std::to_string(f.h) + ") is outside " + fullPath +
+                 " (" + std::to_string(texW) + "x" + std::to_string(texH) + ")");
+            return; // 只报第一帧，后面的多半是同一个原因
+        }
+    }
+
+    if(const minijson::Value* cues = val.get("cues")){
+        if(!cues->isArray()){
+            fail(where, "\"cues\" must be an array");
+            return;
+        }
+        for(const minijson::Value& item : cues->a){
+            if(!item.isObject()) continue;
+            Cue cue;
+            cue.frame = item.getInt("frame", 0);
+            cue.sound = item.getString("sound", "");
+            cue.priority = item.getInt("priority", 0);
+            cue.volume = item.getNumber("volume", 1.0);
+            if(cue.sound.empty()) continue;
+            if(cue.frame < 0 || cue.frame >= static_cast<int>(out.frames.size())){
+                fail(where, "cue '" + cue.sound + "' is out of range (frame " + std::to_string(cue.frame) +
+                     " of " + std::to_string(out.frames.size()) + ")");
+                continue;
+            }
+            const bool known = std::any_of(mf.sounds.begin(), mf.sounds.end(), [&cue](const Sound& s){ return s.name == cue.sound; });
+            if(!known){
+                fail(where, "cue refers to an unknown sound '" + cue.sound + "'");
+                continue;
+            }
+            out.cues.push_back(std::move(cue));
+        }
+    }
+}
+
+using tools::appendf;
+using tools::format;
+
+// 生成的是 C++ 源码，字符串按 C 字面量转义
+std::string literal(const std::string& s){
+    std::string out = "\"";
+    for(unsigned char c : s){
+        if(c == '"' || c == '\\'){
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if(c < 0x20 || c >= 0x7F){
+            appendf(out, "\\%03o", c);
+        } else{
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+std::string Baker::generate() const{
+    std::string out;
+    out += "// Generated by tools/asset_baker. Do not edit.\n";
+    out += "#pragma once\n\nnamespace tools::assets{\nnamespace{\n\n";
+
+    for(size_t i = 0; i < files_.size(); i++){
+        const File& f = files_[i];
+        appendf(out, "// %s (%zu bytes)\nconstexpr unsigned char kFile%zu[] = {", f.path.c_str(), f.bytes.size(), i);
+        for(size_t b = 0; b < f.bytes.size(); b++){
+            out += (b % 24 == 0) ? "\n    " : "";
+            out += std::to_string(static_cast<unsigned char>(f.bytes[b]));
+            out += ',';
+        }
+        out += "\n};\n\n";
+    }
+    out += "constexpr EmbeddedFile kEmbeddedFileTable[] = {\n";
+    for(size_t i = 0; i < files_.size(); i++){
+        appendf(out, "    {%s, kFile%zu, sizeof(kFile%zu)},\n", literal(files_[i].path).c_str(), i, i);
+    }
+    out += "};\n\n";
+
+    for(size_t m = 0; m < manifests_.size(); m++){
+        const Manifest& mf = manifests_[m];
+        out += "// " + mf.path + "\n";
+        for(size_t a = 0; a < mf.animations.size(); a++){
+            const Animation& anim = mf.animations[a];
+            appendf(out, "constexpr EmbeddedFrame kFrames%zu_%zu[] = {", m, a);
+            for(const Frame& f : anim.frames){
+                appendf(out, "{%d, %d, %d, %d, %d}, ", f.x, f.y, f.w, f.h, f.durationMS);
+            }
+            out += "};\n";
+            if(!anim.cues.empty()){
+                appendf(out, "constexpr EmbeddedCue kCues%zu_%zu[] = {", m, a);
+                for(const Cue& c : anim.cues){
+                    appendf(out, "{%d, %s, %d, %.6ff}, ", c.frame, literal(c.sound).c_str(), c.priority, c.volume);
+                }
+                out += "};\n";
+            }
+        }
+        appendf(out, "constexpr EmbeddedAnimation kAnimations%zu[] = {\n", m);
+        for(size_t a = 0; a < mf.animations.size(); a++){
+            const Animation& anim = mf.animations[a];
+            std::string cues = "nullptr, 0";
+            if(!anim.cues.empty()){
+                cues = format("kCues%zu_%zu, %zu", m, a, anim.cues.size());
+            }
+            appendf(out, "    {%s, %s, kFrames%zu_%zu, %zu, %s, %d, %d, %d, %s, %s},\n",
+                literal(anim.name).c_str(), literal(anim.path).c_str(), m, a, anim.frames.size(), cues.c_str(),
+                anim.frameWidth, anim.frameHeight, anim.fps, anim.loop ? "true" : "false", anim.isMovement ? "true" : "false");
+        }
+        out += "};\n";
+        if(!mf.sounds.empty()){
+            appendf(out, "constexpr EmbeddedSound kSounds%zu[] = {\n", m);
+            for(const Sound& s : mf.sounds){
+                appendf(out, "    {%s, %s, %.6ff},\n", literal(s.name).c_str(), literal(s.path).c_str(), s.volume);
+            }
+            out += "};\n";
+        }
+        for(size_t p = 0; p < mf.palettes.size(); p++){
+            const Palette& pal = mf.palettes[p];
+            if(pal.colors.empty()) continue;
+            appendf(out, "constexpr EmbeddedColor kColors%zu_%zu[] = {", m, p);
+            for(const auto& c : pal.colors){
+                appendf(out, "{0x%08Xu, 0x%08Xu}, ", c.first, c.second);
+            }
+            out += "};\n";
+        }
+        if(!mf.palettes.empty()){
+            appendf(out, "constexpr EmbeddedPalette kPalettes%zu[] = {\n", m);
+            for(size_t p = 0; p < mf.palettes.size(); p++){
+                const Palette& pal = mf.palettes[p];
+                if(pal.colors.empty()){
+                    out += "    {" + literal(pal.name) + ", nullptr, 0},\n";
+                } else{
+                    appendf(out, "    {%s, kColors%zu_%zu, %zu},\n", literal(pal.name).c_str(), m, p, pal.colors.size());
+                }
+            }
+            out += "};\n";
+        }
+        out += "\n";
+    }
+
+    out += "constexpr EmbeddedManifest kEmbeddedManifestTable[] = {\n";
+    for(size_t m = 0; m < manifests_.size(); m++){
+        const Manifest& mf = manifests_[m];
+        std::string sounds = "nullptr, 0", palettes = "nullptr, 0";
+        if(!mf.sounds.empty()){
+            sounds = format("kSounds%zu, %zu", m, mf.sounds.size());
+        }
+        if(!mf.palettes.empty()){
+            palettes = format("kPalettes%zu, %zu", m, mf.palettes.size());
+        }
+        appendf(out, "    {%s, %d, %s, kAnimations%zu, %zu, %s, %s},\n",
+            literal(mf.path).c_str(), mf.version, literal(mf.basePath).c_str(), m, mf.animations.size(), sounds.c_str(), palettes.c_str());
+    }
+    out += "};\n\n";
+
+    out += "constexpr const EmbeddedFile* kEmbeddedFiles = kEmbeddedFileTable;\n";
+    out += "constexpr size_t kEmbeddedFileCount = sizeof(kEmbeddedFileTable) / sizeof(kEmbeddedFileTable[0]);\n";
+    out += "constexpr const EmbeddedManifest* kEmbeddedManifests = kEmbeddedManifestTable;\n";
+    out += "constexpr size_t kEmbeddedManifestCount = sizeof(kEmbeddedManifestTable) / sizeof(kEmbeddedManifestTable[0]);\n\n";
+    out += "} // namespace\n} // namespace tools::assets\n";
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    std::string output;
+    std::vector<std::string> manifests;
+    for(int i = 1; i < argc; i++){
+        if(std::strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+            output = argv[++i];
+        } else{
+            manifests.push_back(argv[i]);
+        }
+    }
+    if(output.empty() || manifests.empty()){
+        std::fprintf(stderr, "Usage: %s -o <embedded_assets_data.h> <manifest.json>...\n", argv[0]);
+        return 2;
+    }
+
+    Baker baker;
+    for(const std::string& path : manifests){
+        baker.bakeManifest(path);
+    }
+    if(errors > 0){
+        std::fprintf(stderr, "asset-baker: %d error(s), nothing written\n", errors);
+        return 1;
+    }
+
+    std::ofstream ofs(output, std::ios::binary | std::ios::trunc);
+    if(!ofs.is_open() || !(ofs << baker.generate())){
+        std::fprintf(stderr, "asset-baker: cannot write %s\n", output.c_str());
+        return 1;
+    }
+    return 0;
+}